@@ -0,0 +1,104 @@
+#ifndef MULTIPLE_WINDOWS_ALPHA_MASK_H_
+#define MULTIPLE_WINDOWS_ALPHA_MASK_H_
+
+#include <cstdint>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define MULTIPLE_WINDOWS_ALPHA_MASK_SSE2 1
+#endif
+
+// Per-pixel hit testing for partially click-through windows.
+//
+// Dart sends a downsampled alpha channel of what it painted. The alpha bytes
+// are thresholded into a packed bitmask (one bit per mask pixel, 64 pixels
+// per word) so that WM_NCHITTEST is a scale and a single bit lookup. The
+// threshold kernel handles 16 pixels per SSE2 compare where available and
+// falls back to a scalar loop otherwise.
+//
+// Nothing here depends on <windows.h>.
+
+class AlphaHitMask {
+ public:
+  /// Builds the mask from |alpha|, |width| * |height| bytes in row-major
+  /// order. Pixels with alpha >= |threshold| take input.
+  void Build(const uint8_t* alpha,
+             int32_t width,
+             int32_t height,
+             uint8_t threshold) {
+    width_ = width > 0 ? width : 0;
+    height_ = height > 0 ? height : 0;
+    words_per_row_ = (width_ + 63) / 64;
+    bits_.assign(static_cast<size_t>(words_per_row_) * height_, 0);
+    if (threshold == 0) {
+      threshold = 1;
+    }
+    for (int32_t y = 0; y < height_; ++y) {
+      ThresholdRow(alpha + static_cast<size_t>(y) * width_, width_, threshold,
+                   &bits_[static_cast<size_t>(y) * words_per_row_]);
+    }
+  }
+
+  bool empty() const { return width_ == 0 || height_ == 0; }
+
+  /// Whether mask pixel (x, y) takes input.
+  bool Test(int32_t x, int32_t y) const {
+    if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+      return false;
+    }
+    uint64_t word = bits_[static_cast<size_t>(y) * words_per_row_ + (x >> 6)];
+    return (word >> (x & 63)) & 1;
+  }
+
+  /// Whether the client point (x, y) of a |client_width| x |client_height|
+  /// client area takes input; the mask is stretched over the client area.
+  bool TestClient(int32_t x,
+                  int32_t y,
+                  int32_t client_width,
+                  int32_t client_height) const {
+    if (client_width <= 0 || client_height <= 0) {
+      return false;
+    }
+    return Test(static_cast<int32_t>(static_cast<int64_t>(x) * width_ /
+                                     client_width),
+                static_cast<int32_t>(static_cast<int64_t>(y) * height_ /
+                                     client_height));
+  }
+
+ private:
+  static void ThresholdRow(const uint8_t* row,
+                           int32_t width,
+                           uint8_t threshold,
+                           uint64_t* out) {
+    int32_t x = 0;
+#if defined(MULTIPLE_WINDOWS_ALPHA_MASK_SSE2)
+    // alpha >= threshold  <=>  max(alpha, threshold) == alpha (unsigned).
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(threshold));
+    for (; x + 64 <= width; x += 64) {
+      uint64_t word = 0;
+      for (int32_t lane = 0; lane < 4; ++lane) {
+        __m128i pixels = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(row + x + lane * 16));
+        __m128i hit = _mm_cmpeq_epi8(_mm_max_epu8(pixels, limit), pixels);
+        word |= static_cast<uint64_t>(
+                    static_cast<uint32_t>(_mm_movemask_epi8(hit)))
+                << (lane * 16);
+      }
+      out[x >> 6] = word;
+    }
+#endif
+    for (; x < width; ++x) {
+      if (row[x] >= threshold) {
+        out[x >> 6] |= uint64_t{1} << (x & 63);
+      }
+    }
+  }
+
+  std::vector<uint64_t> bits_;
+  int32_t width_ = 0;
+  int32_t height_ = 0;
+  int32_t words_per_row_ = 0;
+};
+
+#endif  // MULTIPLE_WINDOWS_ALPHA_MASK_H_
@@ -0,0 +1,422 @@
+#ifndef MULTIPLE_WINDOWS_COMPOSITION_ENGINE_H_
+#define MULTIPLE_WINDOWS_COMPOSITION_ENGINE_H_
+
+// This must be included before many other Windows headers.
+#include <windows.h>
+
+#include <dwmapi.h>
+
+#include <cstdint>
+
+#include "win32_calls.h"
+
+/// The fields of ACCENT_POLICY (state, flags, gradient color, animation id).
+struct AccentTuple {
+  DWORD state;
+  DWORD flags;
+  DWORD color;
+  DWORD animation_id;
+
+  bool operator==(const AccentTuple& other) const {
+    return state == other.state && flags == other.flags &&
+           color == other.color && animation_id == other.animation_id;
+  }
+};
+
+/// What one front-end wants composed on a window. Only the attributes whose
+/// bit is set in |fields| are requested; the others are left to other layers.
+struct CompositionRequest {
+  uint32_t fields = 0;
+  AccentTuple accent = {};
+  MARGINS margins = {};
+  // DWMWA_SYSTEMBACKDROP_TYPE.
+  INT backdrop = 0;
+  // DWMWA_USE_IMMERSIVE_DARK_MODE.
+  BOOL dark_mode = FALSE;
+  // DWMWA_CAPTION_COLOR.
+  COLORREF caption_color = 0;
+  // The undocumented pre-22523 Mica attribute.
+  BOOL mica = FALSE;
+};
+
+/// Owns the composition of each window: the accent policy, the DWM frame
+/// margins, the system backdrop, the caption color and the dark mode and
+/// Mica attributes.
+///
+/// The runner (transparent backgrounds and custom frames), window_manager
+/// (background color, shadow margins and brightness) and flutter_acrylic
+/// (window effects) set their requests on separate layers instead of calling
+/// SetWindowCompositionAttribute and DWM directly. For every attribute the
+/// highest layer that requests it wins, so for example turning an acrylic
+/// effect off brings back the transparent background underneath it instead
+/// of leaving whatever the last caller wrote. The two frame layers share the
+/// lowest priority: between them the one set last wins, as it would with
+/// direct calls. After each change the resolved state is compared with what
+/// is applied and only the attributes that differ are sent.
+///
+/// These are separate modules, so the state lives in a block on the process
+/// heap that is attached to the window as a property and shared by all of
+/// them. Use from the thread that owns the window.
+class CompositionEngine {
+ public:
+  /// Lowest to highest priority.
+  enum Layer : uint32_t {
+    // The runner's window modes: custom frames and hidden title bars.
+    kModeFrame = 0,
+    // window_manager's title bar style, shadow and brightness. Same priority
+    // as kModeFrame; the more recently set of the two wins.
+    kWindowManagerFrame,
+    kBackgroundColor,
+    kTransparency,
+    kEffect,
+    kLayerCount,
+  };
+
+  enum Field : uint32_t {
+    kAccent = 1 << 0,
+    kMargins = 1 << 1,
+    kBackdrop = 1 << 2,
+    kDarkMode = 1 << 3,
+    kCaptionColor = 1 << 4,
+    kMica = 1 << 5,
+  };
+
+  /// Calls issued and calls skipped because the value was already in effect,
+  /// by this module.
+  struct Counters {
+    uint64_t accent_issued = 0;
+    uint64_t accent_skipped = 0;
+    uint64_t margins_issued = 0;
+    uint64_t margins_skipped = 0;
+    uint64_t attributes_issued = 0;
+    uint64_t attributes_skipped = 0;
+  };
+
+  /// Replaces the request of |layer| and applies the result. The setters
+  /// return whether every attribute that had to be sent was applied.
+  static bool Set(HWND hwnd, Layer layer, const CompositionRequest& request) {
+    State* state = Attach(hwnd);
+    if (!state) {
+      return false;
+    }
+    state->stamps[layer] = ++state->next_stamp;
+    state->layers[layer] = request;
+    return Commit(hwnd, state);
+  }
+
+  /// Sets only the accent of |layer|, keeping its other attributes.
+  static bool SetAccent(HWND hwnd, Layer layer, const AccentTuple& accent) {
+    State* state = Attach(hwnd);
+    if (!state) {
+      return false;
+    }
+    state->stamps[layer] = ++state->next_stamp;
+    state->layers[layer].fields |= kAccent;
+    state->layers[layer].accent = accent;
+    return Commit(hwnd, state);
+  }
+
+  /// Sets only the margins of |layer|, keeping its other attributes.
+  static bool SetMargins(HWND hwnd, Layer layer, const MARGINS& margins) {
+    State* state = Attach(hwnd);
+    if (!state) {
+      return false;
+    }
+    state->stamps[layer] = ++state->next_stamp;
+    state->layers[layer].fields |= kMargins;
+    state->layers[layer].margins = margins;
+    return Commit(hwnd, state);
+  }
+
+  /// Sets only the dark mode attribute of |layer|.
+  static bool SetDarkMode(HWND hwnd, Layer layer, BOOL dark_mode) {
+    State* state = Attach(hwnd);
+    if (!state) {
+      return false;
+    }
+    state->stamps[layer] = ++state->next_stamp;
+    state->layers[layer].fields |= kDarkMode;
+    state->layers[layer].dark_mode = dark_mode;
+    return Commit(hwnd, state);
+  }
+
+  /// Withdraws every request of |layer|.
+  static bool Clear(HWND hwnd, Layer layer) {
+    State* state = Find(hwnd);
+    if (!state) {
+      return true;
+    }
+    state->layers[layer] = CompositionRequest();
+    return Commit(hwnd, state);
+  }
+
+  /// Whether |layer| currently requests an accent.
+  static bool HasAccent(HWND hwnd, Layer layer) {
+    State* state = Find(hwnd);
+    return state && (state->layers[layer].fields & kAccent);
+  }
+
+  /// Frees the state of |hwnd|; call when the window is destroyed.
+  static void Release(HWND hwnd) {
+    HANDLE block = win32::RemovePropW(hwnd, kStateProperty);
+    if (block) {
+      ::HeapFree(::GetProcessHeap(), 0, block);
+    }
+  }
+
+  /// Whether SetWindowCompositionAttribute is available.
+  static bool AccentSupported() { return SetAttributeExported(); }
+
+  static const Counters& counters() { return MutableCounters(); }
+
+ private:
+  static constexpr const wchar_t* kStateProperty =
+      L"MultipleWindowsCompositionState";
+  static constexpr uint32_t kStateMagic = 0x504D4F43;  // 'COMP'
+  static constexpr uint32_t kStateVersion = 2;
+  static constexpr DWORD kAccentDisabled = 0;
+  static constexpr DWORD kAccentPolicyAttribute = 19;
+  static constexpr DWORD kBackdropAttribute = 38;
+  static constexpr DWORD kDarkModeAttribute = 20;
+  static constexpr DWORD kCaptionColorAttribute = 35;
+  static constexpr DWORD kMicaAttribute = 1029;
+
+  // Shared by all modules through the window property; plain data only, and
+  // only ever extended at the end with a version bump.
+  struct State {
+    uint32_t magic;
+    uint32_t version;
+    CompositionRequest layers[kLayerCount];
+    // What was last sent; |fields| marks the attributes that were ever set.
+    CompositionRequest applied;
+    // When each layer was last set, to order the frame layers.
+    uint32_t stamps[kLayerCount];
+    uint32_t next_stamp;
+  };
+
+  struct AccentPolicyData {
+    DWORD state;
+    DWORD flags;
+    DWORD color;
+    DWORD animation_id;
+  };
+
+  static Counters& MutableCounters() {
+    static Counters counters;
+    return counters;
+  }
+
+  // Looked up once per module; the calls themselves go through the backend.
+  static bool SetAttributeExported() {
+    static const bool exported = []() {
+      HMODULE user32 = ::GetModuleHandleW(L"user32.dll");
+      return user32 != nullptr &&
+             ::GetProcAddress(user32, "SetWindowCompositionAttribute") !=
+                 nullptr;
+    }();
+    return exported;
+  }
+
+  static State* Find(HWND hwnd) {
+    State* state = static_cast<State*>(win32::GetPropW(hwnd, kStateProperty));
+    if (!state || state->magic != kStateMagic ||
+        state->version != kStateVersion) {
+      return nullptr;
+    }
+    return state;
+  }
+
+  static State* Attach(HWND hwnd) {
+    if (State* state = Find(hwnd)) {
+      return state;
+    }
+    if (!win32::IsWindow(hwnd)) {
+      return nullptr;
+    }
+    State* state = static_cast<State*>(
+        ::HeapAlloc(::GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(State)));
+    if (!state) {
+      return nullptr;
+    }
+    state->magic = kStateMagic;
+    state->version = kStateVersion;
+    if (!win32::SetPropW(hwnd, kStateProperty, state)) {
+      ::HeapFree(::GetProcessHeap(), 0, state);
+      return nullptr;
+    }
+    return state;
+  }
+
+  // The value of each attribute from the highest layer requesting it. An
+  // attribute nobody requests any more goes back to its default, but only if
+  // it was ever set; untouched attributes stay as the system left them.
+  static CompositionRequest Resolve(const State& state) {
+    CompositionRequest resolved;
+    resolved.accent = {kAccentDisabled, 0, 0, 0};
+    // At least one non-negative margin keeps the DWM shadow of windows that
+    // handle WM_NCCALCSIZE, matching what flutter_acrylic restored when
+    // leaving Mica.
+    resolved.margins = {0, 0, 1, 0};
+    // DWMWA_CAPTION_COLOR's DWMWA_COLOR_DEFAULT.
+    resolved.caption_color = 0xFFFFFFFF;
+
+    // Highest priority first; the frame layers by recency.
+    uint32_t order[kLayerCount];
+    for (uint32_t i = 0; i < kLayerCount; ++i) {
+      order[i] = kLayerCount - 1 - i;
+    }
+    if (state.stamps[kModeFrame] > state.stamps[kWindowManagerFrame]) {
+      order[kLayerCount - 2] = kModeFrame;
+      order[kLayerCount - 1] = kWindowManagerFrame;
+    }
+
+    for (uint32_t field = kAccent; field <= kMica; field <<= 1) {
+      for (uint32_t layer : order) {
+        const CompositionRequest& request = state.layers[layer];
+        if (request.fields & field) {
+          CopyField(request, field, &resolved);
+          resolved.fields |= field;
+          break;
+        }
+      }
+    }
+    resolved.fields |= state.applied.fields;
+    return resolved;
+  }
+
+  static void CopyField(const CompositionRequest& from,
+                        uint32_t field,
+                        CompositionRequest* to) {
+    switch (field) {
+      case kAccent:
+        to->accent = from.accent;
+        break;
+      case kMargins:
+        to->margins = from.margins;
+        break;
+      case kBackdrop:
+        to->backdrop = from.backdrop;
+        break;
+      case kDarkMode:
+        to->dark_mode = from.dark_mode;
+        break;
+      case kCaptionColor:
+        to->caption_color = from.caption_color;
+        break;
+      case kMica:
+        to->mica = from.mica;
+        break;
+    }
+  }
+
+  static bool SameMargins(const MARGINS& a, const MARGINS& b) {
+    return a.cxLeftWidth == b.cxLeftWidth && a.cxRightWidth == b.cxRightWidth &&
+           a.cyTopHeight == b.cyTopHeight &&
+           a.cyBottomHeight == b.cyBottomHeight;
+  }
+
+  static bool ApplyAccent(HWND hwnd, const AccentTuple& accent) {
+    if (!AccentSupported()) {
+      return false;
+    }
+    AccentPolicyData policy = {accent.state, accent.flags, accent.color,
+                               accent.animation_id};
+    WindowCompositionAttributeData data = {kAccentPolicyAttribute, &policy,
+                                           sizeof(policy)};
+    return win32::SetWindowCompositionAttribute(hwnd, &data) != FALSE;
+  }
+
+  // Returns false if DWM rejected the value; it is then sent again on the
+  // next commit.
+  template <typename T>
+  static bool ApplyAttribute(HWND hwnd,
+                             uint32_t field,
+                             DWORD attribute,
+                             const T& value,
+                             T* applied,
+                             uint32_t* applied_fields) {
+    Counters& counters = MutableCounters();
+    if ((*applied_fields & field) && *applied == value) {
+      ++counters.attributes_skipped;
+      return true;
+    }
+    ++counters.attributes_issued;
+    if (FAILED(win32::DwmSetWindowAttribute(hwnd, attribute, &value,
+                                            sizeof(value)))) {
+      return false;
+    }
+    *applied = value;
+    *applied_fields |= field;
+    return true;
+  }
+
+  static bool Commit(HWND hwnd, State* state) {
+    CompositionRequest target = Resolve(*state);
+    CompositionRequest& applied = state->applied;
+    Counters& counters = MutableCounters();
+    bool succeeded = true;
+
+    if (target.fields & kAccent) {
+      if ((applied.fields & kAccent) && applied.accent == target.accent) {
+        ++counters.accent_skipped;
+      } else {
+        // Switching between two enabled accent states only takes effect
+        // through ACCENT_DISABLED.
+        if ((applied.fields & kAccent) &&
+            applied.accent.state != kAccentDisabled &&
+            target.accent.state != kAccentDisabled &&
+            applied.accent.state != target.accent.state) {
+          ++counters.accent_issued;
+          ApplyAccent(hwnd, {kAccentDisabled, 2, 0, 0});
+        }
+        ++counters.accent_issued;
+        if (ApplyAccent(hwnd, target.accent)) {
+          applied.accent = target.accent;
+          applied.fields |= kAccent;
+        } else {
+          succeeded = false;
+        }
+      }
+    }
+
+    if (target.fields & kMargins) {
+      if ((applied.fields & kMargins) &&
+          SameMargins(applied.margins, target.margins)) {
+        ++counters.margins_skipped;
+      } else {
+        ++counters.margins_issued;
+        if (SUCCEEDED(win32::DwmExtendFrameIntoClientArea(hwnd, &target.margins))) {
+          applied.margins = target.margins;
+          applied.fields |= kMargins;
+        } else {
+          succeeded = false;
+        }
+      }
+    }
+
+    if ((target.fields & kDarkMode) &&
+        !ApplyAttribute(hwnd, kDarkMode, kDarkModeAttribute, target.dark_mode,
+                        &applied.dark_mode, &applied.fields)) {
+      succeeded = false;
+    }
+    if ((target.fields & kCaptionColor) &&
+        !ApplyAttribute(hwnd, kCaptionColor, kCaptionColorAttribute,
+                        target.caption_color, &applied.caption_color,
+                        &applied.fields)) {
+      succeeded = false;
+    }
+    if ((target.fields & kBackdrop) &&
+        !ApplyAttribute(hwnd, kBackdrop, kBackdropAttribute, target.backdrop,
+                        &applied.backdrop, &applied.fields)) {
+      succeeded = false;
+    }
+    if ((target.fields & kMica) &&
+        !ApplyAttribute(hwnd, kMica, kMicaAttribute, target.mica,
+                        &applied.mica, &applied.fields)) {
+      succeeded = false;
+    }
+    return succeeded;
+  }
+};
+
+#endif  // MULTIPLE_WINDOWS_COMPOSITION_ENGINE_H_
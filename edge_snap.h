@@ -0,0 +1,124 @@
+#ifndef MULTIPLE_WINDOWS_EDGE_SNAP_H_
+#define MULTIPLE_WINDOWS_EDGE_SNAP_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+// Magnetic edge snapping for WM_MOVING.
+//
+// The edges a moving window can snap to (other windows of the app and the
+// monitor work areas) are collected once when the move starts and kept in two
+// sorted lists, one for vertical edges (x positions) and one for horizontal
+// edges (y positions). Each WM_MOVING then does a binary search per edge of
+// the moving window instead of walking every window.
+//
+// Nothing here depends on <windows.h>; rects use the same layout as RECT.
+
+/// A rect with the same layout as RECT.
+struct SnapRect {
+  int32_t left;
+  int32_t top;
+  int32_t right;
+  int32_t bottom;
+};
+
+class EdgeSnapIndex {
+ public:
+  void Clear() {
+    x_edges_.clear();
+    y_edges_.clear();
+  }
+
+  /// Adds the four edges of |rect|, e.g. another window or a work area.
+  void AddRect(const SnapRect& rect) {
+    x_edges_.push_back({rect.left, rect.top, rect.bottom});
+    x_edges_.push_back({rect.right, rect.top, rect.bottom});
+    y_edges_.push_back({rect.top, rect.left, rect.right});
+    y_edges_.push_back({rect.bottom, rect.left, rect.right});
+  }
+
+  /// Sorts the edges; call after the last AddRect() and before Snap().
+  void Build() {
+    auto by_position = [](const Edge& a, const Edge& b) {
+      return a.position < b.position;
+    };
+    std::sort(x_edges_.begin(), x_edges_.end(), by_position);
+    std::sort(y_edges_.begin(), y_edges_.end(), by_position);
+  }
+
+  bool empty() const { return x_edges_.empty(); }
+
+  /// Moves |rect| (keeping its size) so that its nearest edge within
+  /// |distance| lines up with an indexed edge, independently per axis.
+  /// Edges only attract when they overlap the rect along the other axis.
+  /// Returns whether |rect| changed.
+  bool Snap(SnapRect* rect, int32_t distance) const {
+    if (distance <= 0) {
+      return false;
+    }
+    int32_t dx = 0;
+    int32_t dy = 0;
+    bool snap_x = false;
+    bool snap_y = false;
+    // Our left and right edges against the vertical edges.
+    snap_x |= Nearest(x_edges_, rect->left, rect->top, rect->bottom, distance,
+                      &dx, snap_x);
+    snap_x |= Nearest(x_edges_, rect->right, rect->top, rect->bottom,
+                      distance, &dx, snap_x);
+    // Our top and bottom edges against the horizontal edges.
+    snap_y |= Nearest(y_edges_, rect->top, rect->left, rect->right, distance,
+                      &dy, snap_y);
+    snap_y |= Nearest(y_edges_, rect->bottom, rect->left, rect->right,
+                      distance, &dy, snap_y);
+    if (!snap_x && !snap_y) {
+      return false;
+    }
+    rect->left += dx;
+    rect->right += dx;
+    rect->top += dy;
+    rect->bottom += dy;
+    return dx != 0 || dy != 0;
+  }
+
+ private:
+  struct Edge {
+    int32_t position;
+    // Extent along the other axis.
+    int32_t from;
+    int32_t to;
+  };
+
+  // Finds the indexed edge closest to |position| within |distance| whose
+  // extent overlaps [from, to]. Updates |delta| if it is closer than the one
+  // found so far (|have_delta|).
+  static bool Nearest(const std::vector<Edge>& edges,
+                      int32_t position,
+                      int32_t from,
+                      int32_t to,
+                      int32_t distance,
+                      int32_t* delta,
+                      bool have_delta) {
+    auto it = std::lower_bound(
+        edges.begin(), edges.end(), position - distance,
+        [](const Edge& edge, int32_t value) { return edge.position < value; });
+    bool found = false;
+    for (; it != edges.end() && it->position <= position + distance; ++it) {
+      if (it->to < from - distance || it->from > to + distance) {
+        continue;
+      }
+      int32_t candidate = it->position - position;
+      if ((!have_delta && !found) || std::abs(candidate) < std::abs(*delta)) {
+        *delta = candidate;
+        found = true;
+      }
+    }
+    return found;
+  }
+
+  std::vector<Edge> x_edges_;
+  std::vector<Edge> y_edges_;
+};
+
+#endif  // MULTIPLE_WINDOWS_EDGE_SNAP_H_
@@ -9,6 +9,9 @@
 #include <flutter/standard_method_codec.h>
 
 #include "include/flutter_acrylic/flutter_acrylic_plugin.h"
+#include "composition_engine.h"
+#include "monitor_cache.h"
+#include "win32_calls.h"
 
 #pragma comment(lib, "dwmapi.lib")
 #pragma comment(lib, "comctl32.lib")
@@ -93,6 +96,7 @@ static constexpr auto kHideWindowControls = "HideWindowControls";
 static constexpr auto kShowWindowControls = "ShowWindowControls";
 static constexpr auto kEnterFullscreen = "EnterFullscreen";
 static constexpr auto kExitFullscreen = "ExitFullscreen";
+static constexpr auto kGetCompositionStats = "GetCompositionStats";
 
 class FlutterAcrylicPlugin : public flutter::Plugin {
  public:
@@ -106,8 +110,9 @@ class FlutterAcrylicPlugin : public flutter::Plugin {
   flutter::PluginRegistrarWindows* registrar_ = nullptr;
   bool is_initialized_ = false;
   bool is_fullscreen_ = false;
+  // The ID of the WindowProc delegate registration.
+  int window_proc_id_ = -1;
   RECT last_rect_ = {};
-  int32_t window_effect_last_ = 0;
 
   void HandleMethodCall(
       const flutter::MethodCall<flutter::EncodableValue>& call,
@@ -133,9 +138,19 @@ void FlutterAcrylicPlugin::RegisterWithRegistrar(
 
 FlutterAcrylicPlugin::FlutterAcrylicPlugin(
     flutter::PluginRegistrarWindows* registrar)
-    : registrar_(registrar) {}
+    : registrar_(registrar) {
+  // Only observes messages to keep the cached monitor topology fresh.
+  window_proc_id_ = registrar_->RegisterTopLevelWindowProcDelegate(
+      [](HWND hwnd, UINT message, WPARAM wparam,
+         LPARAM lparam) -> std::optional<LRESULT> {
+        MonitorCache::Instance().HandleTopologyMessage(message);
+        return std::nullopt;
+      });
+}
 
-FlutterAcrylicPlugin::~FlutterAcrylicPlugin() {}
+FlutterAcrylicPlugin::~FlutterAcrylicPlugin() {
+  registrar_->UnregisterTopLevelWindowProcDelegate(window_proc_id_);
+}
 
 RTL_OSVERSIONINFOW FlutterAcrylicPlugin::GetWindowsVersion() {
   HMODULE hmodule = ::GetModuleHandleW(L"ntdll.dll");
@@ -155,7 +170,7 @@ RTL_OSVERSIONINFOW FlutterAcrylicPlugin::GetWindowsVersion() {
 }
 
 HWND FlutterAcrylicPlugin::GetParentWindow() {
-  return ::GetAncestor(registrar_->GetView()->GetNativeWindow(), GA_ROOT);
+  return win32::GetAncestor(registrar_->GetView()->GetNativeWindow(), GA_ROOT);
 }
 
 void FlutterAcrylicPlugin::HandleMethodCall(
@@ -185,118 +200,111 @@ void FlutterAcrylicPlugin::HandleMethodCall(
     flutter::EncodableMap color = std::get<flutter::EncodableMap>(
         arguments[flutter::EncodableValue("color")]);
     bool dark = std::get<bool>(arguments[flutter::EncodableValue("dark")]);
-    // Set [ACCENT_DISABLED] as [ACCENT_POLICY] in
-    // [SetWindowCompositionAttribute] to apply styles properly.
-    ACCENT_POLICY accent = {ACCENT_DISABLED, 2, static_cast<DWORD>(0), 0};
-    WINDOWCOMPOSITIONATTRIBDATA data;
-    data.Attrib = WCA_ACCENT_POLICY;
-    data.pvData = &accent;
-    data.cbData = sizeof(accent);
-    set_window_composition_attribute_(GetParentWindow(), &data);
+    // The effect is the top composition layer: it wins over transparent
+    // backgrounds and background colors set elsewhere, which show again once
+    // the effect is disabled.
+    CompositionRequest request;
+    const AccentTuple disabled = {ACCENT_DISABLED, 2, 0, 0};
     // Only on later Windows 11 versions and if effect is WindowEffect.mica,
     // WindowEffect.acrylic or WindowEffect.tabbed, otherwise fallback to old
     // approach.
     if (GetWindowsVersion().dwBuildNumber >= 22523 && effect > 3) {
-      BOOL enable = TRUE, dark_bool = dark;
-      MARGINS margins = {-1};
-      ::DwmExtendFrameIntoClientArea(GetParentWindow(), &margins);
-      ::DwmSetWindowAttribute(GetParentWindow(), WINDOWATTRIBUTE::USE_IMMERSIVE_DARK_MODE, &dark_bool,
-                              sizeof(dark_bool));
-      COLORREF COLOR_NONE = 0xFFFFFFFE;
-      ::DwmSetWindowAttribute(GetParentWindow(), CAPTION_COLOR, &COLOR_NONE,
-                              sizeof(COLOR_NONE));
-      INT effect_value = effect == 4 ? 3 : effect == 5 ? 2 : 4;
-      ::DwmSetWindowAttribute(GetParentWindow(), WINDOWATTRIBUTE::SYSTEMBACKDROP_TYPE, &effect_value,
-                              sizeof(enable));
-    } else {
-      if (effect == 5) {
-        // Check for Windows 11.
-        if (GetWindowsVersion().dwBuildNumber >= 22000) {
-          BOOL enable = TRUE, dark_bool = dark;
-          MARGINS margins = {-1};
-          // Mica effect requires [DwmExtendFrameIntoClientArea & "sheet of
-          // glass"
-          // effect with negative margins.
-          ::DwmExtendFrameIntoClientArea(GetParentWindow(), &margins);
-          ::DwmSetWindowAttribute(GetParentWindow(), WINDOWATTRIBUTE::USE_IMMERSIVE_DARK_MODE, &dark_bool,
-                                  sizeof(dark_bool));
-          ::DwmSetWindowAttribute(GetParentWindow(), WINDOWATTRIBUTE::MICA_EFFECT, &enable,
-                                  sizeof(enable));
-        }
-      } else {
-        // Restore original window style & [DwmExtendFrameIntoClientArea] margin
-        // if the last set effect was [WindowEffect.mica], since it sets
-        // negative margins to the window.
-        if (GetWindowsVersion().dwBuildNumber >= 22000 &&
-                window_effect_last_ == 5 ||
-            (GetWindowsVersion().dwBuildNumber >= 22523 &&
-             window_effect_last_ > 3)) {
-          BOOL enable = FALSE;
-          // Atleast one margin should be non-negative in order to show the DWM
-          // window shadow created by handling [WM_NCCALCSIZE].
-          //
-          // Matching value with bitsdojo_window.
-          // https://github.com/bitsdojo/bitsdojo_window/blob/adad0cd40be3d3e12df11d864f18a96a2d0fb4fb/bitsdojo_window_windows/windows/bitsdojo_window.cpp#L149
-          MARGINS margins = {0, 0, 1, 0};
-          ::DwmExtendFrameIntoClientArea(GetParentWindow(), &margins);
-          ::DwmSetWindowAttribute(GetParentWindow(), WINDOWATTRIBUTE::USE_IMMERSIVE_DARK_MODE, &enable,
-                                  sizeof(enable));
-          ::DwmSetWindowAttribute(GetParentWindow(), WINDOWATTRIBUTE::MICA_EFFECT, &enable,
-                                  sizeof(enable));
-        }
-        accent = {
-            static_cast<ACCENT_STATE>(effect), 2,
-            static_cast<DWORD>(
-                (std::get<int>(color[flutter::EncodableValue("A")]) << 24) +
-                (std::get<int>(color[flutter::EncodableValue("B")]) << 16) +
-                (std::get<int>(color[flutter::EncodableValue("G")]) << 8) +
-                (std::get<int>(color[flutter::EncodableValue("R")]))),
-            0};
-        data.Attrib = WCA_ACCENT_POLICY;
-        data.pvData = &accent;
-        data.cbData = sizeof(accent);
-        set_window_composition_attribute_(GetParentWindow(), &data);
+      request.fields = CompositionEngine::kAccent | CompositionEngine::kMargins |
+                       CompositionEngine::kDarkMode |
+                       CompositionEngine::kCaptionColor |
+                       CompositionEngine::kBackdrop;
+      request.accent = disabled;
+      request.margins = {-1};
+      request.dark_mode = dark;
+      // DWMWA_COLOR_NONE.
+      request.caption_color = 0xFFFFFFFE;
+      request.backdrop = effect == 4 ? 3 : effect == 5 ? 2 : 4;
+    } else if (effect == 5) {
+      request.fields = CompositionEngine::kAccent;
+      request.accent = disabled;
+      // Check for Windows 11.
+      if (GetWindowsVersion().dwBuildNumber >= 22000) {
+        // Mica effect requires [DwmExtendFrameIntoClientArea & "sheet of
+        // glass"
+        // effect with negative margins.
+        request.fields |= CompositionEngine::kMargins |
+                          CompositionEngine::kDarkMode |
+                          CompositionEngine::kMica;
+        request.margins = {-1};
+        request.dark_mode = dark;
+        request.mica = TRUE;
       }
+    } else if (effect != ACCENT_DISABLED) {
+      // Leaving [WindowEffect.mica] needs no restoring: its negative margins,
+      // dark mode and Mica attribute fall back to what the other layers
+      // request. Switching between two accents goes through [ACCENT_DISABLED]
+      // inside the engine.
+      request.fields = CompositionEngine::kAccent;
+      request.accent = {
+          static_cast<DWORD>(effect), 2,
+          static_cast<DWORD>(
+              (std::get<int>(color[flutter::EncodableValue("A")]) << 24) +
+              (std::get<int>(color[flutter::EncodableValue("B")]) << 16) +
+              (std::get<int>(color[flutter::EncodableValue("G")]) << 8) +
+              (std::get<int>(color[flutter::EncodableValue("R")]))),
+          0};
     }
-    window_effect_last_ = effect;
+    CompositionEngine::Set(GetParentWindow(), CompositionEngine::kEffect,
+                           request);
     result->Success();
   } else if (call.method_name() == kHideWindowControls) {
-    ::SetWindowLong(GetParentWindow(), GWL_STYLE,
-                    ::GetWindowLong(GetParentWindow(), GWL_STYLE) &
-                        (0xFFFFFFFF ^ WS_SYSMENU));
+    win32::SetWindowLong(GetParentWindow(), GWL_STYLE,
+                         win32::GetWindowLong(GetParentWindow(), GWL_STYLE) &
+                             (0xFFFFFFFF ^ WS_SYSMENU));
     result->Success();
   } else if (call.method_name() == kShowWindowControls) {
-    ::SetWindowLong(GetParentWindow(), GWL_STYLE,
-                    ::GetWindowLong(GetParentWindow(), GWL_STYLE) | WS_SYSMENU);
+    win32::SetWindowLong(GetParentWindow(), GWL_STYLE,
+                         win32::GetWindowLong(GetParentWindow(), GWL_STYLE) | WS_SYSMENU);
     result->Success();
   } else if (call.method_name() == kEnterFullscreen) {
     if (!is_fullscreen_) {
       is_fullscreen_ = true;
       HWND window = GetParentWindow();
-      HMONITOR monitor = ::MonitorFromWindow(window, MONITOR_DEFAULTTONEAREST);
-      MONITORINFO info;
-      info.cbSize = sizeof(MONITORINFO);
-      GetMonitorInfo(monitor, &info);
-      SetWindowLongPtr(window, GWL_STYLE, WS_POPUP | WS_VISIBLE);
-      ::GetWindowRect(window, &last_rect_);
-      ::SetWindowPos(
-          window, HWND_TOPMOST, info.rcMonitor.left, info.rcMonitor.top,
-          info.rcMonitor.right - info.rcMonitor.left,
-          info.rcMonitor.bottom - info.rcMonitor.top, SWP_SHOWWINDOW);
-      ::ShowWindow(window, SW_MAXIMIZE);
+      CachedMonitor info;
+      MonitorCache::Instance().FromWindow(window, &info);
+      win32::SetWindowLongPtr(window, GWL_STYLE, WS_POPUP | WS_VISIBLE);
+      win32::GetWindowRect(window, &last_rect_);
+      win32::SetWindowPos(
+          window, HWND_TOPMOST, info.monitor.left, info.monitor.top,
+          info.monitor.right - info.monitor.left,
+          info.monitor.bottom - info.monitor.top, SWP_SHOWWINDOW);
+      win32::ShowWindow(window, SW_MAXIMIZE);
     }
     result->Success();
   } else if (call.method_name() == kExitFullscreen) {
     if (is_fullscreen_) {
       is_fullscreen_ = false;
       HWND window = GetParentWindow();
-      ::SetWindowLongPtr(window, GWL_STYLE, WS_OVERLAPPEDWINDOW | WS_VISIBLE);
-      ::SetWindowPos(window, HWND_NOTOPMOST, last_rect_.left, last_rect_.top,
-                     last_rect_.right - last_rect_.left,
-                     last_rect_.bottom - last_rect_.top, SWP_SHOWWINDOW);
-      ::ShowWindow(window, SW_RESTORE);
+      win32::SetWindowLongPtr(window, GWL_STYLE, WS_OVERLAPPEDWINDOW | WS_VISIBLE);
+      win32::SetWindowPos(window, HWND_NOTOPMOST, last_rect_.left, last_rect_.top,
+                          last_rect_.right - last_rect_.left,
+                          last_rect_.bottom - last_rect_.top, SWP_SHOWWINDOW);
+      win32::ShowWindow(window, SW_RESTORE);
     }
     result->Success();
+  } else if (call.method_name() == kGetCompositionStats) {
+    const CompositionEngine::Counters& counters =
+        CompositionEngine::counters();
+    flutter::EncodableMap stats;
+    stats[flutter::EncodableValue("accentIssued")] =
+        flutter::EncodableValue(static_cast<int64_t>(counters.accent_issued));
+    stats[flutter::EncodableValue("accentSkipped")] =
+        flutter::EncodableValue(static_cast<int64_t>(counters.accent_skipped));
+    stats[flutter::EncodableValue("marginsIssued")] =
+        flutter::EncodableValue(static_cast<int64_t>(counters.margins_issued));
+    stats[flutter::EncodableValue("marginsSkipped")] =
+        flutter::EncodableValue(static_cast<int64_t>(counters.margins_skipped));
+    stats[flutter::EncodableValue("attributesIssued")] = flutter::EncodableValue(
+        static_cast<int64_t>(counters.attributes_issued));
+    stats[flutter::EncodableValue("attributesSkipped")] =
+        flutter::EncodableValue(
+            static_cast<int64_t>(counters.attributes_skipped));
+    result->Success(flutter::EncodableValue(stats));
   } else
     result->NotImplemented();
 }
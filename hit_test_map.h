@@ -0,0 +1,140 @@
+#ifndef MULTIPLE_WINDOWS_HIT_TEST_MAP_H_
+#define MULTIPLE_WINDOWS_HIT_TEST_MAP_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Native WM_NCHITTEST answers for custom title bars and resize borders.
+//
+// Dart registers a list of rects per window, each tagged with a hit-test code
+// (HTCAPTION, HTMAXBUTTON, HTCLIENT, HTLEFT, ...), once per layout change.
+// The rects are bucketed into a coarse grid over their bounding box so that a
+// lookup only tests the few rects that overlap the cell under the cursor.
+// Later rects are on top of earlier ones.
+//
+// Nothing here depends on <windows.h>.
+
+/// A region as registered from Dart, in logical client coordinates.
+struct HitTestRegionSpec {
+  double x;
+  double y;
+  double width;
+  double height;
+  int32_t code;
+};
+
+class HitTestMap {
+ public:
+  /// Rebuilds the map for |specs| scaled by |pixel_ratio|.
+  void Build(const std::vector<HitTestRegionSpec>& specs, double pixel_ratio) {
+    regions_.clear();
+    cell_offsets_.clear();
+    cell_regions_.clear();
+    columns_ = 0;
+    rows_ = 0;
+
+    int32_t extent_x = 0;
+    int32_t extent_y = 0;
+    for (const HitTestRegionSpec& spec : specs) {
+      Region region;
+      region.left = static_cast<int32_t>(spec.x * pixel_ratio);
+      region.top = static_cast<int32_t>(spec.y * pixel_ratio);
+      region.right = static_cast<int32_t>((spec.x + spec.width) * pixel_ratio);
+      region.bottom =
+          static_cast<int32_t>((spec.y + spec.height) * pixel_ratio);
+      region.code = spec.code;
+      if (region.right <= region.left || region.bottom <= region.top ||
+          region.right <= 0 || region.bottom <= 0) {
+        continue;
+      }
+      region.left = (std::max)(region.left, 0);
+      region.top = (std::max)(region.top, 0);
+      extent_x = (std::max)(extent_x, region.right);
+      extent_y = (std::max)(extent_y, region.bottom);
+      regions_.push_back(region);
+    }
+    if (regions_.empty()) {
+      return;
+    }
+
+    columns_ = ((extent_x - 1) >> kCellShift) + 1;
+    rows_ = ((extent_y - 1) >> kCellShift) + 1;
+
+    // Two passes into a compressed row layout: count, then fill. Region
+    // indices within a cell stay in registration order.
+    cell_offsets_.assign(static_cast<size_t>(columns_) * rows_ + 1, 0);
+    for (const Region& region : regions_) {
+      ForEachCell(region, [this](size_t cell) { ++cell_offsets_[cell + 1]; });
+    }
+    for (size_t i = 1; i < cell_offsets_.size(); ++i) {
+      cell_offsets_[i] += cell_offsets_[i - 1];
+    }
+    cell_regions_.resize(cell_offsets_.back());
+    std::vector<uint32_t> cursor(cell_offsets_.begin(),
+                                 cell_offsets_.end() - 1);
+    for (uint32_t index = 0; index < regions_.size(); ++index) {
+      ForEachCell(regions_[index], [this, &cursor, index](size_t cell) {
+        cell_regions_[cursor[cell]++] = index;
+      });
+    }
+  }
+
+  bool empty() const { return regions_.empty(); }
+
+  /// Returns the code of the topmost region containing the physical client
+  /// point (x, y), or |fallback| when no region does.
+  int32_t Lookup(int32_t x, int32_t y, int32_t fallback) const {
+    if (x < 0 || y < 0) {
+      return fallback;
+    }
+    int32_t column = x >> kCellShift;
+    int32_t row = y >> kCellShift;
+    if (column >= columns_ || row >= rows_) {
+      return fallback;
+    }
+    size_t cell = static_cast<size_t>(row) * columns_ + column;
+    for (uint32_t i = cell_offsets_[cell + 1]; i > cell_offsets_[cell]; --i) {
+      const Region& region = regions_[cell_regions_[i - 1]];
+      if (x >= region.left && x < region.right && y >= region.top &&
+          y < region.bottom) {
+        return region.code;
+      }
+    }
+    return fallback;
+  }
+
+ private:
+  // 64px cells.
+  static constexpr int32_t kCellShift = 6;
+
+  struct Region {
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+    int32_t code;
+  };
+
+  template <typename F>
+  void ForEachCell(const Region& region, F visit) const {
+    int32_t column_end = (region.right - 1) >> kCellShift;
+    int32_t row_end = (region.bottom - 1) >> kCellShift;
+    for (int32_t row = region.top >> kCellShift; row <= row_end; ++row) {
+      for (int32_t column = region.left >> kCellShift; column <= column_end;
+           ++column) {
+        visit(static_cast<size_t>(row) * columns_ + column);
+      }
+    }
+  }
+
+  std::vector<Region> regions_;
+  // cell_regions_[cell_offsets_[c] .. cell_offsets_[c + 1]) are the regions
+  // overlapping cell c.
+  std::vector<uint32_t> cell_offsets_;
+  std::vector<uint32_t> cell_regions_;
+  int32_t columns_ = 0;
+  int32_t rows_ = 0;
+};
+
+#endif  // MULTIPLE_WINDOWS_HIT_TEST_MAP_H_
@@ -0,0 +1,228 @@
+#ifndef MULTIPLE_WINDOWS_ICON_CACHE_H_
+#define MULTIPLE_WINDOWS_ICON_CACHE_H_
+
+// This must be included before many other Windows headers.
+#include <windows.h>
+
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "win32_calls.h"
+
+/// Caches the HICONs created for WM_SETICON.
+///
+/// Icons are keyed by (source hash, pixel size, DPI), where the source is
+/// either a file path or the bytes of an .ico or .png image handed over from
+/// Dart, so swapping between a few status icons neither hits the disk nor
+/// creates GDI objects after the first time. Entries a window currently uses
+/// are pinned; unpinned entries are evicted least recently used first and
+/// destroyed with DestroyIcon.
+///
+/// Use from the platform thread only.
+class IconCache {
+ public:
+  static IconCache& Instance() {
+    static IconCache instance;
+    return instance;
+  }
+
+  /// Hash of an icon file path.
+  static uint64_t HashPath(const std::wstring& path) {
+    return Fnv1a(Fnv1a(kFnvOffsetBasis, "p", 1), path.data(),
+                 path.size() * sizeof(wchar_t));
+  }
+
+  /// Hash of in-memory .ico or .png bytes.
+  static uint64_t HashBytes(const uint8_t* data, size_t size) {
+    return Fnv1a(Fnv1a(kFnvOffsetBasis, "b", 1), data, size);
+  }
+
+  /// Returns the icon for the file at |path| at |size| pixels, pinned.
+  HICON AcquireFromFile(const std::wstring& path, int size, UINT dpi) {
+    Key key{HashPath(path), size, dpi};
+    if (HICON icon = Find(key)) {
+      return icon;
+    }
+    HICON icon = static_cast<HICON>(win32::LoadImageW(
+        nullptr, path.c_str(), IMAGE_ICON, size, size, LR_LOADFROMFILE));
+    return Insert(key, icon);
+  }
+
+  /// Returns the icon for an .ico or .png image in |data| at |size| pixels,
+  /// pinned. |hash| is HashBytes(data, size_in_bytes).
+  HICON AcquireFromBytes(const uint8_t* data,
+                         size_t size_in_bytes,
+                         uint64_t hash,
+                         int size,
+                         UINT dpi) {
+    Key key{hash, size, dpi};
+    if (HICON icon = Find(key)) {
+      return icon;
+    }
+    return Insert(key, CreateFromBytes(data, size_in_bytes, size));
+  }
+
+  /// Drops one pin of |icon|, making it evictable once unused.
+  void Release(HICON icon) {
+    if (!icon) {
+      return;
+    }
+    auto it = by_icon_.find(icon);
+    if (it != by_icon_.end() && it->second->pins > 0) {
+      --it->second->pins;
+      Trim();
+    }
+  }
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  static constexpr size_t kCapacity = 32;
+  static constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ull;
+  static constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+  struct Key {
+    uint64_t hash;
+    int size;
+    UINT dpi;
+
+    bool operator==(const Key& other) const {
+      return hash == other.hash && size == other.size && dpi == other.dpi;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return static_cast<size_t>(key.hash ^
+                                 (static_cast<uint64_t>(key.size) << 32) ^
+                                 key.dpi);
+    }
+  };
+
+  struct Entry {
+    Key key;
+    HICON icon;
+    int pins;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  IconCache() = default;
+  IconCache(IconCache const&) = delete;
+  IconCache& operator=(IconCache const&) = delete;
+
+  // Icons left at exit are reclaimed with the process; destroying them from a
+  // static destructor would run under the loader lock.
+
+  static uint64_t Fnv1a(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+      hash ^= bytes[i];
+      hash *= kFnvPrime;
+    }
+    return hash;
+  }
+
+  // PNG images are passed to CreateIconFromResourceEx as they are. For .ico
+  // files the directory entry closest to |size| (preferring larger images) is
+  // picked and its image data passed on.
+  static HICON CreateFromBytes(const uint8_t* data, size_t length, int size) {
+    static const uint8_t kPngSignature[8] = {0x89, 'P',  'N',  'G',
+                                             '\r', '\n', 0x1A, '\n'};
+    if (length >= 8 && memcmp(data, kPngSignature, 8) == 0) {
+      return win32::CreateIconFromResourceEx(const_cast<PBYTE>(data),
+                                             static_cast<DWORD>(length), TRUE,
+                                             0x00030000, size, size,
+                                             LR_DEFAULTCOLOR);
+    }
+
+    // ICONDIR: reserved (0), type (1 = icon), count; then 16-byte entries.
+    if (length < 6 || ReadU16(data) != 0 || ReadU16(data + 2) != 1) {
+      return nullptr;
+    }
+    uint16_t count = ReadU16(data + 4);
+    if (length < 6 + static_cast<size_t>(count) * 16) {
+      return nullptr;
+    }
+    const uint8_t* best = nullptr;
+    int best_score = INT32_MAX;
+    for (uint16_t i = 0; i < count; ++i) {
+      const uint8_t* entry = data + 6 + i * 16;
+      // A width of 0 means 256.
+      int width = entry[0] == 0 ? 256 : entry[0];
+      int score = width >= size ? width - size : (size - width) * 4;
+      if (score < best_score) {
+        best_score = score;
+        best = entry;
+      }
+    }
+    if (!best) {
+      return nullptr;
+    }
+    uint32_t bytes = ReadU32(best + 8);
+    uint32_t offset = ReadU32(best + 12);
+    if (offset > length || bytes > length - offset) {
+      return nullptr;
+    }
+    return win32::CreateIconFromResourceEx(const_cast<PBYTE>(data + offset),
+                                           bytes, TRUE, 0x00030000, size,
+                                           size, LR_DEFAULTCOLOR);
+  }
+
+  static uint16_t ReadU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+  }
+
+  static uint32_t ReadU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+  }
+
+  HICON Find(const Key& key) {
+    auto it = by_key_.find(key);
+    if (it == by_key_.end()) {
+      return nullptr;
+    }
+    // Most recently used entries live at the front.
+    entries_.splice(entries_.begin(), entries_, it->second);
+    ++it->second->pins;
+    return it->second->icon;
+  }
+
+  HICON Insert(const Key& key, HICON icon) {
+    if (!icon) {
+      return nullptr;
+    }
+    entries_.push_front({key, icon, 1});
+    by_key_[key] = entries_.begin();
+    by_icon_[icon] = entries_.begin();
+    Trim();
+    return icon;
+  }
+
+  // Evicts unpinned entries from the back until the cache fits.
+  void Trim() {
+    auto it = entries_.end();
+    while (entries_.size() > kCapacity && it != entries_.begin()) {
+      --it;
+      if (it->pins > 0) {
+        continue;
+      }
+      win32::DestroyIcon(it->icon);
+      by_key_.erase(it->key);
+      by_icon_.erase(it->icon);
+      it = entries_.erase(it);
+    }
+  }
+
+  EntryList entries_;
+  std::unordered_map<Key, EntryList::iterator, KeyHash> by_key_;
+  std::unordered_map<HICON, EntryList::iterator> by_icon_;
+};
+
+#endif  // MULTIPLE_WINDOWS_ICON_CACHE_H_
@@ -3,8 +3,51 @@
 // found in the LICENSE file.
 
 import 'package:flutter/material.dart';
+import 'window_events.dart';
 import 'window_service.dart';
 
+/// Runs [focused] on the window the runner saw active last. If the runner
+/// knows none, falls back to the window Dart's event mirror reports focused:
+/// sets up its interception, then runs [explicit] on it.
+Future<bool> _onFocusedWindow(
+  Future<bool?> Function() focused,
+  Future<bool> Function(int hwnd) explicit,
+) async {
+  final bool? success = await focused();
+  if (success != null) {
+    return success;
+  }
+
+  final focusedHwnd = WindowEvents.instance.focusedWindow;
+  if (focusedHwnd == null) {
+    print('No focused Flutter window');
+    return false;
+  }
+
+  // Set up window interception first (required for the window mode calls)
+  final interceptionSuccess = await WindowService.setupWindowInterception(focusedHwnd);
+  if (!interceptionSuccess) {
+    print('Failed to set up window interception for 0x${focusedHwnd.toRadixString(16)}');
+    return false;
+  }
+  return explicit(focusedHwnd);
+}
+
+Future<bool> _toggleTitleBar() => _onFocusedWindow(
+      WindowService.toggleTitleBarFocused,
+      WindowService.toggleTitleBar,
+    );
+
+Future<bool> _toggleFrameless() => _onFocusedWindow(
+      WindowService.toggleFramelessFocused,
+      WindowService.toggleFrameless,
+    );
+
+Future<bool> _setTransparentBackground() => _onFocusedWindow(
+      () => WindowService.setTransparentBackgroundFocused(transparent: true),
+      (hwnd) => WindowService.setTransparentBackground(hwnd, transparent: true),
+    );
+
 /// A reusable widget containing common window manipulation controls
 /// including title bar toggle, frameless toggle, and transparency controls.
 class WindowControlsWidget extends StatelessWidget {
@@ -40,35 +83,13 @@ class WindowControlsWidget extends StatelessWidget {
         OutlinedButton(
           style: buttonStyle,
           onPressed: () async {
-            // Get focused window and toggle title bar
-            final focusedHwnd = await WindowService.getFocusedFlutterWindowHandle();
-
-            if (focusedHwnd == null) {
-              if (!context.mounted) return;
-              ScaffoldMessenger.of(context).showSnackBar(
-                const SnackBar(content: Text('No focused Flutter window')),
-              );
-              return;
-            }
-
-            // Set up window interception first (required for proper title bar handling)
-            final interceptionSuccess = await WindowService.setupWindowInterception(focusedHwnd);
-            if (!interceptionSuccess) {
-              if (!context.mounted) return;
-              ScaffoldMessenger.of(context).showSnackBar(
-                const SnackBar(content: Text('Failed to set up window interception')),
-              );
-              return;
-            }
-
-            // Toggle title bar
-            final success = await WindowService.toggleTitleBar(focusedHwnd);
+            final success = await _toggleTitleBar();
 
             if (!context.mounted) return;
             ScaffoldMessenger.of(context).showSnackBar(
               SnackBar(
                 content: Text(success
-                  ? 'Title bar toggled for 0x${focusedHwnd.toRadixString(16)}'
+                  ? 'Title bar toggled'
                   : 'Failed to toggle title bar'
                 ),
               ),
@@ -80,35 +101,13 @@ class WindowControlsWidget extends StatelessWidget {
         OutlinedButton(
           style: buttonStyle,
           onPressed: () async {
-            // Get focused window and toggle frameless mode
-            final focusedHwnd = await WindowService.getFocusedFlutterWindowHandle();
-
-            if (focusedHwnd == null) {
-              if (!context.mounted) return;
-              ScaffoldMessenger.of(context).showSnackBar(
-                const SnackBar(content: Text('No focused Flutter window')),
-              );
-              return;
-            }
-
-            // Set up window interception first (required for proper frameless handling)
-            final interceptionSuccess = await WindowService.setupWindowInterception(focusedHwnd);
-            if (!interceptionSuccess) {
-              if (!context.mounted) return;
-              ScaffoldMessenger.of(context).showSnackBar(
-                const SnackBar(content: Text('Failed to set up window interception')),
-              );
-              return;
-            }
-
-            // Toggle frameless mode
-            final success = await WindowService.toggleFrameless(focusedHwnd);
+            final success = await _toggleFrameless();
 
             if (!context.mounted) return;
             ScaffoldMessenger.of(context).showSnackBar(
               SnackBar(
                 content: Text(success
-                  ? 'Frameless mode toggled for 0x${focusedHwnd.toRadixString(16)}'
+                  ? 'Frameless mode toggled'
                   : 'Failed to toggle frameless mode'
                 ),
               ),
@@ -120,35 +119,13 @@ class WindowControlsWidget extends StatelessWidget {
         OutlinedButton(
           style: buttonStyle,
           onPressed: () async {
-            // Get focused window and set transparent background
-            final focusedHwnd = await WindowService.getFocusedFlutterWindowHandle();
-
-            if (focusedHwnd == null) {
-              if (!context.mounted) return;
-              ScaffoldMessenger.of(context).showSnackBar(
-                const SnackBar(content: Text('No focused Flutter window')),
-              );
-              return;
-            }
-
-            // Set up window interception first (required for proper transparency handling)
-            final interceptionSuccess = await WindowService.setupWindowInterception(focusedHwnd);
-            if (!interceptionSuccess) {
-              if (!context.mounted) return;
-              ScaffoldMessenger.of(context).showSnackBar(
-                const SnackBar(content: Text('Failed to set up window interception')),
-              );
-              return;
-            }
-
-            // Set transparent background
-            final success = await WindowService.setTransparentBackground(focusedHwnd, transparent: true);
+            final success = await _setTransparentBackground();
 
             if (!context.mounted) return;
             ScaffoldMessenger.of(context).showSnackBar(
               SnackBar(
                 content: Text(success
-                  ? 'Transparent background set for 0x${focusedHwnd.toRadixString(16)}'
+                  ? 'Transparent background set'
                   : 'Failed to set transparent background'
                 ),
               ),
@@ -184,25 +161,7 @@ class CompactWindowControlsWidget extends StatelessWidget {
         OutlinedButton(
           style: buttonStyle,
           onPressed: () async {
-            final focusedHwnd = await WindowService.getFocusedFlutterWindowHandle();
-            if (focusedHwnd == null) {
-              if (!context.mounted) return;
-              ScaffoldMessenger.of(context).showSnackBar(
-                const SnackBar(content: Text('No focused Flutter window')),
-              );
-              return;
-            }
-
-            final interceptionSuccess = await WindowService.setupWindowInterception(focusedHwnd);
-            if (!interceptionSuccess) {
-              if (!context.mounted) return;
-              ScaffoldMessenger.of(context).showSnackBar(
-                const SnackBar(content: Text('Failed to set up window interception')),
-              );
-              return;
-            }
-
-            final success = await WindowService.toggleTitleBar(focusedHwnd);
+            final success = await _toggleTitleBar();
             if (!context.mounted) return;
             ScaffoldMessenger.of(context).showSnackBar(
               SnackBar(content: Text(success ? 'Title bar toggled' : 'Failed to toggle title bar')),
@@ -214,25 +173,7 @@ class CompactWindowControlsWidget extends StatelessWidget {
         OutlinedButton(
           style: buttonStyle,
           onPressed: () async {
-            final focusedHwnd = await WindowService.getFocusedFlutterWindowHandle();
-            if (focusedHwnd == null) {
-              if (!context.mounted) return;
-              ScaffoldMessenger.of(context).showSnackBar(
-                const SnackBar(content: Text('No focused Flutter window')),
-              );
-              return;
-            }
-
-            final interceptionSuccess = await WindowService.setupWindowInterception(focusedHwnd);
-            if (!interceptionSuccess) {
-              if (!context.mounted) return;
-              ScaffoldMessenger.of(context).showSnackBar(
-                const SnackBar(content: Text('Failed to set up window interception')),
-              );
-              return;
-            }
-
-            final success = await WindowService.toggleFrameless(focusedHwnd);
+            final success = await _toggleFrameless();
             if (!context.mounted) return;
             ScaffoldMessenger.of(context).showSnackBar(
               SnackBar(content: Text(success ? 'Frameless toggled' : 'Failed to toggle frameless')),
@@ -244,25 +185,7 @@ class CompactWindowControlsWidget extends StatelessWidget {
         OutlinedButton(
           style: buttonStyle,
           onPressed: () async {
-            final focusedHwnd = await WindowService.getFocusedFlutterWindowHandle();
-            if (focusedHwnd == null) {
-              if (!context.mounted) return;
-              ScaffoldMessenger.of(context).showSnackBar(
-                const SnackBar(content: Text('No focused Flutter window')),
-              );
-              return;
-            }
-
-            final interceptionSuccess = await WindowService.setupWindowInterception(focusedHwnd);
-            if (!interceptionSuccess) {
-              if (!context.mounted) return;
-              ScaffoldMessenger.of(context).showSnackBar(
-                const SnackBar(content: Text('Failed to set up window interception')),
-              );
-              return;
-            }
-
-            final success = await WindowService.setTransparentBackground(focusedHwnd, transparent: true);
+            final success = await _setTransparentBackground();
             if (!context.mounted) return;
             ScaffoldMessenger.of(context).showSnackBar(
               SnackBar(content: Text(success ? 'Transparency set' : 'Failed to set transparency')),
@@ -300,25 +223,7 @@ class ConstrainedWindowControlsWidget extends StatelessWidget {
           child: OutlinedButton(
             style: buttonStyle,
             onPressed: () async {
-              final focusedHwnd = await WindowService.getFocusedFlutterWindowHandle();
-              if (focusedHwnd == null) {
-                if (!context.mounted) return;
-                ScaffoldMessenger.of(context).showSnackBar(
-                  const SnackBar(content: Text('No focused Flutter window')),
-                );
-                return;
-              }
-
-              final interceptionSuccess = await WindowService.setupWindowInterception(focusedHwnd);
-              if (!interceptionSuccess) {
-                if (!context.mounted) return;
-                ScaffoldMessenger.of(context).showSnackBar(
-                  const SnackBar(content: Text('Failed to set up window interception')),
-                );
-                return;
-              }
-
-              final success = await WindowService.toggleTitleBar(focusedHwnd);
+              final success = await _toggleTitleBar();
               if (!context.mounted) return;
               ScaffoldMessenger.of(context).showSnackBar(
                 SnackBar(content: Text(success ? 'Title bar toggled' : 'Failed to toggle title bar')),
@@ -333,25 +238,7 @@ class ConstrainedWindowControlsWidget extends StatelessWidget {
           child: OutlinedButton(
             style: buttonStyle,
             onPressed: () async {
-              final focusedHwnd = await WindowService.getFocusedFlutterWindowHandle();
-              if (focusedHwnd == null) {
-                if (!context.mounted) return;
-                ScaffoldMessenger.of(context).showSnackBar(
-                  const SnackBar(content: Text('No focused Flutter window')),
-                );
-                return;
-              }
-
-              final interceptionSuccess = await WindowService.setupWindowInterception(focusedHwnd);
-              if (!interceptionSuccess) {
-                if (!context.mounted) return;
-                ScaffoldMessenger.of(context).showSnackBar(
-                  const SnackBar(content: Text('Failed to set up window interception')),
-                );
-                return;
-              }
-
-              final success = await WindowService.toggleFrameless(focusedHwnd);
+              final success = await _toggleFrameless();
               if (!context.mounted) return;
               ScaffoldMessenger.of(context).showSnackBar(
                 SnackBar(content: Text(success ? 'Frameless toggled' : 'Failed to toggle frameless')),
@@ -366,25 +253,7 @@ class ConstrainedWindowControlsWidget extends StatelessWidget {
           child: OutlinedButton(
             style: buttonStyle,
             onPressed: () async {
-              final focusedHwnd = await WindowService.getFocusedFlutterWindowHandle();
-              if (focusedHwnd == null) {
-                if (!context.mounted) return;
-                ScaffoldMessenger.of(context).showSnackBar(
-                  const SnackBar(content: Text('No focused Flutter window')),
-                );
-                return;
-              }
-
-              final interceptionSuccess = await WindowService.setupWindowInterception(focusedHwnd);
-              if (!interceptionSuccess) {
-                if (!context.mounted) return;
-                ScaffoldMessenger.of(context).showSnackBar(
-                  const SnackBar(content: Text('Failed to set up window interception')),
-                );
-                return;
-              }
-
-              final success = await WindowService.setTransparentBackground(focusedHwnd, transparent: true);
+              final success = await _setTransparentBackground();
               if (!context.mounted) return;
               ScaffoldMessenger.of(context).showSnackBar(
                 SnackBar(content: Text(success ? 'Transparency set' : 'Failed to set transparency')),
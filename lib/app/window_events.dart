@@ -0,0 +1,114 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+import 'dart:async';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+
+/// Bits of [MirroredWindow.mode], as in windows/runner/window_mode.h.
+const int kWindowModeHiddenTitleBar = 1;
+const int kWindowModeFrameless = 2;
+const int kWindowModeTransparent = 4;
+const int kWindowModeMaximized = 8;
+
+/// The last known state of one of the app's windows.
+class MirroredWindow {
+  MirroredWindow({
+    required this.hwnd,
+    required this.visible,
+    required this.focused,
+    required this.mode,
+    required this.dpi,
+  });
+
+  final int hwnd;
+  bool visible;
+  bool focused;
+  int mode;
+  int dpi;
+
+  bool get hiddenTitleBar => mode & kWindowModeHiddenTitleBar != 0;
+  bool get frameless => mode & kWindowModeFrameless != 0;
+  bool get transparent => mode & kWindowModeTransparent != 0;
+  bool get maximized => mode & kWindowModeMaximized != 0;
+}
+
+/// Mirrors the app's windows from the lifecycle events the runner pushes
+/// (created, shown, hidden, destroyed, focused, modeChanged, dpiChanged), so
+/// their state can be read without asking the runner.
+///
+/// Call [listen] once at startup; the runner then sends the windows that
+/// already exist, followed by every change as it happens.
+class WindowEvents extends ChangeNotifier {
+  WindowEvents._();
+
+  static final WindowEvents instance = WindowEvents._();
+
+  static const EventChannel _channel = EventChannel('com.example.window_service/events');
+
+  final Map<int, MirroredWindow> _windows = <int, MirroredWindow>{};
+  StreamSubscription<dynamic>? _subscription;
+  int _lastSequence = 0;
+
+  /// The app's windows by HWND.
+  Map<int, MirroredWindow> get windows => Map<int, MirroredWindow>.unmodifiable(_windows);
+
+  /// The HWND of the app's active window, or null if none is.
+  int? get focusedWindow {
+    for (final MirroredWindow window in _windows.values) {
+      if (window.focused) {
+        return window.hwnd;
+      }
+    }
+    return null;
+  }
+
+  /// Sequence number of the last event applied.
+  int get lastSequence => _lastSequence;
+
+  void listen() {
+    _subscription ??= _channel.receiveBroadcastStream().listen(
+      _onEvent,
+      onError: (Object error) => print('Window event stream failed: $error'),
+    );
+  }
+
+  void _onEvent(dynamic event) {
+    final Map<dynamic, dynamic> fields = event as Map<dynamic, dynamic>;
+    final int sequence = fields['seq'] as int;
+    final int hwnd = fields['hwnd'] as int;
+    _lastSequence = sequence;
+
+    switch (fields['type'] as String) {
+      case 'created':
+        _windows[hwnd] = MirroredWindow(
+          hwnd: hwnd,
+          visible: fields['visible'] as bool,
+          focused: fields['focused'] as bool,
+          mode: fields['mode'] as int,
+          dpi: fields['dpi'] as int,
+        );
+      case 'destroyed':
+        _windows.remove(hwnd);
+      case 'shown':
+        _windows[hwnd]?.visible = true;
+      case 'hidden':
+        _windows[hwnd]?.visible = false;
+      case 'focused':
+        final bool active = fields['active'] as bool;
+        if (active) {
+          for (final MirroredWindow window in _windows.values) {
+            window.focused = false;
+          }
+        }
+        _windows[hwnd]?.focused = active;
+      case 'modeChanged':
+        _windows[hwnd]?.mode = fields['mode'] as int;
+      case 'dpiChanged':
+        _windows[hwnd]?.dpi = fields['dpi'] as int;
+    }
+    notifyListeners();
+  }
+}
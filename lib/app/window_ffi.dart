@@ -0,0 +1,103 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+import 'dart:ffi';
+
+/// Outer bounds of a window in physical pixels; MultipleWindowsBounds in
+/// windows/runner/window_ffi.h.
+final class WindowBounds extends Struct {
+  /// 0 when the handle is not a window.
+  @Int32()
+  external int valid;
+  @Int32()
+  external int x;
+  @Int32()
+  external int y;
+  @Int32()
+  external int width;
+  @Int32()
+  external int height;
+}
+
+/// MultipleWindowsWindowState in windows/runner/window_ffi.h.
+final class WindowState extends Struct {
+  /// 0 when the handle is not a window; the other fields are then 0.
+  @Int32()
+  external int valid;
+  @Int32()
+  external int x;
+  @Int32()
+  external int y;
+  @Int32()
+  external int width;
+  @Int32()
+  external int height;
+  @Int32()
+  external int focused;
+  @Int32()
+  external int maximized;
+  @Int32()
+  external int minimized;
+  @Int32()
+  external int visible;
+
+  /// kWindowMode* flags, as in window_events.dart.
+  @Int32()
+  external int mode;
+}
+
+/// Synchronous window queries through the C ABI the runner exports, for hot
+/// paths where a [WindowService] channel round trip is too slow.
+///
+/// Safe from any isolate: the runner answers the mode flags from its state
+/// mirror, not from state only the platform thread may touch.
+/// window_ffi_benchmark.dart compares the cost with the channel.
+class WindowFfi {
+  static const int _version = 1;
+
+  static final DynamicLibrary _runner = DynamicLibrary.executable();
+
+  static final int Function() _ffiVersion = _runner
+      .lookupFunction<Int32 Function(), int Function()>('MultipleWindowsFfiVersion', isLeaf: true);
+
+  static final WindowBounds Function(int) _getBounds = _runner
+      .lookupFunction<WindowBounds Function(Int64), WindowBounds Function(int)>('MultipleWindowsGetBounds', isLeaf: true);
+
+  static final int Function(int) _isFocused = _runner
+      .lookupFunction<Int32 Function(Int64), int Function(int)>('MultipleWindowsIsFocused', isLeaf: true);
+
+  static final int Function(int) _isMaximized = _runner
+      .lookupFunction<Int32 Function(Int64), int Function(int)>('MultipleWindowsIsMaximized', isLeaf: true);
+
+  static final int Function(int) _getWindowMode = _runner
+      .lookupFunction<Int32 Function(Int64), int Function(int)>('MultipleWindowsGetWindowMode', isLeaf: true);
+
+  static final WindowState Function(int) _getWindowState = _runner
+      .lookupFunction<WindowState Function(Int64), WindowState Function(int)>('MultipleWindowsGetWindowState', isLeaf: true);
+
+  /// Whether the running executable exports the ABI these bindings expect.
+  static bool get isAvailable {
+    try {
+      return _ffiVersion() == _version;
+    } on ArgumentError catch (e) {
+      print('Window FFI is not available: ${e.message}');
+      return false;
+    }
+  }
+
+  /// Outer bounds of a window (HWND); [WindowBounds.valid] is 0 for handles
+  /// that are not windows.
+  static WindowBounds getBounds(int hwnd) => _getBounds(hwnd);
+
+  /// Whether a window (HWND) is the foreground window.
+  static bool isFocused(int hwnd) => _isFocused(hwnd) != 0;
+
+  static bool isMaximized(int hwnd) => _isMaximized(hwnd) != 0;
+
+  /// The kWindowMode* flags of a window (HWND), or -1 if it is not a window.
+  static int getWindowMode(int hwnd) => _getWindowMode(hwnd);
+
+  /// Bounds, focus, visibility and mode of a window (HWND) in one call.
+  static WindowState getWindowState(int hwnd) => _getWindowState(hwnd);
+}
@@ -0,0 +1,104 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+import 'window_ffi.dart';
+import 'window_service.dart';
+import 'window_state_mirror.dart';
+
+/// Average cost of one window state query through each path, in
+/// microseconds. A path the running executable does not provide is null.
+class WindowQueryTimings {
+  WindowQueryTimings({
+    required this.iterations,
+    required this.channelUs,
+    required this.ffiUs,
+    required this.mirrorUs,
+  });
+
+  final int iterations;
+  final double channelUs;
+  final double? ffiUs;
+  final double? mirrorUs;
+
+  @override
+  String toString() {
+    String format(double? us) => us == null ? 'unavailable' : '${us.toStringAsFixed(3)} us';
+    return 'Window state query over $iterations iterations: '
+        'channel ${format(channelUs)}, '
+        'ffi ${format(ffiUs)}, '
+        'mirror ${format(mirrorUs)}';
+  }
+}
+
+/// Times reading the bounds, focus and mode of a window (HWND) through the
+/// window_service channel (getWindowInfo), through [WindowFfi] and through
+/// [WindowStateMirror].
+///
+/// Each path first gets a few untimed rounds so that the timed ones measure
+/// steady state, not lookups and JIT warm-up. Start the app with
+/// --benchmark-window-queries to run it on the main window and print the
+/// result.
+Future<WindowQueryTimings> benchmarkWindowQueries(int hwnd, {int iterations = 1000}) async {
+  const int warmup = 16;
+  final Stopwatch stopwatch = Stopwatch();
+  int sink = 0;
+
+  for (int i = 0; i < warmup; i++) {
+    final Map<String, dynamic>? info = await WindowService.getWindowInfo(hwnd);
+    sink ^= info?.length ?? 0;
+  }
+  stopwatch.start();
+  for (int i = 0; i < iterations; i++) {
+    final Map<String, dynamic>? info = await WindowService.getWindowInfo(hwnd);
+    sink ^= info?.length ?? 0;
+  }
+  stopwatch.stop();
+  final double channelUs = stopwatch.elapsedMicroseconds / iterations;
+
+  double? ffiUs;
+  if (WindowFfi.isAvailable) {
+    for (int i = 0; i < warmup; i++) {
+      sink ^= WindowFfi.getWindowState(hwnd).mode;
+    }
+    stopwatch
+      ..reset()
+      ..start();
+    for (int i = 0; i < iterations; i++) {
+      sink ^= WindowFfi.getWindowState(hwnd).mode;
+    }
+    stopwatch.stop();
+    ffiUs = stopwatch.elapsedMicroseconds / iterations;
+  }
+
+  double? mirrorUs;
+  final WindowStateMirror? mirror = WindowStateMirror.instance;
+  if (mirror != null) {
+    final MirroredWindowState state = MirroredWindowState();
+    for (int i = 0; i < warmup; i++) {
+      mirror.read(hwnd, state);
+      sink ^= state.mode;
+    }
+    stopwatch
+      ..reset()
+      ..start();
+    for (int i = 0; i < iterations; i++) {
+      mirror.read(hwnd, state);
+      sink ^= state.mode;
+    }
+    stopwatch.stop();
+    mirrorUs = stopwatch.elapsedMicroseconds / iterations;
+  }
+
+  // Keeps the reads from being dropped as unused
+  if (sink == -1) {
+    print('Window query benchmark sink: $sink');
+  }
+
+  return WindowQueryTimings(
+    iterations: iterations,
+    channelUs: channelUs,
+    ffiUs: ffiUs,
+    mirrorUs: mirrorUs,
+  );
+}
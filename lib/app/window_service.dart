@@ -3,11 +3,19 @@
 // found in the LICENSE file.
 
 import 'dart:async';
+import 'dart:convert';
+import 'dart:typed_data';
 import 'package:flutter/services.dart';
 
 class WindowService {
   static const MethodChannel _channel = MethodChannel('com.example.window_service');
 
+  /// Arguments naming the app window that was active last instead of an HWND.
+  static const Map<String, String> _focusedTarget = {'target': 'focused'};
+
+  /// Error code of focused-target calls when no app window has been active.
+  static const String _noFocusedWindow = 'no_focused_window';
+
   /// Gets all Flutter window handles (HWND on Windows)
   static Future<List<int>> getFlutterWindowHandles() async {
     try {
@@ -19,10 +27,29 @@ class WindowService {
     }
   }
 
-  /// Gets all window handles in the system
-  static Future<List<int>> getAllWindowHandles() async {
+  /// Gets all window handles in the system, or only those matching the given
+  /// filters, which are applied natively during enumeration: process id,
+  /// class name prefix (case-sensitive), title substring (case-insensitive),
+  /// and visible, minimized, owned and cloaked state.
+  static Future<List<int>> getAllWindowHandles({
+    int? pid,
+    String? classPrefix,
+    String? titleContains,
+    bool? visible,
+    bool? minimized,
+    bool? owned,
+    bool? cloaked,
+  }) async {
     try {
-      final List<dynamic>? handles = await _channel.invokeMethod('getAllWindowHandles');
+      final List<dynamic>? handles = await _channel.invokeMethod('getAllWindowHandles', {
+        if (pid != null) 'pid': pid,
+        if (classPrefix != null) 'classPrefix': classPrefix,
+        if (titleContains != null) 'titleContains': titleContains,
+        if (visible != null) 'visible': visible,
+        if (minimized != null) 'minimized': minimized,
+        if (owned != null) 'owned': owned,
+        if (cloaked != null) 'cloaked': cloaked,
+      });
       return handles?.map((e) => e as int).toList() ?? [];
     } on PlatformException catch (e) {
       print('Failed to get all window handles: ${e.message}');
@@ -41,6 +68,37 @@ class WindowService {
     }
   }
 
+  /// Gets the requested fields of many windows in one call. fields is any of
+  /// title, class, rect, style, pid, visible and owner (all by default).
+  ///
+  /// The reply is column-wise: count, valid (Uint8List), and per field
+  /// title/class (UTF-8 Uint8List with Int32List titleEnds/classEnds, see
+  /// [windowInfoText]), rect (Int32List of left, top, right, bottom per
+  /// window), style and exStyle (Int32List), pid (Int32List), visible
+  /// (Uint8List) and owner (Int64List).
+  static Future<Map<String, dynamic>?> getWindowInfoMany(
+    List<int> hwnds, {
+    List<String>? fields,
+  }) async {
+    try {
+      final Map<dynamic, dynamic>? info = await _channel.invokeMethod('getWindowInfoMany', {
+        'hwnds': Int64List.fromList(hwnds),
+        if (fields != null) 'fields': fields,
+      });
+      return info?.map((key, value) => MapEntry(key.toString(), value));
+    } on PlatformException catch (e) {
+      print('Failed to get window info: ${e.message}');
+      return null;
+    }
+  }
+
+  /// Decodes the [index]th string of a title or class column returned by
+  /// [getWindowInfoMany].
+  static String windowInfoText(Uint8List text, Int32List ends, int index) {
+    final int start = index == 0 ? 0 : ends[index - 1];
+    return utf8.decode(Uint8List.sublistView(text, start, ends[index]));
+  }
+
   /// Gets the native window handle (HWND) for a Flutter view id.
   static Future<int?> getWindowHandleForViewId(int viewId) async {
     try {
@@ -149,4 +207,172 @@ class WindowService {
       return false;
     }
   }
+
+  /// Toggles the title bar of the app window that was active last.
+  /// One call: the runner resolves the window and sets up its interception.
+  /// Returns null when the runner knows no active window; callers can then
+  /// name the window themselves.
+  static Future<bool?> toggleTitleBarFocused() async {
+    try {
+      final bool? success = await _channel.invokeMethod('toggleTitleBar', _focusedTarget);
+      return success ?? false;
+    } on PlatformException catch (e) {
+      if (e.code == _noFocusedWindow) {
+        return null;
+      }
+      print('Failed to toggle title bar of focused window: ${e.message}');
+      return false;
+    }
+  }
+
+  /// Toggles frameless mode of the app window that was active last.
+  /// Returns null when the runner knows no active window.
+  static Future<bool?> toggleFramelessFocused() async {
+    try {
+      final bool? success = await _channel.invokeMethod('toggleFrameless', _focusedTarget);
+      return success ?? false;
+    } on PlatformException catch (e) {
+      if (e.code == _noFocusedWindow) {
+        return null;
+      }
+      print('Failed to toggle frameless of focused window: ${e.message}');
+      return false;
+    }
+  }
+
+  /// Sets the background of the app window that was active last to be
+  /// transparent or normal. Returns null when the runner knows no active
+  /// window.
+  static Future<bool?> setTransparentBackgroundFocused({required bool transparent}) async {
+    try {
+      final bool? success = await _channel.invokeMethod('setTransparentBackground', {
+        ..._focusedTarget,
+        'transparent': transparent,
+      });
+      return success ?? false;
+    } on PlatformException catch (e) {
+      if (e.code == _noFocusedWindow) {
+        return null;
+      }
+      print('Failed to set transparent background of focused window: ${e.message}');
+      return false;
+    }
+  }
+
+  /// Sets a per-pixel hit-test mask for a window (HWND).
+  /// alpha: a width x height alpha channel stretched over the client area;
+  /// pixels below threshold let mouse input through to the windows behind.
+  /// Pass an empty alpha to remove the mask.
+  static Future<bool> setHitTestMask(
+    int hwnd, {
+    required int width,
+    required int height,
+    required Uint8List alpha,
+    int threshold = 128,
+  }) async {
+    try {
+      final bool? success = await _channel.invokeMethod('setHitTestMask', {
+        'hwnd': hwnd,
+        'width': width,
+        'height': height,
+        'alpha': alpha,
+        'threshold': threshold,
+      });
+      return success ?? false;
+    } on PlatformException catch (e) {
+      print('Failed to set hit-test mask: ${e.message}');
+      return false;
+    }
+  }
+
+  /// Runs [commands] in order in a single platform call and returns one result
+  /// per command: its value, or a map with 'error' and 'message'.
+  ///
+  /// Each command is a map with an 'op' (getWindowHandleForViewId,
+  /// setupWindowInterception, toggleTitleBar, setTitleBarStyle,
+  /// toggleFrameless, setFrameless, setTransparentBackground), the window as
+  /// 'hwnd', 'target': 'focused' or 'ref', and the op's arguments as for the
+  /// method of the same name. 'ref' is the index of an earlier command whose
+  /// result is the window, so a setup can start from a view ID:
+  ///
+  /// ```dart
+  /// await WindowService.execute([
+  ///   {'op': 'getWindowHandleForViewId', 'viewId': 3},
+  ///   {'op': 'setFrameless', 'ref': 0, 'frameless': true},
+  ///   {'op': 'setTransparentBackground', 'ref': 0, 'transparent': true},
+  /// ]);
+  /// ```
+  ///
+  /// The mode changes of a window are applied together after the last
+  /// command. Returns null if the batch itself was malformed.
+  static Future<List<dynamic>?> execute(List<Map<String, Object?>> commands) async {
+    try {
+      return await _channel.invokeMethod<List<dynamic>>('execute', {'commands': commands});
+    } on PlatformException catch (e) {
+      print('Failed to execute window commands: ${e.message}');
+      return null;
+    }
+  }
+
+  /// Gets the mode flags a window (HWND) was restored with from the previous
+  /// session: frameless, hiddenTitleBar, transparent, maximized, fullscreen.
+  /// Returns null when the window was not restored.
+  static Future<Map<String, bool>?> getSessionWindowState(int hwnd) async {
+    try {
+      final Map<dynamic, dynamic>? state = await _channel.invokeMethod('getSessionWindowState', {'hwnd': hwnd});
+      return state?.map((key, value) => MapEntry(key.toString(), value as bool));
+    } on PlatformException catch (e) {
+      print('Failed to get session window state: ${e.message}');
+      return null;
+    }
+  }
+
+  /// Gets the startup phase timings recorded by the runner, in microseconds from
+  /// the start of wWinMain: phases, preMainUs, firstWindowShownUs, report.
+  static Future<Map<String, dynamic>?> getStartupProfile() async {
+    try {
+      final Map<dynamic, dynamic>? profile = await _channel.invokeMethod('getStartupProfile');
+      return profile?.map((key, value) => MapEntry(key.toString(), value));
+    } on PlatformException catch (e) {
+      print('Failed to get startup profile: ${e.message}');
+      return null;
+    }
+  }
+
+  /// Gets how many accent policy, DWM margin and DWM attribute calls the
+  /// runner's composition engine issued, and how many it skipped because the
+  /// value was already in effect: accentIssued, accentSkipped, marginsIssued,
+  /// marginsSkipped, attributesIssued, attributesSkipped.
+  static Future<Map<String, int>?> getCompositionStats() async {
+    try {
+      final Map<dynamic, dynamic>? stats = await _channel.invokeMethod('getCompositionStats');
+      return stats?.map((key, value) => MapEntry(key.toString(), value as int));
+    } on PlatformException catch (e) {
+      print('Failed to get composition stats: ${e.message}');
+      return null;
+    }
+  }
+
+  /// Starts recording the user32/dwmapi calls made by the runner and the
+  /// plugins, discarding any previous recording.
+  static Future<void> startWin32CallRecording() async {
+    try {
+      await _channel.invokeMethod('startWin32CallRecording');
+    } on PlatformException catch (e) {
+      print('Failed to start win32 call recording: ${e.message}');
+    }
+  }
+
+  /// Stops recording and returns the calls made since
+  /// [startWin32CallRecording]: {calls: [{api, cost, hwnd, args}], dropped}.
+  /// Comparing the calls one operation makes catches call-count regressions.
+  static Future<Map<String, dynamic>?> stopWin32CallRecording() async {
+    try {
+      final Map<dynamic, dynamic>? log = await _channel.invokeMethod('stopWin32CallRecording');
+      return log?.map((key, value) => MapEntry(key.toString(), value));
+    } on PlatformException catch (e) {
+      print('Failed to stop win32 call recording: ${e.message}');
+      return null;
+    }
+  }
 }
@@ -0,0 +1,126 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+import 'dart:ffi';
+
+import 'window_events.dart';
+
+/// A window's state as read from [WindowStateMirror]. Reused across reads so
+/// that reading allocates nothing.
+class MirroredWindowState {
+  int hwnd = 0;
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+  int dpi = 0;
+  int flags = 0;
+
+  /// kWindowMode* flags, including [kWindowModeMaximized].
+  int mode = 0;
+
+  bool get visible => flags & WindowStateMirror.kVisible != 0;
+  bool get minimized => flags & WindowStateMirror.kMinimized != 0;
+  bool get maximized => flags & WindowStateMirror.kMaximized != 0;
+  bool get focused => flags & WindowStateMirror.kFocused != 0;
+}
+
+/// The runner's per-window state mirror (windows/runner/window_state_mirror.h),
+/// mapped once through dart:ffi.
+///
+/// The runner rewrites a window's record whenever it moves, resizes, changes
+/// DPI, mode or activation, so [read] returns the current bounds and state
+/// with plain memory loads instead of a channel call or an FFI call per
+/// query. Records are guarded by a sequence lock; a read that overlaps a
+/// write is retried.
+///
+/// dart:ffi loads have no acquire ordering, so the retry loop is only sound
+/// where the CPU does not reorder loads with other loads, as on x86 and x64.
+/// Elsewhere (Windows on ARM64) [instance] is null and callers use
+/// WindowFfi (window_ffi.dart), whose native reads are fenced.
+/// test/native/window_state_mirror_stress_test.cpp runs this protocol
+/// against a writer.
+class WindowStateMirror {
+  WindowStateMirror._(Pointer<Void> base)
+      : _words = base.cast<Int32>(),
+        _wides = base.cast<Int64>(),
+        _capacity = base.cast<Uint32>()[1];
+
+  /// Bits of [MirroredWindowState.flags].
+  static const int kVisible = 1 << 0;
+  static const int kMinimized = 1 << 1;
+  static const int kMaximized = 1 << 2;
+  static const int kFocused = 1 << 3;
+
+  static const int _version = 1;
+
+  // Layout, in int32 units: version, capacity, then 10 per record: sequence,
+  // dpi, hwnd (two), x, y, width, height, flags, mode.
+  static const int _headerWords = 2;
+  static const int _recordWords = 10;
+
+  static WindowStateMirror? _instance;
+
+  /// The mirror, or null if the running executable does not export one with
+  /// the layout this file reads, or if [read] would not be safe on this CPU.
+  static WindowStateMirror? get instance {
+    if (_instance != null) {
+      return _instance;
+    }
+    final Abi abi = Abi.current();
+    if (abi != Abi.windowsX64 && abi != Abi.windowsIA32) {
+      return null;
+    }
+    try {
+      final Pointer<Void> Function() getStateMirror = DynamicLibrary.executable()
+          .lookupFunction<Pointer<Void> Function(), Pointer<Void> Function()>('MultipleWindowsGetStateMirror');
+      final Pointer<Void> base = getStateMirror();
+      if (base.cast<Uint32>()[0] != _version) {
+        print('Window state mirror has an unexpected version');
+        return null;
+      }
+      return _instance = WindowStateMirror._(base);
+    } on ArgumentError catch (e) {
+      print('Window state mirror is not available: ${e.message}');
+      return null;
+    }
+  }
+
+  final Pointer<Int32> _words;
+  final Pointer<Int64> _wides;
+  final int _capacity;
+
+  /// Copies the state of a window (HWND) into [into]. Returns false if the
+  /// runner does not mirror the window.
+  bool read(int hwnd, MirroredWindowState into) {
+    if (hwnd == 0) {
+      return false;
+    }
+    for (int slot = 0; slot < _capacity; slot++) {
+      final int record = _headerWords + slot * _recordWords;
+      if (_wides[(record >> 1) + 1] != hwnd) {
+        continue;
+      }
+      // Plain loads, kept in program order by the x86 memory model; see the
+      // class comment.
+      int before;
+      do {
+        before = _words[record];
+        into.hwnd = _wides[(record >> 1) + 1];
+        into.dpi = _words[record + 1];
+        into.x = _words[record + 4];
+        into.y = _words[record + 5];
+        into.width = _words[record + 6];
+        into.height = _words[record + 7];
+        into.flags = _words[record + 8];
+        into.mode = _words[record + 9];
+      } while (before.isOdd || _words[record] != before);
+      // The slot may have been freed or reused in between.
+      if (into.hwnd == hwnd) {
+        return true;
+      }
+    }
+    return false;
+  }
+}
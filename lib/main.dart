@@ -11,6 +11,9 @@ import 'package:flutter/material.dart';
 import 'app/models.dart';
 import 'app/window_content.dart';
 import 'app/main_window.dart';
+import 'app/window_events.dart';
+import 'app/window_ffi_benchmark.dart';
+import 'app/window_service.dart';
 import 'package:flutter/src/widgets/_window.dart';
 
 class MainControllerWindowDelegate with RegularWindowControllerDelegate {
@@ -21,9 +24,23 @@ class MainControllerWindowDelegate with RegularWindowControllerDelegate {
   }
 }
 
-void main() {
+void main(List<String> args) {
   WidgetsFlutterBinding.ensureInitialized();
+  WindowEvents.instance.listen();
   runWidget(MultiWindowApp());
+  if (args.contains('--benchmark-window-queries')) {
+    WidgetsBinding.instance.addPostFrameCallback((_) => _benchmarkWindowQueries());
+  }
+}
+
+/// Compares channel, FFI and mirror window queries on the main window.
+Future<void> _benchmarkWindowQueries() async {
+  final List<int> handles = await WindowService.getFlutterWindowHandles();
+  if (handles.isEmpty) {
+    print('Window query benchmark: no Flutter window');
+    return;
+  }
+  print(await benchmarkWindowQueries(handles.first));
 }
 
 class MultiWindowApp extends StatefulWidget {
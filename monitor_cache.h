@@ -0,0 +1,179 @@
+#ifndef MULTIPLE_WINDOWS_MONITOR_CACHE_H_
+#define MULTIPLE_WINDOWS_MONITOR_CACHE_H_
+
+// This must be included before many other Windows headers.
+#include <windows.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "win32_calls.h"
+
+/// A snapshot of one display monitor: its bounds, work area and effective DPI.
+struct CachedMonitor {
+  HMONITOR handle = nullptr;
+  RECT monitor = {};
+  RECT work = {};
+  UINT dpi = USER_DEFAULT_SCREEN_DPI;
+};
+
+/// Caches the monitor topology so the window message paths (WM_NCCALCSIZE,
+/// DPI lookups, fullscreen) do not go through MonitorFromRect, GetMonitorInfo
+/// and GetDpiForMonitor on every call.
+///
+/// The snapshot is rebuilt lazily on the first lookup after Invalidate().
+/// Window procedures pass every message to HandleTopologyMessage() so that
+/// WM_DISPLAYCHANGE, WM_DPICHANGED and WM_SETTINGCHANGE drop the snapshot.
+///
+/// Header-only so the runner and the plugins share one implementation; each
+/// module still owns its own instance. Use from the platform thread only.
+class MonitorCache {
+ public:
+  static MonitorCache& Instance() {
+    static MonitorCache instance;
+    return instance;
+  }
+
+  void Invalidate() { dirty_ = true; }
+
+  void HandleTopologyMessage(UINT message) {
+    if (message == WM_DISPLAYCHANGE || message == WM_DPICHANGED ||
+        message == WM_SETTINGCHANGE) {
+      Invalidate();
+    }
+  }
+
+  /// Finds the monitor with the largest intersection with |rect|, falling back
+  /// to the nearest one (MONITOR_DEFAULTTONEAREST semantics).
+  bool FromRect(const RECT& rect, CachedMonitor* out) {
+    EnsureFresh();
+    const CachedMonitor* best = nullptr;
+    LONGLONG best_area = -1;
+    LONGLONG best_distance = 0;
+    for (const CachedMonitor& monitor : monitors_) {
+      LONGLONG w = (std::min)(rect.right, monitor.monitor.right) -
+                   (std::max)(rect.left, monitor.monitor.left);
+      LONGLONG h = (std::min)(rect.bottom, monitor.monitor.bottom) -
+                   (std::max)(rect.top, monitor.monitor.top);
+      if (w > 0 && h > 0) {
+        if (w * h > best_area) {
+          best_area = w * h;
+          best = &monitor;
+        }
+        continue;
+      }
+      if (best_area > 0) {
+        continue;
+      }
+      LONGLONG dx =
+          (std::max)(LONG{0}, (std::max)(monitor.monitor.left - rect.right,
+                                         rect.left - monitor.monitor.right));
+      LONGLONG dy =
+          (std::max)(LONG{0}, (std::max)(monitor.monitor.top - rect.bottom,
+                                         rect.top - monitor.monitor.bottom));
+      LONGLONG distance = dx * dx + dy * dy;
+      if (best == nullptr || distance < best_distance) {
+        best = &monitor;
+        best_distance = distance;
+      }
+    }
+    if (best == nullptr) {
+      return false;
+    }
+    *out = *best;
+    return true;
+  }
+
+  /// Finds the monitor a window is on. Minimized windows are resolved through
+  /// their restored position rather than the off-screen iconic rect.
+  bool FromWindow(HWND hwnd, CachedMonitor* out) {
+    RECT rect;
+    if (win32::IsIconic(hwnd)) {
+      WINDOWPLACEMENT placement = {};
+      placement.length = sizeof(WINDOWPLACEMENT);
+      if (!win32::GetWindowPlacement(hwnd, &placement)) {
+        return false;
+      }
+      rect = placement.rcNormalPosition;
+    } else if (!win32::GetWindowRect(hwnd, &rect)) {
+      return false;
+    }
+    return FromRect(rect, out);
+  }
+
+  /// Effective DPI of the monitor a window is on, 96 when unknown.
+  UINT DpiForWindow(HWND hwnd) {
+    CachedMonitor monitor;
+    if (FromWindow(hwnd, &monitor)) {
+      return monitor.dpi;
+    }
+    return USER_DEFAULT_SCREEN_DPI;
+  }
+
+  const std::vector<CachedMonitor>& Monitors() {
+    EnsureFresh();
+    return monitors_;
+  }
+
+ private:
+  typedef HRESULT(WINAPI* GetDpiForMonitorFunc)(HMONITOR, int, UINT*, UINT*);
+
+  MonitorCache() = default;
+  MonitorCache(const MonitorCache&) = delete;
+  MonitorCache& operator=(const MonitorCache&) = delete;
+
+  void EnsureFresh() {
+    if (dirty_) {
+      Rebuild();
+    }
+  }
+
+  void Rebuild() {
+    // shcore.dll is loaded once and kept for the lifetime of the process; it
+    // is resolved dynamically to keep Windows 7 support.
+    if (!shcore_loaded_) {
+      shcore_loaded_ = true;
+      HMODULE shcore = ::LoadLibrary(TEXT("shcore.dll"));
+      if (shcore) {
+        get_dpi_for_monitor_ = reinterpret_cast<GetDpiForMonitorFunc>(
+            ::GetProcAddress(shcore, "GetDpiForMonitor"));
+      }
+    }
+
+    monitors_.clear();
+    win32::EnumDisplayMonitors(
+        nullptr, nullptr,
+        [](HMONITOR handle, HDC, LPRECT, LPARAM lParam) -> BOOL {
+          MonitorCache* self = reinterpret_cast<MonitorCache*>(lParam);
+          MONITORINFO info = {};
+          info.cbSize = sizeof(MONITORINFO);
+          if (!win32::GetMonitorInfo(handle, &info)) {
+            return TRUE;
+          }
+          CachedMonitor monitor;
+          monitor.handle = handle;
+          monitor.monitor = info.rcMonitor;
+          monitor.work = info.rcWork;
+          if (self->get_dpi_for_monitor_) {
+            const int MDT_EFFECTIVE_DPI = 0;
+            UINT dpi_x = USER_DEFAULT_SCREEN_DPI;
+            UINT dpi_y = USER_DEFAULT_SCREEN_DPI;
+            if (SUCCEEDED(self->get_dpi_for_monitor_(handle, MDT_EFFECTIVE_DPI,
+                                                     &dpi_x, &dpi_y))) {
+              monitor.dpi = dpi_x;
+            }
+          }
+          self->monitors_.push_back(monitor);
+          return TRUE;
+        },
+        reinterpret_cast<LPARAM>(this));
+    dirty_ = false;
+  }
+
+  std::vector<CachedMonitor> monitors_;
+  bool dirty_ = true;
+  bool shcore_loaded_ = false;
+  GetDpiForMonitorFunc get_dpi_for_monitor_ = nullptr;
+};
+
+#endif  // MULTIPLE_WINDOWS_MONITOR_CACHE_H_
@@ -0,0 +1,111 @@
+#ifndef MULTIPLE_WINDOWS_NC_INSETS_H_
+#define MULTIPLE_WINDOWS_NC_INSETS_H_
+
+#include <cstdint>
+
+// Precomputed WM_NCCALCSIZE answers.
+//
+// Both the runner's subclass procedure and the window_manager plugin used to
+// work out the non-client adjustment on every WM_NCCALCSIZE from a chain of
+// branches (frame mode, IsZoomed(), Windows version, monitor work area). The
+// functions below turn those branches into a pure mapping from the window's
+// frame inputs to an inset tuple, so the tuple can be computed once whenever
+// an input changes and the message path becomes four additions.
+//
+// Nothing here depends on <windows.h>, so the tables can be checked against a
+// golden table off-Windows.
+
+/// How a window's frame is drawn.
+enum class NcFrameMode : uint8_t {
+  kNormal = 0,
+  kHiddenTitleBar = 1,
+  kFrameless = 2,
+};
+
+/// Values added to the proposed client rect (rgrc[0]) in WM_NCCALCSIZE.
+struct NcInsets {
+  /// False means WM_NCCALCSIZE is left to the original window procedure.
+  bool handled = false;
+  int32_t left = 0;
+  int32_t top = 0;
+  int32_t right = 0;
+  int32_t bottom = 0;
+
+  constexpr bool operator==(const NcInsets& other) const {
+    return handled == other.handled && left == other.left &&
+           top == other.top && right == other.right && bottom == other.bottom;
+  }
+  constexpr bool operator!=(const NcInsets& other) const {
+    return !(*this == other);
+  }
+};
+
+/// Everything the inset tuple depends on.
+struct NcInsetInputs {
+  NcFrameMode mode = NcFrameMode::kNormal;
+  bool maximized = false;
+  /// window_manager only: fullscreen entered with a non-normal title bar
+  /// style.
+  bool fullscreen = false;
+  /// Whether the one pixel top border workaround for Windows 10 is skipped.
+  bool windows11 = false;
+  /// Distance from the window rect's top-left corner to the monitor work
+  /// area's top-left corner (work.left - window.left, work.top - window.top).
+  /// For a maximized window this is the frame overhang. Without a known
+  /// monitor both are -8, adjustNCCALCSIZE()'s fallback, which grows the
+  /// rect by 8 on each side instead.
+  int32_t work_offset_x = -8;
+  int32_t work_offset_y = -8;
+};
+
+/// Insets that clip the window rect to the monitor work area, the equivalent
+/// of window_manager's adjustNCCALCSIZE().
+constexpr NcInsets NcInsetsClipToWorkArea(const NcInsetInputs& in) {
+  return NcInsets{true, in.work_offset_x, in.work_offset_y, -in.work_offset_x,
+                  -in.work_offset_y};
+}
+
+/// Insets that keep the resize borders but drop the caption, used by hidden
+/// title bar windows that are not maximized.
+constexpr NcInsets NcInsetsHiddenTitleBar(const NcInsetInputs& in) {
+  return NcInsets{true, 8, in.windows11 ? 0 : 1, -8, -8};
+}
+
+/// The runner's policy (FlutterWindowSubclassProc).
+constexpr NcInsets ComputeRunnerNcInsets(const NcInsetInputs& in) {
+  switch (in.mode) {
+    case NcFrameMode::kFrameless:
+      // Not maximized: no non-client area at all, which also removes the
+      // borders and rounded corners.
+      return in.maximized ? NcInsetsClipToWorkArea(in)
+                          : NcInsets{true, 0, 0, 0, 0};
+    case NcFrameMode::kHiddenTitleBar:
+      return in.maximized ? NcInsets{true, 8, 8, -8, -8}
+                          : NcInsetsHiddenTitleBar(in);
+    case NcFrameMode::kNormal:
+    default:
+      return NcInsets{};
+  }
+}
+
+/// The window_manager plugin's policy (WindowManagerPlugin::HandleWindowProc).
+constexpr NcInsets ComputeWindowManagerNcInsets(const NcInsetInputs& in) {
+  if (in.fullscreen) {
+    return in.mode == NcFrameMode::kFrameless ? NcInsetsClipToWorkArea(in)
+                                              : NcInsets{true, 0, 0, 0, 0};
+  }
+  switch (in.mode) {
+    case NcFrameMode::kFrameless:
+      return in.maximized ? NcInsetsClipToWorkArea(in)
+                          : NcInsets{true, 0, 0, 0, 0};
+    case NcFrameMode::kHiddenTitleBar:
+      // Adjust the borders when maximized so the app isn't cut off.
+      return in.maximized ? NcInsetsClipToWorkArea(in)
+                          : NcInsetsHiddenTitleBar(in);
+    case NcFrameMode::kNormal:
+    default:
+      return NcInsets{};
+  }
+}
+
+#endif  // MULTIPLE_WINDOWS_NC_INSETS_H_
@@ -0,0 +1,252 @@
+#ifndef MULTIPLE_WINDOWS_SIZE_CONSTRAINTS_H_
+#define MULTIPLE_WINDOWS_SIZE_CONSTRAINTS_H_
+
+#include <cstdint>
+
+// Window size constraints for WM_SIZING and WM_GETMINMAXINFO.
+//
+// A window's constraints are described in logical pixels by a
+// SizeConstraintSpec and compiled into a SizeConstraints descriptor in
+// physical pixels whenever the spec or the device pixel ratio changes. The
+// message handlers only apply the compiled descriptor, which is a fixed
+// number of integer operations regardless of how many constraints are set.
+//
+// Nothing here depends on <windows.h>; rects use the same layout as RECT.
+
+/// Logical (Dart side) description of a window's size constraints.
+///
+/// A value of 0 leaves the corresponding constraint unset, except for the
+/// maximum size where -1 means unconstrained (matching setMaximumSize()).
+struct SizeConstraintSpec {
+  double min_width = 0;
+  double min_height = 0;
+  double max_width = -1;
+  double max_height = -1;
+  /// Width / height of the window rect.
+  double aspect_ratio = 0;
+  /// Relative deviation from |aspect_ratio| that is left alone, e.g. 0.05.
+  double aspect_tolerance = 0;
+  /// Client size increments (e.g. a terminal cell). The window size is floored
+  /// to frame + n * step.
+  double step_width = 0;
+  double step_height = 0;
+  /// Content grid the client size snaps to when within |grid_snap_distance|.
+  double grid_width = 0;
+  double grid_height = 0;
+  double grid_snap_distance = 8;
+};
+
+/// A rect with the same layout as RECT.
+struct SizeConstraintRect {
+  int32_t left;
+  int32_t top;
+  int32_t right;
+  int32_t bottom;
+};
+
+/// Compiled constraints in physical pixels.
+struct SizeConstraints {
+  enum : uint32_t {
+    kMinWidth = 1 << 0,
+    kMinHeight = 1 << 1,
+    kMaxWidth = 1 << 2,
+    kMaxHeight = 1 << 3,
+    kAspect = 1 << 4,
+    kStepWidth = 1 << 5,
+    kStepHeight = 1 << 6,
+    kGridWidth = 1 << 7,
+    kGridHeight = 1 << 8,
+  };
+
+  uint32_t flags = 0;
+  int32_t min_width = 0;
+  int32_t min_height = 0;
+  int32_t max_width = 0;
+  int32_t max_height = 0;
+  /// Non-client frame size; steps and grid apply to the client area.
+  int32_t frame_width = 0;
+  int32_t frame_height = 0;
+  int32_t step_width = 0;
+  int32_t step_height = 0;
+  int32_t grid_width = 0;
+  int32_t grid_height = 0;
+  int32_t grid_snap = 0;
+  double aspect_ratio = 0;
+  double aspect_min = 0;
+  double aspect_max = 0;
+
+  bool Has(uint32_t flag) const { return (flags & flag) != 0; }
+};
+
+/// Compiles |spec| for a window whose frame (window rect minus client rect)
+/// is |frame_width| x |frame_height| physical pixels.
+inline SizeConstraints CompileSizeConstraints(const SizeConstraintSpec& spec,
+                                              double pixel_ratio,
+                                              int32_t frame_width,
+                                              int32_t frame_height) {
+  auto px = [pixel_ratio](double logical) {
+    return static_cast<int32_t>(logical * pixel_ratio);
+  };
+
+  SizeConstraints c;
+  c.frame_width = frame_width;
+  c.frame_height = frame_height;
+  if (spec.min_width > 0) {
+    c.flags |= SizeConstraints::kMinWidth;
+    c.min_width = px(spec.min_width);
+  }
+  if (spec.min_height > 0) {
+    c.flags |= SizeConstraints::kMinHeight;
+    c.min_height = px(spec.min_height);
+  }
+  if (spec.max_width >= 0) {
+    c.flags |= SizeConstraints::kMaxWidth;
+    c.max_width = px(spec.max_width);
+  }
+  if (spec.max_height >= 0) {
+    c.flags |= SizeConstraints::kMaxHeight;
+    c.max_height = px(spec.max_height);
+  }
+  if (spec.aspect_ratio > 0) {
+    c.flags |= SizeConstraints::kAspect;
+    c.aspect_ratio = spec.aspect_ratio;
+    double tolerance = spec.aspect_tolerance > 0 ? spec.aspect_tolerance : 0;
+    c.aspect_min = spec.aspect_ratio * (1 - tolerance);
+    c.aspect_max = spec.aspect_ratio * (1 + tolerance);
+  }
+  if (px(spec.step_width) > 1) {
+    c.flags |= SizeConstraints::kStepWidth;
+    c.step_width = px(spec.step_width);
+  }
+  if (px(spec.step_height) > 1) {
+    c.flags |= SizeConstraints::kStepHeight;
+    c.step_height = px(spec.step_height);
+  }
+  if (px(spec.grid_width) > 1) {
+    c.flags |= SizeConstraints::kGridWidth;
+    c.grid_width = px(spec.grid_width);
+  }
+  if (px(spec.grid_height) > 1) {
+    c.flags |= SizeConstraints::kGridHeight;
+    c.grid_height = px(spec.grid_height);
+  }
+  c.grid_snap = px(spec.grid_snap_distance);
+  return c;
+}
+
+namespace size_constraints_internal {
+
+/// Per WMSZ_* edge: whether the width drives the aspect ratio, and which
+/// edges move when the size is corrected. Index 0 is unused.
+struct EdgeRule {
+  bool width_drives;
+  bool move_left;
+  bool move_top;
+};
+
+constexpr EdgeRule kEdgeRules[9] = {
+    {false, false, false},  // (none)
+    {true, true, true},     // WMSZ_LEFT
+    {true, false, false},   // WMSZ_RIGHT
+    {false, false, true},   // WMSZ_TOP
+    {true, true, true},     // WMSZ_TOPLEFT
+    {false, false, true},   // WMSZ_TOPRIGHT
+    {false, false, false},  // WMSZ_BOTTOM
+    {true, true, false},    // WMSZ_BOTTOMLEFT
+    {false, false, false},  // WMSZ_BOTTOMRIGHT
+};
+
+inline int32_t Step(int32_t size, int32_t frame, int32_t step) {
+  int32_t client = size - frame;
+  if (client <= 0) {
+    return size;
+  }
+  return frame + client / step * step;
+}
+
+inline int32_t Grid(int32_t size, int32_t frame, int32_t grid, int32_t snap) {
+  int32_t client = size - frame;
+  if (client <= 0) {
+    return size;
+  }
+  int32_t snapped = (client + grid / 2) / grid * grid;
+  int32_t distance = snapped > client ? snapped - client : client - snapped;
+  return distance <= snap ? frame + snapped : size;
+}
+
+inline int32_t Clamp(int32_t size, bool has_min, int32_t min, bool has_max,
+                     int32_t max) {
+  if (has_max && size > max) {
+    size = max;
+  }
+  if (has_min && size < min) {
+    size = min;
+  }
+  return size;
+}
+
+}  // namespace size_constraints_internal
+
+/// Applies |c| to the proposed window rect of a WM_SIZING with edge |edge|
+/// (one of the WMSZ_* values).
+inline void ApplySizeConstraints(const SizeConstraints& c,
+                                 uintptr_t edge,
+                                 SizeConstraintRect* rect) {
+  using namespace size_constraints_internal;
+  if (c.flags == 0) {
+    return;
+  }
+  const EdgeRule& rule = kEdgeRules[edge < 9 ? edge : 0];
+
+  int32_t width = rect->right - rect->left;
+  int32_t height = rect->bottom - rect->top;
+
+  if (c.Has(SizeConstraints::kStepWidth)) {
+    width = Step(width, c.frame_width, c.step_width);
+  } else if (c.Has(SizeConstraints::kGridWidth)) {
+    width = Grid(width, c.frame_width, c.grid_width, c.grid_snap);
+  }
+  if (c.Has(SizeConstraints::kStepHeight)) {
+    height = Step(height, c.frame_height, c.step_height);
+  } else if (c.Has(SizeConstraints::kGridHeight)) {
+    height = Grid(height, c.frame_height, c.grid_height, c.grid_snap);
+  }
+
+  width = Clamp(width, c.Has(SizeConstraints::kMinWidth), c.min_width,
+                c.Has(SizeConstraints::kMaxWidth), c.max_width);
+  height = Clamp(height, c.Has(SizeConstraints::kMinHeight), c.min_height,
+                 c.Has(SizeConstraints::kMaxHeight), c.max_height);
+
+  if (c.Has(SizeConstraints::kAspect) && width > 0 && height > 0) {
+    double ratio = static_cast<double>(width) / height;
+    if (ratio < c.aspect_min || ratio > c.aspect_max) {
+      double target = ratio < c.aspect_min ? c.aspect_min : c.aspect_max;
+      if (c.aspect_min == c.aspect_max) {
+        target = c.aspect_ratio;
+      }
+      if (rule.width_drives) {
+        height = static_cast<int32_t>(width / target);
+        height = Clamp(height, c.Has(SizeConstraints::kMinHeight),
+                       c.min_height, c.Has(SizeConstraints::kMaxHeight),
+                       c.max_height);
+      } else {
+        width = static_cast<int32_t>(height * target);
+        width = Clamp(width, c.Has(SizeConstraints::kMinWidth), c.min_width,
+                      c.Has(SizeConstraints::kMaxWidth), c.max_width);
+      }
+    }
+  }
+
+  if (rule.move_left) {
+    rect->left = rect->right - width;
+  } else {
+    rect->right = rect->left + width;
+  }
+  if (rule.move_top) {
+    rect->top = rect->bottom - height;
+  } else {
+    rect->bottom = rect->top + height;
+  }
+}
+
+#endif  // MULTIPLE_WINDOWS_SIZE_CONSTRAINTS_H_
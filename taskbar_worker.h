@@ -0,0 +1,329 @@
+#ifndef MULTIPLE_WINDOWS_TASKBAR_WORKER_H_
+#define MULTIPLE_WINDOWS_TASKBAR_WORKER_H_
+
+// This must be included before many other Windows headers.
+#include <windows.h>
+
+#include <shobjidl_core.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "win32_calls.h"
+
+/// Applies ITaskbarList3 calls on a dedicated STA thread, off the platform
+/// thread.
+///
+/// Platform threads hand commands over through a bounded MPSC ring and an
+/// auto-reset event; the worker owns the COM object, which it creates and
+/// HrInit()s once. Neither side takes a lock: producers count themselves in
+/// while they push, and Release() waits for that count to drain before it
+/// stops the worker and closes the event. Progress updates are coalesced per
+/// window: producers
+/// only overwrite the window's latest value, and a window has at most one
+/// progress command in the ring, so a burst of updates costs one COM call
+/// with the last value. The worker also remembers what it applied last and
+/// skips updates and tab changes that would not change anything.
+///
+/// Shared by every WindowManager in the module. The thread runs while at least
+/// one Retain() is outstanding.
+class TaskbarWorker {
+ public:
+  /// Progress value that removes the progress indicator.
+  static constexpr int32_t kNoProgress = -1;
+
+  static TaskbarWorker& Instance() {
+    static TaskbarWorker instance;
+    return instance;
+  }
+
+  ~TaskbarWorker() {
+    // Only reached at module unload if a Release() is missing; joining under
+    // the loader lock could deadlock.
+    if (thread_.joinable()) {
+      thread_.detach();
+    }
+  }
+
+  /// Starts the worker thread for the first user.
+  void Retain() {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    if (users_++ == 0) {
+      stop_.store(false, std::memory_order_relaxed);
+      wake_ = ::CreateEventW(nullptr, FALSE, FALSE, nullptr);
+      thread_ = std::thread([this]() { Run(); });
+      running_.store(true);
+    }
+  }
+
+  /// Stops and joins the worker thread after the last user. Commands still in
+  /// the ring are applied first.
+  void Release() {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    if (users_ == 0 || --users_ > 0) {
+      return;
+    }
+    // A producer that saw running_ set finishes its push; one that sees it
+    // cleared leaves the ring and the event alone.
+    running_.store(false);
+    while (producers_.load() != 0) {
+      std::this_thread::yield();
+    }
+    stop_.store(true, std::memory_order_release);
+    ::SetEvent(wake_);
+    thread_.join();
+    ::CloseHandle(wake_);
+    wake_ = nullptr;
+  }
+
+  /// Sets the progress of |hwnd| to |percent| (0-100), or kNoProgress.
+  void SetProgress(HWND hwnd, int32_t percent) {
+    Slot* slot = SlotFor(hwnd);
+    if (!slot) {
+      return;
+    }
+    slot->progress.store(percent, std::memory_order_relaxed);
+    // Only the update that finds no progress command pending enqueues one;
+    // the worker reads the latest value when it gets to it.
+    if (!slot->progress_pending.exchange(true, std::memory_order_acq_rel) &&
+        !Push({CommandKind::kProgress, hwnd, slot})) {
+      // No worker to apply it; the next update after Retain() enqueues.
+      slot->progress_pending.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  /// Adds |hwnd| to the taskbar, or removes it when |skip| is true.
+  void SetSkipTaskbar(HWND hwnd, bool skip) {
+    Slot* slot = SlotFor(hwnd);
+    if (!slot) {
+      return;
+    }
+    Push({skip ? CommandKind::kDeleteTab : CommandKind::kAddTab, hwnd, slot});
+  }
+
+  /// Frees the slot of |hwnd| once pending commands for it are applied.
+  void Forget(HWND hwnd) {
+    for (Slot& slot : slots_) {
+      if (slot.hwnd.load(std::memory_order_acquire) == hwnd) {
+        Push({CommandKind::kForget, hwnd, &slot});
+        return;
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t kMaxWindows = 64;
+  static constexpr size_t kRingSize = 256;  // Power of two.
+
+  enum class TabState : int8_t { kUnknown, kAdded, kDeleted };
+
+  struct Slot {
+    std::atomic<HWND> hwnd{nullptr};
+    std::atomic<int32_t> progress{kNoProgress};
+    std::atomic<bool> progress_pending{false};
+    // Owned by the worker thread.
+    int32_t applied_progress = INT32_MIN;
+    TabState tab = TabState::kUnknown;
+  };
+
+  enum class CommandKind : uint8_t { kProgress, kAddTab, kDeleteTab, kForget };
+
+  struct Command {
+    CommandKind kind;
+    HWND hwnd;
+    Slot* slot;
+  };
+
+  struct Cell {
+    std::atomic<size_t> sequence;
+    Command command;
+  };
+
+  TaskbarWorker() {
+    for (size_t i = 0; i < kRingSize; ++i) {
+      ring_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  TaskbarWorker(TaskbarWorker const&) = delete;
+  TaskbarWorker& operator=(TaskbarWorker const&) = delete;
+
+  Slot* SlotFor(HWND hwnd) {
+    if (!hwnd) {
+      return nullptr;
+    }
+    for (Slot& slot : slots_) {
+      if (slot.hwnd.load(std::memory_order_acquire) == hwnd) {
+        return &slot;
+      }
+    }
+    for (Slot& slot : slots_) {
+      HWND expected = nullptr;
+      if (slot.hwnd.compare_exchange_strong(expected, hwnd,
+                                            std::memory_order_acq_rel)) {
+        return &slot;
+      }
+    }
+    return nullptr;
+  }
+
+  // Vyukov's bounded MPMC ring, used with a single consumer. Producers spin
+  // only when the ring is full, which coalescing keeps to bursts of tab
+  // changes; the worker keeps draining meanwhile, as Release() does not stop
+  // it before producers are out. Returns false when no worker is running.
+  bool Push(const Command& command) {
+    // Both sequentially consistent, against running_ and producers_ in
+    // Release(): either it sees this push in flight and waits, or this push
+    // sees the worker stopping.
+    producers_.fetch_add(1);
+    if (!running_.load()) {
+      producers_.fetch_sub(1, std::memory_order_release);
+      return false;
+    }
+    size_t position = enqueue_position_.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& cell = ring_[position & (kRingSize - 1)];
+      size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      intptr_t difference =
+          static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+      if (difference == 0) {
+        if (enqueue_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          cell.command = command;
+          cell.sequence.store(position + 1, std::memory_order_release);
+          ::SetEvent(wake_);
+          producers_.fetch_sub(1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        std::this_thread::yield();
+        position = enqueue_position_.load(std::memory_order_relaxed);
+      } else {
+        position = enqueue_position_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool Pop(Command* command) {
+    Cell& cell = ring_[dequeue_position_ & (kRingSize - 1)];
+    size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    if (sequence != dequeue_position_ + 1) {
+      return false;
+    }
+    *command = cell.command;
+    cell.sequence.store(dequeue_position_ + kRingSize,
+                        std::memory_order_release);
+    ++dequeue_position_;
+    return true;
+  }
+
+  void Run() {
+    ::CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
+    ITaskbarList3* taskbar = nullptr;
+    if (SUCCEEDED(::CoCreateInstance(CLSID_TaskbarList, nullptr,
+                                     CLSCTX_INPROC_SERVER,
+                                     IID_PPV_ARGS(&taskbar))) &&
+        FAILED(taskbar->HrInit())) {
+      taskbar->Release();
+      taskbar = nullptr;
+    }
+
+    for (;;) {
+      // Read before draining: every push that precedes the stop request is
+      // then drained before the loop ends.
+      bool stopping = stop_.load(std::memory_order_acquire);
+      Command command;
+      while (Pop(&command)) {
+        Apply(taskbar, command);
+      }
+      if (stopping) {
+        break;
+      }
+      // An STA thread has to keep pumping messages while it waits.
+      if (win32::MsgWaitForMultipleObjects(1, &wake_, FALSE, INFINITE,
+                                           QS_ALLINPUT) == WAIT_OBJECT_0 + 1) {
+        MSG msg;
+        while (win32::PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+          win32::DispatchMessageW(&msg);
+        }
+      }
+    }
+
+    if (taskbar) {
+      taskbar->Release();
+    }
+    ::CoUninitialize();
+  }
+
+  void Apply(ITaskbarList3* taskbar, const Command& command) {
+    Slot* slot = command.slot;
+    switch (command.kind) {
+      case CommandKind::kProgress: {
+        // An exchange, not a store: it is ordered with the producers'
+        // exchange, so an update either finds the flag cleared and enqueues
+        // again, or is seen by the load below. A store followed by a load
+        // may be reordered and lose the last update.
+        slot->progress_pending.exchange(false, std::memory_order_acq_rel);
+        int32_t progress = slot->progress.load(std::memory_order_relaxed);
+        if (!taskbar || progress == slot->applied_progress) {
+          return;
+        }
+        if (progress == kNoProgress) {
+          taskbar->SetProgressState(command.hwnd, TBPF_NOPROGRESS);
+        } else {
+          // Setting a value also leaves TBPF_NOPROGRESS/TBPF_INDETERMINATE
+          // for TBPF_NORMAL.
+          taskbar->SetProgressValue(command.hwnd, progress, 100);
+        }
+        slot->applied_progress = progress;
+        return;
+      }
+      case CommandKind::kAddTab:
+      case CommandKind::kDeleteTab: {
+        TabState target = command.kind == CommandKind::kAddTab
+                              ? TabState::kAdded
+                              : TabState::kDeleted;
+        if (!taskbar || slot->tab == target) {
+          return;
+        }
+        if (target == TabState::kAdded) {
+          taskbar->AddTab(command.hwnd);
+        } else {
+          taskbar->DeleteTab(command.hwnd);
+        }
+        slot->tab = target;
+        return;
+      }
+      case CommandKind::kForget:
+        // A second Forget() of the window may have been queued before the
+        // first freed the slot, which may belong to another window by now.
+        if (slot->hwnd.load(std::memory_order_acquire) != command.hwnd) {
+          return;
+        }
+        slot->applied_progress = INT32_MIN;
+        slot->tab = TabState::kUnknown;
+        slot->progress.store(kNoProgress, std::memory_order_relaxed);
+        slot->hwnd.store(nullptr, std::memory_order_release);
+        return;
+    }
+  }
+
+  // Serializes Retain() and Release(); guards users_ and thread_. wake_ is
+  // written only while running_ is clear and no producer is in Push().
+  std::mutex lifecycle_mutex_;
+  int users_ = 0;
+  std::thread thread_;
+  HANDLE wake_ = nullptr;
+  std::atomic<bool> running_{false};
+  std::atomic<int> producers_{0};
+  std::atomic<bool> stop_{false};
+
+  Slot slots_[kMaxWindows];
+  Cell ring_[kRingSize];
+  std::atomic<size_t> enqueue_position_{0};
+  size_t dequeue_position_ = 0;
+};
+
+#endif  // MULTIPLE_WINDOWS_TASKBAR_WORKER_H_
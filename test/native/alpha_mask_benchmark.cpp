@@ -0,0 +1,88 @@
+// Builds an AlphaHitMask from a 4K alpha channel, the largest mask Dart sends
+// (one byte per physical pixel of a full-screen 4K window), and times it
+// against a scalar reference. Checks that both agree on every pixel first.
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "alpha_mask.h"
+#include "native_test.h"
+
+namespace {
+
+constexpr int32_t kWidth = 3840;
+constexpr int32_t kHeight = 2160;
+constexpr uint8_t kThreshold = 128;
+
+// One bit per pixel, set where alpha >= threshold; no SIMD.
+std::vector<uint64_t> ScalarMask(const std::vector<uint8_t>& alpha) {
+  int32_t words_per_row = (kWidth + 63) / 64;
+  std::vector<uint64_t> bits(static_cast<size_t>(words_per_row) * kHeight, 0);
+  for (int32_t y = 0; y < kHeight; ++y) {
+    for (int32_t x = 0; x < kWidth; ++x) {
+      if (alpha[static_cast<size_t>(y) * kWidth + x] >= kThreshold) {
+        bits[static_cast<size_t>(y) * words_per_row + (x >> 6)] |=
+            uint64_t{1} << (x & 63);
+      }
+    }
+  }
+  return bits;
+}
+
+// A window with rounded, antialiased corners and a click-through hole, with
+// some noise so that no row is uniform.
+std::vector<uint8_t> SampleAlpha() {
+  std::vector<uint8_t> alpha(static_cast<size_t>(kWidth) * kHeight);
+  uint32_t seed = 12345;
+  for (int32_t y = 0; y < kHeight; ++y) {
+    for (int32_t x = 0; x < kWidth; ++x) {
+      seed = seed * 1664525u + 1013904223u;
+      int32_t dx = x - kWidth / 2;
+      int32_t dy = y - kHeight / 2;
+      bool hole = dx * dx + dy * dy < 400 * 400;
+      uint8_t value = hole ? 0 : 255;
+      if ((seed >> 24) < 16) {
+        value = static_cast<uint8_t>(seed >> 8);
+      }
+      alpha[static_cast<size_t>(y) * kWidth + x] = value;
+    }
+  }
+  return alpha;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int iterations = BenchmarkIterations(argc, argv, 5);
+  std::vector<uint8_t> alpha = SampleAlpha();
+
+  AlphaHitMask mask;
+  mask.Build(alpha.data(), kWidth, kHeight, kThreshold);
+  std::vector<uint64_t> reference = ScalarMask(alpha);
+  int32_t words_per_row = (kWidth + 63) / 64;
+  int32_t mismatches = 0;
+  for (int32_t y = 0; y < kHeight; ++y) {
+    for (int32_t x = 0; x < kWidth; ++x) {
+      bool expected =
+          (reference[static_cast<size_t>(y) * words_per_row + (x >> 6)] >>
+           (x & 63)) & 1;
+      if (mask.Test(x, y) != expected) {
+        ++mismatches;
+      }
+    }
+  }
+  EXPECT_EQ(0, mismatches);
+
+  double built = MeasureNanoseconds(iterations, [&]() {
+    mask.Build(alpha.data(), kWidth, kHeight, kThreshold);
+    DoNotOptimize(mask);
+  });
+  double scalar = MeasureNanoseconds(iterations, [&]() {
+    std::vector<uint64_t> bits = ScalarMask(alpha);
+    DoNotOptimize(bits);
+  });
+  std::printf("4K mask build: AlphaHitMask %.2f ms, scalar %.2f ms (%d runs)\n",
+              built / 1e6, scalar / 1e6, iterations);
+  return NativeTestResult();
+}
@@ -0,0 +1,132 @@
+// Behaviour tests of edge_snap.h: which indexed edges attract a moving rect
+// and where it ends up. Covers edges that do not overlap the rect along the
+// other axis, ties between candidates at the same distance, the snap
+// distance boundary on both sides, and the two axes snapping independently.
+
+#include <cstdint>
+
+#include "edge_snap.h"
+#include "native_test.h"
+
+namespace {
+
+constexpr int32_t kDistance = 10;
+
+bool SameRect(const SnapRect& a, const SnapRect& b) {
+  return a.left == b.left && a.top == b.top && a.right == b.right &&
+         a.bottom == b.bottom;
+}
+
+// Snaps |rect| against an index of |others| and returns where it ends up.
+template <size_t N>
+SnapRect Snapped(const SnapRect (&others)[N],
+                 SnapRect rect,
+                 int32_t distance = kDistance) {
+  EdgeSnapIndex index;
+  for (const SnapRect& other : others) {
+    index.AddRect(other);
+  }
+  index.Build();
+  index.Snap(&rect, distance);
+  return rect;
+}
+
+void CheckEmpty() {
+  EdgeSnapIndex index;
+  index.Build();
+  EXPECT_TRUE(index.empty());
+  SnapRect rect = {100, 100, 300, 200};
+  EXPECT_TRUE(!index.Snap(&rect, kDistance));
+  EXPECT_TRUE(SameRect({100, 100, 300, 200}, rect));
+}
+
+// A vertical edge 5px to the right of the rect's right edge, but entirely
+// above or below it, does not attract; one that reaches to within the snap
+// distance of the rect along y does.
+void CheckNonOverlappingIgnored() {
+  const SnapRect moving = {100, 100, 300, 200};
+  const SnapRect above[] = {{305, 0, 500, 100 - kDistance - 1}};
+  EXPECT_TRUE(SameRect(moving, Snapped(above, moving)));
+  const SnapRect below[] = {{305, 200 + kDistance + 1, 500, 400}};
+  EXPECT_TRUE(SameRect(moving, Snapped(below, moving)));
+  // Its bottom edge, now within reach as well, pulls the top edge up.
+  const SnapRect near_above[] = {{305, 0, 500, 100 - kDistance}};
+  EXPECT_TRUE(SameRect({105, 90, 305, 190}, Snapped(near_above, moving)));
+
+  // The same along the other axis: a horizontal edge 5px below, entirely to
+  // the left or right of the rect.
+  const SnapRect left[] = {{0, 205, 100 - kDistance - 1, 400}};
+  EXPECT_TRUE(SameRect(moving, Snapped(left, moving)));
+  const SnapRect right[] = {{300 + kDistance + 1, 205, 600, 400}};
+  EXPECT_TRUE(SameRect(moving, Snapped(right, moving)));
+}
+
+// The nearest of several edges wins whatever the order they were added in;
+// between two at the same distance, the one found first does: the lower
+// position, and the rect's left (top) edge before its right (bottom) edge.
+void CheckTies() {
+  const SnapRect moving = {100, 100, 300, 200};
+  const SnapRect nearest[] = {
+      {0, 0, 92, 150}, {0, 0, 96, 150}, {0, 0, 93, 150}};
+  EXPECT_TRUE(SameRect({96, 100, 296, 200}, Snapped(nearest, moving)));
+
+  const SnapRect both_sides[] = {{0, 0, 95, 150}, {105, 0, 150, 150}};
+  EXPECT_TRUE(SameRect({95, 100, 295, 200}, Snapped(both_sides, moving)));
+  const SnapRect reversed[] = {{105, 0, 150, 150}, {0, 0, 95, 150}};
+  EXPECT_TRUE(SameRect({95, 100, 295, 200}, Snapped(reversed, moving)));
+
+  // Left edge 4px from x = 96, right edge 4px from x = 304.
+  const SnapRect left_and_right[] = {{0, 0, 96, 150}, {304, 0, 400, 150}};
+  EXPECT_TRUE(SameRect({96, 100, 296, 200}, Snapped(left_and_right, moving)));
+  const SnapRect top_and_bottom[] = {{0, 0, 150, 96}, {0, 204, 150, 400}};
+  EXPECT_TRUE(SameRect({100, 96, 300, 196}, Snapped(top_and_bottom, moving)));
+}
+
+// Edges exactly the snap distance away attract, on either side; one pixel
+// further they do not. A distance of 0 turns snapping off.
+void CheckDistanceBoundary() {
+  const SnapRect moving = {100, 100, 300, 200};
+  const SnapRect at_left[] = {{0, 0, 100 - kDistance, 150}};
+  EXPECT_TRUE(SameRect({90, 100, 290, 200}, Snapped(at_left, moving)));
+  const SnapRect at_right[] = {{300 + kDistance, 0, 500, 150}};
+  EXPECT_TRUE(SameRect({110, 100, 310, 200}, Snapped(at_right, moving)));
+  const SnapRect past_left[] = {{0, 0, 100 - kDistance - 1, 150}};
+  EXPECT_TRUE(SameRect(moving, Snapped(past_left, moving)));
+  const SnapRect past_right[] = {{300 + kDistance + 1, 0, 500, 150}};
+  EXPECT_TRUE(SameRect(moving, Snapped(past_right, moving)));
+
+  const SnapRect at_top[] = {{0, 0, 150, 100 - kDistance}};
+  EXPECT_TRUE(SameRect({100, 90, 300, 190}, Snapped(at_top, moving)));
+  const SnapRect past_bottom[] = {{0, 200 + kDistance + 1, 150, 400}};
+  EXPECT_TRUE(SameRect(moving, Snapped(past_bottom, moving)));
+
+  EXPECT_TRUE(SameRect(moving, Snapped(at_left, moving, 0)));
+
+  // An edge already lined up is a snap that moves nothing.
+  EdgeSnapIndex index;
+  index.AddRect({0, 0, 100, 150});
+  index.Build();
+  SnapRect rect = moving;
+  EXPECT_TRUE(!index.Snap(&rect, kDistance));
+  EXPECT_TRUE(SameRect(moving, rect));
+}
+
+// A work area corner pulls the rect in along both axes at once, each to its
+// own nearest edge.
+void CheckAxesIndependent() {
+  const SnapRect work_area[] = {{0, 0, 1920, 1040}};
+  EXPECT_TRUE(SameRect({0, 0, 200, 100}, Snapped(work_area, {6, 3, 206, 103})));
+  EXPECT_TRUE(SameRect({1720, 940, 1920, 1040},
+                       Snapped(work_area, {1712, 945, 1912, 1045})));
+}
+
+}  // namespace
+
+int main() {
+  CheckEmpty();
+  CheckNonOverlappingIgnored();
+  CheckTies();
+  CheckDistanceBoundary();
+  CheckAxesIndependent();
+  return NativeTestResult();
+}
@@ -0,0 +1,1330 @@
+#ifndef MULTIPLE_WINDOWS_TEST_NATIVE_FAKE_WIN32_BACKEND_H_
+#define MULTIPLE_WINDOWS_TEST_NATIVE_FAKE_WIN32_BACKEND_H_
+
+// This must be included before many other Windows headers.
+#include <windows.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "win32_calls.h"
+
+/// An in-memory model of the window system, installed as the Win32Backend of
+/// the native tests.
+///
+/// Windows have a class, a window procedure, styles, a rectangle, text,
+/// properties, a comctl32 subclass chain and DWM attributes, and receive the
+/// messages user32 would send for the calls made on them: creation and
+/// destruction, WM_WINDOWPOSCHANGING/CHANGED from SetWindowPos() and
+/// ShowWindow(), WM_STYLECHANGING/CHANGED from style changes and
+/// WM_NCCALCSIZE on SWP_FRAMECHANGED. There is one monitor, 1920x1080 at 96
+/// DPI with a 40 px taskbar at the bottom.
+///
+/// Posted messages go to one queue, pumped by the message loop or
+/// PumpPostedMessages(); waits never report input, so only the main thread
+/// dispatches. Window state is guarded by a mutex that is never held while a
+/// window procedure runs, so the query pool's workers can read it. Text is
+/// read directly, without sending WM_GETTEXT.
+class FakeWin32Backend final : public Win32Backend {
+ public:
+  static constexpr int kScreenWidth = 1920;
+  static constexpr int kScreenHeight = 1080;
+  static constexpr int kTaskbarHeight = 40;
+
+  FakeWin32Backend() {
+    monitor_ = reinterpret_cast<HMONITOR>(uintptr_t{0x7000});
+  }
+
+  /// Run by the first GetMessageW(), that is from inside the runner's message
+  /// loop once everything is set up. The loop ends when the queue is empty
+  /// afterwards.
+  void set_on_message_loop(std::function<void()> on_message_loop) {
+    on_message_loop_ = std::move(on_message_loop);
+  }
+
+  /// Dispatches the posted messages, including the ones posted meanwhile.
+  void PumpPostedMessages() {
+    MSG msg;
+    while (PopPosted(&msg, nullptr)) {
+      Dispatch(msg.hwnd, msg.message, msg.wParam, msg.lParam);
+    }
+  }
+
+  bool HasPostedMessages() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !posted_.empty();
+  }
+
+  /// Registers a class and creates a window with it without going through
+  /// the win32 wrappers, as the engine or another process would.
+  HWND CreateTestWindow(const std::wstring& class_name,
+                        WNDPROC window_proc,
+                        const std::wstring& text,
+                        DWORD style,
+                        DWORD ex_style,
+                        RECT rect,
+                        HWND parent = nullptr) {
+    WNDCLASSW window_class = {};
+    window_class.lpfnWndProc = window_proc;
+    window_class.lpszClassName = class_name.c_str();
+    RegisterClassW(&window_class);
+    return CreateWindowExW(ex_style, class_name.c_str(), text.c_str(), style,
+                           rect.left, rect.top, rect.right - rect.left,
+                           rect.bottom - rect.top, parent, nullptr, nullptr,
+                           nullptr);
+  }
+
+  /// Makes |hwnd| look like a window of another process.
+  void SetProcessId(HWND hwnd, DWORD process_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Window* window = Find(hwnd)) {
+      window->process_id = process_id;
+    }
+  }
+
+  void SetCursor(POINT cursor) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cursor_ = cursor;
+  }
+
+  /// Sends a message to the window as user32 would, through its subclass
+  /// chain; not recorded.
+  LRESULT Send(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
+    return Dispatch(hwnd, message, wparam, lparam);
+  }
+
+  /// The last value set for a DWM attribute, or an empty vector.
+  std::vector<uint8_t> DwmAttribute(HWND hwnd, DWORD attribute) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return {};
+    }
+    auto it = window->dwm_attributes.find(attribute);
+    return it == window->dwm_attributes.end() ? std::vector<uint8_t>()
+                                              : it->second;
+  }
+
+  MARGINS Margins(HWND hwnd) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    return window ? window->margins : MARGINS{};
+  }
+
+  size_t SubclassCount(HWND hwnd) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    return window ? window->subclasses.size() : 0;
+  }
+
+  /// Icons created and not destroyed yet, the GDI handles a leak would grow.
+  size_t LiveIcons() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return icons_.size();
+  }
+
+  /// Bytes read by LoadImageW(LR_LOADFROMFILE) so far.
+  size_t FileBytesRead() const { return file_bytes_read_; }
+
+  // Win32Backend:
+  LONG_PTR GetWindowLongPtrW(HWND hwnd, int index) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return 0;
+    }
+    switch (index) {
+      case GWL_STYLE:
+        return static_cast<LONG>(window->style);
+      case GWL_EXSTYLE:
+        return static_cast<LONG>(window->ex_style);
+      case GWLP_WNDPROC:
+        return reinterpret_cast<LONG_PTR>(window->window_proc);
+      case GWLP_USERDATA:
+        return window->user_data;
+      default:
+        return 0;
+    }
+  }
+
+  LONG_PTR SetWindowLongPtrW(HWND hwnd, int index, LONG_PTR value) override {
+    if (index == GWL_STYLE || index == GWL_EXSTYLE) {
+      return SetStyle(hwnd, index, static_cast<DWORD>(value));
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return 0;
+    }
+    LONG_PTR previous = 0;
+    switch (index) {
+      case GWLP_WNDPROC:
+        previous = reinterpret_cast<LONG_PTR>(window->window_proc);
+        window->window_proc = reinterpret_cast<WNDPROC>(value);
+        break;
+      case GWLP_USERDATA:
+        previous = window->user_data;
+        window->user_data = value;
+        break;
+      default:
+        break;
+    }
+    return previous;
+  }
+
+  LONG GetWindowLongW(HWND hwnd, int index) override {
+    return static_cast<LONG>(GetWindowLongPtrW(hwnd, index));
+  }
+
+  LONG SetWindowLongW(HWND hwnd, int index, LONG value) override {
+    return static_cast<LONG>(SetWindowLongPtrW(hwnd, index, value));
+  }
+
+  BOOL SetWindowPos(HWND hwnd,
+                    HWND insert_after,
+                    int x,
+                    int y,
+                    int cx,
+                    int cy,
+                    UINT flags) override {
+    WINDOWPOS position = {hwnd, insert_after, x, y, cx, cy, flags};
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!Find(hwnd)) {
+        return FALSE;
+      }
+    }
+    if (!(flags & SWP_NOSENDCHANGING)) {
+      Dispatch(hwnd, WM_WINDOWPOSCHANGING, 0,
+               reinterpret_cast<LPARAM>(&position));
+    }
+    if (flags & SWP_FRAMECHANGED) {
+      NCCALCSIZE_PARAMS params = {};
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        params.rgrc[0] = Find(hwnd)->rect;
+      }
+      params.lppos = &position;
+      Dispatch(hwnd, WM_NCCALCSIZE, TRUE, reinterpret_cast<LPARAM>(&params));
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      Window* window = Find(hwnd);
+      if (!window) {
+        return FALSE;
+      }
+      RECT& rect = window->rect;
+      if (!(position.flags & SWP_NOMOVE)) {
+        OffsetRect(&rect, position.x - rect.left, position.y - rect.top);
+      }
+      if (!(position.flags & SWP_NOSIZE)) {
+        rect.right = rect.left + position.cx;
+        rect.bottom = rect.top + position.cy;
+      }
+      position.x = rect.left;
+      position.y = rect.top;
+      position.cx = rect.right - rect.left;
+      position.cy = rect.bottom - rect.top;
+      if ((position.flags & SWP_SHOWWINDOW) && !window->visible) {
+        window->visible = true;
+      } else if ((position.flags & SWP_HIDEWINDOW) && window->visible) {
+        window->visible = false;
+      } else {
+        position.flags &= ~(SWP_SHOWWINDOW | SWP_HIDEWINDOW);
+      }
+      if (!(position.flags & SWP_NOZORDER)) {
+        RaiseLocked(hwnd, position.hwndInsertAfter);
+      }
+    }
+    Dispatch(hwnd, WM_WINDOWPOSCHANGED, 0, reinterpret_cast<LPARAM>(&position));
+    return TRUE;
+  }
+
+  BOOL ShowWindow(HWND hwnd, int command) override {
+    bool was_visible;
+    bool visible = true;
+    bool zoomed;
+    bool iconic;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      Window* window = Find(hwnd);
+      if (!window) {
+        return FALSE;
+      }
+      was_visible = window->visible;
+      zoomed = window->zoomed;
+      iconic = window->iconic;
+    }
+    switch (command) {
+      case SW_HIDE:
+        visible = false;
+        break;
+      case SW_SHOWNORMAL:
+      case SW_RESTORE:
+        // Restoring a minimized window that was maximized maximizes it again.
+        if (iconic) {
+          iconic = false;
+        } else {
+          zoomed = false;
+        }
+        break;
+      case SW_SHOWMAXIMIZED:
+        zoomed = true;
+        iconic = false;
+        break;
+      case SW_SHOWMINIMIZED:
+      case SW_MINIMIZE:
+      case SW_SHOWMINNOACTIVE:
+        iconic = true;
+        break;
+      default:
+        break;
+    }
+    RECT rect;
+    bool placement_changed;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      Window* window = Find(hwnd);
+      placement_changed =
+          window->zoomed != zoomed || window->iconic != iconic;
+      if (window->zoomed != zoomed && zoomed) {
+        window->restore_rect = window->rect;
+        window->rect = WorkArea();
+      } else if (window->zoomed != zoomed && !zoomed) {
+        window->rect = window->restore_rect;
+      }
+      window->zoomed = zoomed;
+      window->iconic = iconic;
+      rect = window->rect;
+      if (!placement_changed && was_visible == visible) {
+        return was_visible;
+      }
+    }
+    UINT flags = SWP_NOZORDER | SWP_NOACTIVATE |
+                 (visible ? SWP_SHOWWINDOW : SWP_HIDEWINDOW);
+    if (placement_changed) {
+      // SWP_STATECHANGED, which user32 sets on minimize, maximize and
+      // restore; it is not in the SDK headers.
+      flags |= 0x8000;
+    }
+    SetWindowPos(hwnd, nullptr, rect.left, rect.top, rect.right - rect.left,
+                 rect.bottom - rect.top, flags);
+    return was_visible;
+  }
+
+  BOOL GetWindowRect(HWND hwnd, LPRECT rect) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return FALSE;
+    }
+    *rect = window->rect;
+    return TRUE;
+  }
+
+  BOOL GetClientRect(HWND hwnd, LPRECT rect) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return FALSE;
+    }
+    // The client area covers the window; the sources that care extend it
+    // into the frame anyway.
+    *rect = {0, 0, window->rect.right - window->rect.left,
+             window->rect.bottom - window->rect.top};
+    return TRUE;
+  }
+
+  BOOL GetWindowPlacement(HWND hwnd, WINDOWPLACEMENT* placement) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return FALSE;
+    }
+    placement->flags = 0;
+    placement->showCmd = window->iconic   ? SW_SHOWMINIMIZED
+                         : window->zoomed ? SW_SHOWMAXIMIZED
+                                          : SW_SHOWNORMAL;
+    placement->ptMinPosition = {-1, -1};
+    placement->ptMaxPosition = {-1, -1};
+    placement->rcNormalPosition =
+        window->zoomed ? window->restore_rect : window->rect;
+    return TRUE;
+  }
+
+  BOOL IsZoomed(HWND hwnd) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    return window && window->zoomed;
+  }
+
+  BOOL IsIconic(HWND hwnd) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    return window && window->iconic;
+  }
+
+  BOOL PostMessageW(HWND hwnd,
+                    UINT message,
+                    WPARAM wparam,
+                    LPARAM lparam) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (hwnd && !Find(hwnd)) {
+      return FALSE;
+    }
+    posted_.push_back({hwnd, message, wparam, lparam, 0, {0, 0}});
+    return TRUE;
+  }
+
+  LRESULT SendMessageW(HWND hwnd,
+                       UINT message,
+                       WPARAM wparam,
+                       LPARAM lparam) override {
+    return Dispatch(hwnd, message, wparam, lparam);
+  }
+
+  BOOL SetForegroundWindow(HWND hwnd) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!Find(hwnd)) {
+      return FALSE;
+    }
+    foreground_ = hwnd;
+    active_ = hwnd;
+    return TRUE;
+  }
+
+  int GetWindowTextW(HWND hwnd, LPWSTR text, int max_count) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window || max_count <= 0) {
+      return 0;
+    }
+    return CopyText(window->text, text, max_count);
+  }
+
+  // Sends WM_SETTEXT, whose default handling sets the text.
+  BOOL SetWindowTextW(HWND hwnd, LPCWSTR text) override {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!Find(hwnd)) {
+        return FALSE;
+      }
+    }
+    return Dispatch(hwnd, WM_SETTEXT, 0, reinterpret_cast<LPARAM>(text))
+               ? TRUE
+               : FALSE;
+  }
+
+  BOOL SetLayeredWindowAttributes(HWND hwnd,
+                                  COLORREF key,
+                                  BYTE alpha,
+                                  DWORD flags) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window || !(window->ex_style & WS_EX_LAYERED)) {
+      return FALSE;
+    }
+    window->layered_key = key;
+    window->layered_alpha = alpha;
+    window->layered_flags = flags;
+    return TRUE;
+  }
+
+  HRESULT DwmSetWindowAttribute(HWND hwnd,
+                                DWORD attribute,
+                                LPCVOID value,
+                                DWORD size) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return E_INVALIDARG;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    window->dwm_attributes[attribute].assign(bytes, bytes + size);
+    return S_OK;
+  }
+
+  HRESULT DwmExtendFrameIntoClientArea(HWND hwnd,
+                                       const MARGINS* margins) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return E_INVALIDARG;
+    }
+    window->margins = *margins;
+    return S_OK;
+  }
+
+  BOOL SetWindowCompositionAttribute(
+      HWND hwnd,
+      WindowCompositionAttributeData* data) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window || !data) {
+      return FALSE;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(data->data);
+    window->composition_attributes[data->attribute].assign(
+        bytes, bytes + data->size);
+    return TRUE;
+  }
+
+  BOOL IsWindow(HWND hwnd) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return Find(hwnd) != nullptr;
+  }
+
+  BOOL IsWindowVisible(HWND hwnd) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Window* window = Find(hwnd); window; window = Find(window->parent)) {
+      if (!window->visible) {
+        return FALSE;
+      }
+    }
+    return Find(hwnd) != nullptr;
+  }
+
+  int GetClassNameW(HWND hwnd, LPWSTR name, int max_count) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window || max_count <= 0) {
+      return 0;
+    }
+    return CopyText(window->class_name, name, max_count);
+  }
+
+  DWORD GetWindowThreadProcessId(HWND hwnd, LPDWORD process_id) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return 0;
+    }
+    if (process_id) {
+      *process_id = window->process_id;
+    }
+    return window->thread_id;
+  }
+
+  HWND GetForegroundWindow() override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return Find(foreground_) ? foreground_ : nullptr;
+  }
+
+  HWND GetActiveWindow() override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return Find(active_) ? active_ : nullptr;
+  }
+
+  HWND GetAncestor(HWND hwnd, UINT flags) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return nullptr;
+    }
+    switch (flags) {
+      case GA_PARENT:
+        return window->parent;
+      case GA_ROOT:
+      case GA_ROOTOWNER: {
+        HWND root = hwnd;
+        while (Find(root)->parent) {
+          root = Find(root)->parent;
+        }
+        if (flags == GA_ROOTOWNER) {
+          while (Find(root)->owner) {
+            root = Find(root)->owner;
+          }
+        }
+        return root;
+      }
+      default:
+        return nullptr;
+    }
+  }
+
+  HWND GetWindow(HWND hwnd, UINT command) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return nullptr;
+    }
+    if (command == GW_OWNER) {
+      return window->owner;
+    }
+    if (command == GW_CHILD) {
+      std::vector<HWND> children = ChildrenLocked(hwnd);
+      return children.empty() ? nullptr : children.front();
+    }
+    std::vector<HWND> siblings = ChildrenLocked(window->parent);
+    auto it = std::find(siblings.begin(), siblings.end(), hwnd);
+    switch (command) {
+      case GW_HWNDFIRST:
+        return siblings.front();
+      case GW_HWNDLAST:
+        return siblings.back();
+      case GW_HWNDNEXT:
+        return it + 1 == siblings.end() ? nullptr : *(it + 1);
+      case GW_HWNDPREV:
+        return it == siblings.begin() ? nullptr : *(it - 1);
+      default:
+        return nullptr;
+    }
+  }
+
+  int GetWindowTextLengthW(HWND hwnd) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    return window ? static_cast<int>(window->text.size()) : 0;
+  }
+
+  DWORD GetClassLongW(HWND hwnd, int index) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window || index != GCL_STYLE) {
+      return 0;
+    }
+    return classes_[window->class_name].style;
+  }
+
+  DWORD SetClassLongW(HWND hwnd, int index, LONG value) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window || index != GCL_STYLE) {
+      return 0;
+    }
+    Class& window_class = classes_[window->class_name];
+    DWORD previous = window_class.style;
+    window_class.style = static_cast<DWORD>(value);
+    return previous;
+  }
+
+  BOOL ScreenToClient(HWND hwnd, LPPOINT point) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return FALSE;
+    }
+    point->x -= window->rect.left;
+    point->y -= window->rect.top;
+    return TRUE;
+  }
+
+  BOOL GetCursorPos(LPPOINT point) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    *point = cursor_;
+    return TRUE;
+  }
+
+  int GetSystemMetrics(int index) override {
+    switch (index) {
+      case SM_CXSCREEN:
+        return kScreenWidth;
+      case SM_CYSCREEN:
+        return kScreenHeight;
+      default:
+        return 0;
+    }
+  }
+
+  BOOL GetMonitorInfoW(HMONITOR monitor, LPMONITORINFO info) override {
+    if (monitor != monitor_) {
+      return FALSE;
+    }
+    info->rcMonitor = {0, 0, kScreenWidth, kScreenHeight};
+    info->rcWork = WorkArea();
+    info->dwFlags = MONITORINFOF_PRIMARY;
+    return TRUE;
+  }
+
+  BOOL EnumDisplayMonitors(HDC dc,
+                           LPCRECT,
+                           MONITORENUMPROC callback,
+                           LPARAM data) override {
+    RECT rect = {0, 0, kScreenWidth, kScreenHeight};
+    callback(monitor_, dc, &rect, data);
+    return TRUE;
+  }
+
+  BOOL EnumWindows(WNDENUMPROC callback, LPARAM data) override {
+    std::vector<HWND> windows;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      windows = ChildrenLocked(nullptr);
+    }
+    for (HWND hwnd : windows) {
+      if (!callback(hwnd, data)) {
+        return FALSE;
+      }
+    }
+    return TRUE;
+  }
+
+  HWND FindWindowExW(HWND parent,
+                     HWND after,
+                     LPCWSTR class_name,
+                     LPCWSTR window_name) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<HWND> candidates = ChildrenLocked(parent);
+    auto it = candidates.begin();
+    if (after) {
+      it = std::find(candidates.begin(), candidates.end(), after);
+      if (it != candidates.end()) {
+        ++it;
+      }
+    }
+    for (; it != candidates.end(); ++it) {
+      Window* window = Find(*it);
+      if ((!class_name || window->class_name == class_name) &&
+          (!window_name || window->text == window_name)) {
+        return *it;
+      }
+    }
+    return nullptr;
+  }
+
+  HRESULT DwmGetWindowAttribute(HWND hwnd,
+                                DWORD attribute,
+                                PVOID value,
+                                DWORD size) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return E_INVALIDARG;
+    }
+    if (attribute == DWMWA_EXTENDED_FRAME_BOUNDS && size == sizeof(RECT)) {
+      *static_cast<RECT*>(value) = window->rect;
+      return S_OK;
+    }
+    std::memset(value, 0, size);
+    auto it = window->dwm_attributes.find(attribute);
+    if (it != window->dwm_attributes.end()) {
+      std::memcpy(value, it->second.data(),
+                  (std::min)(it->second.size(), static_cast<size_t>(size)));
+    }
+    return S_OK;
+  }
+
+  HANDLE GetPropW(HWND hwnd, LPCWSTR name) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return nullptr;
+    }
+    auto it = window->props.find(name);
+    return it == window->props.end() ? nullptr : it->second;
+  }
+
+  BOOL SetPropW(HWND hwnd, LPCWSTR name, HANDLE data) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return FALSE;
+    }
+    window->props[name] = data;
+    return TRUE;
+  }
+
+  HANDLE RemovePropW(HWND hwnd, LPCWSTR name) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return nullptr;
+    }
+    auto it = window->props.find(name);
+    if (it == window->props.end()) {
+      return nullptr;
+    }
+    HANDLE data = it->second;
+    window->props.erase(it);
+    return data;
+  }
+
+  HMENU GetSystemMenu(HWND, BOOL) override {
+    return reinterpret_cast<HMENU>(uintptr_t{0x8000});
+  }
+
+  BOOL TrackPopupMenu(HMENU, UINT, int, int, int, HWND, const RECT*) override {
+    // Dismissed without a choice.
+    return FALSE;
+  }
+
+  BOOL SetWindowSubclass(HWND hwnd,
+                         SUBCLASSPROC proc,
+                         UINT_PTR id,
+                         DWORD_PTR data) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return FALSE;
+    }
+    for (Subclass& subclass : window->subclasses) {
+      if (subclass.proc == proc && subclass.id == id) {
+        subclass.data = data;
+        return TRUE;
+      }
+    }
+    window->subclasses.push_back({proc, id, data});
+    return TRUE;
+  }
+
+  BOOL RemoveWindowSubclass(HWND hwnd,
+                            SUBCLASSPROC proc,
+                            UINT_PTR id) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window* window = Find(hwnd);
+    if (!window) {
+      return FALSE;
+    }
+    for (auto it = window->subclasses.begin(); it != window->subclasses.end();
+         ++it) {
+      if (it->proc == proc && it->id == id) {
+        window->subclasses.erase(it);
+        return TRUE;
+      }
+    }
+    return FALSE;
+  }
+
+  HHOOK SetWindowsHookExW(int, HOOKPROC, HINSTANCE, DWORD) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reinterpret_cast<HHOOK>(NextHandleLocked());
+  }
+
+  BOOL UnhookWindowsHookEx(HHOOK hook) override { return hook != nullptr; }
+
+  HWINEVENTHOOK SetWinEventHook(DWORD,
+                                DWORD,
+                                HMODULE,
+                                WINEVENTPROC,
+                                DWORD,
+                                DWORD,
+                                DWORD) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reinterpret_cast<HWINEVENTHOOK>(NextHandleLocked());
+  }
+
+  BOOL UnhookWinEvent(HWINEVENTHOOK hook) override { return hook != nullptr; }
+
+  UINT_PTR SetTimer(HWND hwnd, UINT_PTR id, UINT, TIMERPROC) override {
+    // Timers never fire; the tests drive the code they would run directly.
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hwnd ? id : NextHandleLocked();
+  }
+
+  BOOL KillTimer(HWND, UINT_PTR) override { return TRUE; }
+
+  ATOM RegisterClassW(const WNDCLASSW* window_class) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::wstring name = window_class->lpszClassName;
+    if (classes_.count(name)) {
+      return 0;
+    }
+    classes_[name] = {window_class->lpfnWndProc, window_class->style};
+    return static_cast<ATOM>(0xC000 + classes_.size());
+  }
+
+  HWND CreateWindowExW(DWORD ex_style,
+                       LPCWSTR class_name,
+                       LPCWSTR window_name,
+                       DWORD style,
+                       int x,
+                       int y,
+                       int width,
+                       int height,
+                       HWND parent,
+                       HMENU,
+                       HINSTANCE instance,
+                       LPVOID param) override {
+    HWND hwnd;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = classes_.find(class_name);
+      if (it == classes_.end()) {
+        return nullptr;
+      }
+      hwnd = reinterpret_cast<HWND>(NextHandleLocked());
+      Window& window = windows_[hwnd];
+      window.class_name = class_name;
+      window.window_proc = it->second.window_proc;
+      window.text = window_name ? window_name : L"";
+      window.style = style & ~WS_VISIBLE;
+      window.ex_style = ex_style;
+      window.rect = {x, y, x + width, y + height};
+      window.restore_rect = window.rect;
+      window.message_only = parent == HWND_MESSAGE;
+      if (!window.message_only && parent) {
+        if (style & WS_CHILD) {
+          window.parent = parent;
+        } else {
+          window.owner = parent;
+        }
+      }
+      window.process_id = ::GetCurrentProcessId();
+      window.thread_id = ::GetCurrentThreadId();
+      z_order_.insert(z_order_.begin(), hwnd);
+    }
+    CREATESTRUCTW create = {param,  instance,   nullptr,
+                            parent, height,     width,
+                            y,      x,          static_cast<LONG>(style),
+                            window_name,        class_name,
+                            ex_style};
+    if (!Dispatch(hwnd, WM_NCCREATE, 0, reinterpret_cast<LPARAM>(&create)) ||
+        Dispatch(hwnd, WM_CREATE, 0, reinterpret_cast<LPARAM>(&create)) ==
+            -1) {
+      DestroyWindow(hwnd);
+      return nullptr;
+    }
+    if (style & WS_VISIBLE) {
+      ShowWindow(hwnd, SW_SHOW);
+    }
+    return hwnd;
+  }
+
+  BOOL DestroyWindow(HWND hwnd) override {
+    std::vector<HWND> children;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      Window* window = Find(hwnd);
+      if (!window || window->destroying) {
+        return FALSE;
+      }
+      window->destroying = true;
+      children = ChildrenLocked(hwnd);
+    }
+    Dispatch(hwnd, WM_DESTROY, 0, 0);
+    for (HWND child : children) {
+      DestroyWindow(child);
+    }
+    Dispatch(hwnd, WM_NCDESTROY, 0, 0);
+    std::lock_guard<std::mutex> lock(mutex_);
+    windows_.erase(hwnd);
+    z_order_.erase(std::remove(z_order_.begin(), z_order_.end(), hwnd),
+                   z_order_.end());
+    posted_.erase(std::remove_if(posted_.begin(), posted_.end(),
+                                 [hwnd](const MSG& msg) {
+                                   return msg.hwnd == hwnd;
+                                 }),
+                  posted_.end());
+    return TRUE;
+  }
+
+  BOOL ShowWindowAsync(HWND hwnd, int command) override {
+    ShowWindow(hwnd, command);
+    return TRUE;
+  }
+
+  BOOL ReleaseCapture() override { return TRUE; }
+
+  void PostQuitMessage(int exit_code) override {
+    PostMessageW(nullptr, WM_QUIT, static_cast<WPARAM>(exit_code), 0);
+  }
+
+  HANDLE LoadImageW(HINSTANCE,
+                    LPCWSTR name,
+                    UINT type,
+                    int,
+                    int,
+                    UINT load) override {
+    // Reads the file when there is one, as the system loader would; the
+    // image itself is not decoded.
+    if ((load & LR_LOADFROMFILE) && name) {
+      std::string path;
+      for (; *name; ++name) {
+        path.push_back(static_cast<char>(*name));
+      }
+      std::ifstream file(path, std::ios::binary);
+      std::vector<char> contents((std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+      file_bytes_read_ += contents.size();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    HANDLE image = reinterpret_cast<HANDLE>(NextHandleLocked());
+    if (type == IMAGE_ICON) {
+      icons_.insert(static_cast<HICON>(image));
+    }
+    return image;
+  }
+
+  HICON CreateIconFromResourceEx(PBYTE bits,
+                                 DWORD size,
+                                 BOOL,
+                                 DWORD,
+                                 int,
+                                 int,
+                                 UINT) override {
+    if (!bits || size == 0) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    HICON icon = reinterpret_cast<HICON>(NextHandleLocked());
+    icons_.insert(icon);
+    return icon;
+  }
+
+  BOOL DestroyIcon(HICON icon) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return icons_.erase(icon) != 0;
+  }
+
+  UINT_PTR SHAppBarMessage(DWORD message, PAPPBARDATA data) override {
+    if (message == ABM_QUERYPOS) {
+      return TRUE;
+    }
+    (void)data;
+    return message == ABM_NEW || message == ABM_REMOVE ? TRUE : FALSE;
+  }
+
+  LRESULT DefWindowProcW(HWND hwnd,
+                         UINT message,
+                         WPARAM,
+                         LPARAM lparam) override {
+    switch (message) {
+      case WM_NCCREATE:
+        return TRUE;
+      case WM_CLOSE:
+        DestroyWindow(hwnd);
+        return 0;
+      case WM_GETTEXTLENGTH:
+        return GetWindowTextLengthW(hwnd);
+      case WM_SETTEXT: {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Window* window = Find(hwnd);
+        if (!window) {
+          return FALSE;
+        }
+        const wchar_t* text = reinterpret_cast<const wchar_t*>(lparam);
+        window->text = text ? text : L"";
+        return TRUE;
+      }
+      case WM_SYSCOMMAND:
+        return 0;
+      case WM_WINDOWPOSCHANGED: {
+        const WINDOWPOS* position = reinterpret_cast<const WINDOWPOS*>(lparam);
+        if (!(position->flags & SWP_NOMOVE)) {
+          Dispatch(hwnd, WM_MOVE, 0, MAKELPARAM(position->x, position->y));
+        }
+        if (!(position->flags & SWP_NOSIZE)) {
+          WPARAM kind = IsIconic(hwnd)   ? SIZE_MINIMIZED
+                        : IsZoomed(hwnd) ? SIZE_MAXIMIZED
+                                               : SIZE_RESTORED;
+          Dispatch(hwnd, WM_SIZE, kind, MAKELPARAM(position->cx, position->cy));
+        }
+        return 0;
+      }
+      default:
+        return 0;
+    }
+  }
+
+  LRESULT CallWindowProcW(WNDPROC proc,
+                          HWND hwnd,
+                          UINT message,
+                          WPARAM wparam,
+                          LPARAM lparam) override {
+    return proc(hwnd, message, wparam, lparam);
+  }
+
+  LRESULT DefSubclassProc(HWND hwnd,
+                          UINT message,
+                          WPARAM wparam,
+                          LPARAM lparam) override {
+    // Continues below the subclass that is running for |hwnd|.
+    for (auto it = frames().rbegin(); it != frames().rend(); ++it) {
+      if (it->first == hwnd) {
+        return Call(hwnd, message, wparam, lparam, it->second);
+      }
+    }
+    return DefWindowProcW(hwnd, message, wparam, lparam);
+  }
+
+  LRESULT CallNextHookEx(HHOOK, int, WPARAM, LPARAM) override { return 0; }
+
+  BOOL GetMessageW(LPMSG msg, HWND hwnd, UINT, UINT) override {
+    if (on_message_loop_) {
+      std::function<void()> on_message_loop = std::move(on_message_loop_);
+      on_message_loop_ = nullptr;
+      on_message_loop();
+    }
+    if (!PopPosted(msg, hwnd) || msg->message == WM_QUIT) {
+      return FALSE;
+    }
+    return TRUE;
+  }
+
+  BOOL PeekMessageW(LPMSG msg,
+                    HWND hwnd,
+                    UINT,
+                    UINT,
+                    UINT remove) override {
+    if (!(remove & PM_REMOVE)) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (const MSG& posted : posted_) {
+        if (!hwnd || posted.hwnd == hwnd) {
+          *msg = posted;
+          return TRUE;
+        }
+      }
+      return FALSE;
+    }
+    return PopPosted(msg, hwnd);
+  }
+
+  BOOL TranslateMessage(const MSG*) override { return FALSE; }
+
+  LRESULT DispatchMessageW(const MSG* msg) override {
+    return msg->hwnd ? Dispatch(msg->hwnd, msg->message, msg->wParam,
+                                msg->lParam)
+                     : 0;
+  }
+
+  DWORD MsgWaitForMultipleObjects(DWORD count,
+                                  const HANDLE* handles,
+                                  BOOL,
+                                  DWORD milliseconds,
+                                  DWORD) override {
+    if (count == 0) {
+      return WAIT_TIMEOUT;
+    }
+    // Events are the stand-in kernel32's; anything else is a thread, which
+    // the caller joins right after.
+    DWORD result = ::WaitForSingleObject(handles[0], milliseconds);
+    return result == WAIT_FAILED ? WAIT_OBJECT_0 : result;
+  }
+
+  DWORD CharLowerBuffW(LPWSTR text, DWORD length) override {
+    for (DWORD i = 0; i < length; ++i) {
+      if (text[i] >= L'A' && text[i] <= L'Z') {
+        text[i] = static_cast<wchar_t>(text[i] + (L'a' - L'A'));
+      }
+    }
+    return length;
+  }
+
+ private:
+  struct Subclass {
+    SUBCLASSPROC proc;
+    UINT_PTR id;
+    DWORD_PTR data;
+  };
+
+  struct Class {
+    WNDPROC window_proc = nullptr;
+    DWORD style = 0;
+  };
+
+  struct Window {
+    std::wstring class_name;
+    WNDPROC window_proc = nullptr;
+    std::wstring text;
+    DWORD style = 0;
+    DWORD ex_style = 0;
+    LONG_PTR user_data = 0;
+    RECT rect = {};
+    RECT restore_rect = {};
+    bool visible = false;
+    bool zoomed = false;
+    bool iconic = false;
+    bool message_only = false;
+    bool destroying = false;
+    HWND parent = nullptr;
+    HWND owner = nullptr;
+    DWORD process_id = 0;
+    DWORD thread_id = 0;
+    std::map<std::wstring, HANDLE> props;
+    // In installation order; the last one runs first.
+    std::vector<Subclass> subclasses;
+    std::map<DWORD, std::vector<uint8_t>> dwm_attributes;
+    std::map<DWORD, std::vector<uint8_t>> composition_attributes;
+    MARGINS margins = {};
+    COLORREF layered_key = 0;
+    BYTE layered_alpha = 255;
+    DWORD layered_flags = 0;
+  };
+
+  // The subclass procedures running on this thread, innermost last, as
+  // {window, index of the subclass below}.
+  static std::vector<std::pair<HWND, size_t>>& frames() {
+    thread_local std::vector<std::pair<HWND, size_t>> frames;
+    return frames;
+  }
+
+  static void OffsetRect(RECT* rect, int dx, int dy) {
+    rect->left += dx;
+    rect->right += dx;
+    rect->top += dy;
+    rect->bottom += dy;
+  }
+
+  static RECT WorkArea() {
+    return {0, 0, kScreenWidth, kScreenHeight - kTaskbarHeight};
+  }
+
+  static int CopyText(const std::wstring& source,
+                      LPWSTR target,
+                      int max_count) {
+    int count = (std::min)(static_cast<int>(source.size()), max_count - 1);
+    std::copy(source.begin(), source.begin() + count, target);
+    target[count] = L'\0';
+    return count;
+  }
+
+  Window* Find(HWND hwnd) {
+    auto it = windows_.find(hwnd);
+    return it == windows_.end() ? nullptr : &it->second;
+  }
+
+  uintptr_t NextHandleLocked() {
+    next_handle_ += 0x10;
+    return next_handle_;
+  }
+
+  // Children of |parent| in z-order, topmost first; for nullptr, the
+  // top-level windows except message-only ones.
+  std::vector<HWND> ChildrenLocked(HWND parent) {
+    std::vector<HWND> children;
+    for (HWND hwnd : z_order_) {
+      Window* window = Find(hwnd);
+      if (window->parent == parent && !window->message_only &&
+          !(parent == nullptr && window->destroying)) {
+        children.push_back(hwnd);
+      }
+    }
+    return children;
+  }
+
+  void RaiseLocked(HWND hwnd, HWND insert_after) {
+    if (insert_after == HWND_NOTOPMOST || insert_after == HWND_BOTTOM) {
+      return;
+    }
+    z_order_.erase(std::remove(z_order_.begin(), z_order_.end(), hwnd),
+                   z_order_.end());
+    auto position = z_order_.begin();
+    if (insert_after != HWND_TOP && insert_after != HWND_TOPMOST) {
+      position = std::find(z_order_.begin(), z_order_.end(), insert_after);
+      if (position != z_order_.end()) {
+        ++position;
+      }
+    }
+    z_order_.insert(position, hwnd);
+  }
+
+  LRESULT SetStyle(HWND hwnd, int index, DWORD value) {
+    STYLESTRUCT style;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      Window* window = Find(hwnd);
+      if (!window) {
+        return 0;
+      }
+      style.styleOld = index == GWL_STYLE ? window->style : window->ex_style;
+      style.styleNew = value;
+    }
+    Dispatch(hwnd, WM_STYLECHANGING, static_cast<WPARAM>(index),
+             reinterpret_cast<LPARAM>(&style));
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      Window* window = Find(hwnd);
+      if (!window) {
+        return 0;
+      }
+      DWORD& target = index == GWL_STYLE ? window->style : window->ex_style;
+      if (index == GWL_STYLE) {
+        // Visibility is not a style; ShowWindow() owns it.
+        window->visible = (style.styleNew & WS_VISIBLE) != 0 ||
+                          (window->visible && !(style.styleOld & WS_VISIBLE));
+        style.styleNew &= ~WS_VISIBLE;
+      }
+      target = style.styleNew;
+    }
+    Dispatch(hwnd, WM_STYLECHANGED, static_cast<WPARAM>(index),
+             reinterpret_cast<LPARAM>(&style));
+    return static_cast<LONG>(style.styleOld);
+  }
+
+  bool PopPosted(MSG* msg, HWND hwnd) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = posted_.begin(); it != posted_.end(); ++it) {
+      if (!hwnd || it->hwnd == hwnd) {
+        *msg = *it;
+        posted_.erase(it);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Runs the subclass chain of |hwnd| from |level| subclasses up, then the
+  // window procedure.
+  LRESULT Call(HWND hwnd,
+               UINT message,
+               WPARAM wparam,
+               LPARAM lparam,
+               size_t level) {
+    Subclass subclass = {};
+    WNDPROC window_proc = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      Window* window = Find(hwnd);
+      if (!window) {
+        return 0;
+      }
+      level = (std::min)(level, window->subclasses.size());
+      if (level > 0) {
+        subclass = window->subclasses[level - 1];
+      } else {
+        window_proc = window->window_proc;
+      }
+    }
+    if (!subclass.proc) {
+      return window_proc ? window_proc(hwnd, message, wparam, lparam)
+                         : DefWindowProcW(hwnd, message, wparam, lparam);
+    }
+    frames().emplace_back(hwnd, level - 1);
+    LRESULT result = subclass.proc(hwnd, message, wparam, lparam, subclass.id,
+                                   subclass.data);
+    frames().pop_back();
+    return result;
+  }
+
+  LRESULT Dispatch(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
+    size_t level;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      Window* window = Find(hwnd);
+      if (!window) {
+        return 0;
+      }
+      level = window->subclasses.size();
+    }
+    return Call(hwnd, message, wparam, lparam, level);
+  }
+
+  std::mutex mutex_;
+  std::map<std::wstring, Class> classes_;
+  std::map<HWND, Window> windows_;
+  // Topmost first.
+  std::vector<HWND> z_order_;
+  std::deque<MSG> posted_;
+  uintptr_t next_handle_ = 0x10000;
+  HWND foreground_ = nullptr;
+  HWND active_ = nullptr;
+  POINT cursor_ = {0, 0};
+  HMONITOR monitor_;
+  std::set<HICON> icons_;
+  std::atomic<size_t> file_bytes_read_{0};
+  std::function<void()> on_message_loop_;
+};
+
+#endif  // MULTIPLE_WINDOWS_TEST_NATIVE_FAKE_WIN32_BACKEND_H_
@@ -0,0 +1,123 @@
+// Behaviour tests of hit_test_map.h: which region answers a point. Covers the
+// empty map, overlapping regions where the later one is on top, points on the
+// 64px cell boundaries and on region edges (left and top inclusive, right and
+// bottom exclusive), points outside the grid, and the pixel ratio scaling.
+
+#include <cstdint>
+#include <vector>
+
+#include "hit_test_map.h"
+#include "native_test.h"
+
+namespace {
+
+// WM_NCHITTEST codes.
+constexpr int32_t kNowhere = 0;
+constexpr int32_t kClient = 1;
+constexpr int32_t kCaption = 2;
+constexpr int32_t kMaxButton = 9;
+constexpr int32_t kLeft = 10;
+
+HitTestMap Built(const std::vector<HitTestRegionSpec>& specs,
+                 double pixel_ratio = 1.0) {
+  HitTestMap map;
+  map.Build(specs, pixel_ratio);
+  return map;
+}
+
+void CheckEmpty() {
+  HitTestMap map = Built({});
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(kNowhere, map.Lookup(0, 0, kNowhere));
+  EXPECT_EQ(kClient, map.Lookup(10, 10, kClient));
+  EXPECT_EQ(kClient, map.Lookup(-1, -1, kClient));
+
+  // Regions with no area, or entirely above or left of the client area,
+  // are dropped.
+  map = Built({{10, 10, 0, 20, kCaption},
+               {10, 10, 20, -5, kCaption},
+               {-40, 0, 30, 20, kCaption},
+               {0, -30, 20, 30, kCaption}});
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(kNowhere, map.Lookup(0, 0, kNowhere));
+
+  // Rebuilding with no regions clears the previous ones.
+  map = Built({{0, 0, 100, 100, kCaption}});
+  EXPECT_EQ(kCaption, map.Lookup(50, 50, kNowhere));
+  map.Build({}, 1.0);
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(kNowhere, map.Lookup(50, 50, kNowhere));
+}
+
+// A title bar with a maximize button on it, spanning several cells: the
+// button is registered later and answers where the two overlap. Registered
+// the other way round, the title bar covers the button.
+void CheckOverlapTopmostWins() {
+  const HitTestRegionSpec caption = {0, 0, 800, 32, kCaption};
+  const HitTestRegionSpec button = {700, 0, 46, 32, kMaxButton};
+  HitTestMap map = Built({caption, button});
+  EXPECT_EQ(kCaption, map.Lookup(10, 10, kNowhere));
+  EXPECT_EQ(kCaption, map.Lookup(699, 10, kNowhere));
+  EXPECT_EQ(kMaxButton, map.Lookup(700, 10, kNowhere));
+  EXPECT_EQ(kMaxButton, map.Lookup(745, 31, kNowhere));
+  EXPECT_EQ(kCaption, map.Lookup(746, 10, kNowhere));
+
+  map = Built({button, caption});
+  EXPECT_EQ(kCaption, map.Lookup(700, 10, kNowhere));
+  EXPECT_EQ(kCaption, map.Lookup(745, 31, kNowhere));
+
+  // Three deep: the last one containing the point answers, and the ones
+  // below it show through where it does not reach.
+  map = Built({{0, 0, 300, 300, kClient},
+               {0, 0, 200, 200, kCaption},
+               {0, 0, 100, 100, kLeft}});
+  EXPECT_EQ(kLeft, map.Lookup(99, 99, kNowhere));
+  EXPECT_EQ(kCaption, map.Lookup(100, 99, kNowhere));
+  EXPECT_EQ(kClient, map.Lookup(250, 250, kNowhere));
+}
+
+// Cells are 64px. A region straddling the boundary at x = 64 and one that
+// starts exactly on it, and a point on every side of each edge.
+void CheckCellBoundaryAndEdges() {
+  HitTestMap map = Built({{60, 60, 10, 10, kCaption},
+                          {128, 128, 64, 64, kMaxButton}});
+  // Straddling: left and top inclusive, right and bottom exclusive, on both
+  // sides of the cell boundary.
+  EXPECT_EQ(kNowhere, map.Lookup(59, 64, kNowhere));
+  EXPECT_EQ(kCaption, map.Lookup(60, 60, kNowhere));
+  EXPECT_EQ(kCaption, map.Lookup(63, 63, kNowhere));
+  EXPECT_EQ(kCaption, map.Lookup(64, 64, kNowhere));
+  EXPECT_EQ(kCaption, map.Lookup(69, 69, kNowhere));
+  EXPECT_EQ(kNowhere, map.Lookup(70, 64, kNowhere));
+  EXPECT_EQ(kNowhere, map.Lookup(64, 70, kNowhere));
+
+  // Aligned with the cells: the edges are the cell boundaries.
+  EXPECT_EQ(kNowhere, map.Lookup(127, 150, kNowhere));
+  EXPECT_EQ(kNowhere, map.Lookup(150, 127, kNowhere));
+  EXPECT_EQ(kMaxButton, map.Lookup(128, 128, kNowhere));
+  EXPECT_EQ(kMaxButton, map.Lookup(191, 191, kNowhere));
+  // The right and bottom edges are also the end of the grid.
+  EXPECT_EQ(kNowhere, map.Lookup(192, 150, kNowhere));
+  EXPECT_EQ(kNowhere, map.Lookup(150, 192, kNowhere));
+  EXPECT_EQ(kNowhere, map.Lookup(1000, 1000, kNowhere));
+  EXPECT_EQ(kNowhere, map.Lookup(-1, 150, kNowhere));
+}
+
+// Logical rects are scaled by the pixel ratio and truncated to pixels.
+void CheckPixelRatio() {
+  HitTestMap map = Built({{10, 10, 20, 20, kCaption}}, 1.5);
+  EXPECT_EQ(kNowhere, map.Lookup(14, 20, kNowhere));
+  EXPECT_EQ(kCaption, map.Lookup(15, 15, kNowhere));
+  EXPECT_EQ(kCaption, map.Lookup(44, 44, kNowhere));
+  EXPECT_EQ(kNowhere, map.Lookup(45, 20, kNowhere));
+}
+
+}  // namespace
+
+int main() {
+  CheckEmpty();
+  CheckOverlapTopmostWins();
+  CheckCellBoundaryAndEdges();
+  CheckPixelRatio();
+  return NativeTestResult();
+}
@@ -0,0 +1,172 @@
+// Swaps a window's icon between four status icons the way SetIcon does, on
+// fake_win32_backend.h, and times IconCache hits, from a path and from
+// in-memory .ico bytes, against loading both sizes from disk on every swap.
+// Checks the GDI handle count first: the cache holds one icon per source and
+// size however many swaps, evicts beyond its capacity, and destroys what it
+// evicts, where loading on every swap without DestroyIcon, as SetIcon did,
+// leaks two icons a swap.
+
+// This must be included before many other Windows headers.
+#include <windows.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "fake_win32_backend.h"
+#include "icon_cache.h"
+#include "native_test.h"
+
+namespace {
+
+constexpr UINT kDpi = 96;
+constexpr int kSmall = 16;
+constexpr int kBig = 32;
+constexpr int kStatusIcons = 4;
+
+struct IconPair {
+  HICON small = nullptr;
+  HICON big = nullptr;
+};
+
+// An .ico with one 32x32 32-bit image; |seed| varies the pixels.
+std::vector<uint8_t> IcoBytes(uint8_t seed) {
+  const uint32_t kImageBytes = 40 + 32 * 32 * 4 + 32 * 4;
+  std::vector<uint8_t> ico(6 + 16 + kImageBytes, seed);
+  const uint8_t header[6] = {0, 0, 1, 0, 1, 0};
+  // Width, height, colors, reserved, planes, bits, size, offset.
+  const uint8_t size_low = static_cast<uint8_t>(kImageBytes);
+  const uint8_t size_high = static_cast<uint8_t>(kImageBytes >> 8);
+  const uint8_t entry[16] = {32,       32,        0, 0, 1,  0, 32, 0,
+                             size_low, size_high, 0, 0, 22, 0, 0,  0};
+  std::copy(header, header + 6, ico.begin());
+  std::copy(entry, entry + 16, ico.begin() + 6);
+  return ico;
+}
+
+std::wstring Widen(const std::string& text) {
+  return std::wstring(text.begin(), text.end());
+}
+
+// SetIcon with a path, then with bytes, as ApplyIcon() does it.
+void SwapToFile(const std::wstring& path, IconPair* current) {
+  IconCache& cache = IconCache::Instance();
+  IconPair next = {cache.AcquireFromFile(path, kSmall, kDpi),
+                   cache.AcquireFromFile(path, kBig, kDpi)};
+  cache.Release(current->small);
+  cache.Release(current->big);
+  *current = next;
+}
+
+void SwapToBytes(const std::vector<uint8_t>& bytes, IconPair* current) {
+  IconCache& cache = IconCache::Instance();
+  uint64_t hash = IconCache::HashBytes(bytes.data(), bytes.size());
+  IconPair next = {
+      cache.AcquireFromBytes(bytes.data(), bytes.size(), hash, kSmall, kDpi),
+      cache.AcquireFromBytes(bytes.data(), bytes.size(), hash, kBig, kDpi)};
+  cache.Release(current->small);
+  cache.Release(current->big);
+  *current = next;
+}
+
+// Both sizes from disk on every swap, destroying the previous pair.
+void SwapUncached(const std::wstring& path, IconPair* current) {
+  IconPair next = {
+      static_cast<HICON>(win32::LoadImageW(nullptr, path.c_str(), IMAGE_ICON,
+                                           kSmall, kSmall, LR_LOADFROMFILE)),
+      static_cast<HICON>(win32::LoadImageW(nullptr, path.c_str(), IMAGE_ICON,
+                                           kBig, kBig, LR_LOADFROMFILE))};
+  win32::DestroyIcon(current->small);
+  win32::DestroyIcon(current->big);
+  *current = next;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int iterations = BenchmarkIterations(argc, argv, 20000);
+  FakeWin32Backend backend;
+  Win32Backend::Install(&backend);
+  IconCache& cache = IconCache::Instance();
+
+  std::filesystem::path directory = std::filesystem::temp_directory_path();
+  std::vector<std::vector<uint8_t>> icons;
+  std::vector<std::wstring> paths;
+  for (int i = 0; i < kStatusIcons; ++i) {
+    icons.push_back(IcoBytes(static_cast<uint8_t>(i + 1)));
+    std::string path =
+        (directory / ("icon_cache_benchmark_" + std::to_string(i) + ".ico"))
+            .string();
+    std::ofstream(path, std::ios::binary)
+        .write(reinterpret_cast<const char*>(icons.back().data()),
+               static_cast<std::streamsize>(icons.back().size()));
+    paths.push_back(Widen(path));
+  }
+
+  // Hits create nothing and read nothing.
+  IconPair current;
+  for (int i = 0; i < 1000; ++i) {
+    SwapToFile(paths[i % kStatusIcons], &current);
+  }
+  EXPECT_EQ(size_t{2 * kStatusIcons}, cache.size());
+  EXPECT_EQ(cache.size(), backend.LiveIcons());
+  size_t read_once = backend.FileBytesRead();
+  EXPECT_EQ(2 * kStatusIcons * icons[0].size(), read_once);
+  for (int i = 0; i < 1000; ++i) {
+    SwapToBytes(icons[i % kStatusIcons], &current);
+  }
+  EXPECT_EQ(size_t{4 * kStatusIcons}, cache.size());
+  EXPECT_EQ(cache.size(), backend.LiveIcons());
+  EXPECT_EQ(read_once, backend.FileBytesRead());
+
+  // Cycling through more icons than fit: every evicted icon is destroyed.
+  std::vector<std::vector<uint8_t>> many;
+  for (int i = 0; i < 40; ++i) {
+    many.push_back(IcoBytes(static_cast<uint8_t>(100 + i)));
+  }
+  for (int i = 0; i < 400; ++i) {
+    SwapToBytes(many[i % many.size()], &current);
+  }
+  EXPECT_TRUE(cache.size() <= 32);
+  EXPECT_EQ(cache.size(), backend.LiveIcons());
+
+  // SetIcon before the cache: two loads a swap, never destroyed.
+  size_t live = backend.LiveIcons();
+  for (int i = 0; i < 100; ++i) {
+    win32::LoadImageW(nullptr, paths[i % kStatusIcons].c_str(), IMAGE_ICON,
+                      kSmall, kSmall, LR_LOADFROMFILE);
+    win32::LoadImageW(nullptr, paths[i % kStatusIcons].c_str(), IMAGE_ICON,
+                      kBig, kBig, LR_LOADFROMFILE);
+  }
+  EXPECT_EQ(live + 200, backend.LiveIcons());
+
+  int swap = 0;
+  double from_file = MeasureNanoseconds(iterations, [&]() {
+    SwapToFile(paths[swap++ % kStatusIcons], &current);
+  });
+  double from_bytes = MeasureNanoseconds(iterations, [&]() {
+    SwapToBytes(icons[swap++ % kStatusIcons], &current);
+  });
+  IconPair uncached;
+  double from_disk = MeasureNanoseconds(iterations, [&]() {
+    SwapUncached(paths[swap++ % kStatusIcons], &uncached);
+  });
+  win32::DestroyIcon(uncached.small);
+  win32::DestroyIcon(uncached.big);
+  cache.Release(current.small);
+  cache.Release(current.big);
+
+  std::printf(
+      "Icon swap between %d icons: cached path %.0f ns, cached bytes %.0f ns, "
+      "loaded from disk %.0f ns per swap (%d swaps)\n",
+      kStatusIcons, from_file, from_bytes, from_disk, iterations);
+
+  for (const std::wstring& path : paths) {
+    std::filesystem::remove(std::string(path.begin(), path.end()));
+  }
+  Win32Backend::Install(nullptr);
+  return NativeTestResult();
+}
@@ -0,0 +1,72 @@
+#ifndef MULTIPLE_WINDOWS_TEST_NATIVE_TEST_H_
+#define MULTIPLE_WINDOWS_TEST_NATIVE_TEST_H_
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+// The few checks the native tests need. No test framework is vendored: a test
+// is a main() that runs its cases and returns NativeTestResult().
+
+inline int& NativeTestFailures() {
+  static int failures = 0;
+  return failures;
+}
+
+#define EXPECT_TRUE(condition)                                             \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": expected " #condition \
+                << std::endl;                                              \
+      ++NativeTestFailures();                                              \
+    }                                                                      \
+  } while (0)
+
+#define EXPECT_EQ(expected, actual)                                          \
+  do {                                                                       \
+    const auto& expected_value = (expected);                                 \
+    const auto& actual_value = (actual);                                     \
+    if (!(expected_value == actual_value)) {                                 \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": expected " #actual      \
+                << " == " << expected_value << ", got " << actual_value     \
+                << std::endl;                                                \
+      ++NativeTestFailures();                                                \
+    }                                                                        \
+  } while (0)
+
+inline int NativeTestResult() {
+  if (NativeTestFailures() != 0) {
+    std::cerr << NativeTestFailures() << " check(s) failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+// The iteration count of a benchmark: the first command line argument, or
+// |fallback|, which is kept small so that CTest runs stay quick.
+inline int BenchmarkIterations(int argc, char** argv, int fallback) {
+  int iterations = argc > 1 ? std::atoi(argv[1]) : 0;
+  return iterations > 0 ? iterations : fallback;
+}
+
+// Mean nanoseconds per call of |body| over |iterations| calls.
+template <typename F>
+double MeasureNanoseconds(int iterations, F body) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    body();
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+inline const void* volatile g_benchmark_sink = nullptr;
+
+// Keeps |value| from being optimized away.
+template <typename T>
+void DoNotOptimize(const T& value) {
+  g_benchmark_sink = &value;
+}
+
+#endif  // MULTIPLE_WINDOWS_TEST_NATIVE_TEST_H_
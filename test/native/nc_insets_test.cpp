@@ -0,0 +1,216 @@
+// Checks both WM_NCCALCSIZE policies in nc_insets.h, the runner's and
+// window_manager's, against a golden table of every frame mode, maximized,
+// fullscreen and Windows 11 combination, with three work area offsets: the
+// no-monitor fallback, a window maximized on its monitor, and an off-center
+// one. The expected tuples are what the per-message branches these functions
+// replaced added to the proposed client rect.
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+#include "native_test.h"
+#include "nc_insets.h"
+
+namespace {
+
+constexpr NcFrameMode kNormal = NcFrameMode::kNormal;
+constexpr NcFrameMode kHidden = NcFrameMode::kHiddenTitleBar;
+constexpr NcFrameMode kFrameless = NcFrameMode::kFrameless;
+
+struct GoldenRow {
+  NcInsetInputs inputs;
+  NcInsets runner;
+  NcInsets window_manager;
+};
+
+// {mode, maximized, fullscreen, windows11, work_offset_x, work_offset_y},
+// then the runner's and window_manager's {handled, left, top, right, bottom}.
+constexpr GoldenRow kGolden[] = {
+    {{kNormal, false, false, false, -8, -8},
+     {false, 0, 0, 0, 0}, {false, 0, 0, 0, 0}},
+    {{kNormal, false, false, false, 8, 8},
+     {false, 0, 0, 0, 0}, {false, 0, 0, 0, 0}},
+    {{kNormal, false, false, false, 7, 31},
+     {false, 0, 0, 0, 0}, {false, 0, 0, 0, 0}},
+    {{kNormal, false, false, true, -8, -8},
+     {false, 0, 0, 0, 0}, {false, 0, 0, 0, 0}},
+    {{kNormal, false, false, true, 8, 8},
+     {false, 0, 0, 0, 0}, {false, 0, 0, 0, 0}},
+    {{kNormal, false, false, true, 7, 31},
+     {false, 0, 0, 0, 0}, {false, 0, 0, 0, 0}},
+    {{kNormal, false, true, false, -8, -8},
+     {false, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kNormal, false, true, false, 8, 8},
+     {false, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kNormal, false, true, false, 7, 31},
+     {false, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kNormal, false, true, true, -8, -8},
+     {false, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kNormal, false, true, true, 8, 8},
+     {false, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kNormal, false, true, true, 7, 31},
+     {false, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kNormal, true, false, false, -8, -8},
+     {false, 0, 0, 0, 0}, {false, 0, 0, 0, 0}},
+    {{kNormal, true, false, false, 8, 8},
+     {false, 0, 0, 0, 0}, {false, 0, 0, 0, 0}},
+    {{kNormal, true, false, false, 7, 31},
+     {false, 0, 0, 0, 0}, {false, 0, 0, 0, 0}},
+    {{kNormal, true, false, true, -8, -8},
+     {false, 0, 0, 0, 0}, {false, 0, 0, 0, 0}},
+    {{kNormal, true, false, true, 8, 8},
+     {false, 0, 0, 0, 0}, {false, 0, 0, 0, 0}},
+    {{kNormal, true, false, true, 7, 31},
+     {false, 0, 0, 0, 0}, {false, 0, 0, 0, 0}},
+    {{kNormal, true, true, false, -8, -8},
+     {false, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kNormal, true, true, false, 8, 8},
+     {false, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kNormal, true, true, false, 7, 31},
+     {false, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kNormal, true, true, true, -8, -8},
+     {false, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kNormal, true, true, true, 8, 8},
+     {false, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kNormal, true, true, true, 7, 31},
+     {false, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kHidden, false, false, false, -8, -8},
+     {true, 8, 1, -8, -8}, {true, 8, 1, -8, -8}},
+    {{kHidden, false, false, false, 8, 8},
+     {true, 8, 1, -8, -8}, {true, 8, 1, -8, -8}},
+    {{kHidden, false, false, false, 7, 31},
+     {true, 8, 1, -8, -8}, {true, 8, 1, -8, -8}},
+    {{kHidden, false, false, true, -8, -8},
+     {true, 8, 0, -8, -8}, {true, 8, 0, -8, -8}},
+    {{kHidden, false, false, true, 8, 8},
+     {true, 8, 0, -8, -8}, {true, 8, 0, -8, -8}},
+    {{kHidden, false, false, true, 7, 31},
+     {true, 8, 0, -8, -8}, {true, 8, 0, -8, -8}},
+    {{kHidden, false, true, false, -8, -8},
+     {true, 8, 1, -8, -8}, {true, 0, 0, 0, 0}},
+    {{kHidden, false, true, false, 8, 8},
+     {true, 8, 1, -8, -8}, {true, 0, 0, 0, 0}},
+    {{kHidden, false, true, false, 7, 31},
+     {true, 8, 1, -8, -8}, {true, 0, 0, 0, 0}},
+    {{kHidden, false, true, true, -8, -8},
+     {true, 8, 0, -8, -8}, {true, 0, 0, 0, 0}},
+    {{kHidden, false, true, true, 8, 8},
+     {true, 8, 0, -8, -8}, {true, 0, 0, 0, 0}},
+    {{kHidden, false, true, true, 7, 31},
+     {true, 8, 0, -8, -8}, {true, 0, 0, 0, 0}},
+    {{kHidden, true, false, false, -8, -8},
+     {true, 8, 8, -8, -8}, {true, -8, -8, 8, 8}},
+    {{kHidden, true, false, false, 8, 8},
+     {true, 8, 8, -8, -8}, {true, 8, 8, -8, -8}},
+    {{kHidden, true, false, false, 7, 31},
+     {true, 8, 8, -8, -8}, {true, 7, 31, -7, -31}},
+    {{kHidden, true, false, true, -8, -8},
+     {true, 8, 8, -8, -8}, {true, -8, -8, 8, 8}},
+    {{kHidden, true, false, true, 8, 8},
+     {true, 8, 8, -8, -8}, {true, 8, 8, -8, -8}},
+    {{kHidden, true, false, true, 7, 31},
+     {true, 8, 8, -8, -8}, {true, 7, 31, -7, -31}},
+    {{kHidden, true, true, false, -8, -8},
+     {true, 8, 8, -8, -8}, {true, 0, 0, 0, 0}},
+    {{kHidden, true, true, false, 8, 8},
+     {true, 8, 8, -8, -8}, {true, 0, 0, 0, 0}},
+    {{kHidden, true, true, false, 7, 31},
+     {true, 8, 8, -8, -8}, {true, 0, 0, 0, 0}},
+    {{kHidden, true, true, true, -8, -8},
+     {true, 8, 8, -8, -8}, {true, 0, 0, 0, 0}},
+    {{kHidden, true, true, true, 8, 8},
+     {true, 8, 8, -8, -8}, {true, 0, 0, 0, 0}},
+    {{kHidden, true, true, true, 7, 31},
+     {true, 8, 8, -8, -8}, {true, 0, 0, 0, 0}},
+    {{kFrameless, false, false, false, -8, -8},
+     {true, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kFrameless, false, false, false, 8, 8},
+     {true, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kFrameless, false, false, false, 7, 31},
+     {true, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kFrameless, false, false, true, -8, -8},
+     {true, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kFrameless, false, false, true, 8, 8},
+     {true, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kFrameless, false, false, true, 7, 31},
+     {true, 0, 0, 0, 0}, {true, 0, 0, 0, 0}},
+    {{kFrameless, false, true, false, -8, -8},
+     {true, 0, 0, 0, 0}, {true, -8, -8, 8, 8}},
+    {{kFrameless, false, true, false, 8, 8},
+     {true, 0, 0, 0, 0}, {true, 8, 8, -8, -8}},
+    {{kFrameless, false, true, false, 7, 31},
+     {true, 0, 0, 0, 0}, {true, 7, 31, -7, -31}},
+    {{kFrameless, false, true, true, -8, -8},
+     {true, 0, 0, 0, 0}, {true, -8, -8, 8, 8}},
+    {{kFrameless, false, true, true, 8, 8},
+     {true, 0, 0, 0, 0}, {true, 8, 8, -8, -8}},
+    {{kFrameless, false, true, true, 7, 31},
+     {true, 0, 0, 0, 0}, {true, 7, 31, -7, -31}},
+    {{kFrameless, true, false, false, -8, -8},
+     {true, -8, -8, 8, 8}, {true, -8, -8, 8, 8}},
+    {{kFrameless, true, false, false, 8, 8},
+     {true, 8, 8, -8, -8}, {true, 8, 8, -8, -8}},
+    {{kFrameless, true, false, false, 7, 31},
+     {true, 7, 31, -7, -31}, {true, 7, 31, -7, -31}},
+    {{kFrameless, true, false, true, -8, -8},
+     {true, -8, -8, 8, 8}, {true, -8, -8, 8, 8}},
+    {{kFrameless, true, false, true, 8, 8},
+     {true, 8, 8, -8, -8}, {true, 8, 8, -8, -8}},
+    {{kFrameless, true, false, true, 7, 31},
+     {true, 7, 31, -7, -31}, {true, 7, 31, -7, -31}},
+    {{kFrameless, true, true, false, -8, -8},
+     {true, -8, -8, 8, 8}, {true, -8, -8, 8, 8}},
+    {{kFrameless, true, true, false, 8, 8},
+     {true, 8, 8, -8, -8}, {true, 8, 8, -8, -8}},
+    {{kFrameless, true, true, false, 7, 31},
+     {true, 7, 31, -7, -31}, {true, 7, 31, -7, -31}},
+    {{kFrameless, true, true, true, -8, -8},
+     {true, -8, -8, 8, 8}, {true, -8, -8, 8, 8}},
+    {{kFrameless, true, true, true, 8, 8},
+     {true, 8, 8, -8, -8}, {true, 8, 8, -8, -8}},
+    {{kFrameless, true, true, true, 7, 31},
+     {true, 7, 31, -7, -31}, {true, 7, 31, -7, -31}},
+};
+
+std::ostream& operator<<(std::ostream& out, const NcInsets& insets) {
+  return out << "{" << insets.handled << ", " << insets.left << ", "
+             << insets.top << ", " << insets.right << ", " << insets.bottom
+             << "}";
+}
+
+void PrintRow(size_t index, const NcInsetInputs& in) {
+  std::cerr << "  row " << index << ": mode " << static_cast<int>(in.mode)
+            << ", maximized " << in.maximized << ", fullscreen "
+            << in.fullscreen << ", windows11 " << in.windows11
+            << ", work offset " << in.work_offset_x << ","
+            << in.work_offset_y << std::endl;
+}
+
+}  // namespace
+
+// The tuples are used in constant expressions too.
+static_assert(ComputeRunnerNcInsets(kGolden[0].inputs) == kGolden[0].runner,
+              "nc_insets.h must stay constexpr");
+
+int main() {
+  constexpr size_t kRows = sizeof(kGolden) / sizeof(kGolden[0]);
+  // 3 modes x maximized x fullscreen x windows11 x 3 work offsets.
+  EXPECT_EQ(size_t{3 * 2 * 2 * 2 * 3}, kRows);
+
+  for (size_t i = 0; i < kRows; ++i) {
+    const GoldenRow& row = kGolden[i];
+    int failures = NativeTestFailures();
+    EXPECT_EQ(row.runner, ComputeRunnerNcInsets(row.inputs));
+    EXPECT_EQ(row.window_manager, ComputeWindowManagerNcInsets(row.inputs));
+    if (NativeTestFailures() != failures) {
+      PrintRow(i, row.inputs);
+    }
+  }
+
+  // Inputs left at their defaults are a normal window, which neither module
+  // handles.
+  EXPECT_EQ(NcInsets{}, ComputeRunnerNcInsets(NcInsetInputs{}));
+  EXPECT_EQ(NcInsets{}, ComputeWindowManagerNcInsets(NcInsetInputs{}));
+  return NativeTestResult();
+}
@@ -0,0 +1,152 @@
+// Replays a resize drag, the WM_SIZING proposals of a window resized from
+// three edges at a 1 kHz mouse rate, through a spec with every kind of
+// constraint, and times the compiled descriptor against compiling the spec
+// on every message, as applying the logical values per message amounts to.
+// Checks that both give the same rect for every message first.
+//
+// The trace follows a drag from the bottom-right corner out and back, then
+// the left edge, then the top edge, with a few pixels of hand jitter.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "native_test.h"
+#include "size_constraints.h"
+
+namespace {
+
+// WMSZ_* values.
+constexpr uintptr_t kLeft = 1;
+constexpr uintptr_t kTop = 3;
+constexpr uintptr_t kBottomRight = 8;
+
+constexpr double kPixelRatio = 1.5;
+constexpr int32_t kFrameWidth = 16;
+constexpr int32_t kFrameHeight = 39;
+
+struct SizingMessage {
+  uintptr_t edge;
+  SizeConstraintRect proposed;
+};
+
+// |samples| proposals of one drag of |edge| from |start|, the dragged edges
+// following the cursor by up to |dx|, |dy| and back.
+void AppendDrag(uintptr_t edge,
+                const SizeConstraintRect& start,
+                int32_t dx,
+                int32_t dy,
+                int samples,
+                uint32_t* seed,
+                std::vector<SizingMessage>* trace) {
+  const double kPi = 3.14159265358979323846;
+  for (int i = 0; i < samples; ++i) {
+    *seed = *seed * 1664525u + 1013904223u;
+    int32_t jitter_x = static_cast<int32_t>((*seed >> 16) % 5) - 2;
+    int32_t jitter_y = static_cast<int32_t>((*seed >> 24) % 5) - 2;
+    double t = std::sin(kPi * i / samples);
+    int32_t offset_x = static_cast<int32_t>(dx * t) + jitter_x;
+    int32_t offset_y = static_cast<int32_t>(dy * t) + jitter_y;
+    SizeConstraintRect rect = start;
+    switch (edge) {
+      case kLeft:
+        rect.left += offset_x;
+        break;
+      case kTop:
+        rect.top += offset_y;
+        break;
+      case kBottomRight:
+        rect.right += offset_x;
+        rect.bottom += offset_y;
+        break;
+    }
+    trace->push_back({edge, rect});
+  }
+}
+
+std::vector<SizingMessage> ResizeDrag() {
+  std::vector<SizingMessage> trace;
+  uint32_t seed = 2024;
+  SizeConstraintRect start = {200, 150, 1400, 900};
+  AppendDrag(kBottomRight, start, 900, 500, 1800, &seed, &trace);
+  AppendDrag(kBottomRight, start, -700, -450, 1200, &seed, &trace);
+  AppendDrag(kLeft, start, -180, 0, 700, &seed, &trace);
+  AppendDrag(kTop, start, 0, 400, 900, &seed, &trace);
+  return trace;
+}
+
+SizeConstraintSpec TerminalSpec() {
+  SizeConstraintSpec spec;
+  spec.min_width = 400;
+  spec.min_height = 300;
+  spec.max_width = 1600;
+  spec.max_height = 1000;
+  spec.aspect_ratio = 16.0 / 10.0;
+  spec.aspect_tolerance = 0.25;
+  spec.step_width = 8;
+  spec.step_height = 16;
+  return spec;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int iterations = BenchmarkIterations(argc, argv, 20);
+  std::vector<SizingMessage> trace = ResizeDrag();
+  SizeConstraintSpec spec = TerminalSpec();
+  SizeConstraints compiled =
+      CompileSizeConstraints(spec, kPixelRatio, kFrameWidth, kFrameHeight);
+
+  int32_t mismatches = 0;
+  int32_t changed = 0;
+  for (const SizingMessage& message : trace) {
+    SizeConstraintRect fast = message.proposed;
+    ApplySizeConstraints(compiled, message.edge, &fast);
+    SizeConstraintRect slow = message.proposed;
+    ApplySizeConstraints(
+        CompileSizeConstraints(spec, kPixelRatio, kFrameWidth, kFrameHeight),
+        message.edge, &slow);
+    if (fast.left != slow.left || fast.top != slow.top ||
+        fast.right != slow.right || fast.bottom != slow.bottom) {
+      ++mismatches;
+    }
+    if (fast.left != message.proposed.left ||
+        fast.top != message.proposed.top ||
+        fast.right != message.proposed.right ||
+        fast.bottom != message.proposed.bottom) {
+      ++changed;
+    }
+  }
+  EXPECT_EQ(0, mismatches);
+  // The drag has to exercise the constraints to measure them.
+  EXPECT_TRUE(changed > static_cast<int32_t>(trace.size()) / 2);
+
+  std::vector<SizeConstraintRect> results(trace.size());
+  double precompiled = MeasureNanoseconds(iterations, [&]() {
+    for (size_t i = 0; i < trace.size(); ++i) {
+      results[i] = trace[i].proposed;
+      ApplySizeConstraints(compiled, trace[i].edge, &results[i]);
+    }
+    DoNotOptimize(results);
+  });
+  // Read through a volatile pointer, as from the window's state, so that the
+  // compile is not hoisted out of the loop.
+  const SizeConstraintSpec* volatile live_spec = &spec;
+  double per_message = MeasureNanoseconds(iterations, [&]() {
+    for (size_t i = 0; i < trace.size(); ++i) {
+      results[i] = trace[i].proposed;
+      ApplySizeConstraints(CompileSizeConstraints(*live_spec, kPixelRatio,
+                                                  kFrameWidth, kFrameHeight),
+                           trace[i].edge, &results[i]);
+    }
+    DoNotOptimize(results);
+  });
+  double messages = static_cast<double>(trace.size());
+  std::printf(
+      "Resize drag (%zu WM_SIZING): compiled %.1f ns, compiled per message "
+      "%.1f ns per message (%d runs)\n",
+      trace.size(), precompiled / messages, per_message / messages,
+      iterations);
+  return NativeTestResult();
+}
@@ -0,0 +1,331 @@
+// Property test of size_constraints.h: random specs, frames, pixel ratios,
+// proposed rects and WM_SIZING edges, each result checked against what its
+// constraints promise. Aspect-only specs without a tolerance are also checked
+// against the hand-written WM_SIZING switch the descriptor replaced.
+//
+// Pass the number of cases to run more, e.g.
+//   _gate_build/test/native/size_constraints_test 10000000
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include "native_test.h"
+#include "size_constraints.h"
+
+namespace {
+
+// WMSZ_* values.
+constexpr uintptr_t kLeft = 1;
+constexpr uintptr_t kRight = 2;
+constexpr uintptr_t kTop = 3;
+constexpr uintptr_t kTopLeft = 4;
+constexpr uintptr_t kTopRight = 5;
+constexpr uintptr_t kBottom = 6;
+constexpr uintptr_t kBottomLeft = 7;
+constexpr uintptr_t kBottomRight = 8;
+
+class Random {
+ public:
+  explicit Random(uint64_t seed) : state_(seed) {}
+
+  uint32_t Next() {
+    state_ = state_ * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<uint32_t>(state_ >> 33);
+  }
+
+  // In [low, high].
+  int32_t Int(int32_t low, int32_t high) {
+    return low + static_cast<int32_t>(Next() % static_cast<uint32_t>(
+                                                   high - low + 1));
+  }
+
+  bool Chance(int percent) { return Int(0, 99) < percent; }
+
+ private:
+  uint64_t state_;
+};
+
+bool MovesLeft(uintptr_t edge) {
+  return edge == kLeft || edge == kTopLeft || edge == kBottomLeft;
+}
+
+// WMSZ_LEFT keeps the bottom edge, as the hand-written switch did.
+bool MovesTop(uintptr_t edge) {
+  return edge == kLeft || edge == kTop || edge == kTopLeft ||
+         edge == kTopRight;
+}
+
+bool WidthDrives(uintptr_t edge) {
+  return edge == kLeft || edge == kRight || edge == kTopLeft ||
+         edge == kBottomLeft;
+}
+
+// The WM_SIZING aspect ratio code before size_constraints.h.
+void HandWrittenAspect(double aspect_ratio,
+                       uintptr_t edge,
+                       SizeConstraintRect* rect) {
+  int new_width = rect->right - rect->left;
+  int new_height = rect->bottom - rect->top;
+  if (WidthDrives(edge)) {
+    new_height = static_cast<int>(new_width / aspect_ratio);
+  } else {
+    new_width = static_cast<int>(new_height * aspect_ratio);
+  }
+  int left = rect->left;
+  int top = rect->top;
+  int right = rect->right;
+  int bottom = rect->bottom;
+  switch (edge) {
+    case kRight:
+    case kBottom:
+      right = new_width + left;
+      bottom = top + new_height;
+      break;
+    case kTop:
+      right = new_width + left;
+      top = bottom - new_height;
+      break;
+    case kLeft:
+    case kTopLeft:
+      left = right - new_width;
+      top = bottom - new_height;
+      break;
+    case kTopRight:
+      right = left + new_width;
+      top = bottom - new_height;
+      break;
+    case kBottomLeft:
+      left = right - new_width;
+      bottom = top + new_height;
+      break;
+    case kBottomRight:
+      right = left + new_width;
+      bottom = top + new_height;
+      break;
+  }
+  *rect = {left, top, right, bottom};
+}
+
+bool SameRect(const SizeConstraintRect& a, const SizeConstraintRect& b) {
+  return a.left == b.left && a.top == b.top && a.right == b.right &&
+         a.bottom == b.bottom;
+}
+
+struct Case {
+  SizeConstraintSpec spec;
+  double pixel_ratio;
+  int32_t frame_width;
+  int32_t frame_height;
+  uintptr_t edge;
+  SizeConstraintRect proposed;
+};
+
+Case RandomCase(Random& random) {
+  Case c;
+  static constexpr double kRatios[] = {1.0, 1.25, 1.5, 1.75, 2.0};
+  c.pixel_ratio = kRatios[random.Int(0, 4)];
+  c.frame_width = random.Chance(30) ? 0 : random.Int(0, 16);
+  c.frame_height = random.Chance(30) ? 0 : random.Int(0, 40);
+  c.edge = static_cast<uintptr_t>(random.Int(1, 8));
+
+  SizeConstraintSpec& spec = c.spec;
+  if (random.Chance(50)) {
+    spec.min_width = random.Int(1, 800);
+  }
+  if (random.Chance(50)) {
+    spec.min_height = random.Int(1, 600);
+  }
+  if (random.Chance(50)) {
+    spec.max_width = spec.min_width + random.Int(0, 2000);
+  }
+  if (random.Chance(50)) {
+    spec.max_height = spec.min_height + random.Int(0, 1500);
+  }
+  if (random.Chance(40)) {
+    spec.aspect_ratio = random.Int(25, 400) / 100.0;
+    spec.aspect_tolerance = random.Chance(50) ? random.Int(0, 20) / 100.0 : 0;
+  }
+  if (random.Chance(30)) {
+    spec.step_width = random.Int(1, 24);
+    spec.step_height = random.Int(1, 24);
+  } else if (random.Chance(30)) {
+    spec.grid_width = random.Int(1, 200);
+    spec.grid_height = random.Int(1, 200);
+    spec.grid_snap_distance = random.Int(0, 16);
+  }
+
+  int32_t left = random.Int(-3000, 3000);
+  int32_t top = random.Int(-2000, 2000);
+  c.proposed = {left, top, left + random.Int(1, 4000),
+                top + random.Int(1, 3000)};
+  return c;
+}
+
+int32_t Width(const SizeConstraintRect& rect) {
+  return rect.right - rect.left;
+}
+
+int32_t Height(const SizeConstraintRect& rect) {
+  return rect.bottom - rect.top;
+}
+
+// Checks one case; returns false and describes it on the first broken
+// property.
+bool CheckCase(const Case& c) {
+  SizeConstraints compiled = CompileSizeConstraints(
+      c.spec, c.pixel_ratio, c.frame_width, c.frame_height);
+  SizeConstraintRect rect = c.proposed;
+  ApplySizeConstraints(compiled, c.edge, &rect);
+
+  const char* broken = nullptr;
+  int32_t width = Width(rect);
+  int32_t height = Height(rect);
+
+  // The edges opposite the dragged ones stay put.
+  if (MovesLeft(c.edge) ? rect.right != c.proposed.right
+                        : rect.left != c.proposed.left) {
+    broken = "horizontal anchor moved";
+  }
+  if (MovesTop(c.edge) ? rect.bottom != c.proposed.bottom
+                       : rect.top != c.proposed.top) {
+    broken = "vertical anchor moved";
+  }
+
+  // Minimum and maximum sizes hold whatever else is set.
+  if (compiled.Has(SizeConstraints::kMinWidth) &&
+      width < compiled.min_width) {
+    broken = "narrower than the minimum";
+  }
+  if (compiled.Has(SizeConstraints::kMaxWidth) &&
+      width > compiled.max_width) {
+    broken = "wider than the maximum";
+  }
+  if (compiled.Has(SizeConstraints::kMinHeight) &&
+      height < compiled.min_height) {
+    broken = "shorter than the minimum";
+  }
+  if (compiled.Has(SizeConstraints::kMaxHeight) &&
+      height > compiled.max_height) {
+    broken = "taller than the maximum";
+  }
+
+  bool bounded = compiled.Has(SizeConstraints::kMinWidth) ||
+                 compiled.Has(SizeConstraints::kMinHeight) ||
+                 compiled.Has(SizeConstraints::kMaxWidth) ||
+                 compiled.Has(SizeConstraints::kMaxHeight);
+  bool aspect = compiled.Has(SizeConstraints::kAspect);
+
+  // Alone, a step floors the client size to a multiple of it.
+  if (!bounded && !aspect) {
+    int32_t client = Width(c.proposed) - c.frame_width;
+    if (compiled.Has(SizeConstraints::kStepWidth) && client > 0 &&
+        ((width - c.frame_width) % compiled.step_width != 0 ||
+         width > Width(c.proposed) ||
+         Width(c.proposed) - width >= compiled.step_width)) {
+      broken = "width is not floored to the step";
+    }
+    // Alone, the grid snaps within the snap distance or leaves it alone.
+    if (compiled.Has(SizeConstraints::kGridWidth) && client > 0 &&
+        width != Width(c.proposed) &&
+        ((width - c.frame_width) % compiled.grid_width != 0 ||
+         std::abs(width - Width(c.proposed)) > compiled.grid_snap)) {
+      broken = "width snapped off the grid or too far";
+    }
+  }
+
+  // Alone, an aspect ratio leaves a ratio inside the band alone and puts the
+  // derived side within a pixel of the nearest end of the band otherwise.
+  if (compiled.flags == SizeConstraints::kAspect) {
+    double before =
+        static_cast<double>(Width(c.proposed)) / Height(c.proposed);
+    if (before >= compiled.aspect_min && before <= compiled.aspect_max) {
+      if (!SameRect(rect, c.proposed)) {
+        broken = "ratio inside the tolerance band was changed";
+      }
+    } else {
+      double target = before < compiled.aspect_min ? compiled.aspect_min
+                                                   : compiled.aspect_max;
+      if (compiled.aspect_min == compiled.aspect_max) {
+        target = compiled.aspect_ratio;
+      }
+      double error = WidthDrives(c.edge) ? height - width / target
+                                         : width - height * target;
+      if (error > 0 || error <= -1) {
+        broken = "derived side is not the truncated target";
+      }
+    }
+
+    // Without a tolerance, it is the hand-written switch.
+    if (compiled.aspect_min == compiled.aspect_max &&
+        (before < compiled.aspect_min || before > compiled.aspect_max)) {
+      SizeConstraintRect expected = c.proposed;
+      HandWrittenAspect(compiled.aspect_ratio, c.edge, &expected);
+      if (!SameRect(rect, expected)) {
+        broken = "differs from the hand-written WM_SIZING switch";
+      }
+    }
+  }
+
+  // Min and max alone, and steps alone, are idempotent.
+  if (!aspect && (compiled.flags & (SizeConstraints::kGridWidth |
+                                    SizeConstraints::kGridHeight)) == 0 &&
+      (!bounded || (compiled.flags & (SizeConstraints::kStepWidth |
+                                      SizeConstraints::kStepHeight)) == 0)) {
+    SizeConstraintRect again = rect;
+    ApplySizeConstraints(compiled, c.edge, &again);
+    if (!SameRect(again, rect)) {
+      broken = "applying twice changed the rect";
+    }
+  }
+
+  if (broken) {
+    std::cerr << broken << ": edge " << c.edge << ", ratio "
+              << c.pixel_ratio << ", frame " << c.frame_width << "x"
+              << c.frame_height << ", flags " << compiled.flags
+              << ", proposed " << Width(c.proposed) << "x"
+              << Height(c.proposed) << ", got " << width << "x" << height
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void CheckCompile() {
+  SizeConstraintSpec spec;
+  SizeConstraints none = CompileSizeConstraints(spec, 1.5, 16, 39);
+  EXPECT_EQ(uint32_t{0}, none.flags);
+
+  // An unconstrained descriptor leaves every rect alone.
+  SizeConstraintRect rect = {10, 20, 330, 260};
+  ApplySizeConstraints(none, kBottomRight, &rect);
+  EXPECT_TRUE(SameRect(rect, {10, 20, 330, 260}));
+
+  // Logical pixels are scaled and truncated; a maximum of 0 is a constraint.
+  spec.min_width = 101;
+  spec.max_height = 0;
+  spec.step_width = 0.5;
+  SizeConstraints scaled = CompileSizeConstraints(spec, 1.25, 16, 39);
+  EXPECT_EQ(int32_t{126}, scaled.min_width);
+  EXPECT_TRUE(scaled.Has(SizeConstraints::kMaxHeight));
+  EXPECT_EQ(int32_t{0}, scaled.max_height);
+  // Steps of a physical pixel or less are no constraint.
+  EXPECT_TRUE(!scaled.Has(SizeConstraints::kStepWidth));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int cases = BenchmarkIterations(argc, argv, 200000);
+  CheckCompile();
+
+  Random random(0x5EED5EED);
+  int failed = 0;
+  for (int i = 0; i < cases && failed < 10; ++i) {
+    if (!CheckCase(RandomCase(random))) {
+      ++failed;
+    }
+  }
+  EXPECT_EQ(0, failed);
+  return NativeTestResult();
+}
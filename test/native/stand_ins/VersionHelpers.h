@@ -0,0 +1,7 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_VERSIONHELPERS_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_VERSIONHELPERS_H_
+
+// Nothing from it is used; the sources derive the version themselves.
+#include "windows.h"
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_VERSIONHELPERS_H_
@@ -0,0 +1,7 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_WINDOWS_CAPITALIZED_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_WINDOWS_CAPITALIZED_H_
+
+// The SDK's file system is case-insensitive; some sources spell it Windows.h.
+#include "windows.h"
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_WINDOWS_CAPITALIZED_H_
@@ -0,0 +1,15 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_COMMCTRL_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_COMMCTRL_H_
+
+#include "windows.h"
+
+// Window subclassing (comctl32 v6). The functions are only reachable through
+// the win32 wrappers.
+typedef LRESULT(CALLBACK* SUBCLASSPROC)(HWND hwnd,
+                                        UINT message,
+                                        WPARAM wparam,
+                                        LPARAM lparam,
+                                        UINT_PTR id,
+                                        DWORD_PTR data);
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_COMMCTRL_H_
@@ -0,0 +1,69 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_DWMAPI_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_DWMAPI_H_
+
+#include "windows.h"
+
+// The types and attribute values of dwmapi, with the SDK's values. The
+// functions are only reachable through the win32 wrappers.
+
+typedef struct _MARGINS {
+  int cxLeftWidth;
+  int cxRightWidth;
+  int cyTopHeight;
+  int cyBottomHeight;
+} MARGINS, *PMARGINS;
+
+enum DWMWINDOWATTRIBUTE {
+  DWMWA_NCRENDERING_ENABLED = 1,
+  DWMWA_NCRENDERING_POLICY = 2,
+  DWMWA_TRANSITIONS_FORCEDISABLED = 3,
+  DWMWA_ALLOW_NCPAINT = 4,
+  DWMWA_CAPTION_BUTTON_BOUNDS = 5,
+  DWMWA_NONCLIENT_RTL_LAYOUT = 6,
+  DWMWA_FORCE_ICONIC_REPRESENTATION = 7,
+  DWMWA_FLIP3D_POLICY = 8,
+  DWMWA_EXTENDED_FRAME_BOUNDS = 9,
+  DWMWA_HAS_ICONIC_BITMAP = 10,
+  DWMWA_DISALLOW_PEEK = 11,
+  DWMWA_EXCLUDED_FROM_PEEK = 12,
+  DWMWA_CLOAK = 13,
+  DWMWA_CLOAKED = 14,
+  DWMWA_FREEZE_REPRESENTATION = 15,
+  DWMWA_PASSIVE_UPDATE_MODE = 16,
+  DWMWA_USE_HOSTBACKDROPBRUSH = 17,
+  DWMWA_USE_IMMERSIVE_DARK_MODE = 20,
+  DWMWA_WINDOW_CORNER_PREFERENCE = 33,
+  DWMWA_BORDER_COLOR = 34,
+  DWMWA_CAPTION_COLOR = 35,
+  DWMWA_TEXT_COLOR = 36,
+  DWMWA_VISIBLE_FRAME_BORDER_THICKNESS = 37,
+  DWMWA_SYSTEMBACKDROP_TYPE = 38,
+  DWMWA_LAST
+};
+
+enum DWMNCRENDERINGPOLICY {
+  DWMNCRP_USEWINDOWSTYLE,
+  DWMNCRP_DISABLED,
+  DWMNCRP_ENABLED,
+  DWMNCRP_LAST
+};
+
+enum DWM_WINDOW_CORNER_PREFERENCE {
+  DWMWCP_DEFAULT = 0,
+  DWMWCP_DONOTROUND = 1,
+  DWMWCP_ROUND = 2,
+  DWMWCP_ROUNDSMALL = 3
+};
+
+enum DWM_SYSTEMBACKDROP_TYPE {
+  DWMSBT_AUTO = 0,
+  DWMSBT_NONE = 1,
+  DWMSBT_MAINWINDOW = 2,
+  DWMSBT_TRANSIENTWINDOW = 3,
+  DWMSBT_TABBEDWINDOW = 4
+};
+
+#define DWMWA_COLOR_DEFAULT 0xFFFFFFFF
+#define DWMWA_COLOR_NONE 0xFFFFFFFE
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_DWMAPI_H_
@@ -0,0 +1,67 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_BINARY_MESSENGER_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_BINARY_MESSENGER_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "encodable_value.h"
+#include "event_stream_handler.h"
+#include "method_call.h"
+#include "method_result.h"
+
+namespace flutter {
+
+// The stand-in messenger connects the channels of the native side directly
+// to the test, which plays Dart: there is no encoding and every call
+// completes synchronously unless the handler keeps its result. Values are
+// always EncodableValue.
+class BinaryMessenger {
+ public:
+  using MethodCallHandler = std::function<void(
+      const MethodCall<EncodableValue>& call,
+      std::unique_ptr<MethodResult<EncodableValue>> result)>;
+
+  // A method invocation or stream event the native side sent to Dart.
+  // Stream events have the method name "event".
+  struct Message {
+    std::string channel;
+    std::string method;
+    EncodableValue arguments;
+  };
+
+  BinaryMessenger() = default;
+  BinaryMessenger(BinaryMessenger const&) = delete;
+  BinaryMessenger& operator=(BinaryMessenger const&) = delete;
+
+  // Native side, used by the channels.
+  void SetMethodCallHandler(const std::string& channel,
+                            MethodCallHandler handler);
+  void SetStreamHandler(const std::string& channel,
+                        StreamHandler<EncodableValue>* handler);
+  void Send(const std::string& channel,
+            const std::string& method,
+            const EncodableValue& arguments);
+
+  // Dart side, used by the test. Returns false when no handler is set.
+  bool InvokeMethod(const std::string& channel,
+                    const std::string& method,
+                    const EncodableValue& arguments,
+                    std::unique_ptr<MethodResult<EncodableValue>> result);
+  bool Listen(const std::string& channel);
+  bool Cancel(const std::string& channel);
+
+  const std::vector<Message>& sent() const { return sent_; }
+  void ClearSent() { sent_.clear(); }
+
+ private:
+  std::map<std::string, MethodCallHandler> method_handlers_;
+  std::map<std::string, StreamHandler<EncodableValue>*> stream_handlers_;
+  std::vector<Message> sent_;
+};
+
+}  // namespace flutter
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_BINARY_MESSENGER_H_
@@ -0,0 +1,29 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_DART_PROJECT_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_DART_PROJECT_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace flutter {
+
+class DartProject {
+ public:
+  explicit DartProject(const std::wstring& path) : assets_path_(path) {}
+
+  void set_dart_entrypoint_arguments(std::vector<std::string> arguments) {
+    dart_entrypoint_arguments_ = std::move(arguments);
+  }
+
+  const std::vector<std::string>& dart_entrypoint_arguments() const {
+    return dart_entrypoint_arguments_;
+  }
+
+ private:
+  std::wstring assets_path_;
+  std::vector<std::string> dart_entrypoint_arguments_;
+};
+
+}  // namespace flutter
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_DART_PROJECT_H_
@@ -0,0 +1,72 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_ENCODABLE_VALUE_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_ENCODABLE_VALUE_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace flutter {
+
+class EncodableValue;
+
+using EncodableList = std::vector<EncodableValue>;
+using EncodableMap = std::map<EncodableValue, EncodableValue>;
+
+// The value types of the standard codec, as in the client wrapper, without
+// custom values.
+using EncodableValueVariant = std::variant<std::monostate,
+                                           bool,
+                                           int32_t,
+                                           int64_t,
+                                           double,
+                                           std::string,
+                                           std::vector<uint8_t>,
+                                           std::vector<int32_t>,
+                                           std::vector<int64_t>,
+                                           std::vector<double>,
+                                           EncodableList,
+                                           EncodableMap,
+                                           std::vector<float>>;
+
+class EncodableValue : public EncodableValueVariant {
+ public:
+  using super = EncodableValueVariant;
+
+  using super::super;
+  using super::operator=;
+
+  EncodableValue() = default;
+
+  // Without these, string literals would convert to bool.
+  explicit EncodableValue(const char* string) : super(std::string(string)) {}
+  EncodableValue& operator=(const char* other) {
+    *this = std::string(other);
+    return *this;
+  }
+
+  bool IsNull() const { return std::holds_alternative<std::monostate>(*this); }
+
+  int64_t LongValue() const {
+    if (std::holds_alternative<int32_t>(*this)) {
+      return std::get<int32_t>(*this);
+    }
+    return std::get<int64_t>(*this);
+  }
+
+  friend bool operator<(const EncodableValue& lhs, const EncodableValue& rhs) {
+    return static_cast<const super&>(lhs) < static_cast<const super&>(rhs);
+  }
+  friend bool operator==(const EncodableValue& lhs, const EncodableValue& rhs) {
+    return static_cast<const super&>(lhs) == static_cast<const super&>(rhs);
+  }
+  friend bool operator!=(const EncodableValue& lhs, const EncodableValue& rhs) {
+    return !(lhs == rhs);
+  }
+};
+
+}  // namespace flutter
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_ENCODABLE_VALUE_H_
@@ -0,0 +1,45 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_EVENT_CHANNEL_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_EVENT_CHANNEL_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "binary_messenger.h"
+#include "encodable_value.h"
+#include "event_stream_handler.h"
+#include "standard_method_codec.h"
+
+namespace flutter {
+
+template <typename T = EncodableValue>
+class EventChannel {
+ public:
+  EventChannel(BinaryMessenger* messenger,
+               const std::string& name,
+               const MethodCodec<T>* /* codec */)
+      : messenger_(messenger), name_(name) {}
+
+  ~EventChannel() {
+    if (handler_) {
+      messenger_->SetStreamHandler(name_, nullptr);
+    }
+  }
+
+  EventChannel(EventChannel const&) = delete;
+  EventChannel& operator=(EventChannel const&) = delete;
+
+  void SetStreamHandler(std::unique_ptr<StreamHandler<T>> handler) {
+    handler_ = std::move(handler);
+    messenger_->SetStreamHandler(name_, handler_.get());
+  }
+
+ private:
+  BinaryMessenger* messenger_;
+  std::string name_;
+  std::unique_ptr<StreamHandler<T>> handler_;
+};
+
+}  // namespace flutter
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_EVENT_CHANNEL_H_
@@ -0,0 +1,37 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_EVENT_SINK_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_EVENT_SINK_H_
+
+#include <string>
+
+namespace flutter {
+
+template <typename T>
+class EventSink {
+ public:
+  EventSink() = default;
+  virtual ~EventSink() = default;
+
+  EventSink(EventSink const&) = delete;
+  EventSink& operator=(EventSink const&) = delete;
+
+  void Success(const T& event) { SuccessInternal(&event); }
+  void Success() { SuccessInternal(nullptr); }
+
+  void Error(const std::string& error_code,
+             const std::string& error_message = "") {
+    ErrorInternal(error_code, error_message, nullptr);
+  }
+
+  void EndOfStream() { EndOfStreamInternal(); }
+
+ protected:
+  virtual void SuccessInternal(const T* event) = 0;
+  virtual void ErrorInternal(const std::string& error_code,
+                             const std::string& error_message,
+                             const T* error_details) = 0;
+  virtual void EndOfStreamInternal() = 0;
+};
+
+}  // namespace flutter
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_EVENT_SINK_H_
@@ -0,0 +1,32 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_FLUTTER_ENGINE_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_FLUTTER_ENGINE_H_
+
+#include <flutter_plugin_registrar.h>
+
+#include <string>
+
+#include "binary_messenger.h"
+#include "dart_project.h"
+#include "plugin_registry.h"
+
+namespace flutter {
+
+// Runs no Dart. Run() hands control to the stand-in host, which the test
+// uses to create the engine's windows; destroying the engine destroys the
+// plugins, as shutting down the real one does.
+class FlutterEngine : public PluginRegistry {
+ public:
+  explicit FlutterEngine(const DartProject& project);
+  ~FlutterEngine() override;
+
+  bool Run();
+
+  FlutterDesktopPluginRegistrarRef GetRegistrarForPlugin(
+      const std::string& plugin_name) override;
+
+  BinaryMessenger* messenger();
+};
+
+}  // namespace flutter
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_FLUTTER_ENGINE_H_
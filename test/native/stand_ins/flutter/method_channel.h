@@ -0,0 +1,54 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_METHOD_CHANNEL_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_METHOD_CHANNEL_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "binary_messenger.h"
+#include "encodable_value.h"
+#include "method_call.h"
+#include "method_result.h"
+#include "standard_method_codec.h"
+
+namespace flutter {
+
+template <typename T>
+using MethodCallHandler =
+    std::function<void(const MethodCall<T>& call,
+                       std::unique_ptr<MethodResult<T>> result)>;
+
+template <typename T = EncodableValue>
+class MethodChannel {
+ public:
+  MethodChannel(BinaryMessenger* messenger,
+                const std::string& name,
+                const MethodCodec<T>* /* codec */)
+      : messenger_(messenger), name_(name) {}
+
+  ~MethodChannel() = default;
+
+  MethodChannel(MethodChannel const&) = delete;
+  MethodChannel& operator=(MethodChannel const&) = delete;
+
+  // Replies from Dart are not modeled; |result| is dropped.
+  void InvokeMethod(const std::string& method,
+                    std::unique_ptr<T> arguments,
+                    std::unique_ptr<MethodResult<T>> result = nullptr) {
+    (void)result;
+    messenger_->Send(name_, method, arguments ? *arguments : T());
+  }
+
+  void SetMethodCallHandler(MethodCallHandler<T> handler) const {
+    messenger_->SetMethodCallHandler(name_, std::move(handler));
+  }
+
+ private:
+  BinaryMessenger* messenger_;
+  std::string name_;
+};
+
+}  // namespace flutter
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_METHOD_CHANNEL_H_
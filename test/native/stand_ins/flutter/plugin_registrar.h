@@ -0,0 +1,83 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_PLUGIN_REGISTRAR_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_PLUGIN_REGISTRAR_H_
+
+#include <flutter_plugin_registrar.h>
+
+#include <map>
+#include <memory>
+#include <set>
+
+#include "binary_messenger.h"
+
+namespace flutter {
+
+class Plugin {
+ public:
+  virtual ~Plugin() = default;
+};
+
+class PluginRegistrar {
+ public:
+  explicit PluginRegistrar(FlutterDesktopPluginRegistrarRef core_registrar)
+      : registrar_(core_registrar) {}
+
+  virtual ~PluginRegistrar() = default;
+
+  PluginRegistrar(PluginRegistrar const&) = delete;
+  PluginRegistrar& operator=(PluginRegistrar const&) = delete;
+
+  BinaryMessenger* messenger();
+
+  FlutterDesktopPluginRegistrarRef registrar() { return registrar_; }
+
+  void AddPlugin(std::unique_ptr<Plugin> plugin) {
+    plugins_.insert(std::move(plugin));
+  }
+
+ protected:
+  // Destroys the plugins while the subclass is still alive, as the client
+  // wrapper does, since plugins unregister from it.
+  void ClearPlugins() { plugins_.clear(); }
+
+ private:
+  FlutterDesktopPluginRegistrarRef registrar_;
+  std::set<std::unique_ptr<Plugin>> plugins_;
+};
+
+// Owns the wrapper registrar of each core registrar, like the client wrapper;
+// the stand-in engine resets it when it shuts down.
+class PluginRegistrarManager {
+ public:
+  static PluginRegistrarManager* GetInstance() {
+    static PluginRegistrarManager instance;
+    return &instance;
+  }
+
+  template <class T>
+  T* GetRegistrar(FlutterDesktopPluginRegistrarRef registrar_ref) {
+    auto it = registrars_.find(registrar_ref);
+    if (it != registrars_.end()) {
+      return static_cast<T*>(it->second.get());
+    }
+    auto* wrapper = new T(registrar_ref);
+    registrars_[registrar_ref] = std::unique_ptr<PluginRegistrar>(wrapper);
+    return wrapper;
+  }
+
+  void Reset() {
+    // Plugins may look registrars up while they are destroyed.
+    while (!registrars_.empty()) {
+      registrars_.extract(registrars_.begin());
+    }
+  }
+
+ private:
+  PluginRegistrarManager() = default;
+
+  std::map<FlutterDesktopPluginRegistrarRef, std::unique_ptr<PluginRegistrar>>
+      registrars_;
+};
+
+}  // namespace flutter
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_PLUGIN_REGISTRAR_H_
@@ -0,0 +1,58 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_PLUGIN_REGISTRAR_WINDOWS_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_PLUGIN_REGISTRAR_WINDOWS_H_
+
+#include <flutter_windows.h>
+#include <windows.h>
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "plugin_registrar.h"
+
+namespace flutter {
+
+using WindowProcDelegate = std::function<
+    std::optional<LRESULT>(HWND hwnd, UINT message, WPARAM wparam,
+                           LPARAM lparam)>;
+
+class FlutterView {
+ public:
+  explicit FlutterView(FlutterDesktopViewRef view) : view_(view) {}
+
+  HWND GetNativeWindow() { return FlutterDesktopViewGetHWND(view_); }
+
+ private:
+  FlutterDesktopViewRef view_;
+};
+
+class PluginRegistrarWindows : public PluginRegistrar {
+ public:
+  explicit PluginRegistrarWindows(
+      FlutterDesktopPluginRegistrarRef core_registrar)
+      : PluginRegistrar(core_registrar) {}
+
+  ~PluginRegistrarWindows() override { ClearPlugins(); }
+
+  // The implicit view; the stand-in host may set it after registration.
+  FlutterView* GetView() {
+    FlutterDesktopViewRef view =
+        FlutterDesktopPluginRegistrarGetView(registrar());
+    if (!view) {
+      return nullptr;
+    }
+    views_.push_back(std::make_unique<FlutterView>(view));
+    return views_.back().get();
+  }
+
+  int RegisterTopLevelWindowProcDelegate(WindowProcDelegate delegate);
+  void UnregisterTopLevelWindowProcDelegate(int proc_id);
+
+ private:
+  std::vector<std::unique_ptr<FlutterView>> views_;
+};
+
+}  // namespace flutter
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_PLUGIN_REGISTRAR_WINDOWS_H_
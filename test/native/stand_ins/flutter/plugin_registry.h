@@ -0,0 +1,24 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_PLUGIN_REGISTRY_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_PLUGIN_REGISTRY_H_
+
+#include <flutter_plugin_registrar.h>
+
+#include <string>
+
+namespace flutter {
+
+class PluginRegistry {
+ public:
+  PluginRegistry() = default;
+  virtual ~PluginRegistry() = default;
+
+  PluginRegistry(PluginRegistry const&) = delete;
+  PluginRegistry& operator=(PluginRegistry const&) = delete;
+
+  virtual FlutterDesktopPluginRegistrarRef GetRegistrarForPlugin(
+      const std::string& plugin_name) = 0;
+};
+
+}  // namespace flutter
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_PLUGIN_REGISTRY_H_
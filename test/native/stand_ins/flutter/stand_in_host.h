@@ -0,0 +1,64 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_STAND_IN_HOST_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_STAND_IN_HOST_H_
+
+#include <flutter_windows.h>
+#include <windows.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "binary_messenger.h"
+#include "plugin_registrar_windows.h"
+
+namespace flutter {
+
+// The state behind the stand-in engine, registrars and embedder API: one
+// messenger, the views by id, and the top-level window procedure delegates.
+// It plays the engine's role for the windows the test creates, which route
+// their messages through HandleTopLevelWindowProc() first, as the engine's
+// own windows do.
+class StandInHost {
+ public:
+  static StandInHost& Instance();
+
+  BinaryMessenger* messenger() { return &messenger_; }
+
+  // View 0 is the implicit view.
+  void SetView(FlutterDesktopViewId id, HWND hwnd);
+  void RemoveView(FlutterDesktopViewId id);
+  FlutterDesktopViewRef View(FlutterDesktopViewId id);
+
+  FlutterDesktopPluginRegistrarRef Registrar(const std::string& plugin_name);
+
+  int AddTopLevelWindowProcDelegate(WindowProcDelegate delegate);
+  void RemoveTopLevelWindowProcDelegate(int id);
+
+  // The first delegate that handles the message wins, as in the engine.
+  std::optional<LRESULT> HandleTopLevelWindowProc(HWND hwnd,
+                                                  UINT message,
+                                                  WPARAM wparam,
+                                                  LPARAM lparam);
+
+  // Called from FlutterEngine::Run(); the test sets it before the runner
+  // starts.
+  std::function<void()>& on_run() { return on_run_; }
+
+ private:
+  StandInHost() = default;
+
+  BinaryMessenger messenger_;
+  std::map<FlutterDesktopViewId, HWND> views_;
+  std::map<std::string, std::unique_ptr<int>> registrars_;
+  std::vector<std::pair<int, WindowProcDelegate>> delegates_;
+  int next_delegate_id_ = 1;
+  std::function<void()> on_run_;
+};
+
+}  // namespace flutter
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_STAND_IN_HOST_H_
@@ -0,0 +1,26 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_STANDARD_METHOD_CODEC_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_STANDARD_METHOD_CODEC_H_
+
+#include "encodable_value.h"
+
+namespace flutter {
+
+// Values cross the stand-in messenger unencoded, so codecs only exist to be
+// passed to the channels.
+template <typename T>
+class MethodCodec {
+ public:
+  virtual ~MethodCodec() = default;
+};
+
+class StandardMethodCodec : public MethodCodec<EncodableValue> {
+ public:
+  static const StandardMethodCodec& GetInstance() {
+    static StandardMethodCodec instance;
+    return instance;
+  }
+};
+
+}  // namespace flutter
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_STANDARD_METHOD_CODEC_H_
@@ -0,0 +1,6 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_PLUGIN_REGISTRAR_CORE_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_PLUGIN_REGISTRAR_CORE_H_
+
+typedef struct FlutterDesktopPluginRegistrar* FlutterDesktopPluginRegistrarRef;
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_PLUGIN_REGISTRAR_CORE_H_
@@ -0,0 +1,24 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_WINDOWS_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_WINDOWS_H_
+
+#include <cstdint>
+
+#include "flutter_plugin_registrar.h"
+#include "windows.h"
+
+// The parts of the Flutter Windows embedder C API the runner and the plugins
+// use, backed by flutter::StandInHost (flutter/stand_in_host.h).
+
+typedef struct FlutterDesktopView* FlutterDesktopViewRef;
+typedef int64_t FlutterDesktopViewId;
+
+FlutterDesktopViewRef FlutterDesktopPluginRegistrarGetView(
+    FlutterDesktopPluginRegistrarRef registrar);
+FlutterDesktopViewRef FlutterDesktopPluginRegistrarGetViewById(
+    FlutterDesktopPluginRegistrarRef registrar,
+    FlutterDesktopViewId view_id);
+HWND FlutterDesktopViewGetHWND(FlutterDesktopViewRef view);
+UINT FlutterDesktopGetDpiForHWND(HWND hwnd);
+void FlutterDesktopResyncOutputStreams();
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_FLUTTER_WINDOWS_H_
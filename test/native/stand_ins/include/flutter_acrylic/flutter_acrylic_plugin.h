@@ -0,0 +1,17 @@
+#ifndef FLUTTER_PLUGIN_FLUTTER_ACRYLIC_PLUGIN_H_
+#define FLUTTER_PLUGIN_FLUTTER_ACRYLIC_PLUGIN_H_
+
+// The public header of the flutter_acrylic plugin package, which is not
+// vendored.
+#include <flutter_plugin_registrar.h>
+
+#define FLUTTER_PLUGIN_EXPORT __attribute__((visibility("default")))
+
+extern "C" {
+
+FLUTTER_PLUGIN_EXPORT void FlutterAcrylicPluginRegisterWithRegistrar(
+    FlutterDesktopPluginRegistrarRef registrar);
+
+}  // extern "C"
+
+#endif  // FLUTTER_PLUGIN_FLUTTER_ACRYLIC_PLUGIN_H_
@@ -0,0 +1,17 @@
+#ifndef FLUTTER_PLUGIN_WINDOW_MANAGER_PLUGIN_H_
+#define FLUTTER_PLUGIN_WINDOW_MANAGER_PLUGIN_H_
+
+// The public header of the window_manager plugin package, which is not
+// vendored.
+#include <flutter_plugin_registrar.h>
+
+#define FLUTTER_PLUGIN_EXPORT __attribute__((visibility("default")))
+
+extern "C" {
+
+FLUTTER_PLUGIN_EXPORT void WindowManagerPluginRegisterWithRegistrar(
+    FlutterDesktopPluginRegistrarRef registrar);
+
+}  // extern "C"
+
+#endif  // FLUTTER_PLUGIN_WINDOW_MANAGER_PLUGIN_H_
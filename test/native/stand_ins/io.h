@@ -0,0 +1,17 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_IO_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_IO_H_
+
+#include <cstdio>
+
+// The CRT functions the runner uses to attach a console, defined in
+// stand_in_kernel32.cpp. The tests never create a console.
+typedef int errno_t;
+
+int _dup2(int from, int to);
+int _fileno(FILE* stream);
+errno_t freopen_s(FILE** result,
+                  const char* path,
+                  const char* mode,
+                  FILE* stream);
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_IO_H_
@@ -0,0 +1,8 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_SHELLAPI_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_SHELLAPI_H_
+
+// APPBARDATA and the ABM_ and ABE_ constants are declared with windows.h,
+// which includes shellapi.h in the SDK as well.
+#include "windows.h"
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_SHELLAPI_H_
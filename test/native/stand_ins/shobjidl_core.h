@@ -0,0 +1,43 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_SHOBJIDL_CORE_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_SHOBJIDL_CORE_H_
+
+#include "windows.h"
+
+// ITaskbarList3, as far as taskbar_worker.h uses it. The stand-in
+// CoCreateInstance() creates no objects, so the worker runs without one,
+// unless a test provides one with StandInProvideTaskbarList().
+
+enum TBPFLAG {
+  TBPF_NOPROGRESS = 0,
+  TBPF_INDETERMINATE = 0x1,
+  TBPF_NORMAL = 0x2,
+  TBPF_ERROR = 0x4,
+  TBPF_PAUSED = 0x8
+};
+
+struct ITaskbarList3 {
+  virtual HRESULT HrInit() = 0;
+  virtual HRESULT AddTab(HWND hwnd) = 0;
+  virtual HRESULT DeleteTab(HWND hwnd) = 0;
+  virtual HRESULT SetProgressValue(HWND hwnd,
+                                   ULONGLONG completed,
+                                   ULONGLONG total) = 0;
+  virtual HRESULT SetProgressState(HWND hwnd, TBPFLAG flags) = 0;
+  virtual ULONG Release() = 0;
+};
+
+extern const CLSID CLSID_TaskbarList;
+extern const IID IID_ITaskbarList3;
+
+// Makes CoCreateInstance() hand out |taskbar|, which the test owns; nullptr
+// goes back to creating nothing.
+void StandInProvideTaskbarList(ITaskbarList3* taskbar);
+
+inline REFIID StandInIidOf(ITaskbarList3**) {
+  return IID_ITaskbarList3;
+}
+
+#define IID_PPV_ARGS(object) \
+  StandInIidOf(object), reinterpret_cast<void**>(object)
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_SHOBJIDL_CORE_H_
@@ -0,0 +1,221 @@
+// The Flutter engine, embedder C API and client wrapper parts the stand-in
+// headers declare, backed by flutter::StandInHost.
+
+#include <flutter/binary_messenger.h>
+#include <flutter/flutter_engine.h>
+#include <flutter/plugin_registrar.h>
+#include <flutter/plugin_registrar_windows.h>
+#include <flutter/stand_in_host.h>
+#include <flutter_windows.h>
+
+#include <utility>
+
+namespace flutter {
+
+// static
+StandInHost& StandInHost::Instance() {
+  static StandInHost host;
+  return host;
+}
+
+void StandInHost::SetView(FlutterDesktopViewId id, HWND hwnd) {
+  views_[id] = hwnd;
+}
+
+void StandInHost::RemoveView(FlutterDesktopViewId id) {
+  views_.erase(id);
+}
+
+FlutterDesktopViewRef StandInHost::View(FlutterDesktopViewId id) {
+  auto it = views_.find(id);
+  // A view is represented by its window.
+  if (it == views_.end()) {
+    return nullptr;
+  }
+  return reinterpret_cast<FlutterDesktopViewRef>(it->second);
+}
+
+FlutterDesktopPluginRegistrarRef StandInHost::Registrar(
+    const std::string& plugin_name) {
+  std::unique_ptr<int>& registrar = registrars_[plugin_name];
+  if (!registrar) {
+    registrar = std::make_unique<int>(0);
+  }
+  return reinterpret_cast<FlutterDesktopPluginRegistrarRef>(registrar.get());
+}
+
+int StandInHost::AddTopLevelWindowProcDelegate(WindowProcDelegate delegate) {
+  int id = next_delegate_id_++;
+  delegates_.emplace_back(id, std::move(delegate));
+  return id;
+}
+
+void StandInHost::RemoveTopLevelWindowProcDelegate(int id) {
+  for (auto it = delegates_.begin(); it != delegates_.end(); ++it) {
+    if (it->first == id) {
+      delegates_.erase(it);
+      return;
+    }
+  }
+}
+
+std::optional<LRESULT> StandInHost::HandleTopLevelWindowProc(HWND hwnd,
+                                                             UINT message,
+                                                             WPARAM wparam,
+                                                             LPARAM lparam) {
+  // Delegates may unregister themselves while they run.
+  std::vector<std::pair<int, WindowProcDelegate>> delegates = delegates_;
+  std::optional<LRESULT> handled;
+  for (auto& [id, delegate] : delegates) {
+    std::optional<LRESULT> result = delegate(hwnd, message, wparam, lparam);
+    if (result && !handled) {
+      handled = result;
+    }
+  }
+  return handled;
+}
+
+void BinaryMessenger::SetMethodCallHandler(const std::string& channel,
+                                           MethodCallHandler handler) {
+  if (handler) {
+    method_handlers_[channel] = std::move(handler);
+  } else {
+    method_handlers_.erase(channel);
+  }
+}
+
+void BinaryMessenger::SetStreamHandler(const std::string& channel,
+                                       StreamHandler<EncodableValue>* handler) {
+  if (handler) {
+    stream_handlers_[channel] = handler;
+  } else {
+    stream_handlers_.erase(channel);
+  }
+}
+
+void BinaryMessenger::Send(const std::string& channel,
+                           const std::string& method,
+                           const EncodableValue& arguments) {
+  sent_.push_back({channel, method, arguments});
+}
+
+bool BinaryMessenger::InvokeMethod(
+    const std::string& channel,
+    const std::string& method,
+    const EncodableValue& arguments,
+    std::unique_ptr<MethodResult<EncodableValue>> result) {
+  auto it = method_handlers_.find(channel);
+  if (it == method_handlers_.end()) {
+    return false;
+  }
+  MethodCall<EncodableValue> call(method,
+                                  std::make_unique<EncodableValue>(arguments));
+  it->second(call, std::move(result));
+  return true;
+}
+
+namespace {
+
+class StandInEventSink : public EventSink<EncodableValue> {
+ public:
+  StandInEventSink(BinaryMessenger* messenger, std::string channel)
+      : messenger_(messenger), channel_(std::move(channel)) {}
+
+ protected:
+  void SuccessInternal(const EncodableValue* event) override {
+    messenger_->Send(channel_, "event", event ? *event : EncodableValue());
+  }
+  void ErrorInternal(const std::string& error_code,
+                     const std::string&,
+                     const EncodableValue*) override {
+    messenger_->Send(channel_, "error", EncodableValue(error_code));
+  }
+  void EndOfStreamInternal() override {
+    messenger_->Send(channel_, "endOfStream", EncodableValue());
+  }
+
+ private:
+  BinaryMessenger* messenger_;
+  std::string channel_;
+};
+
+}  // namespace
+
+bool BinaryMessenger::Listen(const std::string& channel) {
+  auto it = stream_handlers_.find(channel);
+  if (it == stream_handlers_.end()) {
+    return false;
+  }
+  it->second->OnListen(nullptr,
+                       std::make_unique<StandInEventSink>(this, channel));
+  return true;
+}
+
+bool BinaryMessenger::Cancel(const std::string& channel) {
+  auto it = stream_handlers_.find(channel);
+  if (it == stream_handlers_.end()) {
+    return false;
+  }
+  it->second->OnCancel(nullptr);
+  return true;
+}
+
+BinaryMessenger* PluginRegistrar::messenger() {
+  return StandInHost::Instance().messenger();
+}
+
+int PluginRegistrarWindows::RegisterTopLevelWindowProcDelegate(
+    WindowProcDelegate delegate) {
+  return StandInHost::Instance().AddTopLevelWindowProcDelegate(
+      std::move(delegate));
+}
+
+void PluginRegistrarWindows::UnregisterTopLevelWindowProcDelegate(
+    int proc_id) {
+  StandInHost::Instance().RemoveTopLevelWindowProcDelegate(proc_id);
+}
+
+FlutterEngine::FlutterEngine(const DartProject&) {}
+
+FlutterEngine::~FlutterEngine() {
+  PluginRegistrarManager::GetInstance()->Reset();
+}
+
+bool FlutterEngine::Run() {
+  if (StandInHost::Instance().on_run()) {
+    StandInHost::Instance().on_run()();
+  }
+  return true;
+}
+
+FlutterDesktopPluginRegistrarRef FlutterEngine::GetRegistrarForPlugin(
+    const std::string& plugin_name) {
+  return StandInHost::Instance().Registrar(plugin_name);
+}
+
+BinaryMessenger* FlutterEngine::messenger() {
+  return StandInHost::Instance().messenger();
+}
+
+}  // namespace flutter
+
+FlutterDesktopViewRef FlutterDesktopPluginRegistrarGetView(
+    FlutterDesktopPluginRegistrarRef) {
+  return flutter::StandInHost::Instance().View(0);
+}
+
+FlutterDesktopViewRef FlutterDesktopPluginRegistrarGetViewById(
+    FlutterDesktopPluginRegistrarRef,
+    FlutterDesktopViewId view_id) {
+  return flutter::StandInHost::Instance().View(view_id);
+}
+
+HWND FlutterDesktopViewGetHWND(FlutterDesktopViewRef view) {
+  return reinterpret_cast<HWND>(view);
+}
+
+UINT FlutterDesktopGetDpiForHWND(HWND) {
+  return 96;
+}
+
+void FlutterDesktopResyncOutputStreams() {}
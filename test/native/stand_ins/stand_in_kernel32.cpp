@@ -0,0 +1,371 @@
+// The kernel32, advapi32, ole32 and shell32 functions declared by the
+// stand-in windows.h, on top of the C and C++ runtimes. Only as much of each
+// as the runner and the plugins rely on: there is no file system access, no
+// COM object other than one a test provides, and no console.
+
+#include <dlfcn.h>
+#include <io.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <windows.h>
+
+#include <shobjidl_core.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+const CLSID CLSID_TaskbarList = {
+    0x56fdf344, 0xfd6d, 0x11d0, {0x95, 0x8a, 0x00, 0x60, 0x97, 0xc9, 0xa0, 0x90}};
+const IID IID_ITaskbarList3 = {
+    0xea1afb91, 0x9e28, 0x4b86, {0x90, 0xe9, 0x9e, 0x9f, 0x8a, 0x5e, 0xef, 0xaf}};
+
+namespace {
+
+// Module handles. The executable's exports are looked up with dlsym(), which
+// finds the runner's as long as it is linked with -rdynamic.
+HMODULE const kExecutable = reinterpret_cast<HMODULE>(uintptr_t{0x1000});
+HMODULE const kUser32 = reinterpret_cast<HMODULE>(uintptr_t{0x2000});
+HMODULE const kNtdll = reinterpret_cast<HMODULE>(uintptr_t{0x3000});
+
+// Windows 11 23H2.
+constexpr DWORD kMajorVersion = 10;
+constexpr DWORD kMinorVersion = 0;
+constexpr DWORD kBuildNumber = 22631;
+
+std::string Narrow(LPCWSTR text) {
+  std::string narrow;
+  for (; text && *text; ++text) {
+    narrow.push_back(*text < 0x80 ? static_cast<char>(*text) : '?');
+  }
+  return narrow;
+}
+
+bool Equals(LPCWSTR text, const char* expected) {
+  return text && Narrow(text) == expected;
+}
+
+// user32 exports SetWindowCompositionAttribute; the sources only check that
+// it resolves and call it through the backend.
+BOOL StandInSetWindowCompositionAttribute(HWND, void*) {
+  return FALSE;
+}
+
+LONG StandInRtlGetVersion(RTL_OSVERSIONINFOW* info) {
+  info->dwMajorVersion = kMajorVersion;
+  info->dwMinorVersion = kMinorVersion;
+  info->dwBuildNumber = kBuildNumber;
+  info->dwPlatformId = 2;
+  return 0;
+}
+
+struct Event {
+  std::mutex mutex;
+  std::condition_variable changed;
+  bool manual_reset = false;
+  bool signaled = false;
+};
+
+std::mutex g_events_mutex;
+std::map<HANDLE, std::shared_ptr<Event>> g_events;
+
+std::shared_ptr<Event> FindEvent(HANDLE handle) {
+  std::lock_guard<std::mutex> lock(g_events_mutex);
+  auto it = g_events.find(handle);
+  return it == g_events.end() ? nullptr : it->second;
+}
+
+int g_process_heap;
+
+// What CoCreateInstance() hands out.
+std::atomic<ITaskbarList3*> g_taskbar_list{nullptr};
+
+}  // namespace
+
+BOOL AttachConsole(DWORD) {
+  return FALSE;
+}
+
+BOOL AllocConsole() {
+  return FALSE;
+}
+
+BOOL IsDebuggerPresent() {
+  return FALSE;
+}
+
+HMODULE GetModuleHandleW(LPCWSTR name) {
+  if (!name) {
+    return kExecutable;
+  }
+  if (Equals(name, "user32.dll")) {
+    return kUser32;
+  }
+  if (Equals(name, "ntdll.dll")) {
+    return kNtdll;
+  }
+  return nullptr;
+}
+
+HMODULE GetModuleHandleA(LPCSTR name) {
+  if (!name) {
+    return kExecutable;
+  }
+  if (std::strcmp(name, "user32.dll") == 0) {
+    return kUser32;
+  }
+  if (std::strcmp(name, "ntdll.dll") == 0) {
+    return kNtdll;
+  }
+  return nullptr;
+}
+
+HMODULE LoadLibraryW(LPCWSTR name) {
+  // shcore.dll is missing, as on Windows 7: monitors report the system DPI.
+  return GetModuleHandleW(name);
+}
+
+FARPROC GetProcAddress(HMODULE module, LPCSTR name) {
+  if (module == kExecutable) {
+    return reinterpret_cast<FARPROC>(::dlsym(RTLD_DEFAULT, name));
+  }
+  if (module == kUser32 &&
+      std::strcmp(name, "SetWindowCompositionAttribute") == 0) {
+    return reinterpret_cast<FARPROC>(&StandInSetWindowCompositionAttribute);
+  }
+  if (module == kNtdll && std::strcmp(name, "RtlGetVersion") == 0) {
+    return reinterpret_cast<FARPROC>(&StandInRtlGetVersion);
+  }
+  return nullptr;
+}
+
+DWORD GetCurrentProcessId() {
+  return static_cast<DWORD>(::getpid());
+}
+
+DWORD GetCurrentThreadId() {
+  return static_cast<DWORD>(::syscall(SYS_gettid));
+}
+
+HANDLE GetCurrentProcess() {
+  return reinterpret_cast<HANDLE>(intptr_t{-1});
+}
+
+DWORD GetLastError() {
+  return 0;
+}
+
+DWORD GetVersion() {
+  return kMajorVersion | (kMinorVersion << 8) | (kBuildNumber << 16);
+}
+
+DWORD GetEnvironmentVariableW(LPCWSTR name, LPWSTR buffer, DWORD size) {
+  const char* value = std::getenv(Narrow(name).c_str());
+  if (!value) {
+    return 0;
+  }
+  DWORD length = static_cast<DWORD>(std::strlen(value));
+  if (!buffer || size <= length) {
+    return length + 1;
+  }
+  for (DWORD i = 0; i <= length; ++i) {
+    buffer[i] = static_cast<unsigned char>(value[i]);
+  }
+  return length;
+}
+
+LPWSTR GetCommandLineW() {
+  static wchar_t command_line[] = L"multiple_windows.exe";
+  return command_line;
+}
+
+int MulDiv(int number, int numerator, int denominator) {
+  if (denominator == 0) {
+    return -1;
+  }
+  int64_t product = static_cast<int64_t>(number) * numerator;
+  int64_t half = (denominator < 0 ? -denominator : denominator) / 2;
+  int64_t rounded = (product < 0) == (denominator < 0) ? product + half
+                                                       : product - half;
+  return static_cast<int>(rounded / denominator);
+}
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER* count) {
+  count->QuadPart = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count();
+  return TRUE;
+}
+
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency) {
+  frequency->QuadPart = 1000000000;
+  return TRUE;
+}
+
+void GetSystemTimePreciseAsFileTime(LPFILETIME time) {
+  // 100 ns intervals since 1601-01-01.
+  constexpr uint64_t kUnixEpochInFileTime = 116444736000000000ull;
+  uint64_t now =
+      kUnixEpochInFileTime +
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+              .count() /
+          100;
+  time->dwLowDateTime = static_cast<DWORD>(now);
+  time->dwHighDateTime = static_cast<DWORD>(now >> 32);
+}
+
+BOOL GetProcessTimes(HANDLE, LPFILETIME, LPFILETIME, LPFILETIME, LPFILETIME) {
+  return FALSE;
+}
+
+HANDLE GetProcessHeap() {
+  return &g_process_heap;
+}
+
+LPVOID HeapAlloc(HANDLE, DWORD flags, SIZE_T bytes) {
+  return (flags & HEAP_ZERO_MEMORY) ? std::calloc(1, bytes)
+                                    : std::malloc(bytes);
+}
+
+BOOL HeapFree(HANDLE, DWORD, LPVOID memory) {
+  std::free(memory);
+  return TRUE;
+}
+
+HANDLE LocalFree(HANDLE memory) {
+  std::free(memory);
+  return nullptr;
+}
+
+HANDLE CreateEventW(LPSECURITY_ATTRIBUTES,
+                    BOOL manual_reset,
+                    BOOL initial_state,
+                    LPCWSTR) {
+  auto event = std::make_shared<Event>();
+  event->manual_reset = manual_reset;
+  event->signaled = initial_state;
+  HANDLE handle = event.get();
+  std::lock_guard<std::mutex> lock(g_events_mutex);
+  g_events[handle] = std::move(event);
+  return handle;
+}
+
+BOOL SetEvent(HANDLE handle) {
+  std::shared_ptr<Event> event = FindEvent(handle);
+  if (!event) {
+    return FALSE;
+  }
+  {
+    std::lock_guard<std::mutex> lock(event->mutex);
+    event->signaled = true;
+  }
+  event->changed.notify_all();
+  return TRUE;
+}
+
+DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds) {
+  std::shared_ptr<Event> event = FindEvent(handle);
+  if (!event) {
+    return WAIT_FAILED;
+  }
+  std::unique_lock<std::mutex> lock(event->mutex);
+  auto signaled = [&event] { return event->signaled; };
+  if (milliseconds == INFINITE) {
+    event->changed.wait(lock, signaled);
+  } else if (!event->changed.wait_for(
+                 lock, std::chrono::milliseconds(milliseconds), signaled)) {
+    return WAIT_TIMEOUT;
+  }
+  if (!event->manual_reset) {
+    event->signaled = false;
+  }
+  return WAIT_OBJECT_0;
+}
+
+BOOL CloseHandle(HANDLE handle) {
+  std::lock_guard<std::mutex> lock(g_events_mutex);
+  return g_events.erase(handle) > 0;
+}
+
+BOOL CreateDirectoryW(LPCWSTR, LPSECURITY_ATTRIBUTES) {
+  return FALSE;
+}
+
+HANDLE CreateFileW(LPCWSTR, DWORD, DWORD, LPSECURITY_ATTRIBUTES, DWORD, DWORD,
+                   HANDLE) {
+  return INVALID_HANDLE_VALUE;
+}
+
+HANDLE CreateFileMappingW(HANDLE, LPSECURITY_ATTRIBUTES, DWORD, DWORD, DWORD,
+                          LPCWSTR) {
+  return nullptr;
+}
+
+LPVOID MapViewOfFile(HANDLE, DWORD, DWORD, DWORD, SIZE_T) {
+  return nullptr;
+}
+
+BOOL UnmapViewOfFile(LPCVOID) {
+  return FALSE;
+}
+
+BOOL FlushViewOfFile(LPCVOID, SIZE_T) {
+  return FALSE;
+}
+
+LSTATUS RegGetValueW(HKEY, LPCWSTR, LPCWSTR, DWORD, LPDWORD, PVOID, LPDWORD) {
+  return ERROR_FILE_NOT_FOUND;
+}
+
+LPWSTR* CommandLineToArgvW(LPCWSTR command_line, int* count) {
+  // One argument, the program; LocalFree() releases the block.
+  size_t length = 0;
+  while (command_line[length]) {
+    ++length;
+  }
+  void* block = std::malloc(sizeof(LPWSTR) + (length + 1) * sizeof(wchar_t));
+  LPWSTR* argv = static_cast<LPWSTR*>(block);
+  argv[0] = reinterpret_cast<LPWSTR>(argv + 1);
+  std::memcpy(argv[0], command_line, (length + 1) * sizeof(wchar_t));
+  *count = 1;
+  return argv;
+}
+
+HRESULT CoInitializeEx(LPVOID, DWORD) {
+  return S_OK;
+}
+
+void CoUninitialize() {}
+
+void StandInProvideTaskbarList(ITaskbarList3* taskbar) {
+  g_taskbar_list.store(taskbar);
+}
+
+HRESULT CoCreateInstance(REFCLSID, void*, DWORD, REFIID, void** object) {
+  // ITaskbarList3 is the only class anything creates.
+  *object = g_taskbar_list.load();
+  return *object ? S_OK : E_NOTIMPL;
+}
+
+int _dup2(int from, int to) {
+  return ::dup2(from, to);
+}
+
+int _fileno(FILE* stream) {
+  return ::fileno(stream);
+}
+
+errno_t freopen_s(FILE** result,
+                  const char* path,
+                  const char* mode,
+                  FILE* stream) {
+  *result = std::freopen(path, mode, stream);
+  return *result ? 0 : 1;
+}
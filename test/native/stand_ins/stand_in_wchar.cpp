@@ -0,0 +1,60 @@
+// The wide-character functions of the C library for a 16-bit wchar_t
+// (-fshort-wchar). They interpose the C library's, which assume 32 bits and
+// are what std::wstring's char_traits call. Deliberately does not include
+// <cwchar>, whose declarations these would conflict with.
+
+#include <cstddef>
+
+extern "C" {
+
+size_t wcslen(const wchar_t* text) {
+  const wchar_t* end = text;
+  while (*end) {
+    ++end;
+  }
+  return static_cast<size_t>(end - text);
+}
+
+int wmemcmp(const wchar_t* lhs, const wchar_t* rhs, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    if (lhs[i] != rhs[i]) {
+      return lhs[i] < rhs[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+wchar_t* wmemchr(const wchar_t* text, wchar_t value, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    if (text[i] == value) {
+      return const_cast<wchar_t*>(text + i);
+    }
+  }
+  return nullptr;
+}
+
+wchar_t* wmemcpy(wchar_t* destination, const wchar_t* source, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    destination[i] = source[i];
+  }
+  return destination;
+}
+
+wchar_t* wmemmove(wchar_t* destination, const wchar_t* source, size_t count) {
+  if (destination < source) {
+    return wmemcpy(destination, source, count);
+  }
+  for (size_t i = count; i > 0; --i) {
+    destination[i - 1] = source[i - 1];
+  }
+  return destination;
+}
+
+wchar_t* wmemset(wchar_t* destination, wchar_t value, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    destination[i] = value;
+  }
+  return destination;
+}
+
+}  // extern "C"
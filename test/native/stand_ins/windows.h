@@ -0,0 +1,662 @@
+#ifndef MULTIPLE_WINDOWS_TEST_STAND_INS_WINDOWS_H_
+#define MULTIPLE_WINDOWS_TEST_STAND_INS_WINDOWS_H_
+
+// Stand-in for the Windows SDK headers, so the runner and the plugins compile
+// on any host for the native tests. It declares the types, constants and
+// kernel32-level functions they use, with the SDK's values and layouts for a
+// 64-bit target, and no user32, dwmapi or comctl32 functions at all: those
+// are reached only through the win32 wrappers (win32_calls.h), so a call that
+// bypasses them does not compile here. wchar_t is 16 bits (-fshort-wchar).
+//
+// The kernel32-level functions are defined in stand_in_kernel32.cpp.
+
+#include <cstddef>
+#include <cstdint>
+
+static_assert(sizeof(wchar_t) == 2, "compile with -fshort-wchar");
+
+// Calling conventions, SAL annotations and declspecs.
+#define WINAPI
+#define CALLBACK
+#define APIENTRY
+#define PASCAL
+#define __cdecl
+#define __stdcall
+#define __declspec(x)
+#define _In_
+#define _In_opt_
+#define _Out_
+#define _Inout_
+
+typedef int BOOL;
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef int32_t LONG;
+typedef uint32_t ULONG;
+typedef int64_t LONGLONG;
+typedef uint64_t ULONGLONG;
+typedef int INT;
+typedef unsigned int UINT;
+typedef short SHORT;
+typedef char CHAR;
+typedef wchar_t WCHAR;
+typedef wchar_t TCHAR;
+typedef intptr_t INT_PTR;
+typedef uintptr_t UINT_PTR;
+typedef intptr_t LONG_PTR;
+typedef uintptr_t ULONG_PTR;
+typedef uintptr_t DWORD_PTR;
+typedef size_t SIZE_T;
+typedef UINT_PTR WPARAM;
+typedef LONG_PTR LPARAM;
+typedef LONG_PTR LRESULT;
+typedef LONG HRESULT;
+typedef LONG LSTATUS;
+typedef WORD ATOM;
+typedef DWORD COLORREF;
+typedef void* PVOID;
+typedef void* LPVOID;
+typedef const void* LPCVOID;
+typedef BYTE* PBYTE;
+typedef DWORD* LPDWORD;
+typedef LONG* PLONG;
+typedef char* LPSTR;
+typedef const char* LPCSTR;
+typedef wchar_t* LPWSTR;
+typedef wchar_t* PWSTR;
+typedef const wchar_t* LPCWSTR;
+typedef const wchar_t* LPCTSTR;
+typedef void* HANDLE;
+// void (*)() rather than the SDK's INT_PTR (*)(), which GCC warns about
+// casting to the actual signature.
+typedef void (*FARPROC)();
+typedef int64_t __int64;
+
+#define DECLARE_HANDLE(name) \
+  struct name##__ {          \
+    int unused;              \
+  };                         \
+  typedef struct name##__* name
+
+DECLARE_HANDLE(HWND);
+DECLARE_HANDLE(HINSTANCE);
+DECLARE_HANDLE(HICON);
+DECLARE_HANDLE(HMENU);
+DECLARE_HANDLE(HHOOK);
+DECLARE_HANDLE(HMONITOR);
+DECLARE_HANDLE(HDC);
+DECLARE_HANDLE(HKEY);
+DECLARE_HANDLE(HWINEVENTHOOK);
+DECLARE_HANDLE(HBRUSH);
+DECLARE_HANDLE(HCURSOR);
+typedef HINSTANCE HMODULE;
+
+#define TRUE 1
+#define FALSE 0
+#define CONST const
+#define MAX_PATH 260
+#define INFINITE 0xFFFFFFFF
+#define TEXT(text) L##text
+
+#define LOWORD(l) ((WORD)(((DWORD_PTR)(l)) & 0xffff))
+#define HIWORD(l) ((WORD)((((DWORD_PTR)(l)) >> 16) & 0xffff))
+#define MAKELONG(a, b) \
+  ((LONG)(((WORD)(((DWORD_PTR)(a)) & 0xffff)) | \
+          ((DWORD)((WORD)(((DWORD_PTR)(b)) & 0xffff))) << 16))
+#define MAKELPARAM(l, h) ((LPARAM)(DWORD)MAKELONG(l, h))
+#define MAKEINTRESOURCEW(i) ((LPWSTR)((ULONG_PTR)((WORD)(i))))
+
+#define S_OK ((HRESULT)0L)
+#define S_FALSE ((HRESULT)1L)
+#define E_FAIL ((HRESULT)0x80004005L)
+#define E_NOTIMPL ((HRESULT)0x80004001L)
+#define E_NOINTERFACE ((HRESULT)0x80004002L)
+#define E_INVALIDARG ((HRESULT)0x80070057L)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+
+#define ERROR_SUCCESS 0L
+#define ERROR_FILE_NOT_FOUND 2L
+#define ERROR_ALREADY_EXISTS 183L
+
+typedef struct tagRECT {
+  LONG left;
+  LONG top;
+  LONG right;
+  LONG bottom;
+} RECT, *PRECT, *LPRECT;
+typedef const RECT* LPCRECT;
+
+typedef struct tagPOINT {
+  LONG x;
+  LONG y;
+} POINT, *PPOINT, *LPPOINT;
+
+typedef struct tagSIZE {
+  LONG cx;
+  LONG cy;
+} SIZE, *PSIZE;
+
+typedef struct _FILETIME {
+  DWORD dwLowDateTime;
+  DWORD dwHighDateTime;
+} FILETIME, *LPFILETIME;
+
+typedef union _LARGE_INTEGER {
+  struct {
+    DWORD LowPart;
+    LONG HighPart;
+  };
+  LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+typedef union _ULARGE_INTEGER {
+  struct {
+    DWORD LowPart;
+    DWORD HighPart;
+  };
+  ULONGLONG QuadPart;
+} ULARGE_INTEGER;
+
+typedef struct _GUID {
+  uint32_t Data1;
+  uint16_t Data2;
+  uint16_t Data3;
+  uint8_t Data4[8];
+} GUID, IID, CLSID;
+typedef const IID& REFIID;
+typedef const CLSID& REFCLSID;
+
+typedef struct _SECURITY_ATTRIBUTES {
+  DWORD nLength;
+  LPVOID lpSecurityDescriptor;
+  BOOL bInheritHandle;
+} SECURITY_ATTRIBUTES, *LPSECURITY_ATTRIBUTES;
+
+typedef struct _OSVERSIONINFOW {
+  ULONG dwOSVersionInfoSize;
+  ULONG dwMajorVersion;
+  ULONG dwMinorVersion;
+  ULONG dwBuildNumber;
+  ULONG dwPlatformId;
+  WCHAR szCSDVersion[128];
+} RTL_OSVERSIONINFOW, *PRTL_OSVERSIONINFOW, OSVERSIONINFOW;
+
+// ---------------------------------------------------------------------------
+// Window types.
+
+typedef LRESULT(CALLBACK* WNDPROC)(HWND, UINT, WPARAM, LPARAM);
+typedef LRESULT(CALLBACK* HOOKPROC)(int code, WPARAM wParam, LPARAM lParam);
+typedef BOOL(CALLBACK* WNDENUMPROC)(HWND, LPARAM);
+typedef BOOL(CALLBACK* MONITORENUMPROC)(HMONITOR, HDC, LPRECT, LPARAM);
+typedef void(CALLBACK* TIMERPROC)(HWND, UINT, UINT_PTR, DWORD);
+typedef void(CALLBACK* WINEVENTPROC)(HWINEVENTHOOK hWinEventHook,
+                                     DWORD event,
+                                     HWND hwnd,
+                                     LONG idObject,
+                                     LONG idChild,
+                                     DWORD idEventThread,
+                                     DWORD dwmsEventTime);
+
+typedef struct tagMSG {
+  HWND hwnd;
+  UINT message;
+  WPARAM wParam;
+  LPARAM lParam;
+  DWORD time;
+  POINT pt;
+} MSG, *PMSG, *LPMSG;
+
+typedef struct tagWNDCLASSW {
+  UINT style;
+  WNDPROC lpfnWndProc;
+  int cbClsExtra;
+  int cbWndExtra;
+  HINSTANCE hInstance;
+  HICON hIcon;
+  HCURSOR hCursor;
+  HBRUSH hbrBackground;
+  LPCWSTR lpszMenuName;
+  LPCWSTR lpszClassName;
+} WNDCLASSW, WNDCLASS;
+
+typedef struct tagCREATESTRUCTW {
+  LPVOID lpCreateParams;
+  HINSTANCE hInstance;
+  HMENU hMenu;
+  HWND hwndParent;
+  int cy;
+  int cx;
+  int y;
+  int x;
+  LONG style;
+  LPCWSTR lpszName;
+  LPCWSTR lpszClass;
+  DWORD dwExStyle;
+} CREATESTRUCTW, CREATESTRUCT, *LPCREATESTRUCTW;
+
+typedef struct tagCBT_CREATEWNDW {
+  CREATESTRUCTW* lpcs;
+  HWND hwndInsertAfter;
+} CBT_CREATEWNDW, CBT_CREATEWND;
+
+typedef struct tagWINDOWPOS {
+  HWND hwnd;
+  HWND hwndInsertAfter;
+  int x;
+  int y;
+  int cx;
+  int cy;
+  UINT flags;
+} WINDOWPOS, *PWINDOWPOS, *LPWINDOWPOS;
+
+typedef struct tagNCCALCSIZE_PARAMS {
+  RECT rgrc[3];
+  PWINDOWPOS lppos;
+} NCCALCSIZE_PARAMS;
+
+typedef struct tagWINDOWPLACEMENT {
+  UINT length;
+  UINT flags;
+  UINT showCmd;
+  POINT ptMinPosition;
+  POINT ptMaxPosition;
+  RECT rcNormalPosition;
+} WINDOWPLACEMENT;
+
+typedef struct tagMINMAXINFO {
+  POINT ptReserved;
+  POINT ptMaxSize;
+  POINT ptMaxPosition;
+  POINT ptMinTrackSize;
+  POINT ptMaxTrackSize;
+} MINMAXINFO;
+
+typedef struct tagMONITORINFO {
+  DWORD cbSize;
+  RECT rcMonitor;
+  RECT rcWork;
+  DWORD dwFlags;
+} MONITORINFO, *LPMONITORINFO;
+
+typedef struct tagSTYLESTRUCT {
+  DWORD styleOld;
+  DWORD styleNew;
+} STYLESTRUCT;
+
+#define CCHILDREN_TITLEBAR 5
+typedef struct tagTITLEBARINFOEX {
+  DWORD cbSize;
+  RECT rcTitleBar;
+  DWORD rgstate[CCHILDREN_TITLEBAR + 1];
+  RECT rgrect[CCHILDREN_TITLEBAR + 1];
+} TITLEBARINFOEX;
+
+// Window messages.
+#define WM_NULL 0x0000
+#define WM_CREATE 0x0001
+#define WM_DESTROY 0x0002
+#define WM_MOVE 0x0003
+#define WM_SIZE 0x0005
+#define WM_ACTIVATE 0x0006
+#define WM_SETFOCUS 0x0007
+#define WM_KILLFOCUS 0x0008
+#define WM_SETTEXT 0x000C
+#define WM_GETTEXT 0x000D
+#define WM_GETTEXTLENGTH 0x000E
+#define WM_PAINT 0x000F
+#define WM_CLOSE 0x0010
+#define WM_QUIT 0x0012
+#define WM_SHOWWINDOW 0x0018
+#define WM_SETTINGCHANGE 0x001A
+#define WM_ACTIVATEAPP 0x001C
+#define WM_GETMINMAXINFO 0x0024
+#define WM_WINDOWPOSCHANGING 0x0046
+#define WM_WINDOWPOSCHANGED 0x0047
+#define WM_STYLECHANGING 0x007C
+#define WM_STYLECHANGED 0x007D
+#define WM_DISPLAYCHANGE 0x007E
+#define WM_SETICON 0x0080
+#define WM_NCCREATE 0x0081
+#define WM_NCDESTROY 0x0082
+#define WM_NCCALCSIZE 0x0083
+#define WM_NCHITTEST 0x0084
+#define WM_NCPAINT 0x0085
+#define WM_NCACTIVATE 0x0086
+#define WM_NCLBUTTONDOWN 0x00A1
+#define WM_NCLBUTTONUP 0x00A2
+#define WM_NCLBUTTONDBLCLK 0x00A3
+#define WM_SYSCOMMAND 0x0112
+#define WM_TIMER 0x0113
+#define WM_SIZING 0x0214
+#define WM_MOVING 0x0216
+#define WM_ENTERSIZEMOVE 0x0231
+#define WM_EXITSIZEMOVE 0x0232
+#define WM_DPICHANGED 0x02E0
+#define WM_GETTITLEBARINFOEX 0x033F
+#define WM_USER 0x0400
+#define WM_APP 0x8000
+
+#define WA_INACTIVE 0
+#define WA_ACTIVE 1
+#define WA_CLICKACTIVE 2
+
+#define SIZE_RESTORED 0
+#define SIZE_MINIMIZED 1
+#define SIZE_MAXIMIZED 2
+
+#define WMSZ_LEFT 1
+#define WMSZ_RIGHT 2
+#define WMSZ_TOP 3
+#define WMSZ_TOPLEFT 4
+#define WMSZ_TOPRIGHT 5
+#define WMSZ_BOTTOM 6
+#define WMSZ_BOTTOMLEFT 7
+#define WMSZ_BOTTOMRIGHT 8
+
+#define WVR_HREDRAW 0x0100
+#define WVR_VREDRAW 0x0200
+
+// Hit-test codes.
+#define HTTRANSPARENT (-1)
+#define HTNOWHERE 0
+#define HTCLIENT 1
+#define HTCAPTION 2
+#define HTSYSMENU 3
+#define HTMINBUTTON 8
+#define HTMAXBUTTON 9
+#define HTLEFT 10
+#define HTRIGHT 11
+#define HTTOP 12
+#define HTTOPLEFT 13
+#define HTTOPRIGHT 14
+#define HTBOTTOM 15
+#define HTBOTTOMLEFT 16
+#define HTBOTTOMRIGHT 17
+#define HTCLOSE 20
+
+// System commands.
+#define SC_SIZE 0xF000
+#define SC_MOVE 0xF010
+#define SC_MINIMIZE 0xF020
+#define SC_MAXIMIZE 0xF030
+#define SC_CLOSE 0xF060
+#define SC_RESTORE 0xF120
+
+// Window styles.
+#define WS_OVERLAPPED 0x00000000L
+#define WS_POPUP 0x80000000L
+#define WS_CHILD 0x40000000L
+#define WS_MINIMIZE 0x20000000L
+#define WS_VISIBLE 0x10000000L
+#define WS_DISABLED 0x08000000L
+#define WS_CLIPSIBLINGS 0x04000000L
+#define WS_CLIPCHILDREN 0x02000000L
+#define WS_MAXIMIZE 0x01000000L
+#define WS_CAPTION 0x00C00000L
+#define WS_BORDER 0x00800000L
+#define WS_DLGFRAME 0x00400000L
+#define WS_SYSMENU 0x00080000L
+#define WS_THICKFRAME 0x00040000L
+#define WS_MINIMIZEBOX 0x00020000L
+#define WS_MAXIMIZEBOX 0x00010000L
+#define WS_OVERLAPPEDWINDOW                                     \
+  (WS_OVERLAPPED | WS_CAPTION | WS_SYSMENU | WS_THICKFRAME | \
+   WS_MINIMIZEBOX | WS_MAXIMIZEBOX)
+
+#define WS_EX_DLGMODALFRAME 0x00000001L
+#define WS_EX_TOPMOST 0x00000008L
+#define WS_EX_TRANSPARENT 0x00000020L
+#define WS_EX_TOOLWINDOW 0x00000080L
+#define WS_EX_WINDOWEDGE 0x00000100L
+#define WS_EX_CLIENTEDGE 0x00000200L
+#define WS_EX_STATICEDGE 0x00020000L
+#define WS_EX_APPWINDOW 0x00040000L
+#define WS_EX_LAYERED 0x00080000
+
+#define CS_VREDRAW 0x0001
+#define CS_HREDRAW 0x0002
+#define CS_NOCLOSE 0x0200
+
+#define GWL_STYLE (-16)
+#define GWL_EXSTYLE (-20)
+#define GWLP_WNDPROC (-4)
+#define GWLP_HINSTANCE (-6)
+#define GWLP_USERDATA (-21)
+#define GCL_STYLE (-26)
+
+#define GW_HWNDFIRST 0
+#define GW_HWNDLAST 1
+#define GW_HWNDNEXT 2
+#define GW_HWNDPREV 3
+#define GW_OWNER 4
+#define GW_CHILD 5
+
+#define GA_PARENT 1
+#define GA_ROOT 2
+#define GA_ROOTOWNER 3
+
+#define SW_HIDE 0
+#define SW_SHOWNORMAL 1
+#define SW_NORMAL 1
+#define SW_SHOWMINIMIZED 2
+#define SW_SHOWMAXIMIZED 3
+#define SW_MAXIMIZE 3
+#define SW_SHOWNOACTIVATE 4
+#define SW_SHOW 5
+#define SW_MINIMIZE 6
+#define SW_SHOWMINNOACTIVE 7
+#define SW_SHOWNA 8
+#define SW_RESTORE 9
+#define SW_SHOWDEFAULT 10
+
+#define SWP_NOSIZE 0x0001
+#define SWP_NOMOVE 0x0002
+#define SWP_NOZORDER 0x0004
+#define SWP_NOREDRAW 0x0008
+#define SWP_NOACTIVATE 0x0010
+#define SWP_FRAMECHANGED 0x0020
+#define SWP_SHOWWINDOW 0x0040
+#define SWP_HIDEWINDOW 0x0080
+#define SWP_NOCOPYBITS 0x0100
+#define SWP_NOOWNERZORDER 0x0200
+#define SWP_NOSENDCHANGING 0x0400
+
+#define HWND_TOP ((HWND)0)
+#define HWND_BOTTOM ((HWND)1)
+#define HWND_TOPMOST ((HWND)-1)
+#define HWND_NOTOPMOST ((HWND)-2)
+#define HWND_MESSAGE ((HWND)-3)
+
+#define SM_CXSCREEN 0
+#define SM_CYSCREEN 1
+
+#define MONITOR_DEFAULTTONULL 0x00000000
+#define MONITOR_DEFAULTTOPRIMARY 0x00000001
+#define MONITOR_DEFAULTTONEAREST 0x00000002
+#define MONITORINFOF_PRIMARY 0x00000001
+
+#define USER_DEFAULT_SCREEN_DPI 96
+
+#define ICON_SMALL 0
+#define ICON_BIG 1
+#define IMAGE_ICON 1
+#define LR_DEFAULTCOLOR 0x00000000
+#define LR_LOADFROMFILE 0x00000010
+
+#define TPM_LEFTBUTTON 0x0000L
+#define TPM_RIGHTBUTTON 0x0002L
+#define TPM_RETURNCMD 0x0100L
+
+#define WH_CBT 5
+#define HCBT_CREATEWND 3
+
+#define EVENT_OBJECT_SHOW 0x8002
+#define WINEVENT_OUTOFCONTEXT 0x0000
+#define OBJID_WINDOW ((LONG)0x00000000)
+#define CHILDID_SELF 0
+
+#define PM_NOREMOVE 0x0000
+#define PM_REMOVE 0x0001
+#define QS_SENDMESSAGE 0x0040
+#define QS_ALLINPUT 0x04FF
+#define PM_QS_SENDMESSAGE (QS_SENDMESSAGE << 16)
+
+#define WAIT_OBJECT_0 0x00000000L
+#define WAIT_TIMEOUT 258L
+#define WAIT_FAILED ((DWORD)0xFFFFFFFF)
+
+// ---------------------------------------------------------------------------
+// Generic-text names. Only the wide functions exist.
+
+#define GetWindowLongPtr GetWindowLongPtrW
+#define SetWindowLongPtr SetWindowLongPtrW
+#define GetWindowLong GetWindowLongW
+#define SetWindowLong SetWindowLongW
+#define GetClassLong GetClassLongW
+#define SetClassLong SetClassLongW
+#define PostMessage PostMessageW
+#define SendMessage SendMessageW
+#define GetWindowText GetWindowTextW
+#define SetWindowText SetWindowTextW
+#define GetWindowTextLength GetWindowTextLengthW
+#define GetClassName GetClassNameW
+#define FindWindowEx FindWindowExW
+#define GetMonitorInfo GetMonitorInfoW
+#define SetWindowsHookEx SetWindowsHookExW
+#define RegisterClass RegisterClassW
+#define CreateWindowEx CreateWindowExW
+#define LoadImage LoadImageW
+#define DefWindowProc DefWindowProcW
+#define CallWindowProc CallWindowProcW
+#define GetMessage GetMessageW
+#define PeekMessage PeekMessageW
+#define DispatchMessage DispatchMessageW
+#define GetNextWindow(hwnd, command) GetWindow(hwnd, command)
+#define GetModuleHandle GetModuleHandleW
+#define LoadLibrary LoadLibraryW
+#define RegGetValue RegGetValueW
+#define GetEnvironmentVariable GetEnvironmentVariableW
+#define OutputDebugString OutputDebugStringW
+
+// ---------------------------------------------------------------------------
+// kernel32, advapi32, ole32 and shell32 stand-ins.
+
+#define ATTACH_PARENT_PROCESS ((DWORD)-1)
+
+#define HEAP_ZERO_MEMORY 0x00000008
+
+#define GENERIC_READ 0x80000000L
+#define GENERIC_WRITE 0x40000000L
+#define FILE_SHARE_READ 0x00000001
+#define FILE_SHARE_WRITE 0x00000002
+#define OPEN_ALWAYS 4
+#define FILE_ATTRIBUTE_NORMAL 0x00000080
+#define INVALID_HANDLE_VALUE ((HANDLE)(LONG_PTR)-1)
+#define PAGE_READWRITE 0x04
+#define FILE_MAP_ALL_ACCESS 0x000F001F
+
+#define HKEY_CURRENT_USER ((HKEY)(ULONG_PTR)((LONG)0x80000001))
+#define RRF_RT_REG_DWORD 0x00000010
+
+#define CP_UTF8 65001
+#define MB_ERR_INVALID_CHARS 0x00000008
+#define WC_ERR_INVALID_CHARS 0x00000080
+
+#define COINIT_APARTMENTTHREADED 0x2
+#define CLSCTX_INPROC_SERVER 0x1
+
+BOOL AttachConsole(DWORD process_id);
+BOOL AllocConsole();
+BOOL IsDebuggerPresent();
+HMODULE GetModuleHandleW(LPCWSTR name);
+HMODULE GetModuleHandleA(LPCSTR name);
+HMODULE LoadLibraryW(LPCWSTR name);
+FARPROC GetProcAddress(HMODULE module, LPCSTR name);
+DWORD GetCurrentProcessId();
+DWORD GetCurrentThreadId();
+HANDLE GetCurrentProcess();
+DWORD GetLastError();
+DWORD GetVersion();
+DWORD GetEnvironmentVariableW(LPCWSTR name, LPWSTR buffer, DWORD size);
+LPWSTR GetCommandLineW();
+int MulDiv(int number, int numerator, int denominator);
+BOOL QueryPerformanceCounter(LARGE_INTEGER* count);
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency);
+void GetSystemTimePreciseAsFileTime(LPFILETIME time);
+BOOL GetProcessTimes(HANDLE process,
+                     LPFILETIME creation,
+                     LPFILETIME exit,
+                     LPFILETIME kernel,
+                     LPFILETIME user);
+HANDLE GetProcessHeap();
+LPVOID HeapAlloc(HANDLE heap, DWORD flags, SIZE_T bytes);
+BOOL HeapFree(HANDLE heap, DWORD flags, LPVOID memory);
+HANDLE LocalFree(HANDLE memory);
+HANDLE CreateEventW(LPSECURITY_ATTRIBUTES attributes,
+                    BOOL manual_reset,
+                    BOOL initial_state,
+                    LPCWSTR name);
+BOOL SetEvent(HANDLE event);
+DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds);
+BOOL CloseHandle(HANDLE handle);
+BOOL CreateDirectoryW(LPCWSTR path, LPSECURITY_ATTRIBUTES attributes);
+HANDLE CreateFileW(LPCWSTR path,
+                   DWORD access,
+                   DWORD share,
+                   LPSECURITY_ATTRIBUTES attributes,
+                   DWORD disposition,
+                   DWORD flags,
+                   HANDLE template_file);
+HANDLE CreateFileMappingW(HANDLE file,
+                          LPSECURITY_ATTRIBUTES attributes,
+                          DWORD protect,
+                          DWORD size_high,
+                          DWORD size_low,
+                          LPCWSTR name);
+LPVOID MapViewOfFile(HANDLE mapping,
+                     DWORD access,
+                     DWORD offset_high,
+                     DWORD offset_low,
+                     SIZE_T bytes);
+BOOL UnmapViewOfFile(LPCVOID address);
+BOOL FlushViewOfFile(LPCVOID address, SIZE_T bytes);
+LSTATUS RegGetValueW(HKEY key,
+                     LPCWSTR sub_key,
+                     LPCWSTR value,
+                     DWORD flags,
+                     LPDWORD type,
+                     PVOID data,
+                     LPDWORD size);
+LPWSTR* CommandLineToArgvW(LPCWSTR command_line, int* count);
+HRESULT CoInitializeEx(LPVOID reserved, DWORD flags);
+void CoUninitialize();
+HRESULT CoCreateInstance(REFCLSID clsid,
+                         void* outer,
+                         DWORD context,
+                         REFIID iid,
+                         void** object);
+
+inline void YieldProcessor() {}
+
+// shellapi.h
+#define ABM_NEW 0x00000000
+#define ABM_REMOVE 0x00000001
+#define ABM_QUERYPOS 0x00000002
+#define ABM_SETPOS 0x00000003
+#define ABE_LEFT 0
+#define ABE_TOP 1
+#define ABE_RIGHT 2
+#define ABE_BOTTOM 3
+
+typedef struct _AppBarData {
+  DWORD cbSize;
+  HWND hWnd;
+  UINT uCallbackMessage;
+  UINT uEdge;
+  RECT rc;
+  LPARAM lParam;
+} APPBARDATA, *PAPPBARDATA;
+
+#endif  // MULTIPLE_WINDOWS_TEST_STAND_INS_WINDOWS_H_
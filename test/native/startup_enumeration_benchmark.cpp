@@ -0,0 +1,116 @@
+// Runs the runner's startup window enumeration on a stand-in desktop of 5000
+// top-level windows (on fake_win32_backend.h), the way wWinMain ran it before
+// the message loop, against deferring it as it does now: by default the
+// platform thread enumerates nothing, and with
+// MULTIPLE_WINDOWS_STARTUP_DIAGNOSTICS set it only starts the thread that
+// enumerates and prints. Reports how long each keeps the platform thread from
+// its first message, and for the deferred pass how long the background thread
+// takes to finish it. Checks first that both count every window.
+
+// This must be included before many other Windows headers.
+#include <windows.h>
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fake_win32_backend.h"
+#include "native_test.h"
+
+namespace {
+
+constexpr int kWindows = 5000;
+
+const wchar_t* const kClasses[] = {
+    L"Chrome_WidgetWin_1", L"ConsoleWindowClass", L"IME",
+    L"tooltips_class32",   L"CoreWindow",         L"WorkerW",
+};
+
+LRESULT CALLBACK DesktopWindowProc(HWND hwnd,
+                                   UINT message,
+                                   WPARAM wparam,
+                                   LPARAM lparam) {
+  return win32::DefWindowProcW(hwnd, message, wparam, lparam);
+}
+
+void BuildDesktop(FakeWin32Backend* backend) {
+  for (int i = 0; i < kWindows; ++i) {
+    backend->CreateTestWindow(kClasses[i % 6], DesktopWindowProc, L"",
+                              WS_OVERLAPPEDWINDOW | (i % 3 ? WS_VISIBLE : 0),
+                              0, {i % 1000, i % 700, i % 1000 + 640,
+                                  i % 700 + 480});
+  }
+}
+
+// GetAllWindowHandles() of main.cpp.
+std::vector<HWND> AllWindowHandles() {
+  std::vector<HWND> handles;
+  win32::EnumWindows(
+      [](HWND hwnd, LPARAM lparam) -> BOOL {
+        reinterpret_cast<std::vector<HWND>*>(lparam)->push_back(hwnd);
+        return TRUE;
+      },
+      reinterpret_cast<LPARAM>(&handles));
+  return handles;
+}
+
+// The diagnostics pass; a string stream stands in for std::cout.
+size_t EnumerateAndPrint(std::ostringstream* out) {
+  std::vector<HWND> handles = AllWindowHandles();
+  *out << "Total windows in system: " << handles.size() << std::endl;
+  return handles.size();
+}
+
+double Milliseconds(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int iterations = BenchmarkIterations(argc, argv, 20);
+  FakeWin32Backend backend;
+  Win32Backend::Install(&backend);
+  BuildDesktop(&backend);
+
+  std::ostringstream out;
+  EXPECT_EQ(static_cast<size_t>(kWindows), EnumerateAndPrint(&out));
+
+  // Before the message loop, as wWinMain did.
+  double inline_pass = MeasureNanoseconds(iterations, [&]() {
+    std::ostringstream inline_out;
+    DoNotOptimize(EnumerateAndPrint(&inline_out));
+  });
+
+  // Opt-in: the platform thread starts the pass and moves on; the thread is
+  // joined outside the timing, before the next run, so runs do not overlap.
+  double deferred_start = 0;
+  double deferred_finish = 0;
+  for (int i = 0; i < iterations; ++i) {
+    std::ostringstream deferred_out;
+    size_t counted = 0;
+    std::chrono::steady_clock::time_point finished;
+    auto start = std::chrono::steady_clock::now();
+    std::thread thread([&]() {
+      counted = EnumerateAndPrint(&deferred_out);
+      finished = std::chrono::steady_clock::now();
+    });
+    deferred_start += Milliseconds(std::chrono::steady_clock::now() - start);
+    thread.join();
+    deferred_finish += Milliseconds(finished - start);
+    EXPECT_EQ(static_cast<size_t>(kWindows), counted);
+  }
+
+  std::printf(
+      "%d windows, platform thread before the first message: inline "
+      "enumeration %.3f ms, deferred %.3f ms (opt-in; the background pass "
+      "finishes after %.3f ms), default 0 ms (%d runs)\n",
+      kWindows, inline_pass / 1e6, deferred_start / iterations,
+      deferred_finish / iterations, iterations);
+
+  Win32Backend::Install(nullptr);
+  return NativeTestResult();
+}
@@ -0,0 +1,185 @@
+// Races SetProgress() bursts from two producer threads, as from two engines,
+// against the TaskbarWorker applying them, and fails when the last update of
+// a burst is never applied: the coalescing flag has to hand every update
+// either to a queued command or to the worker's next read.
+//
+// Then starts and stops the worker over and over while the producers keep
+// pushing, and checks that progress still gets through once it runs again.
+//
+// Pass the number of bursts to run longer, e.g.
+//   _gate_build/test/native/taskbar_worker_test 100000
+
+// This must be included before many other Windows headers.
+#include <windows.h>
+
+#include <shobjidl_core.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "fake_win32_backend.h"
+#include "native_test.h"
+#include "taskbar_worker.h"
+
+namespace {
+
+constexpr int kWindows = 4;
+constexpr int kProducers = 2;
+
+HWND WindowAt(int index) {
+  return reinterpret_cast<HWND>(static_cast<uintptr_t>(0x1000 + index));
+}
+
+int IndexOf(HWND hwnd) {
+  return static_cast<int>(reinterpret_cast<uintptr_t>(hwnd) - 0x1000);
+}
+
+// Records the last progress the worker applied to each window.
+class RecordingTaskbar final : public ITaskbarList3 {
+ public:
+  RecordingTaskbar() {
+    for (std::atomic<int32_t>& progress : progress_) {
+      progress.store(INT32_MIN);
+    }
+  }
+
+  HRESULT HrInit() override { return S_OK; }
+  HRESULT AddTab(HWND) override { return S_OK; }
+  HRESULT DeleteTab(HWND) override { return S_OK; }
+
+  HRESULT SetProgressValue(HWND hwnd, ULONGLONG completed, ULONGLONG) override {
+    progress_[IndexOf(hwnd)].store(static_cast<int32_t>(completed));
+    calls_.fetch_add(1);
+    return S_OK;
+  }
+
+  HRESULT SetProgressState(HWND hwnd, TBPFLAG) override {
+    progress_[IndexOf(hwnd)].store(TaskbarWorker::kNoProgress);
+    calls_.fetch_add(1);
+    return S_OK;
+  }
+
+  ULONG Release() override { return 0; }
+
+  int32_t Progress(HWND hwnd) const {
+    return progress_[IndexOf(hwnd)].load();
+  }
+
+  int64_t calls() const { return calls_.load(); }
+
+ private:
+  std::atomic<int32_t> progress_[kWindows];
+  std::atomic<int64_t> calls_{0};
+};
+
+// Waits up to five seconds for the worker to apply |percent| to |hwnd|.
+bool WaitForProgress(const RecordingTaskbar& taskbar,
+                     HWND hwnd,
+                     int32_t percent) {
+  auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (taskbar.Progress(hwnd) != percent) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+// Each producer ramps its windows from 0 to the burst's final value, which
+// alternates so that a burst applied not at all is caught as well, and waits
+// for the final value to be applied.
+void CheckLastUpdateApplied(RecordingTaskbar* taskbar, int bursts) {
+  TaskbarWorker& worker = TaskbarWorker::Instance();
+  worker.Retain();
+  std::atomic<int> lost{0};
+  int64_t updates = 0;
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&, p]() {
+      for (int burst = 0; burst < bursts; ++burst) {
+        int32_t last = burst % 2 == 0 ? 100 : 50;
+        for (int32_t percent = 0; percent <= last; ++percent) {
+          for (int w = p; w < kWindows; w += kProducers) {
+            worker.SetProgress(WindowAt(w), percent);
+          }
+        }
+        for (int w = p; w < kWindows; w += kProducers) {
+          if (!WaitForProgress(*taskbar, WindowAt(w), last)) {
+            lost.fetch_add(1);
+            return;
+          }
+        }
+      }
+    });
+  }
+  for (std::thread& producer : producers) {
+    producer.join();
+  }
+  for (int burst = 0; burst < bursts; ++burst) {
+    updates += (burst % 2 == 0 ? 101 : 51) * kWindows;
+  }
+  worker.Release();
+  EXPECT_EQ(0, lost.load());
+  // Coalescing: never more COM calls than updates.
+  EXPECT_TRUE(taskbar->calls() <= updates);
+}
+
+// Producers keep pushing while the worker is started and stopped; pushes
+// that find it stopped are dropped, and must not keep later updates out.
+void CheckLifecycleChurn(RecordingTaskbar* taskbar, int cycles) {
+  TaskbarWorker& worker = TaskbarWorker::Instance();
+  std::atomic<bool> done{false};
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&, p]() {
+      int32_t percent = 0;
+      while (!done.load()) {
+        for (int w = p; w < kWindows; w += kProducers) {
+          worker.SetProgress(WindowAt(w), percent);
+          worker.SetSkipTaskbar(WindowAt(w), percent % 2 == 0);
+        }
+        percent = (percent + 1) % 100;
+      }
+    });
+  }
+  for (int i = 0; i < cycles; ++i) {
+    worker.Retain();
+    std::this_thread::yield();
+    worker.Release();
+  }
+  done.store(true);
+  for (std::thread& producer : producers) {
+    producer.join();
+  }
+
+  worker.Retain();
+  for (int w = 0; w < kWindows; ++w) {
+    worker.SetProgress(WindowAt(w), 100 + w);
+  }
+  for (int w = 0; w < kWindows; ++w) {
+    EXPECT_TRUE(WaitForProgress(*taskbar, WindowAt(w), 100 + w));
+  }
+  worker.Release();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int bursts = BenchmarkIterations(argc, argv, 2000);
+  FakeWin32Backend backend;
+  Win32Backend::Install(&backend);
+  RecordingTaskbar taskbar;
+  StandInProvideTaskbarList(&taskbar);
+
+  CheckLastUpdateApplied(&taskbar, bursts);
+  CheckLifecycleChurn(&taskbar, bursts / 10);
+
+  StandInProvideTaskbarList(nullptr);
+  Win32Backend::Install(nullptr);
+  return NativeTestResult();
+}
@@ -0,0 +1,251 @@
+// Converts 1000 window-title-like strings, a quarter of them non-ASCII, both
+// ways with utf_transcode.h into reused buffers, and times that against what
+// the callers did before: std::wstring_convert per call, or on Windows the
+// two-pass WideCharToMultiByte / MultiByteToWideChar of utils.cpp.
+// Checks first that both agree on random valid strings, including across the
+// SIMD block boundaries, and that invalid input is rejected and clears the
+// output.
+
+#ifdef _WIN32
+// This must be included before many other Windows headers.
+#include <windows.h>
+#else
+#include <codecvt>
+#include <locale>
+#endif
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "native_test.h"
+#include "utf_transcode.h"
+
+namespace {
+
+#ifdef _WIN32
+using Char16 = wchar_t;
+
+std::string ReferenceToUtf8(const std::wstring& text) {
+  int size = ::WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS, text.data(),
+                                   static_cast<int>(text.size()), nullptr, 0,
+                                   nullptr, nullptr);
+  std::string utf8(static_cast<size_t>(size), '\0');
+  ::WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS, text.data(),
+                        static_cast<int>(text.size()), &utf8[0], size,
+                        nullptr, nullptr);
+  return utf8;
+}
+
+std::wstring ReferenceToUtf16(const std::string& text) {
+  int size = ::MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, text.data(),
+                                   static_cast<int>(text.size()), nullptr, 0);
+  std::wstring utf16(static_cast<size_t>(size), L'\0');
+  ::MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, text.data(),
+                        static_cast<int>(text.size()), &utf16[0], size);
+  return utf16;
+}
+#else
+using Char16 = char16_t;
+
+// std::wstring_convert is deprecated, which is why the callers stopped using
+// it.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+std::string ReferenceToUtf8(const std::u16string& text) {
+  std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> converter;
+  return converter.to_bytes(text);
+}
+
+std::u16string ReferenceToUtf16(const std::string& text) {
+  std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> converter;
+  return converter.from_bytes(text);
+}
+#pragma GCC diagnostic pop
+#endif
+
+using String16 = std::basic_string<Char16>;
+
+class Random {
+ public:
+  explicit Random(uint32_t seed) : state_(seed) {}
+
+  uint32_t Next() {
+    state_ = state_ * 1664525u + 1013904223u;
+    return state_ >> 8;
+  }
+
+  // In [0, bound).
+  uint32_t Below(uint32_t bound) { return Next() % bound; }
+
+ private:
+  uint32_t state_;
+};
+
+void AppendCodePoint(uint32_t code_point, String16* text) {
+  if (code_point >= 0x10000) {
+    code_point -= 0x10000;
+    text->push_back(static_cast<Char16>(0xD800 + (code_point >> 10)));
+    text->push_back(static_cast<Char16>(0xDC00 + (code_point & 0x3FF)));
+  } else {
+    text->push_back(static_cast<Char16>(code_point));
+  }
+}
+
+// Runs of ASCII long enough for the SIMD path, broken up by code points of
+// every UTF-8 length.
+String16 RandomText(Random& random) {
+  String16 text;
+  size_t length = random.Below(80);
+  while (text.size() < length) {
+    switch (random.Below(5)) {
+      case 0:
+      case 1:
+        for (uint32_t n = random.Below(40); n > 0; --n) {
+          text.push_back(static_cast<Char16>(0x20 + random.Below(0x5F)));
+        }
+        break;
+      case 2:
+        AppendCodePoint(0x80 + random.Below(0x800 - 0x80), &text);
+        break;
+      case 3: {
+        uint32_t code_point = 0x800 + random.Below(0x10000 - 0x800);
+        if (code_point >= 0xD800 && code_point <= 0xDFFF) {
+          code_point -= 0x1000;
+        }
+        AppendCodePoint(code_point, &text);
+        break;
+      }
+      default:
+        AppendCodePoint(0x10000 + random.Below(0x110000 - 0x10000), &text);
+        break;
+    }
+  }
+  return text;
+}
+
+void CheckRandomValid() {
+  Random random(42);
+  std::string utf8;
+  String16 utf16;
+  int mismatches = 0;
+  for (int i = 0; i < 20000; ++i) {
+    String16 text = RandomText(random);
+    std::string expected = ReferenceToUtf8(text);
+    if (!Utf16ToUtf8(text.data(), text.size(), &utf8) || utf8 != expected ||
+        !Utf8ToUtf16(expected.data(), expected.size(), &utf16) ||
+        utf16 != text) {
+      ++mismatches;
+    }
+  }
+  EXPECT_EQ(0, mismatches);
+}
+
+// Invalid sequences, alone and after 15, 16 and 17 ASCII code units so they
+// fall at, on and past a SIMD block boundary.
+void CheckInvalid() {
+  const std::vector<String16> invalid16 = {
+      {Char16(0xD800)},
+      {Char16(0xDC00)},
+      {Char16(0xDBFF), Char16('a')},
+      {Char16(0xDC00), Char16(0xD800)},
+  };
+  const std::vector<std::string> invalid8 = {
+      // Stray continuation byte; overlong forms.
+      "\x80", "\xC0\xAF", "\xC1\xBF", "\xE0\x80\xAF", "\xF0\x80\x80\xAF",
+      // Encoded surrogate; beyond U+10FFFF.
+      "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xF5\x80\x80\x80",
+      // Truncated sequences.
+      "\xE2\x82", "\xC3", "\xE2\x28\xA1",
+  };
+  std::string utf8 = "stale";
+  String16 utf16(1, Char16('x'));
+  for (size_t prefix : {0, 15, 16, 17}) {
+    for (const String16& sequence : invalid16) {
+      String16 text(prefix, Char16('a'));
+      text += sequence;
+      text += String16(20, Char16('b'));
+      EXPECT_TRUE(!Utf16ToUtf8(text.data(), text.size(), &utf8));
+      EXPECT_TRUE(utf8.empty());
+      utf8 = "stale";
+    }
+    for (const std::string& sequence : invalid8) {
+      std::string text(prefix, 'a');
+      text += sequence;
+      text += std::string(20, 'b');
+      EXPECT_TRUE(!Utf8ToUtf16(text.data(), text.size(), &utf16));
+      EXPECT_TRUE(utf16.empty());
+      utf16.assign(1, Char16('x'));
+    }
+  }
+}
+
+// Window titles and class names, one in four with non-ASCII text.
+std::vector<String16> Titles() {
+  const char* const kAscii[] = {
+      "Untitled - Notepad",
+      "main.dart - flutter_multiple_windows - Visual Studio Code",
+      "FLUTTER_RUNNER_WIN32_WINDOW",
+  };
+  const char* const kOther[] = {
+      "Caf\xC3\xA9 \xE2\x80\x94 Men\xC3\xBC",
+      "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\xE3\x81\xAE\xE3\x83\x89"
+      "\xE3\x82\xAD\xE3\x83\xA5\xE3\x83\xA1\xE3\x83\xB3\xE3\x83\x88",
+      "\xF0\x9F\x8E\x89 Release notes - Mail",
+  };
+  std::vector<String16> titles;
+  for (int i = 0; i < 1000; ++i) {
+    const char* title = i % 4 == 3 ? kOther[i % 3] : kAscii[i % 3];
+    titles.push_back(ReferenceToUtf16(title));
+  }
+  return titles;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int iterations = BenchmarkIterations(argc, argv, 200);
+  CheckRandomValid();
+  CheckInvalid();
+
+  std::vector<String16> titles = Titles();
+  std::vector<std::string> titles8;
+  for (const String16& title : titles) {
+    titles8.push_back(ReferenceToUtf8(title));
+  }
+
+  std::string utf8;
+  String16 utf16;
+  double to_utf8 = MeasureNanoseconds(iterations, [&]() {
+    for (const String16& title : titles) {
+      Utf16ToUtf8(title.data(), title.size(), &utf8);
+      DoNotOptimize(utf8);
+    }
+  });
+  double to_utf8_reference = MeasureNanoseconds(iterations, [&]() {
+    for (const String16& title : titles) {
+      DoNotOptimize(ReferenceToUtf8(title));
+    }
+  });
+  double to_utf16 = MeasureNanoseconds(iterations, [&]() {
+    for (const std::string& title : titles8) {
+      Utf8ToUtf16(title.data(), title.size(), &utf16);
+      DoNotOptimize(utf16);
+    }
+  });
+  double to_utf16_reference = MeasureNanoseconds(iterations, [&]() {
+    for (const std::string& title : titles8) {
+      DoNotOptimize(ReferenceToUtf16(title));
+    }
+  });
+
+  double strings = static_cast<double>(titles.size());
+  std::printf(
+      "UTF-16 to UTF-8: transcoder %.0f ns, before %.0f ns per string\n"
+      "UTF-8 to UTF-16: transcoder %.0f ns, before %.0f ns per string "
+      "(%d runs over %zu titles)\n",
+      to_utf8 / strings, to_utf8_reference / strings, to_utf16 / strings,
+      to_utf16_reference / strings, iterations, titles.size());
+  return NativeTestResult();
+}
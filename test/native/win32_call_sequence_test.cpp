@@ -0,0 +1,993 @@
+// Runs the runner's message loop on FakeWin32Backend and calls every method of
+// the window_service, window_manager and flutter_acrylic channels the way Dart
+// would. Each call is recorded with Win32CallRecorder and its window calls,
+// in order, are compared with the golden sequence of the method.
+//
+// The methods run one after another on the same windows, so a sequence also
+// depends on what the methods before it left behind, e.g. a title bar that is
+// already hidden. After an intended change, run
+//   _gate_build/test/native/win32_call_sequence_test --print
+// and review the printed sequences before pasting them over the goldens.
+
+#include <windows.h>
+
+#include <flutter/encodable_value.h>
+#include <flutter/method_result_functions.h>
+#include <flutter/plugin_registry.h>
+#include <flutter/stand_in_host.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "fake_win32_backend.h"
+#include "include/flutter_acrylic/flutter_acrylic_plugin.h"
+#include "include/window_manager/window_manager_plugin.h"
+#include "native_test.h"
+#include "runner/window_state_mirror.h"
+#include "win32_calls.h"
+
+int wWinMain(HINSTANCE instance,
+             HINSTANCE prev,
+             wchar_t* command_line,
+             int show_command);
+
+void RegisterPlugins(flutter::PluginRegistry* registry) {
+  FlutterAcrylicPluginRegisterWithRegistrar(
+      registry->GetRegistrarForPlugin("FlutterAcrylicPlugin"));
+  WindowManagerPluginRegisterWithRegistrar(
+      registry->GetRegistrarForPlugin("WindowManagerPlugin"));
+}
+
+namespace {
+
+using flutter::EncodableList;
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+using ResultFunctions = flutter::MethodResultFunctions<EncodableValue>;
+
+constexpr const char kWindowService[] = "com.example.window_service";
+constexpr const char kWindowManager[] = "window_manager";
+constexpr const char kAcrylic[] = "com.alexmercerind/flutter_acrylic";
+
+constexpr DWORD kOtherProcessId = 4242;
+
+// The windows the methods act on: the app window with its Flutter view, and a
+// window of another process.
+struct Fixture {
+  HWND window = nullptr;
+  HWND view = nullptr;
+  HWND other = nullptr;
+};
+
+// How a method call completed.
+struct Outcome {
+  bool done = false;
+  // The error code, "notImplemented", or empty on success.
+  std::string error;
+  EncodableValue value;
+};
+
+struct Scenario {
+  const char* channel;
+  const char* method;
+  EncodableValue arguments;
+  // The window calls, in order: the API and, for calls on a window, the
+  // window's role in the fixture or else its class name.
+  const char* calls;
+  // The error code the call completes with; nullptr for success.
+  const char* error;
+};
+
+LRESULT CALLBACK TopLevelWindowProc(HWND hwnd,
+                                    UINT message,
+                                    WPARAM wparam,
+                                    LPARAM lparam) {
+  // The engine offers top-level messages to the delegates first.
+  std::optional<LRESULT> result =
+      flutter::StandInHost::Instance().HandleTopLevelWindowProc(
+          hwnd, message, wparam, lparam);
+  return result ? *result
+                : win32::DefWindowProcW(hwnd, message, wparam, lparam);
+}
+
+LRESULT CALLBACK ChildWindowProc(HWND hwnd,
+                                 UINT message,
+                                 WPARAM wparam,
+                                 LPARAM lparam) {
+  return win32::DefWindowProcW(hwnd, message, wparam, lparam);
+}
+
+EncodableValue Handle(HWND hwnd) {
+  return EncodableValue(
+      static_cast<int64_t>(reinterpret_cast<intptr_t>(hwnd)));
+}
+
+EncodableValue Map(
+    std::initializer_list<std::pair<const char*, EncodableValue>> entries) {
+  EncodableMap map;
+  for (const auto& entry : entries) {
+    map[EncodableValue(entry.first)] = entry.second;
+  }
+  return EncodableValue(std::move(map));
+}
+
+EncodableValue List(std::initializer_list<EncodableValue> values) {
+  return EncodableValue(EncodableList(values));
+}
+
+// Calls |method| as Dart would and waits for the result, dispatching what the
+// call posts meanwhile: query pool results and the messages the call posted
+// to its windows.
+Outcome Invoke(FakeWin32Backend* backend,
+               const std::string& channel,
+               const std::string& method,
+               const EncodableValue& arguments) {
+  auto outcome = std::make_shared<Outcome>();
+  auto result = std::make_unique<ResultFunctions>(
+      [outcome](const EncodableValue* value) {
+        outcome->done = true;
+        if (value) {
+          outcome->value = *value;
+        }
+      },
+      [outcome](const std::string& code, const std::string& message,
+                const EncodableValue* details) {
+        outcome->done = true;
+        outcome->error = code;
+      },
+      [outcome]() {
+        outcome->done = true;
+        outcome->error = "notImplemented";
+      });
+  if (!flutter::StandInHost::Instance().messenger()->InvokeMethod(
+          channel, method, arguments, std::move(result))) {
+    outcome->done = true;
+    outcome->error = "noHandler";
+    return *outcome;
+  }
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (!outcome->done && std::chrono::steady_clock::now() < deadline) {
+    backend->PumpPostedMessages();
+    std::this_thread::yield();
+  }
+  backend->PumpPostedMessages();
+  return *outcome;
+}
+
+// The recorded calls as "Api(role)" separated by spaces.
+std::string DescribeCalls(FakeWin32Backend* backend, const Fixture& fixture) {
+  const std::map<HWND, const char*> roles = {
+      {fixture.window, "window"},
+      {fixture.view, "view"},
+      {fixture.other, "other"},
+  };
+  Win32CallRecorder& recorder = Win32CallRecorder::Instance();
+  std::string description;
+  for (uint32_t i = 0; i < recorder.size(); ++i) {
+    const Win32Call& call = recorder.at(i);
+    if (!description.empty()) {
+      description += ' ';
+    }
+    description += Win32CallRecorder::ApiName(call.api);
+    if (!call.hwnd) {
+      continue;
+    }
+    auto role = roles.find(call.hwnd);
+    if (role != roles.end()) {
+      description += std::string("(") + role->second + ")";
+      continue;
+    }
+    // The class name is read from the model, unrecorded.
+    wchar_t class_name[64] = {};
+    int length = backend->GetClassNameW(call.hwnd, class_name, 64);
+    std::string narrow;
+    for (int c = 0; c < length; ++c) {
+      narrow += static_cast<char>(class_name[c]);
+    }
+    description += "(" + (narrow.empty() ? std::string("?") : narrow) + ")";
+  }
+  if (recorder.dropped() > 0) {
+    description += " ...";
+  }
+  return description;
+}
+
+// Prints |calls| as a C++ string literal wrapped for the golden table.
+void PrintGolden(const Scenario& scenario, const std::string& calls) {
+  std::cout << "      // " << scenario.channel << " " << scenario.method
+            << "\n";
+  const std::string indent = "       \"";
+  std::string line = indent;
+  size_t start = 0;
+  while (start <= calls.size()) {
+    size_t end = calls.find(' ', start);
+    if (end == std::string::npos) {
+      end = calls.size();
+    }
+    std::string word = calls.substr(start, end - start);
+    if (end < calls.size()) {
+      word += ' ';
+    }
+    if (line.size() + word.size() > 78) {
+      std::cout << line << "\"\n";
+      line = indent;
+    }
+    line += word;
+    start = end + 1;
+  }
+  std::cout << line << "\"\n";
+}
+
+// The methods in the order they run, with their golden call sequences.
+std::vector<Scenario> Scenarios(const Fixture& f) {
+  EncodableValue window = Handle(f.window);
+  EncodableValue other = Handle(f.other);
+  std::vector<int64_t> both = {std::get<int64_t>(window),
+                               std::get<int64_t>(other)};
+  EncodableValue ratio(1.0);
+  std::vector<uint8_t> alpha(16, 255);
+  alpha[0] = 0;
+  return {
+      // window_manager finds its window first, as the Dart side does.
+      {kWindowManager, "ensureInitialized", EncodableValue(),
+       "GetAncestor(view)",
+       nullptr},
+      // window_service.
+      {kWindowService, "getFlutterWindowHandles", EncodableValue(),
+       "",
+       nullptr},
+      {kWindowService, "getAllWindowHandles", EncodableValue(),
+       "EnumWindows IsWindowVisible(other) IsIconic(other) GetWindow(other) "
+       "IsWindowVisible(window) IsIconic(window) GetWindow(window) "
+       "PostMessage(MultipleWindowsQueryPool) "
+       "GetWindowLongPtr(MultipleWindowsQueryPool)",
+       nullptr},
+      {kWindowService, "getAllWindowHandles",
+       Map({{"visible", EncodableValue(true)},
+            {"classPrefix", EncodableValue("FLUTTER")}}),
+       "EnumWindows IsWindowVisible(other) IsIconic(other) GetWindow(other) "
+       "GetClassName(other) IsWindowVisible(window) IsIconic(window) "
+       "GetWindow(window) GetClassName(window) "
+       "PostMessage(MultipleWindowsQueryPool) "
+       "GetWindowLongPtr(MultipleWindowsQueryPool)",
+       nullptr},
+      {kWindowService, "getAllWindowHandles",
+       Map({{"pid", EncodableValue(static_cast<int32_t>(kOtherProcessId))},
+            {"titleContains", EncodableValue("notepad")}}),
+       "EnumWindows GetWindowThreadProcessId(other) IsWindowVisible(other) "
+       "IsIconic(other) GetWindow(other) GetWindowText(other) "
+       "GetWindowThreadProcessId(window) "
+       "PostMessage(MultipleWindowsQueryPool) "
+       "GetWindowLongPtr(MultipleWindowsQueryPool)",
+       nullptr},
+      {kWindowService, "getWindowInfo", Map({{"hwnd", window}}),
+       "GetWindowTextLength(window) GetWindowText(window) "
+       "GetClassName(window) PostMessage(MultipleWindowsQueryPool) "
+       "GetWindowLongPtr(MultipleWindowsQueryPool)",
+       nullptr},
+      {kWindowService, "getWindowInfo", Map({{"hwnd", other}}),
+       "GetClassName(other) GetWindowText(other) "
+       "PostMessage(MultipleWindowsQueryPool) "
+       "GetWindowLongPtr(MultipleWindowsQueryPool)",
+       nullptr},
+      // The codec sends handles that fit in 32 bits as int32.
+      {kWindowService, "getWindowInfo",
+       Map({{"hwnd",
+             EncodableValue(static_cast<int32_t>(std::get<int64_t>(window)))}}),
+       "GetClassName(window) PostMessage(MultipleWindowsQueryPool) "
+       "GetWindowLongPtr(MultipleWindowsQueryPool)",
+       nullptr},
+      {kWindowService, "getWindowInfo", EncodableValue(),
+       "",
+       "bad_args"},
+      {kWindowService, "getWindowInfoMany",
+       Map({{"hwnds", EncodableValue(both)},
+            {"fields", List({EncodableValue("title"), EncodableValue("rect"),
+                             EncodableValue("pid")})}}),
+       "IsWindow(window) GetWindowRect(window) "
+       "GetWindowThreadProcessId(window) IsWindow(other) GetWindowText(other) "
+       "GetWindowRect(other) GetWindowThreadProcessId(other) "
+       "PostMessage(MultipleWindowsQueryPool) "
+       "GetWindowLongPtr(MultipleWindowsQueryPool)",
+       nullptr},
+      {kWindowService, "getWindowInfoMany", Map({{"hwnds", List({window})}}),
+       "IsWindow(window) GetClassName(window) GetWindowRect(window) "
+       "GetWindowLong(window) GetWindowLong(window) "
+       "GetWindowThreadProcessId(window) IsWindowVisible(window) "
+       "GetWindow(window) PostMessage(MultipleWindowsQueryPool) "
+       "GetWindowLongPtr(MultipleWindowsQueryPool)",
+       nullptr},
+      {kWindowService, "getWindowHandleForViewId",
+       Map({{"viewId", EncodableValue(int64_t{0})}}),
+       "",
+       nullptr},
+      {kWindowService, "getWindowHandleForViewId",
+       Map({{"viewId", EncodableValue(0)}}),
+       "",
+       nullptr},
+      {kWindowService, "setupWindowInterception", Map({{"hwnd", window}}),
+       "IsWindow(window) IsWindow(window)",
+       nullptr},
+      {kWindowService, "setupWindowInterception",
+       Map({{"hwnd", EncodableValue(int64_t{0x1234})}}),
+       "IsWindow(?)",
+       "invalid_hwnd"},
+      {kWindowService, "toggleTitleBar", Map({{"hwnd", window}}),
+       "IsWindow(window) IsWindow(window) GetWindowLongPtr(window) "
+       "SetWindowLongPtr(window) GetProp(window) IsWindow(window) "
+       "SetProp(window) DwmExtendFrameIntoClientArea(window) "
+       "GetWindowRect(window) SetWindowPos(window) IsIconic(window) "
+       "IsZoomed(window)",
+       nullptr},
+      {kWindowService, "toggleTitleBar",
+       Map({{"target", EncodableValue("focused")}}),
+       "GetActiveWindow IsWindow(window) GetWindowLongPtr(window) "
+       "SetWindowLongPtr(window) GetProp(window) "
+       "DwmExtendFrameIntoClientArea(window) GetWindowRect(window) "
+       "SetWindowPos(window) IsIconic(window) IsZoomed(window)",
+       nullptr},
+      {kWindowService, "setTitleBarStyle",
+       Map({{"hwnd", window},
+            {"titleBarStyle", EncodableValue("hidden")}}),
+       "IsWindow(window) IsWindow(window) GetWindowLongPtr(window) "
+       "SetWindowLongPtr(window) GetProp(window) "
+       "DwmExtendFrameIntoClientArea(window) GetWindowRect(window) "
+       "SetWindowPos(window) IsIconic(window) IsZoomed(window)",
+       nullptr},
+      {kWindowService, "setTitleBarStyle",
+       Map({{"hwnd", window},
+            {"titleBarStyle", EncodableValue("hidden")}}),
+       "IsWindow(window) IsWindow(window)",
+       nullptr},
+      {kWindowService, "setTitleBarStyle",
+       Map({{"hwnd", window},
+            {"titleBarStyle", EncodableValue("normal")}}),
+       "IsWindow(window) IsWindow(window) GetWindowLongPtr(window) "
+       "SetWindowLongPtr(window) GetProp(window) "
+       "DwmExtendFrameIntoClientArea(window) GetWindowRect(window) "
+       "SetWindowPos(window) IsIconic(window) IsZoomed(window)",
+       nullptr},
+      {kWindowService, "toggleFrameless", Map({{"hwnd", window}}),
+       "IsWindow(window) IsWindow(window) GetWindowLongPtr(window) "
+       "SetWindowLongPtr(window) GetWindowLongPtr(window) "
+       "SetWindowLongPtr(window) DwmSetWindowAttribute(window) "
+       "DwmSetWindowAttribute(window) GetWindowRect(window) "
+       "SetWindowPos(window) IsIconic(window) IsZoomed(window)",
+       nullptr},
+      {kWindowService, "setFrameless",
+       Map({{"hwnd", window}, {"frameless", EncodableValue(false)}}),
+       "IsWindow(window) IsWindow(window) GetWindowLongPtr(window) "
+       "SetWindowLongPtr(window) GetWindowLongPtr(window) "
+       "SetWindowLongPtr(window) DwmSetWindowAttribute(window) "
+       "DwmSetWindowAttribute(window) GetWindowRect(window) "
+       "SetWindowPos(window) IsIconic(window) IsZoomed(window)",
+       nullptr},
+      {kWindowService, "setFrameless",
+       Map({{"hwnd", window}, {"frameless", EncodableValue(false)}}),
+       "IsWindow(window) IsWindow(window)",
+       nullptr},
+      {kWindowService, "setTransparentBackground",
+       Map({{"hwnd", window}, {"transparent", EncodableValue(true)}}),
+       "IsWindow(window) IsWindow(window) GetProp(window) "
+       "SetWindowCompositionAttribute(window) GetProp(window) "
+       "DwmExtendFrameIntoClientArea(window) GetWindowRect(window) "
+       "SetWindowPos(window) IsIconic(window) IsZoomed(window)",
+       nullptr},
+      {kWindowService, "setTransparentBackground",
+       Map({{"hwnd", window}, {"transparent", EncodableValue(false)}}),
+       "IsWindow(window) IsWindow(window) GetProp(window) "
+       "SetWindowCompositionAttribute(window) GetProp(window) "
+       "DwmExtendFrameIntoClientArea(window) GetWindowRect(window) "
+       "SetWindowPos(window) IsIconic(window) IsZoomed(window)",
+       nullptr},
+      {kWindowService, "setHitTestMask",
+       Map({{"hwnd", window},
+            {"width", EncodableValue(4)},
+            {"height", EncodableValue(4)},
+            {"alpha", EncodableValue(alpha)}}),
+       "IsWindow(window) IsWindow(window) FindWindowEx(window) "
+       "SetWindowSubclass(view)",
+       nullptr},
+      {kWindowService, "execute",
+       Map({{"commands",
+             List({Map({{"op", EncodableValue("getWindowHandleForViewId")},
+                        {"viewId", EncodableValue(0)}}),
+                   Map({{"op", EncodableValue("setTitleBarStyle")},
+                        {"hwnd", window},
+                        {"titleBarStyle", EncodableValue("hidden")}}),
+                   Map({{"op", EncodableValue("setFrameless")},
+                        {"hwnd", window},
+                        {"frameless", EncodableValue(true)}}),
+                   Map({{"op", EncodableValue("setFrameless")},
+                        {"hwnd", window},
+                        {"frameless", EncodableValue(false)}}),
+                   Map({{"op", EncodableValue("setTitleBarStyle")},
+                        {"hwnd", window},
+                        {"titleBarStyle", EncodableValue("normal")}})})}}),
+       "IsWindow(window) IsWindow(window) IsWindow(window) IsWindow(window) "
+       "IsWindow(window) IsWindow(window) IsWindow(window) IsWindow(window)",
+       nullptr},
+      // Only the final mode of each window is applied, once.
+      {kWindowService, "execute",
+       Map({{"commands",
+             List({Map({{"op", EncodableValue("setTitleBarStyle")},
+                        {"hwnd", window},
+                        {"titleBarStyle", EncodableValue("hidden")}}),
+                   Map({{"op", EncodableValue("setFrameless")},
+                        {"hwnd", window},
+                        {"frameless", EncodableValue(true)}})})}}),
+       "IsWindow(window) IsWindow(window) IsWindow(window) IsWindow(window) "
+       "GetWindowLongPtr(window) SetWindowLongPtr(window) "
+       "GetWindowLongPtr(window) SetWindowLongPtr(window) "
+       "DwmSetWindowAttribute(window) DwmSetWindowAttribute(window) "
+       "GetWindowRect(window) SetWindowPos(window) IsIconic(window) "
+       "IsZoomed(window)",
+       nullptr},
+      {kWindowService, "execute",
+       Map({{"commands",
+             List({Map({{"op", EncodableValue("setFrameless")},
+                        {"hwnd", window},
+                        {"frameless", EncodableValue(false)}}),
+                   Map({{"op", EncodableValue("setTitleBarStyle")},
+                        {"hwnd", window},
+                        {"titleBarStyle", EncodableValue("normal")}})})}}),
+       "IsWindow(window) IsWindow(window) IsWindow(window) IsWindow(window) "
+       "GetWindowLongPtr(window) SetWindowLongPtr(window) "
+       "GetWindowLongPtr(window) SetWindowLongPtr(window) "
+       "DwmSetWindowAttribute(window) DwmSetWindowAttribute(window) "
+       "GetWindowRect(window) SetWindowPos(window) IsIconic(window) "
+       "IsZoomed(window)",
+       nullptr},
+      {kWindowService, "getSessionWindowState", Map({{"hwnd", window}}),
+       "",
+       nullptr},
+      {kWindowService, "getFocusedFlutterWindowHandle", EncodableValue(),
+       "GetForegroundWindow GetWindowThreadProcessId(window)",
+       nullptr},
+      {kWindowService, "getCompositionStats", EncodableValue(),
+       "",
+       nullptr},
+      {kWindowService, "getStartupProfile", EncodableValue(),
+       "",
+       nullptr},
+      {kWindowService, "isWindowCreationHookActive", EncodableValue(),
+       "",
+       nullptr},
+      {kWindowService, "noSuchMethod", EncodableValue(),
+       "",
+       "notImplemented"},
+      // window_manager.
+      {kWindowManager, "waitUntilReadyToShow", EncodableValue(),
+       "",
+       nullptr},
+      {kWindowManager, "getId", EncodableValue(),
+       "",
+       nullptr},
+      {kWindowManager, "isPreventClose", EncodableValue(),
+       "",
+       nullptr},
+      {kWindowManager, "isFocused", EncodableValue(),
+       "GetForegroundWindow",
+       nullptr},
+      {kWindowManager, "isVisible", EncodableValue(),
+       "IsWindowVisible(window)",
+       nullptr},
+      {kWindowManager, "isMaximized", EncodableValue(),
+       "GetWindowPlacement(window)",
+       nullptr},
+      {kWindowManager, "isMinimized", EncodableValue(),
+       "GetWindowPlacement(window)",
+       nullptr},
+      {kWindowManager, "isDockable", EncodableValue(),
+       "",
+       nullptr},
+      {kWindowManager, "isDocked", EncodableValue(),
+       "",
+       nullptr},
+      {kWindowManager, "isFullScreen", EncodableValue(),
+       "",
+       nullptr},
+      {kWindowManager, "isResizable", EncodableValue(),
+       "",
+       nullptr},
+      {kWindowManager, "isMinimizable", EncodableValue(),
+       "GetWindowLong(window)",
+       nullptr},
+      {kWindowManager, "isMaximizable", EncodableValue(),
+       "GetWindowLong(window)",
+       nullptr},
+      {kWindowManager, "isClosable", EncodableValue(),
+       "GetClassLong(window)",
+       nullptr},
+      {kWindowManager, "isAlwaysOnTop", EncodableValue(),
+       "GetWindowLong(window)",
+       nullptr},
+      {kWindowManager, "isAlwaysOnBottom", EncodableValue(),
+       "",
+       nullptr},
+      {kWindowManager, "getTitle", EncodableValue(),
+       "GetWindowTextLength(window) GetWindowText(window)",
+       nullptr},
+      {kWindowManager, "getTitleBarHeight", EncodableValue(),
+       "SendMessage(window)",
+       nullptr},
+      {kWindowManager, "isSkipTaskbar", EncodableValue(),
+       "",
+       nullptr},
+      {kWindowManager, "hasShadow", EncodableValue(),
+       "",
+       nullptr},
+      {kWindowManager, "getOpacity", EncodableValue(),
+       "",
+       nullptr},
+      {kWindowManager, "getBounds", Map({{"devicePixelRatio", ratio}}),
+       "GetWindowRect(window)",
+       nullptr},
+      {kWindowManager, "setPreventClose",
+       Map({{"isPreventClose", EncodableValue(false)}}),
+       "",
+       nullptr},
+      {kWindowManager, "focus", EncodableValue(),
+       "GetWindowPlacement(window) SetWindowPos(window) "
+       "SetForegroundWindow(window)",
+       nullptr},
+      {kWindowManager, "blur", EncodableValue(),
+       "GetWindow(window) IsWindowVisible(other) SetForegroundWindow(other)",
+       nullptr},
+      {kWindowManager, "hide", EncodableValue(),
+       "ShowWindow(window) IsIconic(window) IsZoomed(window)",
+       nullptr},
+      {kWindowManager, "show", EncodableValue(),
+       "GetWindowLong(window) ShowWindowAsync(window) IsIconic(window) "
+       "IsZoomed(window) SetForegroundWindow(window)",
+       nullptr},
+      {kWindowManager, "maximize", Map({{"vertically", EncodableValue(false)}}),
+       "GetWindowPlacement(window) PostMessage(window)",
+       nullptr},
+      {kWindowManager, "unmaximize", EncodableValue(),
+       "GetWindowPlacement(window)",
+       nullptr},
+      {kWindowManager, "minimize", EncodableValue(),
+       "GetWindowPlacement(window) PostMessage(window)",
+       nullptr},
+      {kWindowManager, "restore", EncodableValue(),
+       "GetWindowPlacement(window)",
+       nullptr},
+      {kWindowManager, "dock",
+       Map({{"left", EncodableValue(true)},
+            {"right", EncodableValue(false)},
+            {"width", EncodableValue(300)}}),
+       "IsIconic(window) GetWindowRect(window) SHAppBarMessage(window) "
+       "GetSystemMetrics SHAppBarMessage(window) SHAppBarMessage(window) "
+       "SetWindowPos(window) IsIconic(window) IsZoomed(window)",
+       nullptr},
+      {kWindowManager, "undock", EncodableValue(),
+       "SHAppBarMessage(window)",
+       nullptr},
+      {kWindowManager, "setFullScreen",
+       Map({{"isFullScreen", EncodableValue(true)}}),
+       "IsZoomed(window) GetWindowLong(window) GetWindowRect(window) "
+       "IsZoomed(window) GetWindowPlacement(window) IsIconic(window) "
+       "GetWindowRect(window) IsZoomed(window) GetWindowRect(window) "
+       "SetWindowPos(window) IsIconic(window) IsZoomed(window) "
+       "SetWindowLongPtr(window) SetWindowPos(window) GetWindowRect(window) "
+       "IsIconic(window) IsZoomed(window) SetWindowPos(window) "
+       "IsIconic(window) IsZoomed(window)",
+       nullptr},
+      {kWindowManager, "setFullScreen",
+       Map({{"isFullScreen", EncodableValue(false)}}),
+       "IsZoomed(window) SetWindowLongPtr(window) IsZoomed(window) "
+       "SetWindowPos(window) IsIconic(window) IsZoomed(window) "
+       "IsZoomed(window) GetWindowRect(window) GetProp(window) "
+       "SetWindowPos(window) IsIconic(window) IsZoomed(window)",
+       nullptr},
+      {kWindowManager, "setAspectRatio",
+       Map({{"aspectRatio", EncodableValue(1.5)}}),
+       "GetWindowRect(window) GetClientRect(window)",
+       nullptr},
+      {kWindowManager, "setAspectRatio",
+       Map({{"aspectRatio", EncodableValue(0.0)}}),
+       "GetWindowRect(window) GetClientRect(window)",
+       nullptr},
+      {kWindowManager, "setBackgroundColor",
+       Map({{"backgroundColorA", EncodableValue(255)},
+            {"backgroundColorR", EncodableValue(32)},
+            {"backgroundColorG", EncodableValue(64)},
+            {"backgroundColorB", EncodableValue(128)}}),
+       "GetProp(window) SetWindowCompositionAttribute(window)",
+       nullptr},
+      {kWindowManager, "setBounds",
+       Map({{"devicePixelRatio", ratio},
+            {"x", EncodableValue(120.0)},
+            {"y", EncodableValue(80.0)},
+            {"width", EncodableValue(1000.0)},
+            {"height", EncodableValue(700.0)}}),
+       "SetWindowPos(window) IsIconic(window) IsZoomed(window)",
+       nullptr},
+      {kWindowManager, "setMinimumSize",
+       Map({{"devicePixelRatio", ratio},
+            {"width", EncodableValue(400.0)},
+            {"height", EncodableValue(300.0)}}),
+       "GetWindowRect(window) GetClientRect(window)",
+       nullptr},
+      {kWindowManager, "setMaximumSize",
+       Map({{"devicePixelRatio", ratio},
+            {"width", EncodableValue(1600.0)},
+            {"height", EncodableValue(1000.0)}}),
+       "GetWindowRect(window) GetClientRect(window)",
+       nullptr},
+      {kWindowManager, "setSizeConstraints",
+       Map({{"devicePixelRatio", ratio},
+            {"stepWidth", EncodableValue(8.0)},
+            {"stepHeight", EncodableValue(8.0)}}),
+       "GetWindowRect(window) GetClientRect(window)",
+       nullptr},
+      {kWindowManager, "setSnapDistance",
+       Map({{"snapDistance", EncodableValue(12.0)}}),
+       "",
+       nullptr},
+      {kWindowManager, "setHitTestRegions",
+       Map({{"devicePixelRatio", ratio},
+            {"regions",
+             List({Map({{"type", EncodableValue("caption")},
+                        {"x", EncodableValue(0.0)},
+                        {"y", EncodableValue(0.0)},
+                        {"width", EncodableValue(800.0)},
+                        {"height", EncodableValue(32.0)}})})}}),
+       "FindWindowEx(window) SetWindowSubclass(view)",
+       nullptr},
+      {kWindowManager, "setResizable",
+       Map({{"isResizable", EncodableValue(false)}}),
+       "GetWindowLong(window) SetWindowLong(window)",
+       nullptr},
+      {kWindowManager, "setResizable",
+       Map({{"isResizable", EncodableValue(true)}}),
+       "GetWindowLong(window) SetWindowLong(window)",
+       nullptr},
+      {kWindowManager, "setMinimizable",
+       Map({{"isMinimizable", EncodableValue(false)}}),
+       "GetWindowLong(window) SetWindowLong(window)",
+       nullptr},
+      {kWindowManager, "setMinimizable",
+       Map({{"isMinimizable", EncodableValue(true)}}),
+       "GetWindowLong(window) SetWindowLong(window)",
+       nullptr},
+      {kWindowManager, "setMaximizable",
+       Map({{"isMaximizable", EncodableValue(false)}}),
+       "GetWindowLong(window) SetWindowLong(window)",
+       nullptr},
+      {kWindowManager, "setMaximizable",
+       Map({{"isMaximizable", EncodableValue(true)}}),
+       "GetWindowLong(window) SetWindowLong(window)",
+       nullptr},
+      {kWindowManager, "setClosable",
+       Map({{"isClosable", EncodableValue(false)}}),
+       "GetClassLong(window) SetClassLong(window)",
+       nullptr},
+      {kWindowManager, "setClosable",
+       Map({{"isClosable", EncodableValue(true)}}),
+       "GetClassLong(window) SetClassLong(window)",
+       nullptr},
+      {kWindowManager, "setAlwaysOnTop",
+       Map({{"isAlwaysOnTop", EncodableValue(true)}}),
+       "SetWindowPos(window)",
+       nullptr},
+      {kWindowManager, "setAlwaysOnTop",
+       Map({{"isAlwaysOnTop", EncodableValue(false)}}),
+       "SetWindowPos(window)",
+       nullptr},
+      {kWindowManager, "setAlwaysOnBottom",
+       Map({{"isAlwaysOnBottom", EncodableValue(false)}}),
+       "SetWindowPos(window)",
+       nullptr},
+      {kWindowManager, "setTitle", Map({{"title", EncodableValue("Renamed")}}),
+       "SetWindowText(window)",
+       nullptr},
+      {kWindowManager, "setTitleBarStyle",
+       Map({{"titleBarStyle", EncodableValue("hidden")}}),
+       "IsZoomed(window) GetWindowRect(window) GetProp(window) "
+       "SetWindowPos(window) IsIconic(window) IsZoomed(window)",
+       nullptr},
+      {kWindowManager, "setTitleBarStyle",
+       Map({{"titleBarStyle", EncodableValue("normal")}}),
+       "IsZoomed(window) GetWindowRect(window) GetProp(window) "
+       "SetWindowPos(window) IsIconic(window) IsZoomed(window)",
+       nullptr},
+      {kWindowManager, "setSkipTaskbar",
+       Map({{"isSkipTaskbar", EncodableValue(true)}}),
+       "",
+       nullptr},
+      {kWindowManager, "setSkipTaskbar",
+       Map({{"isSkipTaskbar", EncodableValue(false)}}),
+       "",
+       nullptr},
+      {kWindowManager, "setProgressBar",
+       Map({{"progress", EncodableValue(0.5)}}),
+       "",
+       nullptr},
+      {kWindowManager, "setIcon",
+       Map({{"iconPath", EncodableValue("app_icon.ico")}}),
+       "IsIconic(window) GetWindowRect(window) LoadImage LoadImage "
+       "SendMessage(window) SendMessage(window)",
+       nullptr},
+      {kWindowManager, "setHasShadow",
+       Map({{"hasShadow", EncodableValue(false)}}),
+       "",
+       nullptr},
+      {kWindowManager, "setHasShadow",
+       Map({{"hasShadow", EncodableValue(true)}}),
+       "",
+       nullptr},
+      {kWindowManager, "setOpacity", Map({{"opacity", EncodableValue(0.8)}}),
+       "GetWindowLong(window) SetWindowLong(window) "
+       "SetLayeredWindowAttributes(window)",
+       nullptr},
+      {kWindowManager, "setOpacity", Map({{"opacity", EncodableValue(1.0)}}),
+       "GetWindowLong(window) SetWindowLong(window) "
+       "SetLayeredWindowAttributes(window)",
+       nullptr},
+      {kWindowManager, "setBrightness",
+       Map({{"brightness", EncodableValue("dark")}}),
+       "",
+       nullptr},
+      {kWindowManager, "setIgnoreMouseEvents",
+       Map({{"ignore", EncodableValue(true)}}),
+       "GetWindowLong(window) SetWindowLong(window)",
+       nullptr},
+      {kWindowManager, "setIgnoreMouseEvents",
+       Map({{"ignore", EncodableValue(false)}}),
+       "GetWindowLong(window) SetWindowLong(window)",
+       nullptr},
+      {kWindowManager, "setAsFrameless", EncodableValue(),
+       "IsZoomed(window) GetWindowRect(window) SetWindowPos(window) "
+       "IsIconic(window) IsZoomed(window)",
+       nullptr},
+      {kWindowManager, "popUpWindowMenu", Map({}),
+       "GetSystemMenu(window) GetCursorPos TrackPopupMenu(window)",
+       nullptr},
+      {kWindowManager, "startDragging", EncodableValue(),
+       "ReleaseCapture SendMessage(window)",
+       nullptr},
+      {kWindowManager, "startResizing",
+       Map({{"top", EncodableValue(false)},
+            {"bottom", EncodableValue(true)},
+            {"left", EncodableValue(false)},
+            {"right", EncodableValue(true)}}),
+       "ReleaseCapture GetCursorPos PostMessage(window)",
+       nullptr},
+      {kWindowManager, "close", EncodableValue(),
+       "PostMessage(window)",
+       nullptr},
+      // flutter_acrylic.
+      {kAcrylic, "Initialize", EncodableValue(),
+       "",
+       nullptr},
+      {kAcrylic, "SetEffect",
+       Map({{"effect", EncodableValue(3)},
+            {"color", Map({{"A", EncodableValue(204)},
+                           {"R", EncodableValue(32)},
+                           {"G", EncodableValue(32)},
+                           {"B", EncodableValue(32)}})},
+            {"dark", EncodableValue(true)}}),
+       "GetAncestor(view) GetProp(window) "
+       "SetWindowCompositionAttribute(window) "
+       "SetWindowCompositionAttribute(window)",
+       nullptr},
+      {kAcrylic, "SetEffect",
+       Map({{"effect", EncodableValue(4)},
+            {"color", Map({})},
+            {"dark", EncodableValue(true)}}),
+       "GetAncestor(view) GetProp(window) "
+       "SetWindowCompositionAttribute(window) "
+       "DwmExtendFrameIntoClientArea(window) DwmSetWindowAttribute(window) "
+       "DwmSetWindowAttribute(window) DwmSetWindowAttribute(window)",
+       nullptr},
+      {kAcrylic, "SetEffect",
+       Map({{"effect", EncodableValue(0)},
+            {"color", Map({})},
+            {"dark", EncodableValue(false)}}),
+       "GetAncestor(view) GetProp(window) "
+       "SetWindowCompositionAttribute(window) "
+       "DwmExtendFrameIntoClientArea(window) DwmSetWindowAttribute(window) "
+       "DwmSetWindowAttribute(window) DwmSetWindowAttribute(window)",
+       nullptr},
+      {kAcrylic, "HideWindowControls", EncodableValue(),
+       "GetAncestor(view) GetWindowLong(window) GetAncestor(view) "
+       "SetWindowLong(window)",
+       nullptr},
+      {kAcrylic, "ShowWindowControls", EncodableValue(),
+       "GetAncestor(view) GetWindowLong(window) GetAncestor(view) "
+       "SetWindowLong(window)",
+       nullptr},
+      {kAcrylic, "EnterFullscreen", EncodableValue(),
+       "GetAncestor(view) IsIconic(window) GetWindowRect(window) "
+       "SetWindowLongPtr(window) GetWindowRect(window) SetWindowPos(window) "
+       "IsIconic(window) IsZoomed(window) ShowWindow(window) "
+       "GetWindowRect(window) IsZoomed(window) IsIconic(window) "
+       "IsZoomed(window)",
+       nullptr},
+      {kAcrylic, "ExitFullscreen", EncodableValue(),
+       "GetAncestor(view) SetWindowLongPtr(window) SetWindowPos(window) "
+       "GetWindowRect(window) IsIconic(window) IsZoomed(window) "
+       "ShowWindow(window) GetWindowRect(window) IsZoomed(window) "
+       "IsIconic(window) IsZoomed(window)",
+       nullptr},
+      {kAcrylic, "GetCompositionStats", EncodableValue(),
+       "",
+       nullptr},
+      // Last: posts WM_QUIT.
+      {kWindowManager, "destroy", EncodableValue(),
+       "PostQuitMessage",
+       nullptr},
+  };
+}
+
+// startWin32CallRecording and stopWin32CallRecording hand the same log to
+// Dart.
+void CheckRecordingMethods(FakeWin32Backend* backend, const Fixture& fixture) {
+  EXPECT_EQ(std::string(),
+            Invoke(backend, kWindowService, "startWin32CallRecording",
+                   EncodableValue())
+                .error);
+  Invoke(backend, kWindowManager, "isVisible", EncodableValue());
+  Outcome stopped = Invoke(backend, kWindowService, "stopWin32CallRecording",
+                           EncodableValue());
+  const auto* log = std::get_if<EncodableMap>(&stopped.value);
+  EXPECT_TRUE(log != nullptr);
+  if (!log) {
+    return;
+  }
+  const auto& calls =
+      std::get<EncodableList>(log->at(EncodableValue("calls")));
+  EXPECT_EQ(size_t{1}, calls.size());
+  EXPECT_EQ(int64_t{0}, std::get<int64_t>(log->at(EncodableValue("dropped"))));
+  if (calls.size() != 1) {
+    return;
+  }
+  const auto& call = std::get<EncodableMap>(calls[0]);
+  EXPECT_EQ(std::string("IsWindowVisible"),
+            std::get<std::string>(call.at(EncodableValue("api"))));
+  EXPECT_EQ(std::string("query"),
+            std::get<std::string>(call.at(EncodableValue("cost"))));
+  EXPECT_EQ(static_cast<int64_t>(reinterpret_cast<intptr_t>(fixture.window)),
+            std::get<int64_t>(call.at(EncodableValue("hwnd"))));
+}
+
+// SetWindowText sends WM_SETTEXT through the runner's subclass procedure and
+// window_manager's delegate, which both cache the text once it is set; reads
+// then come from the caches.
+void CheckTitleCaches(FakeWin32Backend* backend, const Fixture& fixture) {
+  if (!backend->IsWindow(fixture.window)) {
+    return;
+  }
+  const std::string title = "Caf\xC3\xA9 \xE2\x80\x94 Notes";
+  Invoke(backend, kWindowManager, "setTitle",
+         Map({{"title", EncodableValue(title)}}));
+  wchar_t text[64] = {};
+  backend->GetWindowTextW(fixture.window, text, 64);
+  EXPECT_TRUE(std::wstring(text) == L"Caf\u00E9 \u2014 Notes");
+
+  Win32CallRecorder& recorder = Win32CallRecorder::Instance();
+  recorder.Start();
+  Outcome from_plugin =
+      Invoke(backend, kWindowManager, "getTitle", EncodableValue());
+  recorder.Stop();
+  EXPECT_EQ(std::string(), DescribeCalls(backend, fixture));
+  EXPECT_TRUE(from_plugin.value == EncodableValue(title));
+
+  Outcome from_runner = Invoke(backend, kWindowService, "getWindowInfo",
+                               Map({{"hwnd", Handle(fixture.window)}}));
+  const auto* info = std::get_if<EncodableMap>(&from_runner.value);
+  EXPECT_TRUE(info != nullptr &&
+              info->at(EncodableValue("title")) == EncodableValue(title));
+}
+
+// The runner writes the state mirror from the placement it keeps from
+// WM_WINDOWPOSCHANGED, without asking the window; it has to agree with the
+// window after every method.
+void CheckStateMirror(FakeWin32Backend* backend,
+                      const Fixture& fixture,
+                      const Scenario& scenario) {
+  if (!backend->IsWindow(fixture.window)) {
+    return;
+  }
+  WindowStateSnapshot state = {};
+  RECT rect = {};
+  backend->GetWindowRect(fixture.window, &rect);
+  bool visible = backend->IsWindowVisible(fixture.window) != FALSE;
+  bool minimized = backend->IsIconic(fixture.window) != FALSE;
+  bool maximized = backend->IsZoomed(fixture.window) != FALSE;
+  if (!WindowStateMirror::Instance().Read(fixture.window, &state) ||
+      state.x != rect.left || state.y != rect.top ||
+      state.width != rect.right - rect.left ||
+      state.height != rect.bottom - rect.top ||
+      ((state.flags & WindowStateMirror::kVisible) != 0) != visible ||
+      ((state.flags & WindowStateMirror::kMinimized) != 0) != minimized ||
+      ((state.flags & WindowStateMirror::kMaximized) != 0) != maximized) {
+    std::cerr << scenario.channel << " " << scenario.method
+              << ": the state mirror does not match the window" << std::endl;
+    ++NativeTestFailures();
+  }
+}
+
+void RunScenarios(FakeWin32Backend* backend, bool print) {
+  Fixture fixture;
+  fixture.window = backend->CreateTestWindow(
+      L"FLUTTER_RUNNER_WIN32_WINDOW", TopLevelWindowProc, L"Sequence test",
+      WS_OVERLAPPEDWINDOW | WS_VISIBLE, 0, {100, 100, 900, 700});
+  RECT client = {};
+  backend->GetClientRect(fixture.window, &client);
+  fixture.view = backend->CreateTestWindow(
+      L"FLUTTERVIEW", ChildWindowProc, L"", WS_CHILD | WS_VISIBLE, 0, client,
+      fixture.window);
+  fixture.other = backend->CreateTestWindow(
+      L"Notepad", ChildWindowProc, L"Notes - Notepad",
+      WS_OVERLAPPEDWINDOW | WS_VISIBLE, 0, {200, 200, 800, 600});
+  backend->SetProcessId(fixture.other, kOtherProcessId);
+  backend->SetForegroundWindow(fixture.window);
+  flutter::StandInHost::Instance().SetView(0, fixture.view);
+  backend->PumpPostedMessages();
+
+  Win32CallRecorder& recorder = Win32CallRecorder::Instance();
+  for (const Scenario& scenario : Scenarios(fixture)) {
+    recorder.Start();
+    Outcome outcome =
+        Invoke(backend, scenario.channel, scenario.method, scenario.arguments);
+    recorder.Stop();
+    std::string calls = DescribeCalls(backend, fixture);
+
+    if (print) {
+      if (!outcome.error.empty()) {
+        std::cout << "      // error: " << outcome.error << "\n";
+      }
+      PrintGolden(scenario, calls);
+      continue;
+    }
+    if (!outcome.done) {
+      std::cerr << scenario.method << ": no result" << std::endl;
+      ++NativeTestFailures();
+      continue;
+    }
+    std::string expected_error = scenario.error ? scenario.error : "";
+    if (outcome.error != expected_error) {
+      std::cerr << scenario.channel << " " << scenario.method
+                << ": expected " << (expected_error.empty() ? "success"
+                                                              : expected_error)
+                << ", got " << outcome.error << std::endl;
+      ++NativeTestFailures();
+    }
+    if (calls != scenario.calls) {
+      std::cerr << scenario.channel << " " << scenario.method
+                << ":\n  expected: " << scenario.calls
+                << "\n  actual:   " << calls << std::endl;
+      ++NativeTestFailures();
+    }
+    CheckStateMirror(backend, fixture, scenario);
+  }
+  if (!print) {
+    CheckRecordingMethods(backend, fixture);
+    CheckTitleCaches(backend, fixture);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  bool print = argc > 1 && std::strcmp(argv[1], "--print") == 0;
+  FakeWin32Backend backend;
+  Win32Backend::Install(&backend);
+  backend.set_on_message_loop(
+      [&backend, print]() { RunScenarios(&backend, print); });
+  wchar_t command_line[] = L"";
+  wWinMain(nullptr, nullptr, command_line, SW_SHOWNORMAL);
+  return NativeTestResult();
+}
@@ -0,0 +1,235 @@
+// Enumerates a stand-in desktop of 5000 top-level windows (on
+// fake_win32_backend.h) with the getAllWindowHandles filters, and times
+// EnumerateWindows() filtering during enumeration against shipping every
+// handle and filtering afterwards, one query per handle and predicate, as
+// Dart did. Checks both against the desktop's own model first.
+
+// This must be included before many other Windows headers.
+#include <windows.h>
+
+#include <dwmapi.h>
+#include <flutter/encodable_value.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "fake_win32_backend.h"
+#include "native_test.h"
+#include "runner/window_filter.h"
+
+namespace {
+
+constexpr int kWindows = 5000;
+constexpr DWORD kFirstPid = 2000;
+constexpr int kProcesses = 50;
+
+const wchar_t* const kClasses[] = {
+    L"Chrome_WidgetWin_1", L"ConsoleWindowClass", L"IME",
+    L"MSCTFIME UI",        L"tooltips_class32",   L"CoreWindow",
+    L"ApplicationFrame",   L"#32770",             L"WorkerW",
+    L"Progman",
+};
+
+const wchar_t* const kTitles[] = {
+    L"Quarterly Report.xlsx - Excel", L"",
+    L"Default IME",                   L"Inbox - Mail",
+    L"Q3 report notes - Notepad",     L"Program Manager",
+};
+
+// What the desktop was built with, per window.
+struct ModelWindow {
+  HWND hwnd;
+  DWORD pid;
+  std::wstring class_name;
+  std::wstring title;
+  bool visible;
+  bool minimized;
+  bool owned;
+  bool cloaked;
+};
+
+LRESULT CALLBACK DesktopWindowProc(HWND hwnd,
+                                   UINT message,
+                                   WPARAM wparam,
+                                   LPARAM lparam) {
+  return win32::DefWindowProcW(hwnd, message, wparam, lparam);
+}
+
+std::vector<ModelWindow> BuildDesktop(FakeWin32Backend* backend) {
+  std::vector<ModelWindow> model;
+  model.reserve(kWindows);
+  for (int i = 0; i < kWindows; ++i) {
+    ModelWindow window;
+    window.pid = kFirstPid + static_cast<DWORD>(i % kProcesses);
+    window.class_name = kClasses[i % 10];
+    window.title = kTitles[i % 6];
+    window.visible = i % 3 != 0;
+    window.minimized = window.visible && i % 11 == 0;
+    window.owned = i % 5 == 0 && i > 0;
+    window.cloaked = i % 13 == 0;
+    HWND owner = window.owned ? model.back().hwnd : nullptr;
+    window.hwnd = backend->CreateTestWindow(
+        window.class_name, DesktopWindowProc, window.title,
+        WS_OVERLAPPEDWINDOW | (window.visible ? WS_VISIBLE : 0), 0,
+        {i % 1000, i % 700, i % 1000 + 640, i % 700 + 480}, owner);
+    backend->SetProcessId(window.hwnd, window.pid);
+    if (window.minimized) {
+      backend->ShowWindow(window.hwnd, SW_MINIMIZE);
+    }
+    if (window.cloaked) {
+      DWORD cloaked = 2;  // DWM_CLOAKED_SHELL
+      backend->DwmSetWindowAttribute(window.hwnd, DWMWA_CLOAKED, &cloaked,
+                                     sizeof(cloaked));
+    }
+    model.push_back(window);
+  }
+  return model;
+}
+
+bool StateMatches(WindowFilter::State wanted, bool actual) {
+  return wanted == WindowFilter::State::kAny ||
+         (wanted == WindowFilter::State::kYes) == actual;
+}
+
+std::wstring Lower(std::wstring text) {
+  for (wchar_t& c : text) {
+    if (c >= L'A' && c <= L'Z') {
+      c = static_cast<wchar_t>(c + (L'a' - L'A'));
+    }
+  }
+  return text;
+}
+
+bool ModelMatches(const ModelWindow& window, const WindowFilter& filter) {
+  return (!filter.has_pid || window.pid == filter.pid) &&
+         StateMatches(filter.visible, window.visible) &&
+         StateMatches(filter.minimized, window.minimized) &&
+         StateMatches(filter.owned, window.owned) &&
+         StateMatches(filter.cloaked, window.cloaked) &&
+         window.class_name.compare(0, filter.class_prefix.size(),
+                                   filter.class_prefix) == 0 &&
+         Lower(window.title).find(Lower(filter.title_substring)) !=
+             std::wstring::npos;
+}
+
+// Every handle crosses the channel; then each predicate is one query per
+// handle.
+std::vector<HWND> FilterAfterwards(const WindowFilter& filter) {
+  std::vector<HWND> all = EnumerateWindows(WindowFilter());
+  flutter::EncodableList shipped;
+  shipped.reserve(all.size());
+  for (HWND hwnd : all) {
+    shipped.emplace_back(
+        static_cast<int64_t>(reinterpret_cast<intptr_t>(hwnd)));
+  }
+  std::wstring needle = Lower(filter.title_substring);
+  std::vector<HWND> matches;
+  for (const flutter::EncodableValue& value : shipped) {
+    HWND hwnd = reinterpret_cast<HWND>(
+        static_cast<intptr_t>(std::get<int64_t>(value)));
+    DWORD pid = 0;
+    win32::GetWindowThreadProcessId(hwnd, &pid);
+    DWORD cloaked = 0;
+    win32::DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked,
+                                 sizeof(cloaked));
+    wchar_t text[512];
+    int length = win32::GetClassNameW(hwnd, text, 512);
+    std::wstring class_name(text, static_cast<size_t>(length));
+    length = win32::GetWindowTextW(hwnd, text, 512);
+    std::wstring title =
+        Lower(std::wstring(text, static_cast<size_t>(length)));
+    if ((!filter.has_pid || pid == filter.pid) &&
+        StateMatches(filter.visible, win32::IsWindowVisible(hwnd) != FALSE) &&
+        StateMatches(filter.minimized, win32::IsIconic(hwnd) != FALSE) &&
+        StateMatches(filter.owned,
+                     win32::GetWindow(hwnd, GW_OWNER) != nullptr) &&
+        StateMatches(filter.cloaked, cloaked != 0) &&
+        class_name.compare(0, filter.class_prefix.size(),
+                           filter.class_prefix) == 0 &&
+        title.find(needle) != std::wstring::npos) {
+      matches.push_back(hwnd);
+    }
+  }
+  return matches;
+}
+
+// Native enumeration, and the matches crossing the channel.
+std::vector<HWND> FilterNatively(const WindowFilter& filter) {
+  std::vector<HWND> matches = EnumerateWindows(filter);
+  flutter::EncodableList shipped;
+  shipped.reserve(matches.size());
+  for (HWND hwnd : matches) {
+    shipped.emplace_back(
+        static_cast<int64_t>(reinterpret_cast<intptr_t>(hwnd)));
+  }
+  DoNotOptimize(shipped);
+  return matches;
+}
+
+struct NamedFilter {
+  const char* name;
+  WindowFilter filter;
+};
+
+std::vector<NamedFilter> Filters() {
+  using State = WindowFilter::State;
+  std::vector<NamedFilter> filters(5);
+  filters[0].name = "one process";
+  filters[0].filter.has_pid = true;
+  filters[0].filter.pid = kFirstPid + 7;
+  filters[1].name = "task switcher";
+  filters[1].filter.visible = State::kYes;
+  filters[1].filter.owned = State::kNo;
+  filters[1].filter.cloaked = State::kNo;
+  filters[2].name = "minimized";
+  filters[2].filter.minimized = State::kYes;
+  filters[3].name = "class prefix";
+  filters[3].filter.class_prefix = L"Chrome_";
+  filters[4].name = "visible title";
+  filters[4].filter.visible = State::kYes;
+  filters[4].filter.title_substring = L"REPORT";
+  return filters;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int iterations = BenchmarkIterations(argc, argv, 5);
+  FakeWin32Backend backend;
+  Win32Backend::Install(&backend);
+  std::vector<ModelWindow> model = BuildDesktop(&backend);
+  EXPECT_EQ(static_cast<size_t>(kWindows),
+            EnumerateWindows(WindowFilter()).size());
+
+  for (const NamedFilter& named : Filters()) {
+    // EnumWindows reports the newest window first.
+    std::vector<HWND> expected;
+    for (auto it = model.rbegin(); it != model.rend(); ++it) {
+      if (ModelMatches(*it, named.filter)) {
+        expected.push_back(it->hwnd);
+      }
+    }
+    std::vector<HWND> native = FilterNatively(named.filter);
+    EXPECT_TRUE(native == expected);
+    EXPECT_TRUE(FilterAfterwards(named.filter) == expected);
+    EXPECT_TRUE(!expected.empty() &&
+                expected.size() < static_cast<size_t>(kWindows));
+
+    double filtered = MeasureNanoseconds(iterations, [&]() {
+      DoNotOptimize(FilterNatively(named.filter));
+    });
+    double afterwards = MeasureNanoseconds(iterations, [&]() {
+      DoNotOptimize(FilterAfterwards(named.filter));
+    });
+    std::printf(
+        "%d windows, %-13s: %4zu handles, native filter %.2f ms, "
+        "ship all and filter %.2f ms (%d runs)\n",
+        kWindows, named.name, expected.size(), filtered / 1e6,
+        afterwards / 1e6, iterations);
+  }
+
+  Win32Backend::Install(nullptr);
+  return NativeTestResult();
+}
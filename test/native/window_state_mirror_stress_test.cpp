@@ -0,0 +1,162 @@
+// Hammers one WindowStateRecord from a writer thread while reader threads
+// read it, and fails on any torn read: a copy whose fields come from
+// different writes. Every write stores fields derived from one counter, so a
+// consistent copy is one whose fields all agree on it.
+//
+// On x86 it also runs the protocol of the Dart reader
+// (lib/app/window_state_mirror.dart), which has no acquire ordering: plain
+// loads in program order, retried on an odd or changed sequence. That is
+// only sound where the hardware does not reorder loads with other loads, so
+// it is not run elsewhere, and the Dart reader is not used elsewhere.
+//
+// Pass the number of writes to run longer, e.g.
+//   _gate_build/test/native/window_state_mirror_stress_test 200000000
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "native_test.h"
+#include "runner/window_state_mirror.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || \
+    defined(__i386__)
+#define MIRROR_TEST_DART_READER 1
+#endif
+
+namespace {
+
+constexpr int64_t kHwnd = 0x00C0FFEE;
+constexpr int kReaders = 3;
+
+WindowStateSnapshot Expected(int32_t counter) {
+  WindowStateSnapshot snapshot = {};
+  snapshot.hwnd = kHwnd;
+  snapshot.dpi = counter;
+  snapshot.x = counter * 3;
+  snapshot.y = -counter;
+  snapshot.width = counter ^ 0x5A5A5A5A;
+  snapshot.height = counter + 7;
+  snapshot.flags = counter & 0xF;
+  snapshot.mode = counter >> 4;
+  return snapshot;
+}
+
+bool Consistent(const WindowStateSnapshot& snapshot) {
+  WindowStateSnapshot expected = Expected(snapshot.dpi);
+  return snapshot.hwnd == expected.hwnd && snapshot.x == expected.x &&
+         snapshot.y == expected.y && snapshot.width == expected.width &&
+         snapshot.height == expected.height &&
+         snapshot.flags == expected.flags && snapshot.mode == expected.mode;
+}
+
+#ifdef MIRROR_TEST_DART_READER
+// WindowStateMirror.read() in Dart: relaxed loads that the compiler keeps in
+// program order, like the Dart VM's FFI loads, and no hardware fence.
+void DartRead(const WindowStateRecord& record, WindowStateSnapshot* snapshot) {
+  uint32_t before;
+  do {
+    before = record.sequence.load(std::memory_order_relaxed);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    snapshot->hwnd = record.hwnd.load(std::memory_order_relaxed);
+    snapshot->dpi = record.dpi.load(std::memory_order_relaxed);
+    snapshot->x = record.x.load(std::memory_order_relaxed);
+    snapshot->y = record.y.load(std::memory_order_relaxed);
+    snapshot->width = record.width.load(std::memory_order_relaxed);
+    snapshot->height = record.height.load(std::memory_order_relaxed);
+    snapshot->flags = record.flags.load(std::memory_order_relaxed);
+    snapshot->mode = record.mode.load(std::memory_order_relaxed);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+  } while ((before & 1) ||
+           record.sequence.load(std::memory_order_relaxed) != before);
+}
+#endif
+
+struct ReaderResult {
+  int64_t reads = 0;
+  int64_t torn = 0;
+  int32_t last = 0;
+  bool backwards = false;
+};
+
+template <typename ReadFunction>
+void RunReader(const WindowStateRecord& record,
+               const std::atomic<bool>& done,
+               ReadFunction read,
+               ReaderResult* result) {
+  WindowStateSnapshot snapshot;
+  while (!done.load(std::memory_order_acquire)) {
+    read(record, &snapshot);
+    ++result->reads;
+    if (!Consistent(snapshot)) {
+      ++result->torn;
+    }
+    // A reader never sees an older write after a newer one.
+    if (snapshot.dpi < result->last) {
+      result->backwards = true;
+    }
+    result->last = snapshot.dpi;
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int writes = BenchmarkIterations(argc, argv, 20000000);
+
+  WindowStateRecord record = {};
+  record.Write(Expected(0));
+
+  std::atomic<bool> done{false};
+  std::vector<ReaderResult> results(kReaders);
+  std::vector<std::thread> readers;
+  for (int i = 0; i < kReaders; ++i) {
+    ReaderResult* result = &results[i];
+#ifdef MIRROR_TEST_DART_READER
+    // The last reader follows the Dart protocol.
+    if (i == kReaders - 1) {
+      readers.emplace_back([&record, &done, result]() {
+        RunReader(record, done, DartRead, result);
+      });
+      continue;
+    }
+#endif
+    readers.emplace_back([&record, &done, result]() {
+      RunReader(
+          record, done,
+          [](const WindowStateRecord& r, WindowStateSnapshot* snapshot) {
+            r.Read(snapshot);
+          },
+          result);
+    });
+  }
+
+  for (int32_t counter = 1; counter <= writes; ++counter) {
+    record.Write(Expected(counter));
+  }
+  done.store(true, std::memory_order_release);
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+
+  WindowStateSnapshot final_state;
+  record.Read(&final_state);
+  EXPECT_EQ(writes, final_state.dpi);
+  EXPECT_TRUE(Consistent(final_state));
+
+  for (int i = 0; i < kReaders; ++i) {
+    const ReaderResult& result = results[i];
+#ifdef MIRROR_TEST_DART_READER
+    const char* kind = i == kReaders - 1 ? "dart" : "native";
+#else
+    const char* kind = "native";
+#endif
+    std::cout << kind << " reader " << i << ": " << result.reads
+              << " reads, " << result.torn << " torn" << std::endl;
+    EXPECT_EQ(int64_t{0}, result.torn);
+    EXPECT_TRUE(!result.backwards);
+  }
+  return NativeTestResult();
+}
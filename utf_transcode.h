@@ -0,0 +1,193 @@
+#ifndef MULTIPLE_WINDOWS_UTF_TRANSCODE_H_
+#define MULTIPLE_WINDOWS_UTF_TRANSCODE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define MULTIPLE_WINDOWS_UTF_TRANSCODE_SSE2 1
+#endif
+
+// UTF-16 <-> UTF-8 conversion for strings crossing between Win32 (wchar_t)
+// and Dart (std::string).
+//
+// Both directions write into a caller-provided string that is resized, not
+// reallocated, when it already has the capacity, so callers that convert
+// repeatedly can keep one buffer around. Runs of ASCII are converted 16 code
+// units at a time with SSE2 where available; everything else goes through a
+// validating scalar path. Unpaired surrogates, overlong or truncated UTF-8
+// sequences and code points above U+10FFFF are rejected, matching
+// WC_ERR_INVALID_CHARS / MB_ERR_INVALID_CHARS: the output is cleared and
+// false is returned.
+//
+// Nothing here depends on <windows.h>. The UTF-16 side is templated on the
+// code unit type so the same code serves wchar_t on Windows and char16_t
+// elsewhere.
+
+namespace utf_transcode_internal {
+
+constexpr bool IsHighSurrogate(uint32_t unit) {
+  return unit >= 0xD800 && unit <= 0xDBFF;
+}
+
+constexpr bool IsLowSurrogate(uint32_t unit) {
+  return unit >= 0xDC00 && unit <= 0xDFFF;
+}
+
+constexpr bool IsContinuation(uint8_t byte) {
+  return (byte & 0xC0) == 0x80;
+}
+
+}  // namespace utf_transcode_internal
+
+/// Converts |length| UTF-16 code units at |in| to UTF-8 in |out|.
+template <typename Char16>
+bool Utf16ToUtf8(const Char16* in, size_t length, std::string* out) {
+  static_assert(sizeof(Char16) == 2, "UTF-16 code units are 16 bits");
+  using namespace utf_transcode_internal;
+
+  // At most 3 bytes per code unit; a surrogate pair is 4 bytes for 2 units.
+  out->resize(length * 3);
+  char* begin = &(*out)[0];
+  char* dst = begin;
+  size_t i = 0;
+  while (i < length) {
+#if defined(MULTIPLE_WINDOWS_UTF_TRANSCODE_SSE2)
+    const __m128i non_ascii = _mm_set1_epi16(static_cast<short>(0xFF80));
+    while (i + 16 <= length) {
+      __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+      __m128i hi =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8));
+      __m128i high_bits = _mm_and_si128(_mm_or_si128(lo, hi), non_ascii);
+      if (_mm_movemask_epi8(_mm_cmpeq_epi16(high_bits, _mm_setzero_si128())) !=
+          0xFFFF) {
+        break;
+      }
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                       _mm_packus_epi16(lo, hi));
+      dst += 16;
+      i += 16;
+    }
+    if (i >= length) {
+      break;
+    }
+#endif
+    uint32_t unit = static_cast<uint16_t>(in[i++]);
+    if (unit < 0x80) {
+      *dst++ = static_cast<char>(unit);
+    } else if (unit < 0x800) {
+      *dst++ = static_cast<char>(0xC0 | (unit >> 6));
+      *dst++ = static_cast<char>(0x80 | (unit & 0x3F));
+    } else if (IsHighSurrogate(unit)) {
+      if (i == length || !IsLowSurrogate(static_cast<uint16_t>(in[i]))) {
+        out->clear();
+        return false;
+      }
+      uint32_t code_point = 0x10000 + ((unit - 0xD800) << 10) +
+                            (static_cast<uint16_t>(in[i++]) - 0xDC00);
+      *dst++ = static_cast<char>(0xF0 | (code_point >> 18));
+      *dst++ = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+      *dst++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+      *dst++ = static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (IsLowSurrogate(unit)) {
+      out->clear();
+      return false;
+    } else {
+      *dst++ = static_cast<char>(0xE0 | (unit >> 12));
+      *dst++ = static_cast<char>(0x80 | ((unit >> 6) & 0x3F));
+      *dst++ = static_cast<char>(0x80 | (unit & 0x3F));
+    }
+  }
+  out->resize(static_cast<size_t>(dst - begin));
+  return true;
+}
+
+/// Converts |length| bytes of UTF-8 at |in| to UTF-16 in |out|.
+template <typename Char16>
+bool Utf8ToUtf16(const char* in,
+                 size_t length,
+                 std::basic_string<Char16>* out) {
+  static_assert(sizeof(Char16) == 2, "UTF-16 code units are 16 bits");
+  using namespace utf_transcode_internal;
+
+  // Never more code units than bytes.
+  out->resize(length);
+  Char16* begin = &(*out)[0];
+  Char16* dst = begin;
+  const uint8_t* src = reinterpret_cast<const uint8_t*>(in);
+  size_t i = 0;
+  while (i < length) {
+#if defined(MULTIPLE_WINDOWS_UTF_TRANSCODE_SSE2)
+    while (i + 16 <= length) {
+      __m128i bytes =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      if (_mm_movemask_epi8(bytes) != 0) {
+        break;
+      }
+      __m128i zero = _mm_setzero_si128();
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                       _mm_unpacklo_epi8(bytes, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 8),
+                       _mm_unpackhi_epi8(bytes, zero));
+      dst += 16;
+      i += 16;
+    }
+    if (i >= length) {
+      break;
+    }
+#endif
+    uint8_t lead = src[i];
+    uint32_t code_point;
+    size_t extra;
+    if (lead < 0x80) {
+      *dst++ = static_cast<Char16>(lead);
+      ++i;
+      continue;
+    } else if (lead >= 0xC2 && lead <= 0xDF) {
+      code_point = lead & 0x1F;
+      extra = 1;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+      code_point = lead & 0x0F;
+      extra = 2;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+      code_point = lead & 0x07;
+      extra = 3;
+    } else {
+      // Continuation byte, overlong two-byte lead (C0, C1) or beyond U+10FFFF.
+      out->clear();
+      return false;
+    }
+    if (length - i <= extra) {
+      out->clear();
+      return false;
+    }
+    for (size_t k = 1; k <= extra; ++k) {
+      if (!IsContinuation(src[i + k])) {
+        out->clear();
+        return false;
+      }
+      code_point = (code_point << 6) | (src[i + k] & 0x3F);
+    }
+    // Overlong three- and four-byte forms, encoded surrogates, > U+10FFFF.
+    if ((extra == 2 && code_point < 0x800) ||
+        (extra == 3 && (code_point < 0x10000 || code_point > 0x10FFFF)) ||
+        (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+      out->clear();
+      return false;
+    }
+    i += extra + 1;
+    if (code_point >= 0x10000) {
+      code_point -= 0x10000;
+      *dst++ = static_cast<Char16>(0xD800 + (code_point >> 10));
+      *dst++ = static_cast<Char16>(0xDC00 + (code_point & 0x3FF));
+    } else {
+      *dst++ = static_cast<Char16>(code_point);
+    }
+  }
+  out->resize(static_cast<size_t>(dst - begin));
+  return true;
+}
+
+#endif  // MULTIPLE_WINDOWS_UTF_TRANSCODE_H_
@@ -0,0 +1,1308 @@
+#ifndef MULTIPLE_WINDOWS_WIN32_CALLS_H_
+#define MULTIPLE_WINDOWS_WIN32_CALLS_H_
+
+// This must be included before many other Windows headers.
+#include <windows.h>
+
+#include <commctrl.h>
+#include <dwmapi.h>
+#include <shellapi.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+/// The window-system calls that go through the win32 wrappers below.
+enum class Win32Api : uint8_t {
+  kGetWindowLongPtr,
+  kSetWindowLongPtr,
+  kGetWindowLong,
+  kSetWindowLong,
+  kSetWindowPos,
+  kShowWindow,
+  kGetWindowRect,
+  kGetClientRect,
+  kGetWindowPlacement,
+  kIsZoomed,
+  kIsIconic,
+  kPostMessage,
+  kSendMessage,
+  kSetForegroundWindow,
+  kGetWindowText,
+  kSetWindowText,
+  kSetLayeredWindowAttributes,
+  kDwmSetWindowAttribute,
+  kDwmExtendFrameIntoClientArea,
+  kSetWindowCompositionAttribute,
+  kIsWindow,
+  kIsWindowVisible,
+  kGetClassName,
+  kGetWindowThreadProcessId,
+  kGetForegroundWindow,
+  kGetActiveWindow,
+  kGetAncestor,
+  kGetWindow,
+  kGetWindowTextLength,
+  kGetClassLong,
+  kSetClassLong,
+  kScreenToClient,
+  kGetCursorPos,
+  kGetSystemMetrics,
+  kGetMonitorInfo,
+  kEnumDisplayMonitors,
+  kEnumWindows,
+  kFindWindowEx,
+  kDwmGetWindowAttribute,
+  kGetProp,
+  kSetProp,
+  kRemoveProp,
+  kGetSystemMenu,
+  kTrackPopupMenu,
+  kSetWindowSubclass,
+  kRemoveWindowSubclass,
+  kSetWindowsHookEx,
+  kUnhookWindowsHookEx,
+  kSetWinEventHook,
+  kUnhookWinEvent,
+  kSetTimer,
+  kKillTimer,
+  kRegisterClass,
+  kCreateWindowEx,
+  kDestroyWindow,
+  kShowWindowAsync,
+  kReleaseCapture,
+  kPostQuitMessage,
+  kLoadImage,
+  kCreateIconFromResourceEx,
+  kDestroyIcon,
+  kSHAppBarMessage,
+  kCount,
+};
+
+/// How expensive a call is, roughly.
+enum class Win32CallCost : uint8_t {
+  // Reads window state the system keeps anyway.
+  kQuery,
+  // Changes window state without laying the window out again.
+  kState,
+  // Recomputes the frame, moves, shows or recomposes the window.
+  kFrame,
+  // Posts or sends a message; the cost is whatever the receiver does.
+  kMessage,
+  kCount,
+};
+
+/// One recorded call. |args| holds the arguments after the window handle, in
+/// order, as far as they are scalars; the rest are zero.
+struct Win32Call {
+  Win32Api api;
+  Win32CallCost cost;
+  HWND hwnd;
+  int64_t args[5];
+};
+
+/// Argument of SetWindowCompositionAttribute, which user32 exports without
+/// declaring it.
+struct WindowCompositionAttributeData {
+  DWORD attribute;
+  PVOID data;
+  SIZE_T size;
+};
+
+/// Log of the window-system calls made by the runner and the plugins.
+///
+/// All user32, dwmapi and comctl32 calls go through the wrappers in
+/// namespace win32, which forward to the Win32Backend and, while a recording
+/// runs, append the call to a fixed-size log. Comparing the log of one
+/// operation across changes catches regressions in the number, order or cost
+/// of its calls, such as a transparency toggle growing from N calls back to
+/// 3N. When not recording a call costs one relaxed load.
+///
+/// The runner, window_manager and flutter_acrylic are separate modules. The
+/// runner exports its recorder as kExportName and the plugins look it up
+/// there, so all calls land in one log; hosted by another runner they keep
+/// their own.
+class Win32CallRecorder {
+ public:
+  static constexpr uint32_t kCapacity = 4096;
+  static constexpr const char* kExportName = "MultipleWindowsWin32CallRecorder";
+
+  static Win32CallRecorder& Instance() {
+    static Win32CallRecorder* instance = []() -> Win32CallRecorder* {
+      typedef Win32CallRecorder*(__cdecl * Getter)();
+      HMODULE exe = ::GetModuleHandleW(nullptr);
+      Getter getter =
+          exe ? reinterpret_cast<Getter>(::GetProcAddress(exe, kExportName))
+              : nullptr;
+      if (getter) {
+        return getter();
+      }
+      static Win32CallRecorder local;
+      return &local;
+    }();
+    return *instance;
+  }
+
+  static const char* ApiName(Win32Api api) {
+    static const char* const kNames[] = {
+        "GetWindowLongPtr",
+        "SetWindowLongPtr",
+        "GetWindowLong",
+        "SetWindowLong",
+        "SetWindowPos",
+        "ShowWindow",
+        "GetWindowRect",
+        "GetClientRect",
+        "GetWindowPlacement",
+        "IsZoomed",
+        "IsIconic",
+        "PostMessage",
+        "SendMessage",
+        "SetForegroundWindow",
+        "GetWindowText",
+        "SetWindowText",
+        "SetLayeredWindowAttributes",
+        "DwmSetWindowAttribute",
+        "DwmExtendFrameIntoClientArea",
+        "SetWindowCompositionAttribute",
+        "IsWindow",
+        "IsWindowVisible",
+        "GetClassName",
+        "GetWindowThreadProcessId",
+        "GetForegroundWindow",
+        "GetActiveWindow",
+        "GetAncestor",
+        "GetWindow",
+        "GetWindowTextLength",
+        "GetClassLong",
+        "SetClassLong",
+        "ScreenToClient",
+        "GetCursorPos",
+        "GetSystemMetrics",
+        "GetMonitorInfo",
+        "EnumDisplayMonitors",
+        "EnumWindows",
+        "FindWindowEx",
+        "DwmGetWindowAttribute",
+        "GetProp",
+        "SetProp",
+        "RemoveProp",
+        "GetSystemMenu",
+        "TrackPopupMenu",
+        "SetWindowSubclass",
+        "RemoveWindowSubclass",
+        "SetWindowsHookEx",
+        "UnhookWindowsHookEx",
+        "SetWinEventHook",
+        "UnhookWinEvent",
+        "SetTimer",
+        "KillTimer",
+        "RegisterClass",
+        "CreateWindowEx",
+        "DestroyWindow",
+        "ShowWindowAsync",
+        "ReleaseCapture",
+        "PostQuitMessage",
+        "LoadImage",
+        "CreateIconFromResourceEx",
+        "DestroyIcon",
+        "SHAppBarMessage",
+    };
+    static_assert(sizeof(kNames) / sizeof(kNames[0]) ==
+                      static_cast<size_t>(Win32Api::kCount),
+                  "every Win32Api needs a name");
+    return kNames[static_cast<size_t>(api)];
+  }
+
+  static const char* CostName(Win32CallCost cost) {
+    static const char* const kNames[] = {"query", "state", "frame", "message"};
+    static_assert(sizeof(kNames) / sizeof(kNames[0]) ==
+                      static_cast<size_t>(Win32CallCost::kCount),
+                  "every Win32CallCost needs a name");
+    return kNames[static_cast<size_t>(cost)];
+  }
+
+  /// Clears the log and starts recording.
+  void Start() {
+    next_.store(0, std::memory_order_relaxed);
+    recording_.store(true, std::memory_order_release);
+  }
+
+  /// Stops recording; the log stays readable until the next Start().
+  void Stop() { recording_.store(false, std::memory_order_release); }
+
+  bool recording() const {
+    return recording_.load(std::memory_order_relaxed);
+  }
+
+  void Record(Win32Api api,
+              Win32CallCost cost,
+              HWND hwnd,
+              int64_t a0 = 0,
+              int64_t a1 = 0,
+              int64_t a2 = 0,
+              int64_t a3 = 0,
+              int64_t a4 = 0) {
+    if (!recording()) {
+      return;
+    }
+    uint32_t index = next_.fetch_add(1, std::memory_order_relaxed);
+    if (index >= kCapacity) {
+      return;
+    }
+    calls_[index] = {api, cost, hwnd, {a0, a1, a2, a3, a4}};
+  }
+
+  /// Number of calls in the log.
+  uint32_t size() const {
+    uint32_t next = next_.load(std::memory_order_acquire);
+    return next < kCapacity ? next : kCapacity;
+  }
+
+  /// Calls made after the log was full.
+  uint32_t dropped() const {
+    uint32_t next = next_.load(std::memory_order_acquire);
+    return next > kCapacity ? next - kCapacity : 0;
+  }
+
+  const Win32Call& at(uint32_t index) const { return calls_[index]; }
+
+ private:
+  std::atomic<bool> recording_{false};
+  std::atomic<uint32_t> next_{0};
+  Win32Call calls_[kCapacity] = {};
+};
+
+/// The window system behind the win32 wrappers.
+///
+/// Every user32, dwmapi, comctl32 and shell32 function the runner and the
+/// plugins call is a method here, named after the wide function. The system
+/// backend forwards to the real functions; the native tests install a model
+/// of the window system instead (test/native/fake_win32_backend.h) and run
+/// the real handlers against it. Each module has its own slot, so a backend
+/// is installed per module, before the first window call.
+class Win32Backend {
+ public:
+  virtual ~Win32Backend() = default;
+
+  /// The installed backend, or the system one.
+  static Win32Backend& Current();
+
+  /// Makes |backend| current for this module; nullptr restores the system
+  /// backend. Not synchronized: install before any call is made.
+  static void Install(Win32Backend* backend) { Installed() = backend; }
+
+  virtual LONG_PTR GetWindowLongPtrW(HWND hwnd, int index) = 0;
+  virtual LONG_PTR SetWindowLongPtrW(HWND hwnd, int index, LONG_PTR value) = 0;
+  virtual LONG GetWindowLongW(HWND hwnd, int index) = 0;
+  virtual LONG SetWindowLongW(HWND hwnd, int index, LONG value) = 0;
+  virtual BOOL SetWindowPos(HWND hwnd,
+                            HWND insert_after,
+                            int x,
+                            int y,
+                            int cx,
+                            int cy,
+                            UINT flags) = 0;
+  virtual BOOL ShowWindow(HWND hwnd, int command) = 0;
+  virtual BOOL GetWindowRect(HWND hwnd, LPRECT rect) = 0;
+  virtual BOOL GetClientRect(HWND hwnd, LPRECT rect) = 0;
+  virtual BOOL GetWindowPlacement(HWND hwnd, WINDOWPLACEMENT* placement) = 0;
+  virtual BOOL IsZoomed(HWND hwnd) = 0;
+  virtual BOOL IsIconic(HWND hwnd) = 0;
+  virtual BOOL PostMessageW(HWND hwnd,
+                            UINT message,
+                            WPARAM wparam,
+                            LPARAM lparam) = 0;
+  virtual LRESULT SendMessageW(HWND hwnd,
+                               UINT message,
+                               WPARAM wparam,
+                               LPARAM lparam) = 0;
+  virtual BOOL SetForegroundWindow(HWND hwnd) = 0;
+  virtual int GetWindowTextW(HWND hwnd, LPWSTR text, int max_count) = 0;
+  virtual BOOL SetWindowTextW(HWND hwnd, LPCWSTR text) = 0;
+  virtual BOOL SetLayeredWindowAttributes(HWND hwnd,
+                                          COLORREF key,
+                                          BYTE alpha,
+                                          DWORD flags) = 0;
+  virtual HRESULT DwmSetWindowAttribute(HWND hwnd,
+                                        DWORD attribute,
+                                        LPCVOID value,
+                                        DWORD size) = 0;
+  virtual HRESULT DwmExtendFrameIntoClientArea(HWND hwnd,
+                                               const MARGINS* margins) = 0;
+  /// FALSE when user32 does not export the function.
+  virtual BOOL SetWindowCompositionAttribute(
+      HWND hwnd,
+      WindowCompositionAttributeData* data) = 0;
+  virtual BOOL IsWindow(HWND hwnd) = 0;
+  virtual BOOL IsWindowVisible(HWND hwnd) = 0;
+  virtual int GetClassNameW(HWND hwnd, LPWSTR name, int max_count) = 0;
+  virtual DWORD GetWindowThreadProcessId(HWND hwnd, LPDWORD process_id) = 0;
+  virtual HWND GetForegroundWindow() = 0;
+  virtual HWND GetActiveWindow() = 0;
+  virtual HWND GetAncestor(HWND hwnd, UINT flags) = 0;
+  virtual HWND GetWindow(HWND hwnd, UINT command) = 0;
+  virtual int GetWindowTextLengthW(HWND hwnd) = 0;
+  virtual DWORD GetClassLongW(HWND hwnd, int index) = 0;
+  virtual DWORD SetClassLongW(HWND hwnd, int index, LONG value) = 0;
+  virtual BOOL ScreenToClient(HWND hwnd, LPPOINT point) = 0;
+  virtual BOOL GetCursorPos(LPPOINT point) = 0;
+  virtual int GetSystemMetrics(int index) = 0;
+  virtual BOOL GetMonitorInfoW(HMONITOR monitor, LPMONITORINFO info) = 0;
+  virtual BOOL EnumDisplayMonitors(HDC dc,
+                                   LPCRECT clip,
+                                   MONITORENUMPROC callback,
+                                   LPARAM data) = 0;
+  virtual BOOL EnumWindows(WNDENUMPROC callback, LPARAM data) = 0;
+  virtual HWND FindWindowExW(HWND parent,
+                             HWND after,
+                             LPCWSTR class_name,
+                             LPCWSTR window_name) = 0;
+  virtual HRESULT DwmGetWindowAttribute(HWND hwnd,
+                                        DWORD attribute,
+                                        PVOID value,
+                                        DWORD size) = 0;
+  virtual HANDLE GetPropW(HWND hwnd, LPCWSTR name) = 0;
+  virtual BOOL SetPropW(HWND hwnd, LPCWSTR name, HANDLE data) = 0;
+  virtual HANDLE RemovePropW(HWND hwnd, LPCWSTR name) = 0;
+  virtual HMENU GetSystemMenu(HWND hwnd, BOOL revert) = 0;
+  virtual BOOL TrackPopupMenu(HMENU menu,
+                              UINT flags,
+                              int x,
+                              int y,
+                              int reserved,
+                              HWND hwnd,
+                              const RECT* rect) = 0;
+  virtual BOOL SetWindowSubclass(HWND hwnd,
+                                 SUBCLASSPROC proc,
+                                 UINT_PTR id,
+                                 DWORD_PTR data) = 0;
+  virtual BOOL RemoveWindowSubclass(HWND hwnd,
+                                    SUBCLASSPROC proc,
+                                    UINT_PTR id) = 0;
+  virtual HHOOK SetWindowsHookExW(int type,
+                                  HOOKPROC proc,
+                                  HINSTANCE instance,
+                                  DWORD thread_id) = 0;
+  virtual BOOL UnhookWindowsHookEx(HHOOK hook) = 0;
+  virtual HWINEVENTHOOK SetWinEventHook(DWORD event_min,
+                                        DWORD event_max,
+                                        HMODULE module,
+                                        WINEVENTPROC proc,
+                                        DWORD process_id,
+                                        DWORD thread_id,
+                                        DWORD flags) = 0;
+  virtual BOOL UnhookWinEvent(HWINEVENTHOOK hook) = 0;
+  virtual UINT_PTR SetTimer(HWND hwnd,
+                            UINT_PTR id,
+                            UINT elapse,
+                            TIMERPROC proc) = 0;
+  virtual BOOL KillTimer(HWND hwnd, UINT_PTR id) = 0;
+  virtual ATOM RegisterClassW(const WNDCLASSW* window_class) = 0;
+  virtual HWND CreateWindowExW(DWORD ex_style,
+                               LPCWSTR class_name,
+                               LPCWSTR window_name,
+                               DWORD style,
+                               int x,
+                               int y,
+                               int width,
+                               int height,
+                               HWND parent,
+                               HMENU menu,
+                               HINSTANCE instance,
+                               LPVOID param) = 0;
+  virtual BOOL DestroyWindow(HWND hwnd) = 0;
+  virtual BOOL ShowWindowAsync(HWND hwnd, int command) = 0;
+  virtual BOOL ReleaseCapture() = 0;
+  virtual void PostQuitMessage(int exit_code) = 0;
+  virtual HANDLE LoadImageW(HINSTANCE instance,
+                            LPCWSTR name,
+                            UINT type,
+                            int cx,
+                            int cy,
+                            UINT flags) = 0;
+  virtual HICON CreateIconFromResourceEx(PBYTE bits,
+                                         DWORD size,
+                                         BOOL icon,
+                                         DWORD version,
+                                         int cx,
+                                         int cy,
+                                         UINT flags) = 0;
+  virtual BOOL DestroyIcon(HICON icon) = 0;
+  virtual UINT_PTR SHAppBarMessage(DWORD message, PAPPBARDATA data) = 0;
+
+  // Message plumbing and text helpers; see the unrecorded wrappers.
+  virtual LRESULT DefWindowProcW(HWND hwnd,
+                                 UINT message,
+                                 WPARAM wparam,
+                                 LPARAM lparam) = 0;
+  virtual LRESULT CallWindowProcW(WNDPROC proc,
+                                  HWND hwnd,
+                                  UINT message,
+                                  WPARAM wparam,
+                                  LPARAM lparam) = 0;
+  virtual LRESULT DefSubclassProc(HWND hwnd,
+                                  UINT message,
+                                  WPARAM wparam,
+                                  LPARAM lparam) = 0;
+  virtual LRESULT CallNextHookEx(HHOOK hook,
+                                 int code,
+                                 WPARAM wparam,
+                                 LPARAM lparam) = 0;
+  virtual BOOL GetMessageW(LPMSG msg, HWND hwnd, UINT min, UINT max) = 0;
+  virtual BOOL PeekMessageW(LPMSG msg,
+                            HWND hwnd,
+                            UINT min,
+                            UINT max,
+                            UINT remove) = 0;
+  virtual BOOL TranslateMessage(const MSG* msg) = 0;
+  virtual LRESULT DispatchMessageW(const MSG* msg) = 0;
+  virtual DWORD MsgWaitForMultipleObjects(DWORD count,
+                                          const HANDLE* handles,
+                                          BOOL wait_all,
+                                          DWORD milliseconds,
+                                          DWORD wake_mask) = 0;
+  virtual DWORD CharLowerBuffW(LPWSTR text, DWORD length) = 0;
+
+ private:
+  static Win32Backend*& Installed() {
+    static Win32Backend* backend = nullptr;
+    return backend;
+  }
+};
+
+#ifdef _WIN32
+
+/// Forwards every call to the system.
+class SystemWin32Backend final : public Win32Backend {
+ public:
+  LONG_PTR GetWindowLongPtrW(HWND hwnd, int index) override {
+    return ::GetWindowLongPtrW(hwnd, index);
+  }
+  LONG_PTR SetWindowLongPtrW(HWND hwnd, int index, LONG_PTR value) override {
+    return ::SetWindowLongPtrW(hwnd, index, value);
+  }
+  LONG GetWindowLongW(HWND hwnd, int index) override {
+    return ::GetWindowLongW(hwnd, index);
+  }
+  LONG SetWindowLongW(HWND hwnd, int index, LONG value) override {
+    return ::SetWindowLongW(hwnd, index, value);
+  }
+  BOOL SetWindowPos(HWND hwnd,
+                    HWND insert_after,
+                    int x,
+                    int y,
+                    int cx,
+                    int cy,
+                    UINT flags) override {
+    return ::SetWindowPos(hwnd, insert_after, x, y, cx, cy, flags);
+  }
+  BOOL ShowWindow(HWND hwnd, int command) override {
+    return ::ShowWindow(hwnd, command);
+  }
+  BOOL GetWindowRect(HWND hwnd, LPRECT rect) override {
+    return ::GetWindowRect(hwnd, rect);
+  }
+  BOOL GetClientRect(HWND hwnd, LPRECT rect) override {
+    return ::GetClientRect(hwnd, rect);
+  }
+  BOOL GetWindowPlacement(HWND hwnd, WINDOWPLACEMENT* placement) override {
+    return ::GetWindowPlacement(hwnd, placement);
+  }
+  BOOL IsZoomed(HWND hwnd) override { return ::IsZoomed(hwnd); }
+  BOOL IsIconic(HWND hwnd) override { return ::IsIconic(hwnd); }
+  BOOL PostMessageW(HWND hwnd,
+                    UINT message,
+                    WPARAM wparam,
+                    LPARAM lparam) override {
+    return ::PostMessageW(hwnd, message, wparam, lparam);
+  }
+  LRESULT SendMessageW(HWND hwnd,
+                       UINT message,
+                       WPARAM wparam,
+                       LPARAM lparam) override {
+    return ::SendMessageW(hwnd, message, wparam, lparam);
+  }
+  BOOL SetForegroundWindow(HWND hwnd) override {
+    return ::SetForegroundWindow(hwnd);
+  }
+  int GetWindowTextW(HWND hwnd, LPWSTR text, int max_count) override {
+    return ::GetWindowTextW(hwnd, text, max_count);
+  }
+  BOOL SetWindowTextW(HWND hwnd, LPCWSTR text) override {
+    return ::SetWindowTextW(hwnd, text);
+  }
+  BOOL SetLayeredWindowAttributes(HWND hwnd,
+                                  COLORREF key,
+                                  BYTE alpha,
+                                  DWORD flags) override {
+    return ::SetLayeredWindowAttributes(hwnd, key, alpha, flags);
+  }
+  HRESULT DwmSetWindowAttribute(HWND hwnd,
+                                DWORD attribute,
+                                LPCVOID value,
+                                DWORD size) override {
+    return ::DwmSetWindowAttribute(hwnd, attribute, value, size);
+  }
+  HRESULT DwmExtendFrameIntoClientArea(HWND hwnd,
+                                       const MARGINS* margins) override {
+    return ::DwmExtendFrameIntoClientArea(hwnd, margins);
+  }
+  BOOL SetWindowCompositionAttribute(
+      HWND hwnd,
+      WindowCompositionAttributeData* data) override {
+    typedef BOOL(WINAPI * Function)(HWND, WindowCompositionAttributeData*);
+    // Resolved once; user32 stays loaded for the process lifetime.
+    static Function function = []() -> Function {
+      HMODULE user32 = ::GetModuleHandleW(L"user32.dll");
+      return user32 ? reinterpret_cast<Function>(::GetProcAddress(
+                          user32, "SetWindowCompositionAttribute"))
+                    : nullptr;
+    }();
+    return function ? function(hwnd, data) : FALSE;
+  }
+  BOOL IsWindow(HWND hwnd) override { return ::IsWindow(hwnd); }
+  BOOL IsWindowVisible(HWND hwnd) override { return ::IsWindowVisible(hwnd); }
+  int GetClassNameW(HWND hwnd, LPWSTR name, int max_count) override {
+    return ::GetClassNameW(hwnd, name, max_count);
+  }
+  DWORD GetWindowThreadProcessId(HWND hwnd, LPDWORD process_id) override {
+    return ::GetWindowThreadProcessId(hwnd, process_id);
+  }
+  HWND GetForegroundWindow() override { return ::GetForegroundWindow(); }
+  HWND GetActiveWindow() override { return ::GetActiveWindow(); }
+  HWND GetAncestor(HWND hwnd, UINT flags) override {
+    return ::GetAncestor(hwnd, flags);
+  }
+  HWND GetWindow(HWND hwnd, UINT command) override {
+    return ::GetWindow(hwnd, command);
+  }
+  int GetWindowTextLengthW(HWND hwnd) override {
+    return ::GetWindowTextLengthW(hwnd);
+  }
+  DWORD GetClassLongW(HWND hwnd, int index) override {
+    return ::GetClassLongW(hwnd, index);
+  }
+  DWORD SetClassLongW(HWND hwnd, int index, LONG value) override {
+    return ::SetClassLongW(hwnd, index, value);
+  }
+  BOOL ScreenToClient(HWND hwnd, LPPOINT point) override {
+    return ::ScreenToClient(hwnd, point);
+  }
+  BOOL GetCursorPos(LPPOINT point) override { return ::GetCursorPos(point); }
+  int GetSystemMetrics(int index) override {
+    return ::GetSystemMetrics(index);
+  }
+  BOOL GetMonitorInfoW(HMONITOR monitor, LPMONITORINFO info) override {
+    return ::GetMonitorInfoW(monitor, info);
+  }
+  BOOL EnumDisplayMonitors(HDC dc,
+                           LPCRECT clip,
+                           MONITORENUMPROC callback,
+                           LPARAM data) override {
+    return ::EnumDisplayMonitors(dc, clip, callback, data);
+  }
+  BOOL EnumWindows(WNDENUMPROC callback, LPARAM data) override {
+    return ::EnumWindows(callback, data);
+  }
+  HWND FindWindowExW(HWND parent,
+                     HWND after,
+                     LPCWSTR class_name,
+                     LPCWSTR window_name) override {
+    return ::FindWindowExW(parent, after, class_name, window_name);
+  }
+  HRESULT DwmGetWindowAttribute(HWND hwnd,
+                                DWORD attribute,
+                                PVOID value,
+                                DWORD size) override {
+    return ::DwmGetWindowAttribute(hwnd, attribute, value, size);
+  }
+  HANDLE GetPropW(HWND hwnd, LPCWSTR name) override {
+    return ::GetPropW(hwnd, name);
+  }
+  BOOL SetPropW(HWND hwnd, LPCWSTR name, HANDLE data) override {
+    return ::SetPropW(hwnd, name, data);
+  }
+  HANDLE RemovePropW(HWND hwnd, LPCWSTR name) override {
+    return ::RemovePropW(hwnd, name);
+  }
+  HMENU GetSystemMenu(HWND hwnd, BOOL revert) override {
+    return ::GetSystemMenu(hwnd, revert);
+  }
+  BOOL TrackPopupMenu(HMENU menu,
+                      UINT flags,
+                      int x,
+                      int y,
+                      int reserved,
+                      HWND hwnd,
+                      const RECT* rect) override {
+    return ::TrackPopupMenu(menu, flags, x, y, reserved, hwnd, rect);
+  }
+  BOOL SetWindowSubclass(HWND hwnd,
+                         SUBCLASSPROC proc,
+                         UINT_PTR id,
+                         DWORD_PTR data) override {
+    return ::SetWindowSubclass(hwnd, proc, id, data);
+  }
+  BOOL RemoveWindowSubclass(HWND hwnd,
+                            SUBCLASSPROC proc,
+                            UINT_PTR id) override {
+    return ::RemoveWindowSubclass(hwnd, proc, id);
+  }
+  HHOOK SetWindowsHookExW(int type,
+                          HOOKPROC proc,
+                          HINSTANCE instance,
+                          DWORD thread_id) override {
+    return ::SetWindowsHookExW(type, proc, instance, thread_id);
+  }
+  BOOL UnhookWindowsHookEx(HHOOK hook) override {
+    return ::UnhookWindowsHookEx(hook);
+  }
+  HWINEVENTHOOK SetWinEventHook(DWORD event_min,
+                                DWORD event_max,
+                                HMODULE module,
+                                WINEVENTPROC proc,
+                                DWORD process_id,
+                                DWORD thread_id,
+                                DWORD flags) override {
+    return ::SetWinEventHook(event_min, event_max, module, proc, process_id,
+                             thread_id, flags);
+  }
+  BOOL UnhookWinEvent(HWINEVENTHOOK hook) override {
+    return ::UnhookWinEvent(hook);
+  }
+  UINT_PTR SetTimer(HWND hwnd, UINT_PTR id, UINT elapse, TIMERPROC proc)
+      override {
+    return ::SetTimer(hwnd, id, elapse, proc);
+  }
+  BOOL KillTimer(HWND hwnd, UINT_PTR id) override {
+    return ::KillTimer(hwnd, id);
+  }
+  ATOM RegisterClassW(const WNDCLASSW* window_class) override {
+    return ::RegisterClassW(window_class);
+  }
+  HWND CreateWindowExW(DWORD ex_style,
+                       LPCWSTR class_name,
+                       LPCWSTR window_name,
+                       DWORD style,
+                       int x,
+                       int y,
+                       int width,
+                       int height,
+                       HWND parent,
+                       HMENU menu,
+                       HINSTANCE instance,
+                       LPVOID param) override {
+    return ::CreateWindowExW(ex_style, class_name, window_name, style, x, y,
+                             width, height, parent, menu, instance, param);
+  }
+  BOOL DestroyWindow(HWND hwnd) override { return ::DestroyWindow(hwnd); }
+  BOOL ShowWindowAsync(HWND hwnd, int command) override {
+    return ::ShowWindowAsync(hwnd, command);
+  }
+  BOOL ReleaseCapture() override { return ::ReleaseCapture(); }
+  void PostQuitMessage(int exit_code) override {
+    ::PostQuitMessage(exit_code);
+  }
+  HANDLE LoadImageW(HINSTANCE instance,
+                    LPCWSTR name,
+                    UINT type,
+                    int cx,
+                    int cy,
+                    UINT flags) override {
+    return ::LoadImageW(instance, name, type, cx, cy, flags);
+  }
+  HICON CreateIconFromResourceEx(PBYTE bits,
+                                 DWORD size,
+                                 BOOL icon,
+                                 DWORD version,
+                                 int cx,
+                                 int cy,
+                                 UINT flags) override {
+    return ::CreateIconFromResourceEx(bits, size, icon, version, cx, cy,
+                                      flags);
+  }
+  BOOL DestroyIcon(HICON icon) override { return ::DestroyIcon(icon); }
+  UINT_PTR SHAppBarMessage(DWORD message, PAPPBARDATA data) override {
+    return ::SHAppBarMessage(message, data);
+  }
+  LRESULT DefWindowProcW(HWND hwnd,
+                         UINT message,
+                         WPARAM wparam,
+                         LPARAM lparam) override {
+    return ::DefWindowProcW(hwnd, message, wparam, lparam);
+  }
+  LRESULT CallWindowProcW(WNDPROC proc,
+                          HWND hwnd,
+                          UINT message,
+                          WPARAM wparam,
+                          LPARAM lparam) override {
+    return ::CallWindowProcW(proc, hwnd, message, wparam, lparam);
+  }
+  LRESULT DefSubclassProc(HWND hwnd,
+                          UINT message,
+                          WPARAM wparam,
+                          LPARAM lparam) override {
+    return ::DefSubclassProc(hwnd, message, wparam, lparam);
+  }
+  LRESULT CallNextHookEx(HHOOK hook,
+                         int code,
+                         WPARAM wparam,
+                         LPARAM lparam) override {
+    return ::CallNextHookEx(hook, code, wparam, lparam);
+  }
+  BOOL GetMessageW(LPMSG msg, HWND hwnd, UINT min, UINT max) override {
+    return ::GetMessageW(msg, hwnd, min, max);
+  }
+  BOOL PeekMessageW(LPMSG msg, HWND hwnd, UINT min, UINT max, UINT remove)
+      override {
+    return ::PeekMessageW(msg, hwnd, min, max, remove);
+  }
+  BOOL TranslateMessage(const MSG* msg) override {
+    return ::TranslateMessage(msg);
+  }
+  LRESULT DispatchMessageW(const MSG* msg) override {
+    return ::DispatchMessageW(msg);
+  }
+  DWORD MsgWaitForMultipleObjects(DWORD count,
+                                  const HANDLE* handles,
+                                  BOOL wait_all,
+                                  DWORD milliseconds,
+                                  DWORD wake_mask) override {
+    return ::MsgWaitForMultipleObjects(count, handles, wait_all, milliseconds,
+                                       wake_mask);
+  }
+  DWORD CharLowerBuffW(LPWSTR text, DWORD length) override {
+    return ::CharLowerBuffW(text, length);
+  }
+};
+
+#endif  // _WIN32
+
+inline Win32Backend& Win32Backend::Current() {
+  if (Win32Backend* backend = Installed()) {
+    return *backend;
+  }
+#ifdef _WIN32
+  static SystemWin32Backend system;
+  return system;
+#else
+  // Only the native tests build elsewhere, and they install a backend.
+  std::abort();
+#endif
+}
+
+/// Recording wrappers, named after the functions they forward to. The
+/// generic-text macros (SetWindowLongPtr, PostMessage, ...) resolve to the
+/// wide names, so call sites read win32::SetWindowLongPtr(...).
+namespace win32 {
+
+inline void Record(Win32Api api,
+                   Win32CallCost cost,
+                   HWND hwnd,
+                   int64_t a0 = 0,
+                   int64_t a1 = 0,
+                   int64_t a2 = 0,
+                   int64_t a3 = 0,
+                   int64_t a4 = 0) {
+  Win32CallRecorder::Instance().Record(api, cost, hwnd, a0, a1, a2, a3, a4);
+}
+
+inline Win32Backend& Backend() {
+  return Win32Backend::Current();
+}
+
+inline LONG_PTR GetWindowLongPtrW(HWND hwnd, int index) {
+  Record(Win32Api::kGetWindowLongPtr, Win32CallCost::kQuery, hwnd, index);
+  return Backend().GetWindowLongPtrW(hwnd, index);
+}
+
+inline LONG_PTR SetWindowLongPtrW(HWND hwnd, int index, LONG_PTR value) {
+  Record(Win32Api::kSetWindowLongPtr, Win32CallCost::kState, hwnd, index,
+         value);
+  return Backend().SetWindowLongPtrW(hwnd, index, value);
+}
+
+inline LONG GetWindowLongW(HWND hwnd, int index) {
+  Record(Win32Api::kGetWindowLong, Win32CallCost::kQuery, hwnd, index);
+  return Backend().GetWindowLongW(hwnd, index);
+}
+
+inline LONG SetWindowLongW(HWND hwnd, int index, LONG value) {
+  Record(Win32Api::kSetWindowLong, Win32CallCost::kState, hwnd, index, value);
+  return Backend().SetWindowLongW(hwnd, index, value);
+}
+
+inline BOOL SetWindowPos(HWND hwnd,
+                         HWND insert_after,
+                         int x,
+                         int y,
+                         int cx,
+                         int cy,
+                         UINT flags) {
+  Record(Win32Api::kSetWindowPos, Win32CallCost::kFrame, hwnd, x, y, cx, cy,
+         flags);
+  return Backend().SetWindowPos(hwnd, insert_after, x, y, cx, cy, flags);
+}
+
+inline BOOL ShowWindow(HWND hwnd, int command) {
+  Record(Win32Api::kShowWindow, Win32CallCost::kFrame, hwnd, command);
+  return Backend().ShowWindow(hwnd, command);
+}
+
+inline BOOL GetWindowRect(HWND hwnd, LPRECT rect) {
+  Record(Win32Api::kGetWindowRect, Win32CallCost::kQuery, hwnd);
+  return Backend().GetWindowRect(hwnd, rect);
+}
+
+inline BOOL GetClientRect(HWND hwnd, LPRECT rect) {
+  Record(Win32Api::kGetClientRect, Win32CallCost::kQuery, hwnd);
+  return Backend().GetClientRect(hwnd, rect);
+}
+
+inline BOOL GetWindowPlacement(HWND hwnd, WINDOWPLACEMENT* placement) {
+  Record(Win32Api::kGetWindowPlacement, Win32CallCost::kQuery, hwnd);
+  return Backend().GetWindowPlacement(hwnd, placement);
+}
+
+inline BOOL IsZoomed(HWND hwnd) {
+  Record(Win32Api::kIsZoomed, Win32CallCost::kQuery, hwnd);
+  return Backend().IsZoomed(hwnd);
+}
+
+inline BOOL IsIconic(HWND hwnd) {
+  Record(Win32Api::kIsIconic, Win32CallCost::kQuery, hwnd);
+  return Backend().IsIconic(hwnd);
+}
+
+inline BOOL PostMessageW(HWND hwnd,
+                         UINT message,
+                         WPARAM wparam,
+                         LPARAM lparam) {
+  Record(Win32Api::kPostMessage, Win32CallCost::kMessage, hwnd, message,
+         static_cast<int64_t>(wparam), lparam);
+  return Backend().PostMessageW(hwnd, message, wparam, lparam);
+}
+
+inline LRESULT SendMessageW(HWND hwnd,
+                            UINT message,
+                            WPARAM wparam,
+                            LPARAM lparam) {
+  Record(Win32Api::kSendMessage, Win32CallCost::kMessage, hwnd, message,
+         static_cast<int64_t>(wparam), lparam);
+  return Backend().SendMessageW(hwnd, message, wparam, lparam);
+}
+
+inline BOOL SetForegroundWindow(HWND hwnd) {
+  Record(Win32Api::kSetForegroundWindow, Win32CallCost::kState, hwnd);
+  return Backend().SetForegroundWindow(hwnd);
+}
+
+inline int GetWindowTextW(HWND hwnd, LPWSTR text, int max_count) {
+  // Sends WM_GETTEXT to windows of this process.
+  Record(Win32Api::kGetWindowText, Win32CallCost::kMessage, hwnd, max_count);
+  return Backend().GetWindowTextW(hwnd, text, max_count);
+}
+
+inline BOOL SetWindowTextW(HWND hwnd, LPCWSTR text) {
+  Record(Win32Api::kSetWindowText, Win32CallCost::kMessage, hwnd);
+  return Backend().SetWindowTextW(hwnd, text);
+}
+
+inline BOOL SetLayeredWindowAttributes(HWND hwnd,
+                                       COLORREF key,
+                                       BYTE alpha,
+                                       DWORD flags) {
+  Record(Win32Api::kSetLayeredWindowAttributes, Win32CallCost::kState, hwnd,
+         key, alpha, flags);
+  return Backend().SetLayeredWindowAttributes(hwnd, key, alpha, flags);
+}
+
+inline HRESULT DwmSetWindowAttribute(HWND hwnd,
+                                     DWORD attribute,
+                                     LPCVOID value,
+                                     DWORD size) {
+  // The first four bytes of the value cover every attribute used here.
+  int64_t first = 0;
+  if (value && size >= sizeof(DWORD)) {
+    first = *static_cast<const DWORD*>(value);
+  }
+  Record(Win32Api::kDwmSetWindowAttribute, Win32CallCost::kState, hwnd,
+         attribute, first, size);
+  return Backend().DwmSetWindowAttribute(hwnd, attribute, value, size);
+}
+
+inline HRESULT DwmExtendFrameIntoClientArea(HWND hwnd, const MARGINS* margins) {
+  Record(Win32Api::kDwmExtendFrameIntoClientArea, Win32CallCost::kFrame, hwnd,
+         margins->cxLeftWidth, margins->cxRightWidth, margins->cyTopHeight,
+         margins->cyBottomHeight);
+  return Backend().DwmExtendFrameIntoClientArea(hwnd, margins);
+}
+
+inline BOOL SetWindowCompositionAttribute(HWND hwnd,
+                                          WindowCompositionAttributeData* data) {
+  // The first three DWORDs of the value: state, flags and color of an
+  // accent policy.
+  int64_t fields[3] = {};
+  const DWORD* value = static_cast<const DWORD*>(data->data);
+  for (size_t i = 0; i < 3 && (i + 1) * sizeof(DWORD) <= data->size; ++i) {
+    fields[i] = value[i];
+  }
+  Record(Win32Api::kSetWindowCompositionAttribute, Win32CallCost::kFrame, hwnd,
+         data->attribute, fields[0], fields[1], fields[2]);
+  return Backend().SetWindowCompositionAttribute(hwnd, data);
+}
+
+inline BOOL IsWindow(HWND hwnd) {
+  Record(Win32Api::kIsWindow, Win32CallCost::kQuery, hwnd);
+  return Backend().IsWindow(hwnd);
+}
+
+inline BOOL IsWindowVisible(HWND hwnd) {
+  Record(Win32Api::kIsWindowVisible, Win32CallCost::kQuery, hwnd);
+  return Backend().IsWindowVisible(hwnd);
+}
+
+inline int GetClassNameW(HWND hwnd, LPWSTR name, int max_count) {
+  Record(Win32Api::kGetClassName, Win32CallCost::kQuery, hwnd, max_count);
+  return Backend().GetClassNameW(hwnd, name, max_count);
+}
+
+inline DWORD GetWindowThreadProcessId(HWND hwnd, LPDWORD process_id) {
+  Record(Win32Api::kGetWindowThreadProcessId, Win32CallCost::kQuery, hwnd);
+  return Backend().GetWindowThreadProcessId(hwnd, process_id);
+}
+
+inline HWND GetForegroundWindow() {
+  Record(Win32Api::kGetForegroundWindow, Win32CallCost::kQuery, nullptr);
+  return Backend().GetForegroundWindow();
+}
+
+inline HWND GetActiveWindow() {
+  Record(Win32Api::kGetActiveWindow, Win32CallCost::kQuery, nullptr);
+  return Backend().GetActiveWindow();
+}
+
+inline HWND GetAncestor(HWND hwnd, UINT flags) {
+  Record(Win32Api::kGetAncestor, Win32CallCost::kQuery, hwnd, flags);
+  return Backend().GetAncestor(hwnd, flags);
+}
+
+inline HWND GetWindow(HWND hwnd, UINT command) {
+  Record(Win32Api::kGetWindow, Win32CallCost::kQuery, hwnd, command);
+  return Backend().GetWindow(hwnd, command);
+}
+
+inline int GetWindowTextLengthW(HWND hwnd) {
+  // Sends WM_GETTEXTLENGTH to windows of this process.
+  Record(Win32Api::kGetWindowTextLength, Win32CallCost::kMessage, hwnd);
+  return Backend().GetWindowTextLengthW(hwnd);
+}
+
+inline DWORD GetClassLongW(HWND hwnd, int index) {
+  Record(Win32Api::kGetClassLong, Win32CallCost::kQuery, hwnd, index);
+  return Backend().GetClassLongW(hwnd, index);
+}
+
+inline DWORD SetClassLongW(HWND hwnd, int index, LONG value) {
+  Record(Win32Api::kSetClassLong, Win32CallCost::kState, hwnd, index, value);
+  return Backend().SetClassLongW(hwnd, index, value);
+}
+
+inline BOOL ScreenToClient(HWND hwnd, LPPOINT point) {
+  Record(Win32Api::kScreenToClient, Win32CallCost::kQuery, hwnd, point->x,
+         point->y);
+  return Backend().ScreenToClient(hwnd, point);
+}
+
+inline BOOL GetCursorPos(LPPOINT point) {
+  Record(Win32Api::kGetCursorPos, Win32CallCost::kQuery, nullptr);
+  return Backend().GetCursorPos(point);
+}
+
+inline int GetSystemMetrics(int index) {
+  Record(Win32Api::kGetSystemMetrics, Win32CallCost::kQuery, nullptr, index);
+  return Backend().GetSystemMetrics(index);
+}
+
+inline BOOL GetMonitorInfoW(HMONITOR monitor, LPMONITORINFO info) {
+  Record(Win32Api::kGetMonitorInfo, Win32CallCost::kQuery, nullptr,
+         reinterpret_cast<intptr_t>(monitor));
+  return Backend().GetMonitorInfoW(monitor, info);
+}
+
+inline BOOL EnumDisplayMonitors(HDC dc,
+                                LPCRECT clip,
+                                MONITORENUMPROC callback,
+                                LPARAM data) {
+  Record(Win32Api::kEnumDisplayMonitors, Win32CallCost::kQuery, nullptr);
+  return Backend().EnumDisplayMonitors(dc, clip, callback, data);
+}
+
+inline BOOL EnumWindows(WNDENUMPROC callback, LPARAM data) {
+  Record(Win32Api::kEnumWindows, Win32CallCost::kQuery, nullptr);
+  return Backend().EnumWindows(callback, data);
+}
+
+inline HWND FindWindowExW(HWND parent,
+                          HWND after,
+                          LPCWSTR class_name,
+                          LPCWSTR window_name) {
+  Record(Win32Api::kFindWindowEx, Win32CallCost::kQuery, parent,
+         reinterpret_cast<intptr_t>(after));
+  return Backend().FindWindowExW(parent, after, class_name, window_name);
+}
+
+inline HRESULT DwmGetWindowAttribute(HWND hwnd,
+                                     DWORD attribute,
+                                     PVOID value,
+                                     DWORD size) {
+  Record(Win32Api::kDwmGetWindowAttribute, Win32CallCost::kQuery, hwnd,
+         attribute, size);
+  return Backend().DwmGetWindowAttribute(hwnd, attribute, value, size);
+}
+
+inline HANDLE GetPropW(HWND hwnd, LPCWSTR name) {
+  Record(Win32Api::kGetProp, Win32CallCost::kQuery, hwnd);
+  return Backend().GetPropW(hwnd, name);
+}
+
+inline BOOL SetPropW(HWND hwnd, LPCWSTR name, HANDLE data) {
+  Record(Win32Api::kSetProp, Win32CallCost::kState, hwnd);
+  return Backend().SetPropW(hwnd, name, data);
+}
+
+inline HANDLE RemovePropW(HWND hwnd, LPCWSTR name) {
+  Record(Win32Api::kRemoveProp, Win32CallCost::kState, hwnd);
+  return Backend().RemovePropW(hwnd, name);
+}
+
+inline HMENU GetSystemMenu(HWND hwnd, BOOL revert) {
+  Record(Win32Api::kGetSystemMenu, Win32CallCost::kQuery, hwnd, revert);
+  return Backend().GetSystemMenu(hwnd, revert);
+}
+
+inline BOOL TrackPopupMenu(HMENU menu,
+                           UINT flags,
+                           int x,
+                           int y,
+                           int reserved,
+                           HWND hwnd,
+                           const RECT* rect) {
+  // Runs a modal menu loop until the menu is dismissed.
+  Record(Win32Api::kTrackPopupMenu, Win32CallCost::kMessage, hwnd, flags, x, y);
+  return Backend().TrackPopupMenu(menu, flags, x, y, reserved, hwnd, rect);
+}
+
+inline BOOL SetWindowSubclass(HWND hwnd,
+                              SUBCLASSPROC proc,
+                              UINT_PTR id,
+                              DWORD_PTR data) {
+  Record(Win32Api::kSetWindowSubclass, Win32CallCost::kState, hwnd,
+         static_cast<int64_t>(id));
+  return Backend().SetWindowSubclass(hwnd, proc, id, data);
+}
+
+inline BOOL RemoveWindowSubclass(HWND hwnd, SUBCLASSPROC proc, UINT_PTR id) {
+  Record(Win32Api::kRemoveWindowSubclass, Win32CallCost::kState, hwnd,
+         static_cast<int64_t>(id));
+  return Backend().RemoveWindowSubclass(hwnd, proc, id);
+}
+
+inline HHOOK SetWindowsHookExW(int type,
+                               HOOKPROC proc,
+                               HINSTANCE instance,
+                               DWORD thread_id) {
+  Record(Win32Api::kSetWindowsHookEx, Win32CallCost::kState, nullptr, type,
+         thread_id);
+  return Backend().SetWindowsHookExW(type, proc, instance, thread_id);
+}
+
+inline BOOL UnhookWindowsHookEx(HHOOK hook) {
+  Record(Win32Api::kUnhookWindowsHookEx, Win32CallCost::kState, nullptr);
+  return Backend().UnhookWindowsHookEx(hook);
+}
+
+inline HWINEVENTHOOK SetWinEventHook(DWORD event_min,
+                                     DWORD event_max,
+                                     HMODULE module,
+                                     WINEVENTPROC proc,
+                                     DWORD process_id,
+                                     DWORD thread_id,
+                                     DWORD flags) {
+  Record(Win32Api::kSetWinEventHook, Win32CallCost::kState, nullptr, event_min,
+         event_max, process_id, thread_id, flags);
+  return Backend().SetWinEventHook(event_min, event_max, module, proc,
+                                   process_id, thread_id, flags);
+}
+
+inline BOOL UnhookWinEvent(HWINEVENTHOOK hook) {
+  Record(Win32Api::kUnhookWinEvent, Win32CallCost::kState, nullptr);
+  return Backend().UnhookWinEvent(hook);
+}
+
+inline UINT_PTR SetTimer(HWND hwnd, UINT_PTR id, UINT elapse, TIMERPROC proc) {
+  Record(Win32Api::kSetTimer, Win32CallCost::kState, hwnd,
+         static_cast<int64_t>(id), elapse);
+  return Backend().SetTimer(hwnd, id, elapse, proc);
+}
+
+inline BOOL KillTimer(HWND hwnd, UINT_PTR id) {
+  Record(Win32Api::kKillTimer, Win32CallCost::kState, hwnd,
+         static_cast<int64_t>(id));
+  return Backend().KillTimer(hwnd, id);
+}
+
+inline ATOM RegisterClassW(const WNDCLASSW* window_class) {
+  Record(Win32Api::kRegisterClass, Win32CallCost::kState, nullptr,
+         window_class->style);
+  return Backend().RegisterClassW(window_class);
+}
+
+inline HWND CreateWindowExW(DWORD ex_style,
+                            LPCWSTR class_name,
+                            LPCWSTR window_name,
+                            DWORD style,
+                            int x,
+                            int y,
+                            int width,
+                            int height,
+                            HWND parent,
+                            HMENU menu,
+                            HINSTANCE instance,
+                            LPVOID param) {
+  // Sends WM_NCCREATE, WM_NCCALCSIZE and WM_CREATE before it returns.
+  Record(Win32Api::kCreateWindowEx, Win32CallCost::kFrame, parent, ex_style,
+         style, x, y);
+  return Backend().CreateWindowExW(ex_style, class_name, window_name, style, x,
+                                   y, width, height, parent, menu, instance,
+                                   param);
+}
+
+inline BOOL DestroyWindow(HWND hwnd) {
+  Record(Win32Api::kDestroyWindow, Win32CallCost::kFrame, hwnd);
+  return Backend().DestroyWindow(hwnd);
+}
+
+inline BOOL ShowWindowAsync(HWND hwnd, int command) {
+  Record(Win32Api::kShowWindowAsync, Win32CallCost::kFrame, hwnd, command);
+  return Backend().ShowWindowAsync(hwnd, command);
+}
+
+inline BOOL ReleaseCapture() {
+  Record(Win32Api::kReleaseCapture, Win32CallCost::kState, nullptr);
+  return Backend().ReleaseCapture();
+}
+
+inline void PostQuitMessage(int exit_code) {
+  Record(Win32Api::kPostQuitMessage, Win32CallCost::kMessage, nullptr,
+         exit_code);
+  Backend().PostQuitMessage(exit_code);
+}
+
+inline HANDLE LoadImageW(HINSTANCE instance,
+                         LPCWSTR name,
+                         UINT type,
+                         int cx,
+                         int cy,
+                         UINT flags) {
+  Record(Win32Api::kLoadImage, Win32CallCost::kState, nullptr, type, cx, cy,
+         flags);
+  return Backend().LoadImageW(instance, name, type, cx, cy, flags);
+}
+
+inline HICON CreateIconFromResourceEx(PBYTE bits,
+                                      DWORD size,
+                                      BOOL icon,
+                                      DWORD version,
+                                      int cx,
+                                      int cy,
+                                      UINT flags) {
+  Record(Win32Api::kCreateIconFromResourceEx, Win32CallCost::kState, nullptr,
+         size, cx, cy, flags);
+  return Backend().CreateIconFromResourceEx(bits, size, icon, version, cx, cy,
+                                            flags);
+}
+
+inline BOOL DestroyIcon(HICON icon) {
+  Record(Win32Api::kDestroyIcon, Win32CallCost::kState, nullptr);
+  return Backend().DestroyIcon(icon);
+}
+
+inline UINT_PTR SHAppBarMessage(DWORD message, PAPPBARDATA data) {
+  Record(Win32Api::kSHAppBarMessage, Win32CallCost::kMessage, data->hWnd,
+         message, data->uEdge);
+  return Backend().SHAppBarMessage(message, data);
+}
+
+// Message plumbing: the message loop, default and subclass procedures and
+// hook chaining. It goes through the backend but is never recorded, since it
+// runs for every message and would bury the calls operations make.
+
+inline LRESULT DefWindowProcW(HWND hwnd,
+                              UINT message,
+                              WPARAM wparam,
+                              LPARAM lparam) {
+  return Backend().DefWindowProcW(hwnd, message, wparam, lparam);
+}
+
+inline LRESULT CallWindowProcW(WNDPROC proc,
+                               HWND hwnd,
+                               UINT message,
+                               WPARAM wparam,
+                               LPARAM lparam) {
+  return Backend().CallWindowProcW(proc, hwnd, message, wparam, lparam);
+}
+
+inline LRESULT DefSubclassProc(HWND hwnd,
+                               UINT message,
+                               WPARAM wparam,
+                               LPARAM lparam) {
+  return Backend().DefSubclassProc(hwnd, message, wparam, lparam);
+}
+
+inline LRESULT CallNextHookEx(HHOOK hook,
+                              int code,
+                              WPARAM wparam,
+                              LPARAM lparam) {
+  return Backend().CallNextHookEx(hook, code, wparam, lparam);
+}
+
+inline BOOL GetMessageW(LPMSG msg, HWND hwnd, UINT min, UINT max) {
+  return Backend().GetMessageW(msg, hwnd, min, max);
+}
+
+inline BOOL PeekMessageW(LPMSG msg,
+                         HWND hwnd,
+                         UINT min,
+                         UINT max,
+                         UINT remove) {
+  return Backend().PeekMessageW(msg, hwnd, min, max, remove);
+}
+
+inline BOOL TranslateMessage(const MSG* msg) {
+  return Backend().TranslateMessage(msg);
+}
+
+inline LRESULT DispatchMessageW(const MSG* msg) {
+  return Backend().DispatchMessageW(msg);
+}
+
+inline DWORD MsgWaitForMultipleObjects(DWORD count,
+                                       const HANDLE* handles,
+                                       BOOL wait_all,
+                                       DWORD milliseconds,
+                                       DWORD wake_mask) {
+  return Backend().MsgWaitForMultipleObjects(count, handles, wait_all,
+                                             milliseconds, wake_mask);
+}
+
+// Text helper; no window state involved.
+inline DWORD CharLowerBuffW(LPWSTR text, DWORD length) {
+  return Backend().CharLowerBuffW(text, length);
+}
+
+}  // namespace win32
+
+#endif  // MULTIPLE_WINDOWS_WIN32_CALLS_H_
@@ -5,6 +5,7 @@
 
 #include <Windows.h>
 
+#include <commctrl.h>
 #include <shobjidl_core.h>
 
 #include <flutter/method_channel.h>
@@ -12,11 +13,23 @@
 #include <flutter/standard_method_codec.h>
 
 #include <dwmapi.h>
-#include <codecvt>
 #include <map>
 #include <memory>
+#include <optional>
 #include <sstream>
 
+#include "composition_engine.h"
+#include "edge_snap.h"
+#include "hit_test_map.h"
+#include "icon_cache.h"
+#include "monitor_cache.h"
+#include "nc_insets.h"
+#include "size_constraints.h"
+#include "taskbar_worker.h"
+#include "utf_transcode.h"
+#include "win32_calls.h"
+
+#pragma comment(lib, "comctl32.lib")
 #pragma comment(lib, "dwmapi.lib")
 #pragma comment(lib, "user32.lib")
 #pragma comment(lib, "shcore.lib")
@@ -28,16 +41,6 @@
 #define STATE_FULLSCREEN_ENTERED 3
 #define STATE_DOCKED 4
 
-/// Window attribute that enables dark mode window decorations.
-///
-/// Redefined in case the developer's machine has a Windows SDK older than
-/// version 10.0.22000.0.
-/// See:
-/// https://docs.microsoft.com/windows/win32/api/dwmapi/ne-dwmapi-dwmwindowattribute
-#ifndef DWMWA_USE_IMMERSIVE_DARK_MODE
-#define DWMWA_USE_IMMERSIVE_DARK_MODE 20
-#endif
-
 constexpr const wchar_t kWindowClassName[] = L"FLUTTER_RUNNER_WIN32_WINDOW";
 
 /// Registry key for app theme preference.
@@ -62,13 +65,33 @@ const flutter::EncodableValue* ValueOrNull(const flutter::EncodableMap& map,
   return &(it->second);
 }
 
+// Maps the hit-test region types accepted by setHitTestRegions to HT* codes,
+// or -1 for an unknown type.
+int32_t HitTestCodeFromType(const std::string& type) {
+  static const std::map<std::string, int32_t> kCodes = {
+      {"client", HTCLIENT},         {"caption", HTCAPTION},
+      {"maxButton", HTMAXBUTTON},   {"left", HTLEFT},
+      {"right", HTRIGHT},           {"top", HTTOP},
+      {"topLeft", HTTOPLEFT},       {"topRight", HTTOPRIGHT},
+      {"bottom", HTBOTTOM},         {"bottomLeft", HTBOTTOMLEFT},
+      {"bottomRight", HTBOTTOMRIGHT},
+  };
+  auto it = kCodes.find(type);
+  return it == kCodes.end() ? -1 : it->second;
+}
+
+// Whether |code| is one of the resize border codes, HTLEFT to HTBOTTOMRIGHT.
+bool IsResizeBorderHitTestCode(int32_t code) {
+  return code >= HTLEFT && code <= HTBOTTOMRIGHT;
+}
+
 class WindowManager {
  public:
   WindowManager();
 
   virtual ~WindowManager();
 
-  HWND native_window;
+  HWND native_window = nullptr;
 
   int last_state = STATE_NORMAL;
 
@@ -76,83 +99,125 @@ class WindowManager {
   bool is_always_on_bottom_ = false;
   bool is_frameless_ = false;
   bool is_prevent_close_ = false;
-  double aspect_ratio_ = 0;
-  POINT minimum_size_ = {0, 0};
-  POINT maximum_size_ = {-1, -1};
+  // Minimum/maximum size, aspect ratio, step and grid constraints in logical
+  // pixels, and their compiled form that WM_SIZING and WM_GETMINMAXINFO apply.
+  SizeConstraintSpec size_constraint_spec_;
+  SizeConstraints size_constraints_;
   double pixel_ratio_ = 1;
+  // Magnetic snapping of WM_MOVING to other app windows and work areas, in
+  // logical pixels; 0 disables it.
+  double snap_distance_ = 0;
+  EdgeSnapIndex snap_index_;
+  // Invisible resize borders of this window, so snapping uses visible edges.
+  RECT snap_frame_inset_ = {0, 0, 0, 0};
+  // Title bar and resize border regions registered from Dart, in logical
+  // client coordinates, and the index WM_NCHITTEST is answered from.
+  std::vector<HitTestRegionSpec> hit_test_regions_;
+  HitTestMap hit_test_map_;
+  // Icon source set by SetIcon (a file path or .ico/.png bytes) and the
+  // pinned IconCache entries currently set on the window.
+  std::wstring icon_path_;
+  std::vector<uint8_t> icon_bytes_;
+  uint64_t icon_bytes_hash_ = 0;
+  HICON icon_small_ = nullptr;
+  HICON icon_big_ = nullptr;
   bool is_resizable_ = true;
+  // Reused for UTF-8 <-> UTF-16 conversions of titles.
+  std::wstring wide_buffer_;
+  // The window text in UTF-8, kept current from WM_SETTEXT so GetTitle does
+  // not have to query the window.
+  std::string title_;
+  bool has_title_ = false;
   int is_docked_ = 0;
   bool is_registered_for_docking_ = false;
   bool is_skip_taskbar_ = true;
   std::string title_bar_style_ = "normal";
   double opacity_ = 1;
+  bool is_windows_11_or_greater_ = false;
+
+  // WM_NCCALCSIZE answer, recomputed by RefreshNcInsets() whenever the frame
+  // mode, fullscreen, the maximized state or the monitor changes.
+  NcFrameMode nc_frame_mode_ = NcFrameMode::kNormal;
+  bool nc_maximized_ = false;
+  NcInsets nc_insets_;
 
   bool is_resizing_ = false;
   bool is_moving_ = false;
 
   HWND GetMainWindow();
-  void WindowManager::ForceRefresh();
-  void WindowManager::ForceChildRefresh();
-  void WindowManager::SetAsFrameless();
-  void WindowManager::WaitUntilReadyToShow();
-  void WindowManager::Destroy();
-  void WindowManager::Close();
-  bool WindowManager::IsPreventClose();
-  void WindowManager::SetPreventClose(const flutter::EncodableMap& args);
-  void WindowManager::Focus();
-  void WindowManager::Blur();
-  bool WindowManager::IsFocused();
-  void WindowManager::Show();
-  void WindowManager::Hide();
-  bool WindowManager::IsVisible();
-  bool WindowManager::IsMaximized();
-  void WindowManager::Maximize(const flutter::EncodableMap& args);
-  void WindowManager::Unmaximize();
-  bool WindowManager::IsMinimized();
-  void WindowManager::Minimize();
-  void WindowManager::Restore();
-  bool WindowManager::IsDockable();
-  int WindowManager::IsDocked();
-  void WindowManager::Dock(const flutter::EncodableMap& args);
-  bool WindowManager::Undock();
-  bool WindowManager::IsFullScreen();
-  void WindowManager::SetFullScreen(const flutter::EncodableMap& args);
-  void WindowManager::SetAspectRatio(const flutter::EncodableMap& args);
-  void WindowManager::SetBackgroundColor(const flutter::EncodableMap& args);
-  flutter::EncodableMap WindowManager::GetBounds(
-      const flutter::EncodableMap& args);
-  void WindowManager::SetBounds(const flutter::EncodableMap& args);
-  void WindowManager::SetMinimumSize(const flutter::EncodableMap& args);
-  void WindowManager::SetMaximumSize(const flutter::EncodableMap& args);
-  bool WindowManager::IsResizable();
-  void WindowManager::SetResizable(const flutter::EncodableMap& args);
-  bool WindowManager::IsMinimizable();
-  void WindowManager::SetMinimizable(const flutter::EncodableMap& args);
-  bool WindowManager::IsMaximizable();
-  void WindowManager::SetMaximizable(const flutter::EncodableMap& args);
-  bool WindowManager::IsClosable();
-  void WindowManager::SetClosable(const flutter::EncodableMap& args);
-  bool WindowManager::IsAlwaysOnTop();
-  void WindowManager::SetAlwaysOnTop(const flutter::EncodableMap& args);
-  bool WindowManager::IsAlwaysOnBottom();
-  void WindowManager::SetAlwaysOnBottom(const flutter::EncodableMap& args);
-  std::string WindowManager::GetTitle();
-  void WindowManager::SetTitle(const flutter::EncodableMap& args);
-  void WindowManager::SetTitleBarStyle(const flutter::EncodableMap& args);
-  int WindowManager::GetTitleBarHeight();
-  bool WindowManager::IsSkipTaskbar();
-  void WindowManager::SetSkipTaskbar(const flutter::EncodableMap& args);
-  void WindowManager::SetProgressBar(const flutter::EncodableMap& args);
-  void WindowManager::SetIcon(const flutter::EncodableMap& args);
-  bool WindowManager::HasShadow();
-  void WindowManager::SetHasShadow(const flutter::EncodableMap& args);
-  double WindowManager::GetOpacity();
-  void WindowManager::SetOpacity(const flutter::EncodableMap& args);
-  void WindowManager::SetBrightness(const flutter::EncodableMap& args);
-  void WindowManager::SetIgnoreMouseEvents(const flutter::EncodableMap& args);
-  void WindowManager::PopUpWindowMenu(const flutter::EncodableMap& args);
-  void WindowManager::StartDragging();
-  void WindowManager::StartResizing(const flutter::EncodableMap& args);
+  void ForceRefresh();
+  void ForceChildRefresh();
+  void RefreshNcInsets(const RECT* window_rect = nullptr,
+                       std::optional<bool> maximized = std::nullopt);
+  void UpdateSizeConstraints();
+  void BuildSnapIndex();
+  bool SnapMovingRect(RECT* rect);
+  void UpdateHitTestMap();
+  int32_t HitTest(LPARAM lParam, int32_t fallback);
+  void SetAsFrameless();
+  void WaitUntilReadyToShow();
+  void Destroy();
+  void Close();
+  bool IsPreventClose();
+  void SetPreventClose(const flutter::EncodableMap& args);
+  void Focus();
+  void Blur();
+  bool IsFocused();
+  void Show();
+  void Hide();
+  bool IsVisible();
+  bool IsMaximized();
+  void Maximize(const flutter::EncodableMap& args);
+  void Unmaximize();
+  bool IsMinimized();
+  void Minimize();
+  void Restore();
+  bool IsDockable();
+  int IsDocked();
+  void Dock(const flutter::EncodableMap& args);
+  bool Undock();
+  bool IsFullScreen();
+  void SetFullScreen(const flutter::EncodableMap& args);
+  void SetAspectRatio(const flutter::EncodableMap& args);
+  void SetBackgroundColor(const flutter::EncodableMap& args);
+  flutter::EncodableMap GetBounds(const flutter::EncodableMap& args);
+  void SetBounds(const flutter::EncodableMap& args);
+  void SetMinimumSize(const flutter::EncodableMap& args);
+  void SetMaximumSize(const flutter::EncodableMap& args);
+  void SetSizeConstraints(const flutter::EncodableMap& args);
+  void SetSnapDistance(const flutter::EncodableMap& args);
+  void SetHitTestRegions(const flutter::EncodableMap& args);
+  bool IsResizable();
+  void SetResizable(const flutter::EncodableMap& args);
+  bool IsMinimizable();
+  void SetMinimizable(const flutter::EncodableMap& args);
+  bool IsMaximizable();
+  void SetMaximizable(const flutter::EncodableMap& args);
+  bool IsClosable();
+  void SetClosable(const flutter::EncodableMap& args);
+  bool IsAlwaysOnTop();
+  void SetAlwaysOnTop(const flutter::EncodableMap& args);
+  bool IsAlwaysOnBottom();
+  void SetAlwaysOnBottom(const flutter::EncodableMap& args);
+  const std::string& GetTitle();
+  void CacheTitle(const wchar_t* text);
+  void SetTitle(const flutter::EncodableMap& args);
+  void SetTitleBarStyle(const flutter::EncodableMap& args);
+  int GetTitleBarHeight();
+  bool IsSkipTaskbar();
+  void SetSkipTaskbar(const flutter::EncodableMap& args);
+  void SetProgressBar(const flutter::EncodableMap& args);
+  void SetIcon(const flutter::EncodableMap& args);
+  void ApplyIcon();
+  bool HasShadow();
+  void SetHasShadow(const flutter::EncodableMap& args);
+  double GetOpacity();
+  void SetOpacity(const flutter::EncodableMap& args);
+  void SetBrightness(const flutter::EncodableMap& args);
+  void SetIgnoreMouseEvents(const flutter::EncodableMap& args);
+  void PopUpWindowMenu(const flutter::EncodableMap& args);
+  void StartDragging();
+  void StartResizing(const flutter::EncodableMap& args);
 
  private:
   static constexpr auto kFlutterViewWindowClassName = L"FLUTTERVIEW";
@@ -161,19 +226,39 @@ class WindowManager {
   RECT g_frame_before_fullscreen;
   bool g_maximized_before_fullscreen;
   LONG g_style_before_fullscreen;
-  ITaskbarList3* taskbar_ = nullptr;
+  // The FLUTTERVIEW child subclassed to let non-client regions through.
+  HWND hit_test_flutter_view_ = nullptr;
   double GetDpiForHwnd(HWND hWnd);
-  BOOL WindowManager::RegisterAccessBar(HWND hwnd, BOOL fRegister);
-  void PASCAL WindowManager::AppBarQuerySetPos(HWND hwnd,
-                                               UINT uEdge,
-                                               LPRECT lprc,
-                                               PAPPBARDATA pabd);
-  void WindowManager::DockAccessBar(HWND hwnd, UINT edge, UINT windowWidth);
+  static LRESULT CALLBACK FlutterViewHitTestProc(HWND hWnd,
+                                                 UINT message,
+                                                 WPARAM wParam,
+                                                 LPARAM lParam,
+                                                 UINT_PTR uIdSubclass,
+                                                 DWORD_PTR dwRefData);
+  BOOL RegisterAccessBar(HWND hwnd, BOOL fRegister);
+  void PASCAL AppBarQuerySetPos(HWND hwnd,
+                                UINT uEdge,
+                                LPRECT lprc,
+                                PAPPBARDATA pabd);
+  void DockAccessBar(HWND hwnd, UINT edge, UINT windowWidth);
 };
 
-WindowManager::WindowManager() {}
+WindowManager::WindowManager() {
+  TaskbarWorker::Instance().Retain();
+}
 
-WindowManager::~WindowManager() {}
+WindowManager::~WindowManager() {
+  if (native_window) {
+    TaskbarWorker::Instance().Forget(native_window);
+  }
+  TaskbarWorker::Instance().Release();
+  IconCache::Instance().Release(icon_small_);
+  IconCache::Instance().Release(icon_big_);
+  if (hit_test_flutter_view_ && win32::IsWindow(hit_test_flutter_view_)) {
+    win32::RemoveWindowSubclass(hit_test_flutter_view_, FlutterViewHitTestProc,
+                                1);
+  }
+}
 
 HWND WindowManager::GetMainWindow() {
   return native_window;
@@ -184,58 +269,97 @@ void WindowManager::ForceRefresh() {
 
   RECT rect;
 
-  GetWindowRect(hWnd, &rect);
-  SetWindowPos(
+  win32::GetWindowRect(hWnd, &rect);
+  win32::SetWindowPos(
       hWnd, nullptr, rect.left, rect.top, rect.right - rect.left + 1,
       rect.bottom - rect.top,
       SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOMOVE | SWP_FRAMECHANGED);
-  SetWindowPos(
+  win32::SetWindowPos(
       hWnd, nullptr, rect.left, rect.top, rect.right - rect.left,
       rect.bottom - rect.top,
       SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOMOVE | SWP_FRAMECHANGED);
 }
 
 void WindowManager::ForceChildRefresh() {
-  HWND hWnd = GetWindow(GetMainWindow(), GW_CHILD);
+  HWND hWnd = win32::GetWindow(GetMainWindow(), GW_CHILD);
 
   RECT rect;
 
-  GetWindowRect(hWnd, &rect);
-  SetWindowPos(
+  win32::GetWindowRect(hWnd, &rect);
+  win32::SetWindowPos(
       hWnd, nullptr, rect.left, rect.top, rect.right - rect.left + 1,
       rect.bottom - rect.top,
       SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOMOVE | SWP_FRAMECHANGED);
-  SetWindowPos(
+  win32::SetWindowPos(
       hWnd, nullptr, rect.left, rect.top, rect.right - rect.left,
       rect.bottom - rect.top,
       SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOMOVE | SWP_FRAMECHANGED);
 }
 
+void WindowManager::RefreshNcInsets(const RECT* window_rect,
+                                    std::optional<bool> maximized) {
+  HWND hWnd = GetMainWindow();
+
+  NcInsetInputs inputs;
+  if (is_frameless_) {
+    inputs.mode = NcFrameMode::kFrameless;
+  } else if (title_bar_style_ == "hidden") {
+    inputs.mode = NcFrameMode::kHiddenTitleBar;
+  }
+  inputs.maximized = maximized ? *maximized : win32::IsZoomed(hWnd) != FALSE;
+  inputs.fullscreen = IsFullScreen() && title_bar_style_ != "normal";
+  inputs.windows11 = is_windows_11_or_greater_;
+
+  // Only the work area clip needs the monitor.
+  if (inputs.mode != NcFrameMode::kNormal &&
+      (inputs.maximized || inputs.fullscreen)) {
+    RECT rect;
+    if (window_rect) {
+      rect = *window_rect;
+    } else {
+      win32::GetWindowRect(hWnd, &rect);
+    }
+    // Don't use `MonitorFromWindow(hwnd, MONITOR_DEFAULTTONEAREST)` here.
+    // Because if the window is restored from minimized state, the window is not
+    // in the correct monitor. The monitor is always the left-most monitor.
+    // https://github.com/leanflutter/window_manager/issues/489
+    CachedMonitor monitor;
+    if (MonitorCache::Instance().FromRect(rect, &monitor)) {
+      inputs.work_offset_x = monitor.work.left - rect.left;
+      inputs.work_offset_y = monitor.work.top - rect.top;
+    }
+  }
+
+  nc_frame_mode_ = inputs.mode;
+  nc_maximized_ = inputs.maximized;
+  nc_insets_ = ComputeWindowManagerNcInsets(inputs);
+}
+
 void WindowManager::SetAsFrameless() {
   is_frameless_ = true;
+  RefreshNcInsets();
   HWND hWnd = GetMainWindow();
 
   RECT rect;
 
-  GetWindowRect(hWnd, &rect);
-  SetWindowPos(hWnd, nullptr, rect.left, rect.top, rect.right - rect.left,
-               rect.bottom - rect.top,
-               SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOMOVE | SWP_NOSIZE |
-                   SWP_FRAMECHANGED);
+  win32::GetWindowRect(hWnd, &rect);
+  win32::SetWindowPos(hWnd, nullptr, rect.left, rect.top, rect.right - rect.left,
+                      rect.bottom - rect.top,
+                      SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOMOVE | SWP_NOSIZE |
+                          SWP_FRAMECHANGED);
 }
 
 void WindowManager::WaitUntilReadyToShow() {
-  ::CoCreateInstance(CLSID_TaskbarList, NULL, CLSCTX_INPROC_SERVER,
-                     IID_PPV_ARGS(&taskbar_));
+  // The taskbar COM object is created once, on the TaskbarWorker thread.
 }
 
 void WindowManager::Destroy() {
-  PostQuitMessage(0);
+  win32::PostQuitMessage(0);
 }
 
 void WindowManager::Close() {
   HWND hWnd = GetMainWindow();
-  PostMessage(hWnd, WM_SYSCOMMAND, SC_CLOSE, 0);
+  win32::PostMessage(hWnd, WM_SYSCOMMAND, SC_CLOSE, 0);
 }
 
 void WindowManager::SetPreventClose(const flutter::EncodableMap& args) {
@@ -253,52 +377,52 @@ void WindowManager::Focus() {
     Restore();
   }
 
-  ::SetWindowPos(hWnd, HWND_TOP, 0, 0, 0, 0, SWP_NOSIZE | SWP_NOMOVE);
-  SetForegroundWindow(hWnd);
+  win32::SetWindowPos(hWnd, HWND_TOP, 0, 0, 0, 0, SWP_NOSIZE | SWP_NOMOVE);
+  win32::SetForegroundWindow(hWnd);
 }
 
 void WindowManager::Blur() {
   HWND hWnd = GetMainWindow();
-  HWND next_hwnd = ::GetNextWindow(hWnd, GW_HWNDNEXT);
+  HWND next_hwnd = win32::GetNextWindow(hWnd, GW_HWNDNEXT);
   while (next_hwnd) {
-    if (::IsWindowVisible(next_hwnd)) {
-      ::SetForegroundWindow(next_hwnd);
+    if (win32::IsWindowVisible(next_hwnd)) {
+      win32::SetForegroundWindow(next_hwnd);
       return;
     }
-    next_hwnd = ::GetNextWindow(next_hwnd, GW_HWNDNEXT);
+    next_hwnd = win32::GetNextWindow(next_hwnd, GW_HWNDNEXT);
   }
 }
 
 bool WindowManager::IsFocused() {
-  return GetMainWindow() == GetForegroundWindow();
+  return GetMainWindow() == win32::GetForegroundWindow();
 }
 
 void WindowManager::Show() {
   HWND hWnd = GetMainWindow();
-  DWORD gwlStyle = GetWindowLong(hWnd, GWL_STYLE);
+  DWORD gwlStyle = win32::GetWindowLong(hWnd, GWL_STYLE);
   gwlStyle = gwlStyle | WS_VISIBLE;
   if ((gwlStyle & WS_VISIBLE) == 0) {
-    SetWindowLong(hWnd, GWL_STYLE, gwlStyle);
-    ::SetWindowPos(hWnd, HWND_TOP, 0, 0, 0, 0, SWP_NOSIZE | SWP_NOMOVE);
+    win32::SetWindowLong(hWnd, GWL_STYLE, gwlStyle);
+    win32::SetWindowPos(hWnd, HWND_TOP, 0, 0, 0, 0, SWP_NOSIZE | SWP_NOMOVE);
   }
 
-  ShowWindowAsync(GetMainWindow(), SW_SHOW);
-  SetForegroundWindow(GetMainWindow());
+  win32::ShowWindowAsync(GetMainWindow(), SW_SHOW);
+  win32::SetForegroundWindow(GetMainWindow());
 }
 
 void WindowManager::Hide() {
-  ShowWindow(GetMainWindow(), SW_HIDE);
+  win32::ShowWindow(GetMainWindow(), SW_HIDE);
 }
 
 bool WindowManager::IsVisible() {
-  bool isVisible = IsWindowVisible(GetMainWindow());
+  bool isVisible = win32::IsWindowVisible(GetMainWindow());
   return isVisible;
 }
 
 bool WindowManager::IsMaximized() {
   HWND mainWindow = GetMainWindow();
   WINDOWPLACEMENT windowPlacement;
-  GetWindowPlacement(mainWindow, &windowPlacement);
+  win32::GetWindowPlacement(mainWindow, &windowPlacement);
 
   return windowPlacement.showCmd == SW_MAXIMIZE;
 }
@@ -309,16 +433,16 @@ void WindowManager::Maximize(const flutter::EncodableMap& args) {
 
   HWND hwnd = GetMainWindow();
   WINDOWPLACEMENT windowPlacement;
-  GetWindowPlacement(hwnd, &windowPlacement);
+  win32::GetWindowPlacement(hwnd, &windowPlacement);
 
   if (vertically) {
     POINT cursorPos;
-    GetCursorPos(&cursorPos);
-    PostMessage(hwnd, WM_NCLBUTTONDBLCLK, HTTOP,
-                MAKELPARAM(cursorPos.x, cursorPos.y));
+    win32::GetCursorPos(&cursorPos);
+    win32::PostMessage(hwnd, WM_NCLBUTTONDBLCLK, HTTOP,
+                       MAKELPARAM(cursorPos.x, cursorPos.y));
   } else {
     if (windowPlacement.showCmd != SW_MAXIMIZE) {
-      PostMessage(hwnd, WM_SYSCOMMAND, SC_MAXIMIZE, 0);
+      win32::PostMessage(hwnd, WM_SYSCOMMAND, SC_MAXIMIZE, 0);
     }
   }
 }
@@ -326,17 +450,17 @@ void WindowManager::Maximize(const flutter::EncodableMap& args) {
 void WindowManager::Unmaximize() {
   HWND mainWindow = GetMainWindow();
   WINDOWPLACEMENT windowPlacement;
-  GetWindowPlacement(mainWindow, &windowPlacement);
+  win32::GetWindowPlacement(mainWindow, &windowPlacement);
 
   if (windowPlacement.showCmd != SW_NORMAL) {
-    PostMessage(mainWindow, WM_SYSCOMMAND, SC_RESTORE, 0);
+    win32::PostMessage(mainWindow, WM_SYSCOMMAND, SC_RESTORE, 0);
   }
 }
 
 bool WindowManager::IsMinimized() {
   HWND mainWindow = GetMainWindow();
   WINDOWPLACEMENT windowPlacement;
-  GetWindowPlacement(mainWindow, &windowPlacement);
+  win32::GetWindowPlacement(mainWindow, &windowPlacement);
 
   return windowPlacement.showCmd == SW_SHOWMINIMIZED;
 }
@@ -348,20 +472,20 @@ void WindowManager::Minimize() {
   }
   HWND mainWindow = GetMainWindow();
   WINDOWPLACEMENT windowPlacement;
-  GetWindowPlacement(mainWindow, &windowPlacement);
+  win32::GetWindowPlacement(mainWindow, &windowPlacement);
 
   if (windowPlacement.showCmd != SW_SHOWMINIMIZED) {
-    PostMessage(mainWindow, WM_SYSCOMMAND, SC_MINIMIZE, 0);
+    win32::PostMessage(mainWindow, WM_SYSCOMMAND, SC_MINIMIZE, 0);
   }
 }
 
 void WindowManager::Restore() {
   HWND mainWindow = GetMainWindow();
   WINDOWPLACEMENT windowPlacement;
-  GetWindowPlacement(mainWindow, &windowPlacement);
+  win32::GetWindowPlacement(mainWindow, &windowPlacement);
 
   if (windowPlacement.showCmd != SW_NORMAL) {
-    PostMessage(mainWindow, WM_SYSCOMMAND, SC_RESTORE, 0);
+    win32::PostMessage(mainWindow, WM_SYSCOMMAND, SC_RESTORE, 0);
   }
 }
 
@@ -374,32 +498,9 @@ int WindowManager::IsDocked() {
 }
 
 double WindowManager::GetDpiForHwnd(HWND hWnd) {
-  auto monitor = MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST);
-  UINT newDpiX = 96;  // Default values
-  UINT newDpiY = 96;
-
-  // Dynamically load shcore.dll and get the GetDpiForMonitor function address
-  // We need to do this to ensure Windows 7 support
-  HMODULE shcore = LoadLibrary(TEXT("shcore.dll"));
-  if (shcore) {
-    typedef HRESULT (*GetDpiForMonitor)(HMONITOR, int, UINT*, UINT*);
-
-    GetDpiForMonitor GetDpiForMonitorFunc =
-        (GetDpiForMonitor)GetProcAddress(shcore, "GetDpiForMonitor");
-
-    if (GetDpiForMonitorFunc) {
-      // Use the loaded function if available
-      const int MDT_EFFECTIVE_DPI = 0;
-      if (FAILED(GetDpiForMonitorFunc(monitor, MDT_EFFECTIVE_DPI, &newDpiX,
-                                      &newDpiY))) {
-        // If it fails, set the default values again
-        newDpiX = 96;
-        newDpiY = 96;
-      }
-    }
-    FreeLibrary(shcore);
-  }
-  return ((double)newDpiX);
+  // Served from the cached monitor topology; shcore.dll is resolved once by
+  // the cache instead of being loaded and freed on every call.
+  return static_cast<double>(MonitorCache::Instance().DpiForWindow(hWnd));
 }
 
 void WindowManager::Dock(const flutter::EncodableMap& args) {
@@ -450,15 +551,15 @@ void PASCAL WindowManager::AppBarQuerySetPos(HWND hwnd,
   if ((uEdge == ABE_LEFT) || (uEdge == ABE_RIGHT)) {
     iWidth = pabd->rc.right - pabd->rc.left;
     pabd->rc.top = 0;
-    pabd->rc.bottom = GetSystemMetrics(SM_CYSCREEN);
+    pabd->rc.bottom = win32::GetSystemMetrics(SM_CYSCREEN);
   } else {
     iHeight = pabd->rc.bottom - pabd->rc.top;
     pabd->rc.left = 0;
-    pabd->rc.right = GetSystemMetrics(SM_CXSCREEN);
+    pabd->rc.right = win32::GetSystemMetrics(SM_CXSCREEN);
   }
 
   // Query the system for an approved size and position.
-  SHAppBarMessage(ABM_QUERYPOS, pabd);
+  win32::SHAppBarMessage(ABM_QUERYPOS, pabd);
 
   // Adjust the rectangle, depending on the edge to which the appbar is
   // anchored.
@@ -481,14 +582,14 @@ void PASCAL WindowManager::AppBarQuerySetPos(HWND hwnd,
   }
 
   // Pass the final bounding rectangle to the system.
-  SHAppBarMessage(ABM_SETPOS, pabd);
+  win32::SHAppBarMessage(ABM_SETPOS, pabd);
 
   // Move and size the appbar so that it conforms to the
   // bounding rectangle passed to the system.
   UINT uFlags = NULL;
-  SetWindowPos(hwnd, HWND_TOP, pabd->rc.left, pabd->rc.top,
-               pabd->rc.right - pabd->rc.left, pabd->rc.bottom - pabd->rc.top,
-               uFlags);
+  win32::SetWindowPos(hwnd, HWND_TOP, pabd->rc.left, pabd->rc.top,
+                      pabd->rc.right - pabd->rc.left, pabd->rc.bottom - pabd->rc.top,
+                      uFlags);
 }
 
 BOOL WindowManager::RegisterAccessBar(HWND hwnd, BOOL fRegister) {
@@ -508,7 +609,7 @@ BOOL WindowManager::RegisterAccessBar(HWND hwnd, BOOL fRegister) {
 
   if (!fRegister && is_registered_for_docking_) {
     // Unregister the appbar.
-    SHAppBarMessage(ABM_REMOVE, &abd);
+    win32::SHAppBarMessage(ABM_REMOVE, &abd);
     is_registered_for_docking_ = false;
     is_docked_ = 0;
     return true;
@@ -519,7 +620,7 @@ BOOL WindowManager::RegisterAccessBar(HWND hwnd, BOOL fRegister) {
     abd.uCallbackMessage = APPBAR_CALLBACK;
 
     // Register the appbar.
-    if (!SHAppBarMessage(ABM_NEW, &abd))
+    if (!win32::SHAppBarMessage(ABM_NEW, &abd))
       return false;
 
     is_docked_ = 1;  // default edge
@@ -541,8 +642,8 @@ void WindowManager::DockAccessBar(HWND hwnd, UINT edge, UINT windowWidth) {
     lprc.left = 0;
     lprc.right = windowWidth;
   } else {
-    lprc.left = GetSystemMetrics(SM_CXSCREEN) - windowWidth;
-    lprc.right = GetSystemMetrics(SM_CXSCREEN);
+    lprc.left = win32::GetSystemMetrics(SM_CXSCREEN) - windowWidth;
+    lprc.right = win32::GetSystemMetrics(SM_CXSCREEN);
   }
 
   // Specify the structure size and handle to the appbar.
@@ -580,60 +681,59 @@ void WindowManager::SetFullScreen(const flutter::EncodableMap& args) {
   // Save current window state if not already fullscreen.
   if (!g_is_window_fullscreen) {
     // Save current window information.
-    g_maximized_before_fullscreen = ::IsZoomed(mainWindow);
-    g_style_before_fullscreen = GetWindowLong(mainWindow, GWL_STYLE);
-    ::GetWindowRect(mainWindow, &g_frame_before_fullscreen);
+    g_maximized_before_fullscreen = win32::IsZoomed(mainWindow);
+    g_style_before_fullscreen = win32::GetWindowLong(mainWindow, GWL_STYLE);
+    win32::GetWindowRect(mainWindow, &g_frame_before_fullscreen);
     g_title_bar_style_before_fullscreen = title_bar_style_;
   }
 
   g_is_window_fullscreen = isFullScreen;
+  RefreshNcInsets();
 
   if (isFullScreen) {  // Set to fullscreen
     // ::SendMessage(mainWindow, WM_SYSCOMMAND, SC_MAXIMIZE, 0);
     if (!is_frameless_) {
-      auto monitor = MONITORINFO{};
+      auto monitor = CachedMonitor{};
       auto placement = WINDOWPLACEMENT{};
-      monitor.cbSize = sizeof(MONITORINFO);
       placement.length = sizeof(WINDOWPLACEMENT);
-      ::GetWindowPlacement(mainWindow, &placement);
-      ::GetMonitorInfo(
-          ::MonitorFromWindow(mainWindow, MONITOR_DEFAULTTONEAREST), &monitor);
+      win32::GetWindowPlacement(mainWindow, &placement);
+      MonitorCache::Instance().FromWindow(mainWindow, &monitor);
       if (!g_maximized_before_fullscreen) {
         SetAsFrameless();
       }
-      ::SetWindowLongPtr(
+      win32::SetWindowLongPtr(
           mainWindow, GWL_STYLE,
           g_style_before_fullscreen & ~(WS_THICKFRAME | WS_MAXIMIZEBOX));
-      ::SetWindowPos(mainWindow, HWND_TOP, monitor.rcMonitor.left,
-                     monitor.rcMonitor.top, 0, 0,
-                     SWP_NOSIZE | SWP_NOOWNERZORDER | SWP_FRAMECHANGED);
-      ::SetWindowPos(mainWindow, HWND_TOP, 0, 0,
-                     monitor.rcMonitor.right - monitor.rcMonitor.left,
-                     monitor.rcMonitor.bottom - monitor.rcMonitor.top,
-                     SWP_NOMOVE | SWP_NOOWNERZORDER | SWP_FRAMECHANGED);
+      win32::SetWindowPos(mainWindow, HWND_TOP, monitor.monitor.left,
+                          monitor.monitor.top, 0, 0,
+                          SWP_NOSIZE | SWP_NOOWNERZORDER | SWP_FRAMECHANGED);
+      win32::SetWindowPos(mainWindow, HWND_TOP, 0, 0,
+                          monitor.monitor.right - monitor.monitor.left,
+                          monitor.monitor.bottom - monitor.monitor.top,
+                          SWP_NOMOVE | SWP_NOOWNERZORDER | SWP_FRAMECHANGED);
     }
   } else {  // Restore from fullscreen
     // if (!g_maximized_before_fullscreen)
     //   Restore();
-    ::SetWindowLongPtr(
+    win32::SetWindowLongPtr(
         mainWindow, GWL_STYLE,
         g_style_before_fullscreen | (WS_THICKFRAME | WS_MAXIMIZEBOX));
-    if (::IsZoomed(mainWindow)) {
+    if (win32::IsZoomed(mainWindow)) {
       // Refresh the parent mainWindow.
-      ::SetWindowPos(mainWindow, nullptr, 0, 0, 0, 0,
-                     SWP_NOACTIVATE | SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER |
-                         SWP_FRAMECHANGED);
+      win32::SetWindowPos(mainWindow, nullptr, 0, 0, 0, 0,
+                          SWP_NOACTIVATE | SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER |
+                              SWP_FRAMECHANGED);
       auto rect = RECT{};
-      ::GetClientRect(mainWindow, &rect);
-      auto flutter_view = ::FindWindowEx(mainWindow, nullptr,
-                                         kFlutterViewWindowClassName, nullptr);
-      ::SetWindowPos(flutter_view, nullptr, rect.left, rect.top,
-                     rect.right - rect.left, rect.bottom - rect.top,
-                     SWP_NOACTIVATE | SWP_NOZORDER);
+      win32::GetClientRect(mainWindow, &rect);
+      auto flutter_view = win32::FindWindowEx(
+          mainWindow, nullptr, kFlutterViewWindowClassName, nullptr);
+      win32::SetWindowPos(flutter_view, nullptr, rect.left, rect.top,
+                          rect.right - rect.left, rect.bottom - rect.top,
+                          SWP_NOACTIVATE | SWP_NOZORDER);
       if (g_maximized_before_fullscreen)
-        PostMessage(mainWindow, WM_SYSCOMMAND, SC_MAXIMIZE, 0);
+        win32::PostMessage(mainWindow, WM_SYSCOMMAND, SC_MAXIMIZE, 0);
     } else {
-      ::SetWindowPos(
+      win32::SetWindowPos(
           mainWindow, nullptr, g_frame_before_fullscreen.left,
           g_frame_before_fullscreen.top,
           g_frame_before_fullscreen.right - g_frame_before_fullscreen.left,
@@ -643,20 +743,23 @@ void WindowManager::SetFullScreen(const flutter::EncodableMap& args) {
       // restore titlebar style
       title_bar_style_ = g_title_bar_style_before_fullscreen;
       is_frameless_ = false;
+      RefreshNcInsets();
       MARGINS margins = {0, 0, 0, 0};
       RECT rect1;
-      GetWindowRect(mainWindow, &rect1);
-      DwmExtendFrameIntoClientArea(mainWindow, &margins);
-      SetWindowPos(mainWindow, nullptr, rect1.left, rect1.top, 0, 0,
-                   SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOMOVE | SWP_NOSIZE |
-                       SWP_FRAMECHANGED);
+      win32::GetWindowRect(mainWindow, &rect1);
+      CompositionEngine::SetMargins(
+          mainWindow, CompositionEngine::kWindowManagerFrame, margins);
+      win32::SetWindowPos(mainWindow, nullptr, rect1.left, rect1.top, 0, 0,
+                          SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOMOVE | SWP_NOSIZE |
+                              SWP_FRAMECHANGED);
     }
   }
 }
 
 void WindowManager::SetAspectRatio(const flutter::EncodableMap& args) {
-  aspect_ratio_ =
+  size_constraint_spec_.aspect_ratio =
       std::get<double>(args.at(flutter::EncodableValue("aspectRatio")));
+  UpdateSizeConstraints();
 }
 
 void WindowManager::SetBackgroundColor(const flutter::EncodableMap& args) {
@@ -672,47 +775,16 @@ void WindowManager::SetBackgroundColor(const flutter::EncodableMap& args) {
   bool isTransparent = backgroundColorA == 0 && backgroundColorR == 0 &&
                        backgroundColorG == 0 && backgroundColorB == 0;
 
-  HWND hWnd = GetMainWindow();
-  const HINSTANCE hModule = LoadLibrary(TEXT("user32.dll"));
-  if (hModule) {
-    typedef enum _ACCENT_STATE {
-      ACCENT_DISABLED = 0,
-      ACCENT_ENABLE_GRADIENT = 1,
-      ACCENT_ENABLE_TRANSPARENTGRADIENT = 2,
-      ACCENT_ENABLE_BLURBEHIND = 3,
-      ACCENT_ENABLE_ACRYLICBLURBEHIND = 4,
-      ACCENT_ENABLE_HOSTBACKDROP = 5,
-      ACCENT_INVALID_STATE = 6
-    } ACCENT_STATE;
-    struct ACCENTPOLICY {
-      int nAccentState;
-      int nFlags;
-      int nColor;
-      int nAnimationId;
-    };
-    struct WINCOMPATTRDATA {
-      int nAttribute;
-      PVOID pData;
-      ULONG ulDataSize;
-    };
-    typedef BOOL(WINAPI * pSetWindowCompositionAttribute)(HWND,
-                                                          WINCOMPATTRDATA*);
-    const pSetWindowCompositionAttribute SetWindowCompositionAttribute =
-        (pSetWindowCompositionAttribute)GetProcAddress(
-            hModule, "SetWindowCompositionAttribute");
-    if (SetWindowCompositionAttribute) {
-      int32_t accent_state = isTransparent ? ACCENT_ENABLE_TRANSPARENTGRADIENT
-                                           : ACCENT_ENABLE_GRADIENT;
-      ACCENTPOLICY policy = {
-          accent_state, 2,
-          ((backgroundColorA << 24) + (backgroundColorB << 16) +
-           (backgroundColorG << 8) + (backgroundColorR)),
-          0};
-      WINCOMPATTRDATA data = {19, &policy, sizeof(policy)};
-      SetWindowCompositionAttribute(hWnd, &data);
-    }
-    FreeLibrary(hModule);
-  }
+  // ACCENT_ENABLE_TRANSPARENTGRADIENT or ACCENT_ENABLE_GRADIENT, with the
+  // color in ABGR. Effects and transparent backgrounds set by others take
+  // precedence; this layer shows again once they are removed.
+  AccentTuple accent = {
+      isTransparent ? 2u : 1u, 2,
+      static_cast<DWORD>((backgroundColorA << 24) + (backgroundColorB << 16) +
+                         (backgroundColorG << 8) + (backgroundColorR)),
+      0};
+  CompositionEngine::SetAccent(GetMainWindow(),
+                               CompositionEngine::kBackgroundColor, accent);
 }
 
 flutter::EncodableMap WindowManager::GetBounds(
@@ -723,7 +795,7 @@ flutter::EncodableMap WindowManager::GetBounds(
 
   flutter::EncodableMap resultMap = flutter::EncodableMap();
   RECT rect;
-  if (GetWindowRect(hwnd, &rect)) {
+  if (win32::GetWindowRect(hwnd, &rect)) {
     double x = rect.left / devicePixelRatio * 1.0f;
     double y = rect.top / devicePixelRatio * 1.0f;
     double width = (rect.right - rect.left) / devicePixelRatio * 1.0f;
@@ -772,7 +844,7 @@ void WindowManager::SetBounds(const flutter::EncodableMap& args) {
     uFlags = SWP_NOSIZE;
   }
 
-  SetWindowPos(hwnd, HWND_TOP, x, y, width, height, uFlags);
+  win32::SetWindowPos(hwnd, HWND_TOP, x, y, width, height, uFlags);
 }
 
 void WindowManager::SetMinimumSize(const flutter::EncodableMap& args) {
@@ -783,10 +855,9 @@ void WindowManager::SetMinimumSize(const flutter::EncodableMap& args) {
 
   if (width >= 0 && height >= 0) {
     pixel_ratio_ = devicePixelRatio;
-    POINT point = {};
-    point.x = static_cast<LONG>(width);
-    point.y = static_cast<LONG>(height);
-    minimum_size_ = point;
+    size_constraint_spec_.min_width = width;
+    size_constraint_spec_.min_height = height;
+    UpdateSizeConstraints();
   }
 }
 
@@ -798,11 +869,126 @@ void WindowManager::SetMaximumSize(const flutter::EncodableMap& args) {
 
   if (width >= 0 && height >= 0) {
     pixel_ratio_ = devicePixelRatio;
-    POINT point = {};
-    point.x = static_cast<LONG>(width);
-    point.y = static_cast<LONG>(height);
-    maximum_size_ = point;
+    size_constraint_spec_.max_width = width;
+    size_constraint_spec_.max_height = height;
+    UpdateSizeConstraints();
+  }
+}
+
+void WindowManager::SetSizeConstraints(const flutter::EncodableMap& args) {
+  // Every key is optional; missing keys keep their current value.
+  auto read = [&args](const char* key, double* out) {
+    const flutter::EncodableValue* value = ValueOrNull(args, key);
+    if (value != nullptr && std::holds_alternative<double>(*value)) {
+      *out = std::get<double>(*value);
+    }
+  };
+
+  read("devicePixelRatio", &pixel_ratio_);
+  read("minWidth", &size_constraint_spec_.min_width);
+  read("minHeight", &size_constraint_spec_.min_height);
+  read("maxWidth", &size_constraint_spec_.max_width);
+  read("maxHeight", &size_constraint_spec_.max_height);
+  read("aspectRatio", &size_constraint_spec_.aspect_ratio);
+  read("aspectTolerance", &size_constraint_spec_.aspect_tolerance);
+  read("stepWidth", &size_constraint_spec_.step_width);
+  read("stepHeight", &size_constraint_spec_.step_height);
+  read("gridWidth", &size_constraint_spec_.grid_width);
+  read("gridHeight", &size_constraint_spec_.grid_height);
+  read("gridSnapDistance", &size_constraint_spec_.grid_snap_distance);
+  UpdateSizeConstraints();
+}
+
+void WindowManager::UpdateSizeConstraints() {
+  // Steps and grid apply to the client area, so measure the current frame.
+  HWND hWnd = GetMainWindow();
+  RECT window_rect = {};
+  RECT client_rect = {};
+  int32_t frame_width = 0;
+  int32_t frame_height = 0;
+  if (hWnd && win32::GetWindowRect(hWnd, &window_rect) &&
+      win32::GetClientRect(hWnd, &client_rect)) {
+    frame_width = (window_rect.right - window_rect.left) - client_rect.right;
+    frame_height = (window_rect.bottom - window_rect.top) - client_rect.bottom;
+  }
+
+  size_constraints_ = CompileSizeConstraints(
+      size_constraint_spec_, pixel_ratio_, frame_width, frame_height);
+}
+
+void WindowManager::SetSnapDistance(const flutter::EncodableMap& args) {
+  snap_distance_ =
+      std::get<double>(args.at(flutter::EncodableValue("snapDistance")));
+  snap_index_.Clear();
+}
+
+void WindowManager::BuildSnapIndex() {
+  snap_index_.Clear();
+  if (snap_distance_ <= 0) {
+    return;
+  }
+
+  HWND hWnd = GetMainWindow();
+  RECT window_rect = {};
+  RECT frame = {};
+  snap_frame_inset_ = {0, 0, 0, 0};
+  if (win32::GetWindowRect(hWnd, &window_rect) &&
+      SUCCEEDED(win32::DwmGetWindowAttribute(hWnd, DWMWA_EXTENDED_FRAME_BOUNDS,
+                                             &frame, sizeof(frame)))) {
+    snap_frame_inset_.left = frame.left - window_rect.left;
+    snap_frame_inset_.top = frame.top - window_rect.top;
+    snap_frame_inset_.right = window_rect.right - frame.right;
+    snap_frame_inset_.bottom = window_rect.bottom - frame.bottom;
   }
+
+  for (const CachedMonitor& monitor : MonitorCache::Instance().Monitors()) {
+    snap_index_.AddRect({monitor.work.left, monitor.work.top,
+                         monitor.work.right, monitor.work.bottom});
+  }
+
+  // The other visible top-level windows of this process. The index is only
+  // rebuilt when a move starts, since nothing else moves during the drag.
+  win32::EnumWindows(
+      [](HWND other, LPARAM lParam) -> BOOL {
+        WindowManager* self = reinterpret_cast<WindowManager*>(lParam);
+        DWORD pid = 0;
+        win32::GetWindowThreadProcessId(other, &pid);
+        if (other == self->GetMainWindow() || pid != GetCurrentProcessId() ||
+            !win32::IsWindowVisible(other) || win32::IsIconic(other)) {
+          return TRUE;
+        }
+        RECT bounds;
+        if (FAILED(win32::DwmGetWindowAttribute(
+                other, DWMWA_EXTENDED_FRAME_BOUNDS, &bounds, sizeof(bounds))) &&
+            !win32::GetWindowRect(other, &bounds)) {
+          return TRUE;
+        }
+        self->snap_index_.AddRect(
+            {bounds.left, bounds.top, bounds.right, bounds.bottom});
+        return TRUE;
+      },
+      reinterpret_cast<LPARAM>(this));
+
+  snap_index_.Build();
+}
+
+bool WindowManager::SnapMovingRect(RECT* rect) {
+  if (snap_distance_ <= 0 || snap_index_.empty()) {
+    return false;
+  }
+  SnapRect visible = {rect->left + snap_frame_inset_.left,
+                      rect->top + snap_frame_inset_.top,
+                      rect->right - snap_frame_inset_.right,
+                      rect->bottom - snap_frame_inset_.bottom};
+  int32_t distance = static_cast<int32_t>(snap_distance_ * pixel_ratio_);
+  if (!snap_index_.Snap(&visible, distance)) {
+    return false;
+  }
+  rect->left = visible.left - snap_frame_inset_.left;
+  rect->top = visible.top - snap_frame_inset_.top;
+  rect->right = visible.right + snap_frame_inset_.right;
+  rect->bottom = visible.bottom + snap_frame_inset_.bottom;
+  return true;
 }
 
 bool WindowManager::IsResizable() {
@@ -813,18 +999,18 @@ void WindowManager::SetResizable(const flutter::EncodableMap& args) {
   HWND hWnd = GetMainWindow();
   is_resizable_ =
       std::get<bool>(args.at(flutter::EncodableValue("isResizable")));
-  DWORD gwlStyle = GetWindowLong(hWnd, GWL_STYLE);
+  DWORD gwlStyle = win32::GetWindowLong(hWnd, GWL_STYLE);
   if (is_resizable_) {
     gwlStyle |= WS_THICKFRAME;
   } else {
     gwlStyle &= ~WS_THICKFRAME;
   }
-  ::SetWindowLong(hWnd, GWL_STYLE, gwlStyle);
+  win32::SetWindowLong(hWnd, GWL_STYLE, gwlStyle);
 }
 
 bool WindowManager::IsMinimizable() {
   HWND hWnd = GetMainWindow();
-  DWORD gwlStyle = GetWindowLong(hWnd, GWL_STYLE);
+  DWORD gwlStyle = win32::GetWindowLong(hWnd, GWL_STYLE);
   return (gwlStyle & WS_MINIMIZEBOX) != 0;
 }
 
@@ -832,15 +1018,15 @@ void WindowManager::SetMinimizable(const flutter::EncodableMap& args) {
   HWND hWnd = GetMainWindow();
   bool isMinimizable =
       std::get<bool>(args.at(flutter::EncodableValue("isMinimizable")));
-  DWORD gwlStyle = GetWindowLong(hWnd, GWL_STYLE);
+  DWORD gwlStyle = win32::GetWindowLong(hWnd, GWL_STYLE);
   gwlStyle =
       isMinimizable ? gwlStyle | WS_MINIMIZEBOX : gwlStyle & ~WS_MINIMIZEBOX;
-  SetWindowLong(hWnd, GWL_STYLE, gwlStyle);
+  win32::SetWindowLong(hWnd, GWL_STYLE, gwlStyle);
 }
 
 bool WindowManager::IsMaximizable() {
   HWND hWnd = GetMainWindow();
-  DWORD gwlStyle = GetWindowLong(hWnd, GWL_STYLE);
+  DWORD gwlStyle = win32::GetWindowLong(hWnd, GWL_STYLE);
   return (gwlStyle & WS_MAXIMIZEBOX) != 0;
 }
 
@@ -848,15 +1034,15 @@ void WindowManager::SetMaximizable(const flutter::EncodableMap& args) {
   HWND hWnd = GetMainWindow();
   bool isMaximizable =
       std::get<bool>(args.at(flutter::EncodableValue("isMaximizable")));
-  DWORD gwlStyle = GetWindowLong(hWnd, GWL_STYLE);
+  DWORD gwlStyle = win32::GetWindowLong(hWnd, GWL_STYLE);
   gwlStyle =
       isMaximizable ? gwlStyle | WS_MAXIMIZEBOX : gwlStyle & ~WS_MAXIMIZEBOX;
-  SetWindowLong(hWnd, GWL_STYLE, gwlStyle);
+  win32::SetWindowLong(hWnd, GWL_STYLE, gwlStyle);
 }
 
 bool WindowManager::IsClosable() {
   HWND hWnd = GetMainWindow();
-  DWORD gclStyle = GetClassLong(hWnd, GCL_STYLE);
+  DWORD gclStyle = win32::GetClassLong(hWnd, GCL_STYLE);
   return !((gclStyle & CS_NOCLOSE) != 0);
 }
 
@@ -864,21 +1050,21 @@ void WindowManager::SetClosable(const flutter::EncodableMap& args) {
   HWND hWnd = GetMainWindow();
   bool isClosable =
       std::get<bool>(args.at(flutter::EncodableValue("isClosable")));
-  DWORD gclStyle = GetClassLong(hWnd, GCL_STYLE);
+  DWORD gclStyle = win32::GetClassLong(hWnd, GCL_STYLE);
   gclStyle = isClosable ? gclStyle & ~CS_NOCLOSE : gclStyle | CS_NOCLOSE;
-  SetClassLong(hWnd, GCL_STYLE, gclStyle);
+  win32::SetClassLong(hWnd, GCL_STYLE, gclStyle);
 }
 
 bool WindowManager::IsAlwaysOnTop() {
-  DWORD dwExStyle = GetWindowLong(GetMainWindow(), GWL_EXSTYLE);
+  DWORD dwExStyle = win32::GetWindowLong(GetMainWindow(), GWL_EXSTYLE);
   return (dwExStyle & WS_EX_TOPMOST) != 0;
 }
 
 void WindowManager::SetAlwaysOnTop(const flutter::EncodableMap& args) {
   bool isAlwaysOnTop =
       std::get<bool>(args.at(flutter::EncodableValue("isAlwaysOnTop")));
-  SetWindowPos(GetMainWindow(), isAlwaysOnTop ? HWND_TOPMOST : HWND_NOTOPMOST,
-               0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE);
+  win32::SetWindowPos(GetMainWindow(), isAlwaysOnTop ? HWND_TOPMOST : HWND_NOTOPMOST,
+                      0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE);
 }
 
 bool WindowManager::IsAlwaysOnBottom() {
@@ -889,26 +1075,40 @@ void WindowManager::SetAlwaysOnBottom(const flutter::EncodableMap& args) {
   is_always_on_bottom_ =
       std::get<bool>(args.at(flutter::EncodableValue("isAlwaysOnBottom")));
 
-  SetWindowPos(GetMainWindow(),
-               is_always_on_bottom_ ? HWND_BOTTOM : HWND_NOTOPMOST, 0, 0, 0, 0,
-               SWP_NOMOVE | SWP_NOSIZE);
+  win32::SetWindowPos(GetMainWindow(),
+                      is_always_on_bottom_ ? HWND_BOTTOM : HWND_NOTOPMOST, 0, 0, 0, 0,
+                      SWP_NOMOVE | SWP_NOSIZE);
 }
 
-std::string WindowManager::GetTitle() {
-  int const bufferSize = 1 + GetWindowTextLength(GetMainWindow());
-  std::wstring title(bufferSize, L'\0');
-  GetWindowText(GetMainWindow(), &title[0], bufferSize);
+const std::string& WindowManager::GetTitle() {
+  if (!has_title_) {
+    // Text set before the plugin was attached; later changes arrive through
+    // WM_SETTEXT.
+    int const bufferSize = 1 + win32::GetWindowTextLength(GetMainWindow());
+    wide_buffer_.resize(bufferSize);
+    int length = win32::GetWindowText(GetMainWindow(), &wide_buffer_[0], bufferSize);
+    Utf16ToUtf8(wide_buffer_.data(), static_cast<size_t>(length), &title_);
+    has_title_ = true;
+  }
+  return title_;
+}
 
-  std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-  return (converter.to_bytes(title)).c_str();
+void WindowManager::CacheTitle(const wchar_t* text) {
+  if (text) {
+    Utf16ToUtf8(text, wcslen(text), &title_);
+  } else {
+    title_.clear();
+  }
+  has_title_ = true;
 }
 
 void WindowManager::SetTitle(const flutter::EncodableMap& args) {
   std::string title =
       std::get<std::string>(args.at(flutter::EncodableValue("title")));
 
-  std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-  SetWindowText(GetMainWindow(), converter.from_bytes(title).c_str());
+  // WM_SETTEXT updates the cached title.
+  Utf8ToUtf16(title.data(), title.size(), &wide_buffer_);
+  win32::SetWindowText(GetMainWindow(), wide_buffer_.c_str());
 }
 
 void WindowManager::SetTitleBarStyle(const flutter::EncodableMap& args) {
@@ -917,15 +1117,17 @@ void WindowManager::SetTitleBarStyle(const flutter::EncodableMap& args) {
   // Enables the ability to go from setAsFrameless() to
   // TitleBarStyle.normal/hidden
   is_frameless_ = false;
+  RefreshNcInsets();
 
   MARGINS margins = {0, 0, 0, 0};
   HWND hWnd = GetMainWindow();
   RECT rect;
-  GetWindowRect(hWnd, &rect);
-  DwmExtendFrameIntoClientArea(hWnd, &margins);
-  SetWindowPos(hWnd, nullptr, rect.left, rect.top, 0, 0,
-               SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOMOVE | SWP_NOSIZE |
-                   SWP_FRAMECHANGED);
+  win32::GetWindowRect(hWnd, &rect);
+  CompositionEngine::SetMargins(hWnd, CompositionEngine::kWindowManagerFrame,
+                                margins);
+  win32::SetWindowPos(hWnd, nullptr, rect.left, rect.top, 0, 0,
+                      SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOMOVE | SWP_NOSIZE |
+                          SWP_FRAMECHANGED);
 }
 
 int WindowManager::GetTitleBarHeight() {
@@ -933,7 +1135,7 @@ int WindowManager::GetTitleBarHeight() {
 
   TITLEBARINFOEX* ptinfo = (TITLEBARINFOEX*)malloc(sizeof(TITLEBARINFOEX));
   ptinfo->cbSize = sizeof(TITLEBARINFOEX);
-  SendMessage(hWnd, WM_GETTITLEBARINFOEX, 0, (LPARAM)ptinfo);
+  win32::SendMessage(hWnd, WM_GETTITLEBARINFOEX, 0, (LPARAM)ptinfo);
   int height = ptinfo->rcTitleBar.bottom == 0
                    ? 0
                    : ptinfo->rcTitleBar.bottom - ptinfo->rcTitleBar.top;
@@ -950,60 +1152,73 @@ void WindowManager::SetSkipTaskbar(const flutter::EncodableMap& args) {
   is_skip_taskbar_ =
       std::get<bool>(args.at(flutter::EncodableValue("isSkipTaskbar")));
 
-  HWND hWnd = GetMainWindow();
-
-  LPVOID lp = NULL;
-  CoInitialize(lp);
-
-  taskbar_->HrInit();
-  if (!is_skip_taskbar_)
-    taskbar_->AddTab(hWnd);
-  else
-    taskbar_->DeleteTab(hWnd);
+  TaskbarWorker::Instance().SetSkipTaskbar(GetMainWindow(), is_skip_taskbar_);
 }
 
 void WindowManager::SetProgressBar(const flutter::EncodableMap& args) {
   double progress =
       std::get<double>(args.at(flutter::EncodableValue("progress")));
 
-  HWND hWnd = GetMainWindow();
-  taskbar_->SetProgressState(hWnd, TBPF_INDETERMINATE);
-  taskbar_->SetProgressValue(hWnd, static_cast<int32_t>(progress * 100),
-                             static_cast<int32_t>(100));
-
+  // Coalesced per window and applied off the platform thread; repeating the
+  // current percentage is a no-op.
+  int32_t percent;
   if (progress < 0) {
-    taskbar_->SetProgressState(hWnd, TBPF_NOPROGRESS);
-    taskbar_->SetProgressValue(hWnd, static_cast<int32_t>(0),
-                               static_cast<int32_t>(0));
+    percent = TaskbarWorker::kNoProgress;
   } else if (progress > 1) {
-    taskbar_->SetProgressState(hWnd, TBPF_INDETERMINATE);
-    taskbar_->SetProgressValue(hWnd, static_cast<int32_t>(100),
-                               static_cast<int32_t>(100));
+    percent = 100;
   } else {
-    taskbar_->SetProgressState(hWnd, TBPF_INDETERMINATE);
-    taskbar_->SetProgressValue(hWnd, static_cast<int32_t>(progress * 100),
-                               static_cast<int32_t>(100));
+    percent = static_cast<int32_t>(progress * 100);
   }
+  TaskbarWorker::Instance().SetProgress(GetMainWindow(), percent);
 }
 
 void WindowManager::SetIcon(const flutter::EncodableMap& args) {
-  std::string iconPath =
-      std::get<std::string>(args.at(flutter::EncodableValue("iconPath")));
-
-  std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-
-  HICON hIconSmall =
-      (HICON)(LoadImage(NULL, (LPCWSTR)(converter.from_bytes(iconPath).c_str()),
-                        IMAGE_ICON, 16, 16, LR_LOADFROMFILE));
-
-  HICON hIconLarge =
-      (HICON)(LoadImage(NULL, (LPCWSTR)(converter.from_bytes(iconPath).c_str()),
-                        IMAGE_ICON, 32, 32, LR_LOADFROMFILE));
+  // Either a file path or the bytes of an .ico or .png image.
+  if (auto* bytes = std::get_if<std::vector<uint8_t>>(
+          ValueOrNull(args, "iconBytes"))) {
+    icon_path_.clear();
+    icon_bytes_ = *bytes;
+    icon_bytes_hash_ =
+        IconCache::HashBytes(icon_bytes_.data(), icon_bytes_.size());
+  } else {
+    std::string iconPath =
+        std::get<std::string>(args.at(flutter::EncodableValue("iconPath")));
+    Utf8ToUtf16(iconPath.data(), iconPath.size(), &icon_path_);
+    icon_bytes_.clear();
+  }
+  ApplyIcon();
+}
 
+void WindowManager::ApplyIcon() {
+  if (icon_path_.empty() && icon_bytes_.empty()) {
+    return;
+  }
   HWND hWnd = GetMainWindow();
+  UINT dpi = static_cast<UINT>(GetDpiForHwnd(hWnd));
+  int small_size = MulDiv(16, dpi, USER_DEFAULT_SCREEN_DPI);
+  int big_size = MulDiv(32, dpi, USER_DEFAULT_SCREEN_DPI);
+
+  IconCache& cache = IconCache::Instance();
+  HICON hIconSmall;
+  HICON hIconLarge;
+  if (!icon_bytes_.empty()) {
+    hIconSmall = cache.AcquireFromBytes(icon_bytes_.data(), icon_bytes_.size(),
+                                        icon_bytes_hash_, small_size, dpi);
+    hIconLarge = cache.AcquireFromBytes(icon_bytes_.data(), icon_bytes_.size(),
+                                        icon_bytes_hash_, big_size, dpi);
+  } else {
+    hIconSmall = cache.AcquireFromFile(icon_path_, small_size, dpi);
+    hIconLarge = cache.AcquireFromFile(icon_path_, big_size, dpi);
+  }
 
-  SendMessage(hWnd, WM_SETICON, ICON_SMALL, (LPARAM)hIconSmall);
-  SendMessage(hWnd, WM_SETICON, ICON_BIG, (LPARAM)hIconLarge);
+  win32::SendMessage(hWnd, WM_SETICON, ICON_SMALL, (LPARAM)hIconSmall);
+  win32::SendMessage(hWnd, WM_SETICON, ICON_BIG, (LPARAM)hIconLarge);
+
+  // The previous icons are no longer referenced by the window.
+  cache.Release(icon_small_);
+  cache.Release(icon_big_);
+  icon_small_ = hIconSmall;
+  icon_big_ = hIconLarge;
 }
 
 bool WindowManager::HasShadow() {
@@ -1020,7 +1235,8 @@ void WindowManager::SetHasShadow(const flutter::EncodableMap& args) {
 
     MARGINS margins[2]{{0, 0, 0, 0}, {0, 0, 1, 0}};
 
-    DwmExtendFrameIntoClientArea(hWnd, &margins[has_shadow_]);
+    CompositionEngine::SetMargins(
+        hWnd, CompositionEngine::kWindowManagerFrame, margins[has_shadow_]);
   }
 }
 
@@ -1031,10 +1247,10 @@ double WindowManager::GetOpacity() {
 void WindowManager::SetOpacity(const flutter::EncodableMap& args) {
   opacity_ = std::get<double>(args.at(flutter::EncodableValue("opacity")));
   HWND hWnd = GetMainWindow();
-  long gwlExStyle = GetWindowLong(hWnd, GWL_EXSTYLE);
-  SetWindowLong(hWnd, GWL_EXSTYLE, gwlExStyle | WS_EX_LAYERED);
-  SetLayeredWindowAttributes(hWnd, 0, static_cast<int8_t>(255 * opacity_),
-                             0x02);
+  long gwlExStyle = win32::GetWindowLong(hWnd, GWL_EXSTYLE);
+  win32::SetWindowLong(hWnd, GWL_EXSTYLE, gwlExStyle | WS_EX_LAYERED);
+  win32::SetLayeredWindowAttributes(hWnd, 0, static_cast<int8_t>(255 * opacity_),
+                                    0x02);
 }
 
 void WindowManager::SetBrightness(const flutter::EncodableMap& args) {
@@ -1050,8 +1266,8 @@ void WindowManager::SetBrightness(const flutter::EncodableMap& args) {
         std::get<std::string>(args.at(flutter::EncodableValue("brightness")));
     HWND hWnd = GetMainWindow();
     BOOL enable_dark_mode = light_mode == 0 && brightness == "dark";
-    DwmSetWindowAttribute(hWnd, DWMWA_USE_IMMERSIVE_DARK_MODE,
-                          &enable_dark_mode, sizeof(enable_dark_mode));
+    CompositionEngine::SetDarkMode(
+        hWnd, CompositionEngine::kWindowManagerFrame, enable_dark_mode);
   }
 }
 
@@ -1059,39 +1275,39 @@ void WindowManager::SetIgnoreMouseEvents(const flutter::EncodableMap& args) {
   bool ignore = std::get<bool>(args.at(flutter::EncodableValue("ignore")));
 
   HWND hwnd = GetMainWindow();
-  LONG ex_style = ::GetWindowLong(hwnd, GWL_EXSTYLE);
+  LONG ex_style = win32::GetWindowLong(hwnd, GWL_EXSTYLE);
   if (ignore)
     ex_style |= (WS_EX_TRANSPARENT | WS_EX_LAYERED);
   else
     ex_style &= ~(WS_EX_TRANSPARENT | WS_EX_LAYERED);
 
-  ::SetWindowLong(hwnd, GWL_EXSTYLE, ex_style);
+  win32::SetWindowLong(hwnd, GWL_EXSTYLE, ex_style);
 }
 
 void WindowManager::PopUpWindowMenu(const flutter::EncodableMap& args) {
   HWND hWnd = GetMainWindow();
-  HMENU hMenu = GetSystemMenu(hWnd, false);
+  HMENU hMenu = win32::GetSystemMenu(hWnd, false);
 
   double x, y;
 
   POINT cursorPos;
-  GetCursorPos(&cursorPos);
+  win32::GetCursorPos(&cursorPos);
   x = cursorPos.x;
   y = cursorPos.y;
 
-  int cmd =
-      TrackPopupMenu(hMenu, TPM_LEFTBUTTON | TPM_RIGHTBUTTON | TPM_RETURNCMD,
-                     static_cast<int>(x), static_cast<int>(y), 0, hWnd, NULL);
+  int cmd = win32::TrackPopupMenu(
+      hMenu, TPM_LEFTBUTTON | TPM_RIGHTBUTTON | TPM_RETURNCMD,
+      static_cast<int>(x), static_cast<int>(y), 0, hWnd, NULL);
 
   if (cmd) {
-    PostMessage(hWnd, WM_SYSCOMMAND, cmd, 0);
+    win32::PostMessage(hWnd, WM_SYSCOMMAND, cmd, 0);
   }
 }
 
 void WindowManager::StartDragging() {
-  ReleaseCapture();
+  win32::ReleaseCapture();
   Undock();
-  SendMessage(GetMainWindow(), WM_SYSCOMMAND, SC_MOVE | HTCAPTION, 0);
+  win32::SendMessage(GetMainWindow(), WM_SYSCOMMAND, SC_MOVE | HTCAPTION, 0);
 }
 
 void WindowManager::StartResizing(const flutter::EncodableMap& args) {
@@ -1102,7 +1318,7 @@ void WindowManager::StartResizing(const flutter::EncodableMap& args) {
 
   HWND hWnd = GetMainWindow();
   Undock();
-  ReleaseCapture();
+  win32::ReleaseCapture();
   LONG command;
   if (top && !bottom && !right && !left) {
     command = HTTOP;
@@ -1121,9 +1337,81 @@ void WindowManager::StartResizing(const flutter::EncodableMap& args) {
   } else
     command = HTBOTTOMRIGHT;
   POINT cursorPos;
-  GetCursorPos(&cursorPos);
-  PostMessage(hWnd, WM_NCLBUTTONDOWN, command,
-              MAKELPARAM(cursorPos.x, cursorPos.y));
+  win32::GetCursorPos(&cursorPos);
+  win32::PostMessage(hWnd, WM_NCLBUTTONDOWN, command,
+                     MAKELPARAM(cursorPos.x, cursorPos.y));
+}
+
+void WindowManager::SetHitTestRegions(const flutter::EncodableMap& args) {
+  const flutter::EncodableValue* ratio = ValueOrNull(args, "devicePixelRatio");
+  if (ratio != nullptr && std::holds_alternative<double>(*ratio)) {
+    pixel_ratio_ = std::get<double>(*ratio);
+  }
+
+  hit_test_regions_.clear();
+  const flutter::EncodableList& regions = std::get<flutter::EncodableList>(
+      args.at(flutter::EncodableValue("regions")));
+  for (const flutter::EncodableValue& value : regions) {
+    const flutter::EncodableMap& region =
+        std::get<flutter::EncodableMap>(value);
+    int32_t code = HitTestCodeFromType(
+        std::get<std::string>(region.at(flutter::EncodableValue("type"))));
+    if (code < 0) {
+      continue;
+    }
+    hit_test_regions_.push_back(
+        {std::get<double>(region.at(flutter::EncodableValue("x"))),
+         std::get<double>(region.at(flutter::EncodableValue("y"))),
+         std::get<double>(region.at(flutter::EncodableValue("width"))),
+         std::get<double>(region.at(flutter::EncodableValue("height"))),
+         code});
+  }
+  UpdateHitTestMap();
+
+  // The Flutter view covers the whole client area and gets WM_NCHITTEST
+  // first, so it has to answer HTTRANSPARENT over the registered non-client
+  // regions for the top-level window to see them.
+  HWND flutter_view = win32::FindWindowEx(GetMainWindow(), nullptr,
+                                          kFlutterViewWindowClassName, nullptr);
+  if (flutter_view && flutter_view != hit_test_flutter_view_ &&
+      win32::SetWindowSubclass(flutter_view, FlutterViewHitTestProc, 1,
+                               reinterpret_cast<DWORD_PTR>(this))) {
+    hit_test_flutter_view_ = flutter_view;
+  }
+}
+
+void WindowManager::UpdateHitTestMap() {
+  hit_test_map_.Build(hit_test_regions_, pixel_ratio_);
+}
+
+int32_t WindowManager::HitTest(LPARAM lParam, int32_t fallback) {
+  if (hit_test_map_.empty()) {
+    return fallback;
+  }
+  POINT point = {static_cast<short>(LOWORD(lParam)),
+                 static_cast<short>(HIWORD(lParam))};
+  win32::ScreenToClient(GetMainWindow(), &point);
+  return hit_test_map_.Lookup(point.x, point.y, fallback);
+}
+
+// static
+LRESULT CALLBACK WindowManager::FlutterViewHitTestProc(HWND hWnd,
+                                                       UINT message,
+                                                       WPARAM wParam,
+                                                       LPARAM lParam,
+                                                       UINT_PTR uIdSubclass,
+                                                       DWORD_PTR dwRefData) {
+  if (message == WM_NCHITTEST) {
+    WindowManager* self = reinterpret_cast<WindowManager*>(dwRefData);
+    if (self->HitTest(lParam, HTCLIENT) != HTCLIENT) {
+      return HTTRANSPARENT;
+    }
+  } else if (message == WM_NCDESTROY) {
+    win32::RemoveWindowSubclass(hWnd, FlutterViewHitTestProc, uIdSubclass);
+    WindowManager* self = reinterpret_cast<WindowManager*>(dwRefData);
+    self->hit_test_flutter_view_ = nullptr;
+  }
+  return win32::DefSubclassProc(hWnd, message, wParam, lParam);
 }
 
 }  // namespace
\ No newline at end of file
@@ -7,13 +7,18 @@
 #include <flutter/plugin_registrar_windows.h>
 #include <flutter/standard_method_codec.h>
 
-#include <codecvt>
 #include <map>
 #include <memory>
 #include <sstream>
 
 #include "window_manager.cpp"
 
+// Set in the WINDOWPOS of the position change that minimizes, maximizes or
+// restores a window. Not in the SDK headers.
+#ifndef SWP_STATECHANGED
+#define SWP_STATECHANGED 0x8000
+#endif
+
 namespace {
 
 bool IsWindows11OrGreater() {
@@ -45,51 +50,22 @@ class WindowManagerPlugin : public flutter::Plugin {
       std::default_delete<flutter::MethodChannel<flutter::EncodableValue>>>
       channel = nullptr;
 
-  WindowManager* window_manager;
+  std::unique_ptr<WindowManager> window_manager;
   flutter::PluginRegistrarWindows* registrar;
 
   // The ID of the WindowProc delegate registration.
   int window_proc_id = -1;
 
-  void WindowManagerPlugin::_EmitEvent(std::string eventName);
+  void _EmitEvent(std::string eventName);
   // Called for top-level WindowProc delegation.
-  std::optional<LRESULT> WindowManagerPlugin::HandleWindowProc(HWND hWnd,
-                                                               UINT message,
-                                                               WPARAM wParam,
-                                                               LPARAM lParam);
+  std::optional<LRESULT> HandleWindowProc(HWND hWnd,
+                                          UINT message,
+                                          WPARAM wParam,
+                                          LPARAM lParam);
   // Called when a method is called on this plugin's channel from Dart.
   void HandleMethodCall(
       const flutter::MethodCall<flutter::EncodableValue>& method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
-
-  void adjustNCCALCSIZE(HWND hwnd, NCCALCSIZE_PARAMS* sz) {
-    LONG l = 8;
-    LONG t = 8;
-
-    // HMONITOR monitor = MonitorFromWindow(hwnd, MONITOR_DEFAULTTONEAREST);
-    // Don't use `MonitorFromWindow(hwnd, MONITOR_DEFAULTTONEAREST)` above.
-    // Because if the window is restored from minimized state, the window is not
-    // in the correct monitor. The monitor is always the left-most monitor.
-    // https://github.com/leanflutter/window_manager/issues/489
-    HMONITOR monitor = MonitorFromRect(&sz->rgrc[0], MONITOR_DEFAULTTONEAREST);
-    if (monitor != NULL) {
-      MONITORINFO monitorInfo;
-      monitorInfo.cbSize = sizeof(MONITORINFO);
-      if (TRUE == GetMonitorInfo(monitor, &monitorInfo)) {
-        l = sz->rgrc[0].left - monitorInfo.rcWork.left;
-        t = sz->rgrc[0].top - monitorInfo.rcWork.top;
-      } else {
-        // GetMonitorInfo failed, use (8, 8) as default value
-      }
-    } else {
-      // unreachable code
-    }
-
-    sz->rgrc[0].left -= l;
-    sz->rgrc[0].top -= t;
-    sz->rgrc[0].right += l;
-    sz->rgrc[0].bottom += t;
-  }
 };
 
 // static
@@ -103,7 +79,8 @@ void WindowManagerPlugin::RegisterWithRegistrar(
 WindowManagerPlugin::WindowManagerPlugin(
     flutter::PluginRegistrarWindows* registrar)
     : registrar(registrar) {
-  window_manager = new WindowManager();
+  window_manager = std::make_unique<WindowManager>();
+  window_manager->is_windows_11_or_greater_ = IsWindows11OrGreater();
   window_proc_id = registrar->RegisterTopLevelWindowProcDelegate(
       [this](HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
         return HandleWindowProc(hWnd, message, wParam, lParam);
@@ -138,45 +115,91 @@ std::optional<LRESULT> WindowManagerPlugin::HandleWindowProc(HWND hWnd,
                                                              LPARAM lParam) {
   std::optional<LRESULT> result = std::nullopt;
 
+  MonitorCache::Instance().HandleTopologyMessage(message);
+
+  if (message == WM_SETTEXT) {
+    // Delegates run before the window procedure, so set the text here, as
+    // the window procedure would leave it to DefWindowProc, and cache it only
+    // once it is set.
+    LRESULT set = win32::DefWindowProcW(hWnd, message, wParam, lParam);
+    if (set) {
+      window_manager->CacheTitle(reinterpret_cast<const wchar_t*>(lParam));
+    }
+    return set;
+  }
+
+  if (message == WM_DESTROY) {
+    CompositionEngine::Release(hWnd);
+    // Frees the window's taskbar slot for windows created later.
+    TaskbarWorker::Instance().Forget(hWnd);
+  }
+
   if (message == WM_DPICHANGED) {
     window_manager->pixel_ratio_ =
         (float)LOWORD(wParam) / USER_DEFAULT_SCREEN_DPI;
+    window_manager->UpdateSizeConstraints();
+    window_manager->UpdateHitTestMap();
+    window_manager->ApplyIcon();
     window_manager->ForceChildRefresh();
   }
 
-  if (wParam && message == WM_NCCALCSIZE) {
-    if (window_manager->IsFullScreen() &&
-        window_manager->title_bar_style_ != "normal") {
-      if (window_manager->is_frameless_) {
-        adjustNCCALCSIZE(hWnd, reinterpret_cast<NCCALCSIZE_PARAMS*>(lParam));
+  if (message == WM_DPICHANGED || message == WM_DISPLAYCHANGE ||
+      message == WM_SETTINGCHANGE) {
+    // The work area may have moved.
+    window_manager->RefreshNcInsets();
+  }
+
+  if (message == WM_WINDOWPOSCHANGING) {
+    // Maximizing, restoring, or moving a maximized or fullscreen window
+    // changes the insets; other moves and sizes do not. Only a state change
+    // needs the new maximized state from the window.
+    const WINDOWPOS* pos = reinterpret_cast<const WINDOWPOS*>(lParam);
+    bool state_changed = (pos->flags & SWP_STATECHANGED) != 0;
+    if (state_changed ||
+        ((window_manager->nc_maximized_ || window_manager->IsFullScreen()) &&
+         !(pos->flags & SWP_NOMOVE))) {
+      RECT rect;
+      win32::GetWindowRect(hWnd, &rect);
+      if (!(pos->flags & SWP_NOMOVE)) {
+        rect.right += pos->x - rect.left;
+        rect.bottom += pos->y - rect.top;
+        rect.left = pos->x;
+        rect.top = pos->y;
       }
-      return 0;
-    }
-    // This must always be before handling title_bar_style_ == "hidden" so
-    // the `if TitleBarStyle.hidden` doesn't get executed.
-    if (window_manager->is_frameless_) {
-      if (window_manager->IsMaximized()) {
-        adjustNCCALCSIZE(hWnd, reinterpret_cast<NCCALCSIZE_PARAMS*>(lParam));
+      if (!(pos->flags & SWP_NOSIZE)) {
+        rect.right = rect.left + pos->cx;
+        rect.bottom = rect.top + pos->cy;
       }
-      return 0;
+      window_manager->RefreshNcInsets(
+          &rect, state_changed ? win32::IsZoomed(hWnd) != FALSE
+                               : window_manager->nc_maximized_);
     }
+  }
 
-    // This must always be last.
-    if (wParam && window_manager->title_bar_style_ == "hidden") {
-      if (window_manager->IsMaximized()) {
-        // Adjust the borders when maximized so the app isn't cut off
-        adjustNCCALCSIZE(hWnd, reinterpret_cast<NCCALCSIZE_PARAMS*>(lParam));
-      } else {
-        NCCALCSIZE_PARAMS* sz = reinterpret_cast<NCCALCSIZE_PARAMS*>(lParam);
-        // on windows 10, if set to 0, there's a white line at the top
-        // of the app and I've yet to find a way to remove that.
-        sz->rgrc[0].top += IsWindows11OrGreater() ? 0 : 1;
-        // The following lines are required for resizing the window.
-        // https://github.com/leanflutter/window_manager/issues/483
-        sz->rgrc[0].right -= 8;
-        sz->rgrc[0].bottom -= 8;
-        sz->rgrc[0].left -= -8;
-      }
+  if (message == WM_SIZE && wParam != SIZE_MINIMIZED &&
+      (wParam == SIZE_MAXIMIZED) != window_manager->nc_maximized_) {
+    // A maximize or restore that came without SWP_STATECHANGED was answered
+    // with the old insets; recompute them and ask again.
+    window_manager->RefreshNcInsets(nullptr, wParam == SIZE_MAXIMIZED);
+    win32::SetWindowPos(hWnd, nullptr, 0, 0, 0, 0,
+                        SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER |
+                            SWP_NOACTIVATE | SWP_FRAMECHANGED);
+  }
+
+  if (wParam && message == WM_NCCALCSIZE) {
+    NCCALCSIZE_PARAMS* sz = reinterpret_cast<NCCALCSIZE_PARAMS*>(lParam);
+
+    // The insets are precomputed from the frame mode (see nc_insets.h). For
+    // hidden title bars, on windows 10 a top inset of 0 leaves a white line at
+    // the top of the app, and the 8px side and bottom insets are required for
+    // resizing the window.
+    // https://github.com/leanflutter/window_manager/issues/483
+    const NcInsets& insets = window_manager->nc_insets_;
+    if (insets.handled) {
+      sz->rgrc[0].left += insets.left;
+      sz->rgrc[0].top += insets.top;
+      sz->rgrc[0].right += insets.right;
+      sz->rgrc[0].bottom += insets.bottom;
 
       // Previously (WVR_HREDRAW | WVR_VREDRAW), but returning 0 or 1 doesn't
       // actually break anything so I've set it to 0. Unless someone pointed a
@@ -184,24 +207,44 @@ std::optional<LRESULT> WindowManagerPlugin::HandleWindowProc(HWND hWnd,
       return 0;
     }
   } else if (message == WM_NCHITTEST) {
-    if (!window_manager->is_resizable_) {
+    // Title bar and resize border regions registered from Dart. Windows that
+    // are not resizable keep their title bar and button regions; only the
+    // resize borders are suppressed.
+    int32_t code = window_manager->HitTest(lParam, HTNOWHERE);
+    if (!window_manager->is_resizable_ &&
+        (code == HTNOWHERE || IsResizeBorderHitTestCode(code))) {
       return HTNOWHERE;
     }
+    if (code != HTNOWHERE) {
+      return code;
+    }
+  } else if (message == WM_NCLBUTTONDOWN && wParam == HTMAXBUTTON) {
+    // Registered maximize buttons are drawn by Flutter; swallow the press so
+    // DefWindowProc doesn't paint the classic button, and act on release.
+    return 0;
+  } else if (message == WM_NCLBUTTONUP && wParam == HTMAXBUTTON) {
+    // The region may outlive setMaximizable(false).
+    if (!window_manager->IsMaximizable()) {
+      return 0;
+    }
+    if (win32::IsZoomed(hWnd)) {
+      win32::ShowWindow(hWnd, SW_RESTORE);
+    } else {
+      win32::ShowWindow(hWnd, SW_MAXIMIZE);
+    }
+    return 0;
   } else if (message == WM_GETMINMAXINFO) {
     MINMAXINFO* info = reinterpret_cast<MINMAXINFO*>(lParam);
+    const SizeConstraints& constraints = window_manager->size_constraints_;
     // For the special "unconstrained" values, leave the defaults.
-    if (window_manager->minimum_size_.x != 0)
-      info->ptMinTrackSize.x = static_cast<LONG>(
-          window_manager->minimum_size_.x * window_manager->pixel_ratio_);
-    if (window_manager->minimum_size_.y != 0)
-      info->ptMinTrackSize.y = static_cast<LONG>(
-          window_manager->minimum_size_.y * window_manager->pixel_ratio_);
-    if (window_manager->maximum_size_.x != -1)
-      info->ptMaxTrackSize.x = static_cast<LONG>(
-          window_manager->maximum_size_.x * window_manager->pixel_ratio_);
-    if (window_manager->maximum_size_.y != -1)
-      info->ptMaxTrackSize.y = static_cast<LONG>(
-          window_manager->maximum_size_.y * window_manager->pixel_ratio_);
+    if (constraints.Has(SizeConstraints::kMinWidth))
+      info->ptMinTrackSize.x = constraints.min_width;
+    if (constraints.Has(SizeConstraints::kMinHeight))
+      info->ptMinTrackSize.y = constraints.min_height;
+    if (constraints.Has(SizeConstraints::kMaxWidth))
+      info->ptMaxTrackSize.x = constraints.max_width;
+    if (constraints.Has(SizeConstraints::kMaxHeight))
+      info->ptMaxTrackSize.y = constraints.max_height;
     result = 0;
   } else if (message == WM_NCACTIVATE) {
     if (wParam != 0) {
@@ -210,9 +253,12 @@ std::optional<LRESULT> WindowManagerPlugin::HandleWindowProc(HWND hWnd,
       _EmitEvent("blur");
     }
 
-    if (window_manager->title_bar_style_ == "hidden" ||
-        window_manager->is_frameless_)
+    if (window_manager->nc_frame_mode_ != NcFrameMode::kNormal)
       return 1;
+  } else if (message == WM_ENTERSIZEMOVE) {
+    // The frame may have changed since the constraints were compiled.
+    window_manager->UpdateSizeConstraints();
+    window_manager->BuildSnapIndex();
   } else if (message == WM_EXITSIZEMOVE) {
     if (window_manager->is_resizing_) {
       _EmitEvent("resized");
@@ -225,69 +271,23 @@ std::optional<LRESULT> WindowManagerPlugin::HandleWindowProc(HWND hWnd,
     return false;
   } else if (message == WM_MOVING) {
     window_manager->is_moving_ = true;
+    window_manager->SnapMovingRect(reinterpret_cast<RECT*>(lParam));
     _EmitEvent("move");
     return false;
   } else if (message == WM_SIZING) {
     window_manager->is_resizing_ = true;
     _EmitEvent("resize");
 
-    if (window_manager->aspect_ratio_ > 0) {
-      RECT* rect = (LPRECT)lParam;
-
-      double aspect_ratio = window_manager->aspect_ratio_;
-
-      int new_width = static_cast<int>(rect->right - rect->left);
-      int new_height = static_cast<int>(rect->bottom - rect->top);
-
-      bool is_resizing_horizontally =
-          wParam == WMSZ_LEFT || wParam == WMSZ_RIGHT ||
-          wParam == WMSZ_TOPLEFT || wParam == WMSZ_BOTTOMLEFT;
-
-      if (is_resizing_horizontally) {
-        new_height = static_cast<int>(new_width / aspect_ratio);
-      } else {
-        new_width = static_cast<int>(new_height * aspect_ratio);
-      }
-
-      int left = rect->left;
-      int top = rect->top;
-      int right = rect->right;
-      int bottom = rect->bottom;
-
-      switch (wParam) {
-        case WMSZ_RIGHT:
-        case WMSZ_BOTTOM:
-          right = new_width + left;
-          bottom = top + new_height;
-          break;
-        case WMSZ_TOP:
-          right = new_width + left;
-          top = bottom - new_height;
-          break;
-        case WMSZ_LEFT:
-        case WMSZ_TOPLEFT:
-          left = right - new_width;
-          top = bottom - new_height;
-          break;
-        case WMSZ_TOPRIGHT:
-          right = left + new_width;
-          top = bottom - new_height;
-          break;
-        case WMSZ_BOTTOMLEFT:
-          left = right - new_width;
-          bottom = top + new_height;
-          break;
-        case WMSZ_BOTTOMRIGHT:
-          right = left + new_width;
-          bottom = top + new_height;
-          break;
-      }
-
-      rect->left = left;
-      rect->top = top;
-      rect->right = right;
-      rect->bottom = bottom;
-    }
+    // Size, aspect ratio, step and grid constraints are compiled ahead of
+    // time (see size_constraints.h).
+    RECT* rect = (LPRECT)lParam;
+    SizeConstraintRect proposed = {rect->left, rect->top, rect->right,
+                                   rect->bottom};
+    ApplySizeConstraints(window_manager->size_constraints_, wParam, &proposed);
+    rect->left = proposed.left;
+    rect->top = proposed.top;
+    rect->right = proposed.right;
+    rect->bottom = proposed.bottom;
   } else if (message == WM_SIZE) {
     if (window_manager->IsFullScreen() && wParam == SIZE_MAXIMIZED &&
         window_manager->last_state != STATE_FULLSCREEN_ENTERED) {
@@ -346,7 +346,7 @@ void WindowManagerPlugin::HandleMethodCall(
 
   if (method_name.compare("ensureInitialized") == 0) {
     window_manager->native_window =
-        ::GetAncestor(registrar->GetView()->GetNativeWindow(), GA_ROOT);
+        win32::GetAncestor(registrar->GetView()->GetNativeWindow(), GA_ROOT);
     result->Success(flutter::EncodableValue(true));
   } else if (method_name.compare("waitUntilReadyToShow") == 0) {
     window_manager->WaitUntilReadyToShow();
@@ -461,6 +461,21 @@ void WindowManagerPlugin::HandleMethodCall(
         std::get<flutter::EncodableMap>(*method_call.arguments());
     window_manager->SetMaximumSize(args);
     result->Success(flutter::EncodableValue(true));
+  } else if (method_name.compare("setSizeConstraints") == 0) {
+    const flutter::EncodableMap& args =
+        std::get<flutter::EncodableMap>(*method_call.arguments());
+    window_manager->SetSizeConstraints(args);
+    result->Success(flutter::EncodableValue(true));
+  } else if (method_name.compare("setSnapDistance") == 0) {
+    const flutter::EncodableMap& args =
+        std::get<flutter::EncodableMap>(*method_call.arguments());
+    window_manager->SetSnapDistance(args);
+    result->Success(flutter::EncodableValue(true));
+  } else if (method_name.compare("setHitTestRegions") == 0) {
+    const flutter::EncodableMap& args =
+        std::get<flutter::EncodableMap>(*method_call.arguments());
+    window_manager->SetHitTestRegions(args);
+    result->Success(flutter::EncodableValue(true));
   } else if (method_name.compare("isResizable") == 0) {
     bool value = window_manager->IsResizable();
     result->Success(flutter::EncodableValue(value));
@@ -510,7 +525,7 @@ void WindowManagerPlugin::HandleMethodCall(
     window_manager->SetAlwaysOnBottom(args);
     result->Success(flutter::EncodableValue(true));
   } else if (method_name.compare("getTitle") == 0) {
-    std::string value = window_manager->GetTitle();
+    const std::string& value = window_manager->GetTitle();
     result->Success(flutter::EncodableValue(value));
   } else if (method_name.compare("setTitle") == 0) {
     const flutter::EncodableMap& args =
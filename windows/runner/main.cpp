@@ -5,24 +5,46 @@
 #include <flutter/dart_project.h>
 #include <flutter/flutter_engine.h>
 #include <flutter/generated_plugin_registrant.h>
+#include <flutter/method_channel.h>
+#include <flutter/method_result_functions.h>
 #include <flutter/plugin_registrar_windows.h>
+#include <flutter/standard_method_codec.h>
 
+#include <cstring>
 #include <iostream>
+#include <thread>
 #include <vector>
 #include <dwmapi.h>
 #include <map>
 #include <algorithm>
+#include <optional>
 
+#include "query_pool.h"
+#include "session_store.h"
+#include "startup_profiler.h"
 #include "utils.h"
-
-#include "../flutter/ephemeral/cpp_client_wrapper/include/flutter/method_channel.h"
-#include "../flutter/ephemeral/cpp_client_wrapper/include/flutter/standard_method_codec.h"
+#include "window_events.h"
+#include "window_ffi.h"
+#include "window_filter.h"
+#include "window_info_batch.h"
+#include "window_mode.h"
+#include "window_state_mirror.h"
+#include "../../alpha_mask.h"
+#include "../../composition_engine.h"
+#include "../../monitor_cache.h"
+#include "../../nc_insets.h"
+#include "../../utf_transcode.h"
+#include "../../win32_calls.h"
 
 #pragma comment(lib, "dwmapi.lib")
 
 // Custom window message for deferred window processing
 #define WM_FLUTTER_WINDOW_CREATED (WM_APP + 1)
 
+// Posted to a window adopted into the session to re-apply its saved mode
+// once creation has finished
+#define WM_FLUTTER_RESTORE_WINDOW_MODE (WM_APP + 2)
+
 // Timer ID for delayed window setup
 #define TIMER_AUTOSETUP_WINDOW 1001
 
@@ -115,6 +137,59 @@ std::map<HWND, bool> g_flutter_frameless_windows;
 // Global state to track Flutter windows with transparent backgrounds
 std::map<HWND, bool> g_flutter_transparent_windows;
 
+// Precomputed WM_NCCALCSIZE answer for each window with a custom frame.
+// Recomputed whenever the frame mode, the maximized state or the monitor
+// changes, so the message itself only has to apply the stored insets.
+struct FlutterWindowFrameState {
+  NcFrameMode mode = NcFrameMode::kNormal;
+  bool maximized = false;
+  NcInsets insets;
+};
+std::map<HWND, FlutterWindowFrameState> g_flutter_window_frame_states;
+
+// Per-pixel hit-test masks for partially click-through windows, and the
+// FLUTTERVIEW children subclassed to honour them
+std::map<HWND, AlphaHitMask> g_flutter_hit_test_masks;
+std::map<HWND, HWND> g_flutter_masked_views;
+
+// Window layout persisted across launches, the creation-order slot of each
+// top-level Flutter window, and the windows to maximize when first shown
+SessionStore g_session_store;
+std::map<HWND, uint32_t> g_session_window_slots;
+uint32_t g_next_session_window_slot = 0;
+std::map<HWND, bool> g_session_pending_maximize;
+
+// Bounds, DPI, visibility and min/max state of each subclassed window. Read
+// from the window once when it is subclassed, then kept from the WINDOWPOS of
+// its WM_WINDOWPOSCHANGED messages and from WM_DPICHANGED, so a move or size
+// costs no further queries of the window
+struct WindowPlacement {
+  RECT rect = {};
+  UINT dpi = USER_DEFAULT_SCREEN_DPI;
+  bool visible = false;
+  bool minimized = false;
+  bool maximized = false;
+  // Inside a modal move or size loop; the session record waits for its end
+  bool moving = false;
+};
+std::map<HWND, WindowPlacement> g_window_placements;
+
+// Set in the WINDOWPOS of the position change that minimizes, maximizes or
+// restores a window. Not in the SDK headers.
+#define SWP_STATECHANGED 0x8000
+
+// UTF-8 window text of each subclassed window, kept current from WM_SETTEXT
+// so title reads do not send WM_GETTEXT and transcode again
+std::map<HWND, std::string> g_window_titles;
+
+// The subclassed window whose message the subclass procedure is passing on
+// to the original window procedure, restored once that returns
+HWND g_forwarding_window = nullptr;
+
+// The subclassed window that was activated last, tracked from WM_ACTIVATE
+// and WM_NCACTIVATE; the window that 'target': 'focused' calls act on
+HWND g_last_active_window = nullptr;
+
 // Global function pointer for SetWindowCompositionAttribute
 SetWindowCompositionAttribute g_set_window_composition_attribute = nullptr;
 
@@ -131,31 +206,6 @@ UINT_PTR g_next_timer_id = TIMER_AUTOSETUP_WINDOW;
 // Forward declaration
 bool AutoSetupFlutterWindow(HWND hwnd);
 
-/**
- * Adjust NCCALCSIZE parameters for maximized frameless windows.
- * This mimics the window_manager plugin's adjustNCCALCSIZE function.
- */
-void adjustNCCALCSIZE(HWND hwnd, NCCALCSIZE_PARAMS* sz) {
-  LONG l = 8;
-  LONG t = 8;
-
-  // Get monitor information for proper border calculation
-  HMONITOR monitor = MonitorFromRect(&sz->rgrc[0], MONITOR_DEFAULTTONEAREST);
-  if (monitor != NULL) {
-    MONITORINFO monitorInfo;
-    monitorInfo.cbSize = sizeof(MONITORINFO);
-    if (TRUE == GetMonitorInfo(monitor, &monitorInfo)) {
-      l = sz->rgrc[0].left - monitorInfo.rcWork.left;
-      t = sz->rgrc[0].top - monitorInfo.rcWork.top;
-    }
-  }
-
-  sz->rgrc[0].left -= l;
-  sz->rgrc[0].top -= t;
-  sz->rgrc[0].right += l;
-  sz->rgrc[0].bottom += t;
-}
-
 /**
  * Check if running on Windows 11 or greater.
  * Used to handle Windows version-specific behavior for title bar hiding.
@@ -175,6 +225,65 @@ bool IsWindows11OrGreater() {
   return dwBuild >= 22000;
 }
 
+/**
+ * Recompute the stored NCCALCSIZE insets for a window.
+ * Call after changing the frameless or hidden title bar tracking of a window,
+ * before the SWP_FRAMECHANGED that makes Windows ask for the new frame.
+ * |window_rect| is the window rect the insets are for when it differs from
+ * the current one (e.g. the target rect in WM_WINDOWPOSCHANGING), and
+ * |maximized| the maximized state when the caller already knows it; otherwise
+ * it is taken from the tracked placement, or IsZoomed() for windows that are
+ * not subclassed.
+ */
+void RefreshNcInsets(HWND hwnd, const RECT* window_rect = nullptr, std::optional<bool> maximized = std::nullopt) {
+  // The OS version never changes at runtime, so look it up once
+  static const bool windows11 = IsWindows11OrGreater();
+
+  auto titleBarIt = g_flutter_hidden_title_bar_windows.find(hwnd);
+  auto framelessIt = g_flutter_frameless_windows.find(hwnd);
+
+  NcInsetInputs inputs;
+  if (framelessIt != g_flutter_frameless_windows.end() && framelessIt->second) {
+    inputs.mode = NcFrameMode::kFrameless;
+  } else if (titleBarIt != g_flutter_hidden_title_bar_windows.end() && titleBarIt->second) {
+    inputs.mode = NcFrameMode::kHiddenTitleBar;
+  }
+
+  if (inputs.mode == NcFrameMode::kNormal) {
+    g_flutter_window_frame_states.erase(hwnd);
+    return;
+  }
+
+  if (maximized) {
+    inputs.maximized = *maximized;
+  } else {
+    auto placementIt = g_window_placements.find(hwnd);
+    inputs.maximized = placementIt != g_window_placements.end() ? placementIt->second.maximized
+                                                                : win32::IsZoomed(hwnd) != FALSE;
+  }
+  inputs.windows11 = windows11;
+
+  // Maximized frameless windows are clipped to the work area of their monitor
+  if (inputs.maximized && inputs.mode == NcFrameMode::kFrameless) {
+    RECT rect;
+    if (window_rect) {
+      rect = *window_rect;
+    } else {
+      win32::GetWindowRect(hwnd, &rect);
+    }
+    CachedMonitor monitor;
+    if (MonitorCache::Instance().FromRect(rect, &monitor)) {
+      inputs.work_offset_x = monitor.work.left - rect.left;
+      inputs.work_offset_y = monitor.work.top - rect.top;
+    }
+  }
+
+  FlutterWindowFrameState& state = g_flutter_window_frame_states[hwnd];
+  state.mode = inputs.mode;
+  state.maximized = inputs.maximized;
+  state.insets = ComputeRunnerNcInsets(inputs);
+}
+
 /**
  * Check if a window handle belongs to a Flutter window.
  * This helps us avoid interfering with non-Flutter windows.
@@ -182,7 +291,7 @@ bool IsWindows11OrGreater() {
 bool IsFlutterWindow(HWND hwnd) {
   // Check window class name - Flutter windows typically have specific class names
   wchar_t className[256];
-  if (GetClassNameW(hwnd, className, sizeof(className) / sizeof(wchar_t))) {
+  if (win32::GetClassNameW(hwnd, className, sizeof(className) / sizeof(wchar_t))) {
     std::wstring classStr(className);
 
     // Flutter windows often have class names containing "Flutter" or specific patterns
@@ -201,10 +310,334 @@ bool IsFlutterWindow(HWND hwnd) {
 
   // Additional check: Flutter windows are typically owned by the current process
   DWORD pid = 0;
-  GetWindowThreadProcessId(hwnd, &pid);
+  win32::GetWindowThreadProcessId(hwnd, &pid);
   return (pid == GetCurrentProcessId());
 }
 
+/**
+ * Read a window's placement from the window itself.
+ */
+WindowPlacement ReadWindowPlacement(HWND hwnd) {
+  WindowPlacement placement;
+  win32::GetWindowRect(hwnd, &placement.rect);
+  placement.dpi = MonitorCache::Instance().DpiForWindow(hwnd);
+  placement.visible = win32::IsWindowVisible(hwnd) != FALSE;
+  placement.minimized = win32::IsIconic(hwnd) != FALSE;
+  placement.maximized = win32::IsZoomed(hwnd) != FALSE;
+  return placement;
+}
+
+/**
+ * Apply the WINDOWPOS of a WM_WINDOWPOSCHANGED to a window's placement.
+ * The min/max state is only queried when the size, the frame or the state
+ * changed; moves and z-order changes use the WINDOWPOS alone.
+ * Returns whether the placement changed.
+ */
+bool UpdateWindowPlacement(HWND hwnd, const WINDOWPOS& pos, WindowPlacement* placement) {
+  WindowPlacement before = *placement;
+  RECT& rect = placement->rect;
+  if (!(pos.flags & SWP_NOMOVE)) {
+    rect.right += pos.x - rect.left;
+    rect.bottom += pos.y - rect.top;
+    rect.left = pos.x;
+    rect.top = pos.y;
+  }
+  if (!(pos.flags & SWP_NOSIZE)) {
+    rect.right = rect.left + pos.cx;
+    rect.bottom = rect.top + pos.cy;
+  }
+  if (pos.flags & SWP_SHOWWINDOW) {
+    placement->visible = true;
+  } else if (pos.flags & SWP_HIDEWINDOW) {
+    placement->visible = false;
+  }
+  if (!(pos.flags & SWP_NOSIZE) || (pos.flags & (SWP_FRAMECHANGED | SWP_STATECHANGED))) {
+    placement->minimized = win32::IsIconic(hwnd) != FALSE;
+    placement->maximized = win32::IsZoomed(hwnd) != FALSE;
+  }
+  return before.rect.left != rect.left || before.rect.top != rect.top ||
+         before.rect.right != rect.right || before.rect.bottom != rect.bottom ||
+         before.visible != placement->visible ||
+         before.minimized != placement->minimized || before.maximized != placement->maximized;
+}
+
+/**
+ * Store a window's bounds, DPI and mode flags in the session file, from its
+ * placement. This only writes to the mapped view, and only when the record
+ * changed; the file is flushed at exit.
+ */
+void RecordSessionWindow(HWND hwnd, const WindowPlacement& placement) {
+  auto slotIt = g_session_window_slots.find(hwnd);
+  if (slotIt == g_session_window_slots.end()) {
+    return;
+  }
+
+  // Start from the previous record to keep the restored bounds of a window
+  // that is currently maximized, minimized or fullscreen
+  SessionStore::WindowRecord record = {};
+  g_session_store.CurrentRecord(slotIt->second, &record);
+
+  record.flags = 0;
+  auto framelessIt = g_flutter_frameless_windows.find(hwnd);
+  if (framelessIt != g_flutter_frameless_windows.end() && framelessIt->second) {
+    record.flags |= SessionStore::kFrameless;
+  }
+  auto titleBarIt = g_flutter_hidden_title_bar_windows.find(hwnd);
+  if (titleBarIt != g_flutter_hidden_title_bar_windows.end() && titleBarIt->second) {
+    record.flags |= SessionStore::kHiddenTitleBar;
+  }
+  auto transparentIt = g_flutter_transparent_windows.find(hwnd);
+  if (transparentIt != g_flutter_transparent_windows.end() && transparentIt->second) {
+    record.flags |= SessionStore::kTransparent;
+  }
+
+  SessionStore::WindowRecord previous = record;
+  CachedMonitor monitor;
+  const RECT& rect = placement.rect;
+  if (placement.maximized) {
+    record.flags |= SessionStore::kMaximized;
+  } else if (!placement.minimized) {
+    bool fullscreen = MonitorCache::Instance().FromRect(rect, &monitor) &&
+                      rect.left == monitor.monitor.left && rect.top == monitor.monitor.top &&
+                      rect.right == monitor.monitor.right && rect.bottom == monitor.monitor.bottom;
+    if (fullscreen) {
+      record.flags |= SessionStore::kFullscreen;
+    }
+    if (!fullscreen || record.right <= record.left) {
+      record.left = rect.left;
+      record.top = rect.top;
+      record.right = rect.right;
+      record.bottom = rect.bottom;
+    }
+  }
+  record.dpi = placement.dpi;
+
+  if (std::memcmp(&record, &previous, sizeof(record)) != 0) {
+    g_session_store.Write(slotIt->second, record);
+  }
+}
+
+/**
+ * Store a window's state in the session file, from its tracked placement or,
+ * for windows that are not subclassed, from the window.
+ */
+void RecordSessionWindow(HWND hwnd) {
+  auto placementIt = g_window_placements.find(hwnd);
+  if (placementIt != g_window_placements.end()) {
+    RecordSessionWindow(hwnd, placementIt->second);
+  } else if (g_session_window_slots.find(hwnd) != g_session_window_slots.end()) {
+    RecordSessionWindow(hwnd, ReadWindowPlacement(hwnd));
+  }
+}
+
+/**
+ * The current window mode of a window, from the runner's tracking and the
+ * window's placement, or IsZoomed() for windows that are not subclassed.
+ */
+uint8_t CurrentWindowMode(HWND hwnd) {
+  uint8_t mode = 0;
+  auto titleBarIt = g_flutter_hidden_title_bar_windows.find(hwnd);
+  if (titleBarIt != g_flutter_hidden_title_bar_windows.end() && titleBarIt->second) {
+    mode |= kWindowModeHiddenTitleBar;
+  }
+  auto framelessIt = g_flutter_frameless_windows.find(hwnd);
+  if (framelessIt != g_flutter_frameless_windows.end() && framelessIt->second) {
+    mode |= kWindowModeFrameless;
+  }
+  auto transparentIt = g_flutter_transparent_windows.find(hwnd);
+  if (transparentIt != g_flutter_transparent_windows.end() && transparentIt->second) {
+    mode |= kWindowModeTransparent;
+  }
+  auto placementIt = g_window_placements.find(hwnd);
+  bool maximized = placementIt != g_window_placements.end() ? placementIt->second.maximized
+                                                            : win32::IsZoomed(hwnd) != FALSE;
+  if (maximized) {
+    mode |= kWindowModeMaximized;
+  }
+  return mode;
+}
+
+/**
+ * The state mirror's record of a window, from its placement and window mode.
+ */
+WindowStateSnapshot MirrorState(const WindowPlacement& placement, uint8_t mode) {
+  WindowStateSnapshot state = {};
+  state.x = placement.rect.left;
+  state.y = placement.rect.top;
+  state.width = placement.rect.right - placement.rect.left;
+  state.height = placement.rect.bottom - placement.rect.top;
+  state.dpi = static_cast<int32_t>(placement.dpi);
+  if (placement.visible) {
+    state.flags |= WindowStateMirror::kVisible;
+  }
+  if (placement.minimized) {
+    state.flags |= WindowStateMirror::kMinimized;
+  }
+  if (mode & kWindowModeMaximized) {
+    state.flags |= WindowStateMirror::kMaximized;
+  }
+  state.mode = mode;
+  return state;
+}
+
+/**
+ * Rewrite the state mirror's record of a subclassed window.
+ */
+void UpdateStateMirror(HWND hwnd) {
+  auto placementIt = g_window_placements.find(hwnd);
+  if (placementIt != g_window_placements.end()) {
+    WindowStateMirror::Instance().Update(hwnd, MirrorState(placementIt->second, CurrentWindowMode(hwnd)));
+  }
+}
+
+/**
+ * Move a window to window mode |to| by running the precomputed plan from its
+ * current mode (see window_mode.h). Every custom frame and transparency
+ * handler goes through here, so they all end up with the same styles, DWM
+ * attributes and frame margins for the same mode.
+ * Returns false, leaving the window in its current mode, if the transparency
+ * accent could not be applied.
+ */
+bool ApplyWindowMode(HWND hwnd, uint8_t to) {
+  const WindowModeAttributes& target = kWindowModes[to];
+  const WindowModePlan& plan = WindowModePlanFor(CurrentWindowMode(hwnd), to);
+  for (size_t i = 0; i < plan.count; ++i) {
+    switch (plan.steps[i]) {
+      case WindowModeStep::kAccent:
+        if (target.transparent_accent) {
+          // GradientColor fully transparent in ABGR format
+          AccentTuple accent = {ACCENT_ENABLE_TRANSPARENTGRADIENT, 2, 0x00000000, 0};
+          if (!CompositionEngine::SetAccent(hwnd, CompositionEngine::kTransparency, accent)) {
+            return false;
+          }
+        } else if (!CompositionEngine::Clear(hwnd, CompositionEngine::kTransparency)) {
+          return false;
+        }
+        break;
+      case WindowModeStep::kStyle: {
+        LONG_PTR style = win32::GetWindowLongPtrW(hwnd, GWL_STYLE);
+        win32::SetWindowLongPtrW(hwnd, GWL_STYLE, (style & ~target.style_clear) | target.style_set);
+        break;
+      }
+      case WindowModeStep::kExStyle: {
+        LONG_PTR exStyle = win32::GetWindowLongPtrW(hwnd, GWL_EXSTYLE);
+        win32::SetWindowLongPtrW(hwnd, GWL_EXSTYLE, (exStyle & ~target.ex_style_clear) | target.ex_style_set);
+        break;
+      }
+      case WindowModeStep::kCornerPreference: {
+        DWM_WINDOW_CORNER_PREFERENCE cornerPref = target.corner;
+        win32::DwmSetWindowAttribute(hwnd, DWMWA_WINDOW_CORNER_PREFERENCE, &cornerPref, sizeof(cornerPref));
+        break;
+      }
+      case WindowModeStep::kNcRendering: {
+        DWMNCRENDERINGPOLICY policy = target.nc_rendering;
+        win32::DwmSetWindowAttribute(hwnd, DWMWA_NCRENDERING_POLICY, &policy, sizeof(policy));
+        break;
+      }
+      case WindowModeStep::kMargins:
+        CompositionEngine::SetMargins(hwnd, CompositionEngine::kModeFrame, target.margins);
+        break;
+      case WindowModeStep::kTracking:
+        if (target.flags & kWindowModeHiddenTitleBar) {
+          g_flutter_hidden_title_bar_windows[hwnd] = true;
+        } else {
+          g_flutter_hidden_title_bar_windows.erase(hwnd);
+        }
+        if (target.flags & kWindowModeFrameless) {
+          g_flutter_frameless_windows[hwnd] = true;
+        } else {
+          g_flutter_frameless_windows.erase(hwnd);
+        }
+        if (target.flags & kWindowModeTransparent) {
+          g_flutter_transparent_windows[hwnd] = true;
+        } else {
+          g_flutter_transparent_windows.erase(hwnd);
+        }
+        RecordSessionWindow(hwnd);
+        break;
+      case WindowModeStep::kNcInsets:
+        RefreshNcInsets(hwnd);
+        break;
+      case WindowModeStep::kFrameChanged: {
+        RECT rect;
+        win32::GetWindowRect(hwnd, &rect);
+        win32::SetWindowPos(hwnd, nullptr, rect.left, rect.top,
+                            rect.right - rect.left, rect.bottom - rect.top,
+                            SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_FRAMECHANGED);
+        break;
+      }
+      case WindowModeStep::kReshowMaximized:
+        // window_manager handles this in WM_NCCALCSIZE
+        win32::ShowWindow(hwnd, SW_HIDE);
+        win32::ShowWindow(hwnd, SW_SHOWMAXIMIZED);
+        break;
+      case WindowModeStep::kCount:
+        break;
+    }
+  }
+  WindowEvents::Instance().WindowModeMaybeChanged(hwnd);
+  UpdateStateMirror(hwnd);
+  return true;
+}
+
+/**
+ * Re-apply the frameless, hidden title bar and transparent flags saved for a
+ * window in the previous session. Posted once the window has been created,
+ * since the mode changes restyle and reframe it.
+ */
+void RestoreSessionWindowMode(HWND hwnd) {
+  auto slotIt = g_session_window_slots.find(hwnd);
+  SessionStore::WindowRecord record;
+  if (slotIt == g_session_window_slots.end() ||
+      !g_session_store.PreviousRecord(slotIt->second, &record)) {
+    return;
+  }
+
+  uint8_t mode = CurrentWindowMode(hwnd);
+  mode = WithWindowModeFlag(mode, kWindowModeFrameless, (record.flags & SessionStore::kFrameless) != 0);
+  mode = WithWindowModeFlag(mode, kWindowModeHiddenTitleBar, (record.flags & SessionStore::kHiddenTitleBar) != 0);
+  // Transparency needs SetWindowCompositionAttribute
+  mode = WithWindowModeFlag(mode, kWindowModeTransparent,
+                            (record.flags & SessionStore::kTransparent) != 0 && g_set_window_composition_attribute);
+  if (mode != CurrentWindowMode(hwnd) && !ApplyWindowMode(hwnd, mode)) {
+    std::cerr << "Failed to restore the session window mode for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
+  }
+}
+
+/**
+ * Check whether a WM_NCHITTEST point falls on a transparent pixel of the
+ * window's hit-test mask. Windows without a mask take input everywhere.
+ */
+bool IsMaskedOut(HWND hwnd, LPARAM lParam) {
+  auto maskIt = g_flutter_hit_test_masks.find(hwnd);
+  if (maskIt == g_flutter_hit_test_masks.end() || maskIt->second.empty()) {
+    return false;
+  }
+
+  POINT point = {static_cast<short>(LOWORD(lParam)), static_cast<short>(HIWORD(lParam))};
+  RECT client;
+  if (!win32::ScreenToClient(hwnd, &point) || !win32::GetClientRect(hwnd, &client)) {
+    return false;
+  }
+  return !maskIt->second.TestClient(point.x, point.y, client.right, client.bottom);
+}
+
+/**
+ * Window procedure for the FLUTTERVIEW child of a masked window.
+ * The child receives WM_NCHITTEST before its parent, so it has to let
+ * transparent pixels through as well. dwRefData is the top-level window.
+ */
+LRESULT CALLBACK FlutterViewMaskSubclassProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam, UINT_PTR uIdSubclass, DWORD_PTR dwRefData) {
+  if (message == WM_NCHITTEST && IsMaskedOut(reinterpret_cast<HWND>(dwRefData), lParam)) {
+    return HTTRANSPARENT;
+  }
+  if (message == WM_NCDESTROY) {
+    win32::RemoveWindowSubclass(hwnd, FlutterViewMaskSubclassProc, uIdSubclass);
+    g_flutter_masked_views.erase(reinterpret_cast<HWND>(dwRefData));
+  }
+  return win32::DefSubclassProc(hwnd, message, wParam, lParam);
+}
+
 /**
  * Set up window subclassing for proper message interception.
  * This is called before manipulating a window's title bar to ensure
@@ -215,7 +648,7 @@ bool IsFlutterWindow(HWND hwnd) {
 LRESULT CALLBACK FlutterWindowSubclassProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam, UINT_PTR uIdSubclass, DWORD_PTR dwRefData);
 
 bool setupWindowInterception(HWND hwnd) {
-  if (!hwnd || !::IsWindow(hwnd)) {
+  if (!hwnd || !win32::IsWindow(hwnd)) {
     return false;
   }
 
@@ -223,13 +656,29 @@ bool setupWindowInterception(HWND hwnd) {
   auto it = g_original_window_procedures.find(hwnd);
   if (it == g_original_window_procedures.end()) {
     // Store original procedure
-    WNDPROC originalProc = reinterpret_cast<WNDPROC>(GetWindowLongPtr(hwnd, GWLP_WNDPROC));
+    WNDPROC originalProc = reinterpret_cast<WNDPROC>(win32::GetWindowLongPtr(hwnd, GWLP_WNDPROC));
     g_original_window_procedures[hwnd] = originalProc;
 
+    // Display changes that happened while no window was intercepted went
+    // unnoticed, so start the newly observed window from a fresh topology
+    MonitorCache::Instance().Invalidate();
+
     // Set up subclassing for proper message interception
     // Forward declaration needed - FlutterWindowSubclassProc is defined later
-    if (SetWindowSubclass(hwnd, FlutterWindowSubclassProc, 1, 0)) {
-      std::cout << "Window subclassing set up for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
+    if (win32::SetWindowSubclass(hwnd, FlutterWindowSubclassProc, 1, 0)) {
+      const WindowPlacement& placement = g_window_placements[hwnd] = ReadWindowPlacement(hwnd);
+      RefreshNcInsets(hwnd);
+      // Windows already active when subclassed send no activation message
+      bool active = win32::GetActiveWindow() == hwnd;
+      if (active) {
+        g_last_active_window = hwnd;
+      }
+      WindowEvents::Instance().WindowCreated(hwnd);
+      WindowStateSnapshot state = MirrorState(placement, CurrentWindowMode(hwnd));
+      if (active) {
+        state.flags |= WindowStateMirror::kFocused;
+      }
+      WindowStateMirror::Instance().Track(hwnd, state);
       return true;
     } else {
       std::cerr << "Failed to set up window subclassing for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
@@ -242,80 +691,247 @@ bool setupWindowInterception(HWND hwnd) {
 }
 
 
+/**
+ * Passes a message on to the window procedure that was replaced when the
+ * window was subclassed. While it runs, g_forwarding_window names the window,
+ * which tells RunnerWindowProcDelegate that the window is adopted already.
+ */
+LRESULT CallOriginalWindowProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam) {
+  HWND forwarding = g_forwarding_window;
+  g_forwarding_window = hwnd;
+  LRESULT result;
+  auto origProcIt = g_original_window_procedures.find(hwnd);
+  if (origProcIt != g_original_window_procedures.end()) {
+    result = win32::CallWindowProc(origProcIt->second, hwnd, message, wParam, lParam);
+  } else {
+    // Fallback to default window procedure
+    result = win32::DefWindowProc(hwnd, message, wParam, lParam);
+  }
+  g_forwarding_window = forwarding;
+  return result;
+}
+
+/**
+ * Returns the cached UTF-8 title of a subclassed window, reading the window
+ * text once if it was set before the window was subclassed. Returns nullptr
+ * for windows that are not subclassed, whose text changes go unobserved.
+ */
+const std::string* CachedWindowTitle(HWND hwnd) {
+  auto titleIt = g_window_titles.find(hwnd);
+  if (titleIt != g_window_titles.end()) {
+    return &titleIt->second;
+  }
+  if (g_original_window_procedures.find(hwnd) == g_original_window_procedures.end()) {
+    return nullptr;
+  }
+  std::wstring text(win32::GetWindowTextLengthW(hwnd) + 1, L'\0');
+  int length = win32::GetWindowTextW(hwnd, &text[0], static_cast<int>(text.size()));
+  std::string& title = g_window_titles[hwnd];
+  Utf16ToUtf8(text.data(), static_cast<size_t>(length), &title);
+  return &title;
+}
+
 /**
  * Window procedure for subclassed Flutter windows with hidden title bars.
  * This intercepts WM_NCCALCSIZE messages to properly handle frame calculations.
  */
 LRESULT CALLBACK FlutterWindowSubclassProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam, UINT_PTR uIdSubclass, DWORD_PTR dwRefData) {
-  // Check if this window needs special frame handling (frameless or title bar hidden)
-  auto titleBarIt = g_flutter_hidden_title_bar_windows.find(hwnd);
-  auto framelessIt = g_flutter_frameless_windows.find(hwnd);
+  // Drop the cached monitor topology on display, DPI and work area changes
+  MonitorCache::Instance().HandleTopologyMessage(message);
 
-  bool needsSpecialHandling = (titleBarIt != g_flutter_hidden_title_bar_windows.end() && titleBarIt->second) ||
-                              (framelessIt != g_flutter_frameless_windows.end() && framelessIt->second);
+  // Transparent pixels of a masked window let clicks through
+  if (message == WM_NCHITTEST && IsMaskedOut(hwnd, lParam)) {
+    return HTTRANSPARENT;
+  }
 
-  if (needsSpecialHandling) {
-    // This window needs special frame handling
+  // Keep the session file and the shared state mirror up to date with
+  // moves, sizes and frame changes, and report maximize and restore to Dart,
+  // all from the one placement. A drag writes the session record once, when
+  // it ends; the mirror follows it live
+  auto placementIt = g_window_placements.find(hwnd);
+  if (placementIt != g_window_placements.end()) {
+    WindowPlacement& placement = placementIt->second;
+    bool was_maximized = placement.maximized;
+    if (message == WM_WINDOWPOSCHANGED &&
+        UpdateWindowPlacement(hwnd, *reinterpret_cast<const WINDOWPOS*>(lParam), &placement)) {
+      if (!placement.moving) {
+        RecordSessionWindow(hwnd, placement);
+      }
+      // Of the window mode, only the maximized bit changes with the position;
+      // ApplyWindowMode reports the rest
+      if (placement.maximized != was_maximized) {
+        WindowEvents::Instance().WindowModeMaybeChanged(hwnd);
+      }
+      WindowStateMirror::Instance().Update(hwnd, MirrorState(placement, CurrentWindowMode(hwnd)));
+    } else if (message == WM_DPICHANGED) {
+      placement.dpi = HIWORD(wParam);
+      WindowStateMirror::Instance().Update(hwnd, MirrorState(placement, CurrentWindowMode(hwnd)));
+    } else if (message == WM_ENTERSIZEMOVE) {
+      placement.moving = true;
+    } else if (message == WM_EXITSIZEMOVE) {
+      placement.moving = false;
+      RecordSessionWindow(hwnd, placement);
+    }
+  }
 
-    if (message == WM_NCCALCSIZE && wParam) {
-      // Handle non-client area size calculation for frameless or title bar hidden windows
-      NCCALCSIZE_PARAMS* sz = reinterpret_cast<NCCALCSIZE_PARAMS*>(lParam);
+  // Keep the cached title in step with the window text
+  if (message == WM_SETTEXT) {
+    LRESULT set = CallOriginalWindowProc(hwnd, message, wParam, lParam);
+    if (set) {
+      const wchar_t* text = reinterpret_cast<const wchar_t*>(lParam);
+      std::string& title = g_window_titles[hwnd];
+      if (text) {
+        Utf16ToUtf8(text, wcslen(text), &title);
+      } else {
+        title.clear();
+      }
+    }
+    return set;
+  }
+  if (message == WM_NCDESTROY) {
+    g_window_titles.erase(hwnd);
+    g_flutter_hit_test_masks.erase(hwnd);
+    g_session_window_slots.erase(hwnd);
+    g_session_pending_maximize.erase(hwnd);
+    g_window_placements.erase(hwnd);
+    CompositionEngine::Release(hwnd);
+    WindowEvents::Instance().WindowDestroyed(hwnd);
+    WindowStateMirror::Instance().Untrack(hwnd);
+    if (g_last_active_window == hwnd) {
+      g_last_active_window = nullptr;
+    }
 
-      // Check if this window is frameless
-      bool isFrameless = (framelessIt != g_flutter_frameless_windows.end() && framelessIt->second);
+    // The original procedure still has to see the message; after it the
+    // handle may be reused, so nothing of this window may stay tracked
+    LRESULT destroyed = CallOriginalWindowProc(hwnd, message, wParam, lParam);
+    win32::RemoveWindowSubclass(hwnd, FlutterWindowSubclassProc, uIdSubclass);
+    g_original_window_procedures.erase(hwnd);
+    g_flutter_hidden_title_bar_windows.erase(hwnd);
+    g_flutter_frameless_windows.erase(hwnd);
+    g_flutter_transparent_windows.erase(hwnd);
+    g_flutter_window_frame_states.erase(hwnd);
+    return destroyed;
+  }
 
-      if (::IsZoomed(hwnd)) {
-        // For maximized windows - use window_manager's adjustNCCALCSIZE for frameless
-        if (isFrameless) {
-          adjustNCCALCSIZE(hwnd, sz);
-          std::cout << "[NCCALCSIZE] Maximized frameless window adjusted with monitor info" << std::endl;
-        } else {
-          // For maximized windows with hidden title bar - standard adjustment
-          sz->rgrc[0].left += 8;
-          sz->rgrc[0].top += 8;
-          sz->rgrc[0].right -= 8;
-          sz->rgrc[0].bottom -= 8;
-          std::cout << "[NCCALCSIZE] Maximized title bar hidden window adjusted" << std::endl;
-        }
-      } else {
-        // For normal windows - handle frameless vs title bar hidden differently
-        if (isFrameless) {
-          // For frameless windows: return 0 to indicate no non-client area
-          // This removes all borders and rounded corners completely
-          std::cout << "[NCCALCSIZE] Frameless window - no borders" << std::endl;
-          return 0;
-        } else {
-          // For title bar hidden windows - use window_manager's exact approach
-          sz->rgrc[0].top += IsWindows11OrGreater() ? 0 : 1;
-          sz->rgrc[0].right -= 8;   // Remove right border
-          sz->rgrc[0].bottom -= 8;  // Remove bottom border
-          sz->rgrc[0].left -= -8;   // Remove left border
-
-          std::cout << "[NCCALCSIZE] Title bar hidden window: left=" << sz->rgrc[0].left
-                    << " top=" << sz->rgrc[0].top << " right=" << sz->rgrc[0].right
-                    << " bottom=" << sz->rgrc[0].bottom << std::endl;
+  // Re-apply the mode a window had in the previous session
+  if (message == WM_FLUTTER_RESTORE_WINDOW_MODE) {
+    RestoreSessionWindowMode(hwnd);
+    return 0;
+  }
+
+  // Records are written for the display configuration in effect now; the
+  // topology cache was dropped above
+  if (message == WM_DISPLAYCHANGE || message == WM_DPICHANGED) {
+    g_session_store.SetTopologyHash(SessionStore::TopologyHash());
+  }
+
+  // Remember the last active window; it stays the focused target while
+  // another process is in the foreground
+  if ((message == WM_ACTIVATE && LOWORD(wParam) != WA_INACTIVE) ||
+      (message == WM_NCACTIVATE && wParam)) {
+    g_last_active_window = hwnd;
+  }
+
+  // The shared state mirror's focus flag, for Dart's direct reads
+  if (message == WM_ACTIVATE) {
+    WindowStateMirror::Instance().UpdateFocus(hwnd, LOWORD(wParam) != WA_INACTIVE);
+  }
+
+  // Lifecycle events for Dart. Visibility comes from the position change
+  // rather than WM_SHOWWINDOW, which is not sent for every show and hide
+  // (ShowWindow with SW_SHOWNORMAL or SW_SHOWMAXIMIZED, SetWindowPos with
+  // SWP_SHOWWINDOW or SWP_HIDEWINDOW)
+  UINT visibility_change = 0;
+  if (message == WM_WINDOWPOSCHANGED) {
+    visibility_change = reinterpret_cast<const WINDOWPOS*>(lParam)->flags &
+                        (SWP_SHOWWINDOW | SWP_HIDEWINDOW);
+  }
+  if (visibility_change) {
+    WindowEvents::Instance().WindowShown(hwnd, visibility_change == SWP_SHOWWINDOW);
+  } else if (message == WM_ACTIVATE) {
+    WindowEvents::Instance().WindowActivated(hwnd, LOWORD(wParam) != WA_INACTIVE);
+  } else if (message == WM_DPICHANGED) {
+    WindowEvents::Instance().WindowDpiChanged(hwnd, HIWORD(wParam));
+  }
+
+  // Windows restored as maximized are maximized once they are first shown
+  if (visibility_change == SWP_SHOWWINDOW) {
+    auto pendingIt = g_session_pending_maximize.find(hwnd);
+    if (pendingIt != g_session_pending_maximize.end()) {
+      g_session_pending_maximize.erase(pendingIt);
+      win32::PostMessage(hwnd, WM_SYSCOMMAND, SC_MAXIMIZE, 0);
+    }
+  }
+
+  auto stateIt = g_flutter_window_frame_states.find(hwnd);
+
+  // Only windows with a custom frame (frameless or title bar hidden) have a state
+  if (stateIt != g_flutter_window_frame_states.end()) {
+    switch (message) {
+      case WM_WINDOWPOSCHANGING: {
+        // Maximizing, restoring, or moving a maximized window to another
+        // monitor changes the insets; the other moves and sizes do not. Only
+        // a state change needs the new maximized state from the window
+        const WINDOWPOS* pos = reinterpret_cast<const WINDOWPOS*>(lParam);
+        bool state_changed = (pos->flags & SWP_STATECHANGED) != 0;
+        if (state_changed || (stateIt->second.maximized && !(pos->flags & SWP_NOMOVE))) {
+          RECT rect;
+          win32::GetWindowRect(hwnd, &rect);
+          if (!(pos->flags & SWP_NOMOVE)) {
+            rect.right += pos->x - rect.left;
+            rect.bottom += pos->y - rect.top;
+            rect.left = pos->x;
+            rect.top = pos->y;
+          }
+          if (!(pos->flags & SWP_NOSIZE)) {
+            rect.right = rect.left + pos->cx;
+            rect.bottom = rect.top + pos->cy;
+          }
+          RefreshNcInsets(hwnd, &rect, state_changed ? win32::IsZoomed(hwnd) != FALSE : stateIt->second.maximized);
         }
+        break;
       }
 
-      return 0;  // Don't call original window procedure for this message
-    }
+      case WM_SIZE:
+        // A maximize or restore that came without SWP_STATECHANGED was
+        // answered with the old insets; recompute them and ask again
+        if (wParam != SIZE_MINIMIZED && (wParam == SIZE_MAXIMIZED) != stateIt->second.maximized) {
+          RefreshNcInsets(hwnd, nullptr, wParam == SIZE_MAXIMIZED);
+          win32::SetWindowPos(hwnd, nullptr, 0, 0, 0, 0,
+                              SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER | SWP_NOACTIVATE | SWP_FRAMECHANGED);
+        }
+        break;
+
+      case WM_DPICHANGED:
+      case WM_DISPLAYCHANGE:
+      case WM_SETTINGCHANGE:
+        // The work area may have moved; the topology cache was dropped above
+        RefreshNcInsets(hwnd);
+        break;
+
+      case WM_NCCALCSIZE:
+        if (wParam) {
+          NCCALCSIZE_PARAMS* sz = reinterpret_cast<NCCALCSIZE_PARAMS*>(lParam);
+          const NcInsets& insets = stateIt->second.insets;
+          if (insets.handled) {
+            sz->rgrc[0].left += insets.left;
+            sz->rgrc[0].top += insets.top;
+            sz->rgrc[0].right += insets.right;
+            sz->rgrc[0].bottom += insets.bottom;
+            return 0;  // Don't call original window procedure for this message
+          }
+        }
+        break;
 
-    if (message == WM_NCACTIVATE) {
-      // Prevent default frame painting during activation for custom frames
-      // This prevents the flicker when focusing/unfocusing frameless or hidden title bar windows
-      std::cout << "[NCACTIVATE] Intercepted activation message for custom frame window" << std::endl;
-      return 1;  // Tell Windows we handled the activation painting
+      case WM_NCACTIVATE:
+        // Prevent default frame painting during activation for custom frames
+        // This prevents the flicker when focusing/unfocusing frameless or hidden title bar windows
+        return 1;  // Tell Windows we handled the activation painting
     }
   }
 
   // For all other messages, call the original window procedure
-  auto origProcIt = g_original_window_procedures.find(hwnd);
-  if (origProcIt != g_original_window_procedures.end()) {
-    return CallWindowProc(origProcIt->second, hwnd, message, wParam, lParam);
-  }
-
-  // Fallback to default window procedure
-  return DefWindowProc(hwnd, message, wParam, lParam);
+  return CallOriginalWindowProc(hwnd, message, wParam, lParam);
 }
 
 // ============================================================================
@@ -367,7 +983,7 @@ std::vector<HWND> GetFlutterWindowHandles(flutter::FlutterEngine* engine) {
 std::vector<HWND> GetAllWindowHandles() {
   std::vector<HWND> handles;
 
-  ::EnumWindows([](HWND hwnd, LPARAM lParam) -> BOOL {
+  win32::EnumWindows([](HWND hwnd, LPARAM lParam) -> BOOL {
     std::vector<HWND>* pHandles = reinterpret_cast<std::vector<HWND>*>(lParam);
     pHandles->push_back(hwnd);
     return TRUE; // Continue enumeration
@@ -376,6 +992,221 @@ std::vector<HWND> GetAllWindowHandles() {
   return handles;
 }
 
+/**
+ * Resolves the window a channel call acts on.
+ *
+ * Calls name it either by 'hwnd' (int64, int32 or double, as Dart may send
+ * any of them) or with 'target': 'focused', the app window that was active
+ * last. The focused form saves the caller a round trip to look the handle up.
+ *
+ * @param args The call arguments
+ * @param result Completed with an error when no valid window is named
+ * @return The window, or nullptr after |result| was completed
+ */
+HWND TargetWindow(const flutter::EncodableMap& args,
+                  flutter::MethodResult<flutter::EncodableValue>* result) {
+  auto it_target = args.find(flutter::EncodableValue("target"));
+  if (it_target != args.end()) {
+    const auto* target = std::get_if<std::string>(&it_target->second);
+    if (!target || *target != "focused") {
+      result->Error("bad_args", "'target' must be 'focused'");
+      return nullptr;
+    }
+    // Windows activated before they were subclassed sent no activation the
+    // subclass procedure saw; ask the thread for its active window instead
+    if (!g_last_active_window || !win32::IsWindow(g_last_active_window)) {
+      g_last_active_window = win32::GetActiveWindow();
+    }
+    if (!g_last_active_window) {
+      result->Error("no_focused_window", "No app window has been active");
+      return nullptr;
+    }
+    return g_last_active_window;
+  }
+
+  auto it_hwnd = args.find(flutter::EncodableValue("hwnd"));
+  if (it_hwnd == args.end()) {
+    result->Error("bad_args", "Missing 'hwnd' or 'target'");
+    return nullptr;
+  }
+
+  int64_t hwnd_val = 0;
+  const auto& hwnd_value = it_hwnd->second;
+  if (std::holds_alternative<int64_t>(hwnd_value)) {
+    hwnd_val = std::get<int64_t>(hwnd_value);
+  } else if (std::holds_alternative<int32_t>(hwnd_value)) {
+    hwnd_val = static_cast<int64_t>(std::get<int32_t>(hwnd_value));
+  } else if (std::holds_alternative<double>(hwnd_value)) {
+    hwnd_val = static_cast<int64_t>(std::get<double>(hwnd_value));
+  } else {
+    result->Error("bad_type", "HWND value is not a supported numeric type");
+    return nullptr;
+  }
+
+  HWND hwnd = reinterpret_cast<HWND>(static_cast<intptr_t>(hwnd_val));
+  if (!win32::IsWindow(hwnd)) {
+    result->Error("invalid_hwnd", "Invalid window handle");
+    return nullptr;
+  }
+  return hwnd;
+}
+
+/**
+ * A window mode change requested by an 'execute' batch, and the commands
+ * that asked for it.
+ */
+struct PendingWindowMode {
+  uint8_t mode;
+  std::vector<size_t> commands;
+};
+
+/**
+ * The result of a failed batch command.
+ */
+flutter::EncodableValue BatchError(const std::string& code, const std::string& message) {
+  flutter::EncodableMap error;
+  error[flutter::EncodableValue("error")] = flutter::EncodableValue(code);
+  error[flutter::EncodableValue("message")] = flutter::EncodableValue(message);
+  return flutter::EncodableValue(std::move(error));
+}
+
+/**
+ * Resolves the window a batch command acts on: 'ref', the index of an earlier
+ * command that returned a window handle, or anything TargetWindow accepts.
+ *
+ * @return The window, or nullptr with |error| set
+ */
+HWND BatchTarget(const flutter::EncodableMap& command,
+                 const flutter::EncodableList& results,
+                 flutter::EncodableValue* error) {
+  auto it_ref = command.find(flutter::EncodableValue("ref"));
+  if (it_ref == command.end()) {
+    flutter::MethodResultFunctions<flutter::EncodableValue> capture(
+        nullptr,
+        [error](const std::string& code, const std::string& message,
+                const flutter::EncodableValue* /* details */) {
+          *error = BatchError(code, message);
+        },
+        nullptr);
+    return TargetWindow(command, &capture);
+  }
+
+  int64_t ref = -1;
+  if (std::holds_alternative<int32_t>(it_ref->second)) {
+    ref = std::get<int32_t>(it_ref->second);
+  } else if (std::holds_alternative<int64_t>(it_ref->second)) {
+    ref = std::get<int64_t>(it_ref->second);
+  }
+  if (ref < 0 || static_cast<size_t>(ref) >= results.size()) {
+    *error = BatchError("bad_ref", "'ref' must be the index of an earlier command");
+    return nullptr;
+  }
+  const auto* hwnd_val = std::get_if<int64_t>(&results[static_cast<size_t>(ref)]);
+  if (!hwnd_val) {
+    *error = BatchError("bad_ref", "Command " + std::to_string(ref) + " did not return a window handle");
+    return nullptr;
+  }
+  HWND hwnd = reinterpret_cast<HWND>(static_cast<intptr_t>(*hwnd_val));
+  if (!win32::IsWindow(hwnd)) {
+    *error = BatchError("invalid_hwnd", "Invalid window handle");
+    return nullptr;
+  }
+  return hwnd;
+}
+
+/**
+ * Runs command |index| of an 'execute' batch.
+ *
+ * Mode commands (toggleTitleBar, setTitleBarStyle, toggleFrameless,
+ * setFrameless, setTransparentBackground) only fold their flag into the
+ * window's entry in |pending_modes|; the batch applies each window's final
+ * mode once after the last command, so however many commands touch a window
+ * it is restyled and its frame recalculated once.
+ *
+ * @return The command's result, or a BatchError
+ */
+flutter::EncodableValue RunBatchCommand(FlutterDesktopPluginRegistrarRef registrar,
+                                        const flutter::EncodableMap& command,
+                                        size_t index,
+                                        const flutter::EncodableList& results,
+                                        std::map<HWND, PendingWindowMode>* pending_modes) {
+  auto arg = [&command](const char* name) -> const flutter::EncodableValue* {
+    auto it = command.find(flutter::EncodableValue(name));
+    return it == command.end() ? nullptr : &it->second;
+  };
+
+  const auto* op_value = arg("op");
+  const auto* op = op_value ? std::get_if<std::string>(op_value) : nullptr;
+  if (!op) {
+    return BatchError("bad_args", "Missing 'op'");
+  }
+
+  if (*op == "getWindowHandleForViewId") {
+    const auto* view_value = arg("viewId");
+    int64_t view_id = 0;
+    if (view_value && std::holds_alternative<int32_t>(*view_value)) {
+      view_id = std::get<int32_t>(*view_value);
+    } else if (view_value && std::holds_alternative<int64_t>(*view_value)) {
+      view_id = std::get<int64_t>(*view_value);
+    } else {
+      return BatchError("bad_args", "Missing 'viewId'");
+    }
+    FlutterDesktopViewRef view = FlutterDesktopPluginRegistrarGetViewById(registrar, view_id);
+    if (!view) {
+      return flutter::EncodableValue();
+    }
+    HWND hwnd = FlutterDesktopViewGetHWND(view);
+    return flutter::EncodableValue(static_cast<int64_t>(reinterpret_cast<intptr_t>(hwnd)));
+  }
+
+  // The remaining commands act on a window, subclassed on demand
+  flutter::EncodableValue error;
+  HWND hwnd = BatchTarget(command, results, &error);
+  if (!hwnd) {
+    return error;
+  }
+  if (!setupWindowInterception(hwnd)) {
+    return BatchError("interception_failed", "Failed to set up window interception");
+  }
+  if (*op == "setupWindowInterception") {
+    return flutter::EncodableValue(true);
+  }
+
+  uint8_t flag = 0;
+  bool on = false;
+  bool toggle = false;
+  if (*op == "toggleTitleBar" || *op == "toggleFrameless") {
+    flag = *op == "toggleTitleBar" ? kWindowModeHiddenTitleBar : kWindowModeFrameless;
+    toggle = true;
+  } else if (*op == "setTitleBarStyle") {
+    const auto* style_value = arg("titleBarStyle");
+    const auto* style = style_value ? std::get_if<std::string>(style_value) : nullptr;
+    if (!style || (*style != "hidden" && *style != "normal" && *style != "visible")) {
+      return BatchError("invalid_style", "titleBarStyle must be 'hidden' or 'normal'");
+    }
+    flag = kWindowModeHiddenTitleBar;
+    on = *style == "hidden";
+  } else if (*op == "setFrameless" || *op == "setTransparentBackground") {
+    const char* name = *op == "setFrameless" ? "frameless" : "transparent";
+    const auto* flag_value = arg(name);
+    if (!flag_value || !std::holds_alternative<bool>(*flag_value)) {
+      return BatchError("bad_type", std::string(name) + " value is not a boolean");
+    }
+    if (*op == "setTransparentBackground" && !g_set_window_composition_attribute) {
+      return BatchError("function_not_loaded", "SetWindowCompositionAttribute not available");
+    }
+    flag = *op == "setFrameless" ? kWindowModeFrameless : kWindowModeTransparent;
+    on = std::get<bool>(*flag_value);
+  } else {
+    return BatchError("unknown_op", "Unknown op '" + *op + "'");
+  }
+
+  auto pending = pending_modes->try_emplace(hwnd, PendingWindowMode{CurrentWindowMode(hwnd), {}}).first;
+  uint8_t& mode = pending->second.mode;
+  mode = WithWindowModeFlag(mode, flag, toggle ? (mode & flag) == 0 : on);
+  pending->second.commands.push_back(index);
+  return flutter::EncodableValue(true);
+}
 
 /**
  * Automatically set up a Flutter window with frameless and transparency.
@@ -391,58 +1222,17 @@ bool AutoSetupFlutterWindow(HWND hwnd) {
   }
   std::cout << "[AUTOSETUP] Window interception setup complete" << std::endl;
   
-  // Make frameless
-  LONG_PTR style = ::GetWindowLongPtrW(hwnd, GWL_STYLE);
-  std::cout << "[AUTOSETUP] Original style: 0x" << std::hex << style << std::dec << std::endl;
-  
-  style &= ~(WS_CAPTION | WS_THICKFRAME | WS_SYSMENU | WS_MINIMIZEBOX | WS_MAXIMIZEBOX |
-            WS_BORDER | WS_DLGFRAME | WS_SIZEBOX);
-  style |= WS_THICKFRAME;
-  ::SetWindowLongPtrW(hwnd, GWL_STYLE, style);
-  std::cout << "[AUTOSETUP] Applied frameless style: 0x" << std::hex << style << std::dec << std::endl;
-  
-  LONG_PTR exStyle = ::GetWindowLongPtrW(hwnd, GWL_EXSTYLE);
-  exStyle &= ~(WS_EX_WINDOWEDGE | WS_EX_CLIENTEDGE | WS_EX_DLGMODALFRAME |
-              WS_EX_STATICEDGE | WS_EX_TOOLWINDOW | WS_EX_APPWINDOW);
-  ::SetWindowLongPtrW(hwnd, GWL_EXSTYLE, exStyle);
-  std::cout << "[AUTOSETUP] Applied extended style" << std::endl;
-  
-  DWM_WINDOW_CORNER_PREFERENCE cornerPref = DWMWCP_DONOTROUND;
-  ::DwmSetWindowAttribute(hwnd, DWMWA_WINDOW_CORNER_PREFERENCE, &cornerPref, sizeof(cornerPref));
-  std::cout << "[AUTOSETUP] Set corner preference" << std::endl;
-
-  // Explicitly disable shadows
-  DWMNCRENDERINGPOLICY policy = DWMNCRP_DISABLED;
-  ::DwmSetWindowAttribute(hwnd, DWMWA_NCRENDERING_POLICY, &policy, sizeof(policy));
-  std::cout << "[AUTOSETUP] Disabled NC rendering (removes shadow)" << std::endl;
-
-  MARGINS margins = {0, 0, 0, 0};
-  ::DwmExtendFrameIntoClientArea(hwnd, &margins);
-  std::cout << "[AUTOSETUP] Extended DWM frame for frameless" << std::endl;
-  
-  g_flutter_frameless_windows[hwnd] = true;
-  
-  // Make transparent (if function available)
+  // Make frameless: strips the frame, disables NC rendering (removes the
+  // shadow) and keeps the DWM frame unextended
+  uint8_t mode = WithWindowModeFlag(CurrentWindowMode(hwnd), kWindowModeFrameless, true);
+  ApplyWindowMode(hwnd, mode);
+  std::cout << "[AUTOSETUP] Applied frameless mode" << std::endl;
+
+  // Make transparent (if function available). Frameless windows keep their
+  // {0,0,0,0} margins; transparency works fine without extending DWM frame
   if (g_set_window_composition_attribute) {
     std::cout << "[AUTOSETUP] Applying transparency..." << std::endl;
-    
-    // Don't change margins - keep {0,0,0,0} for shadow removal
-    // Transparency works fine without extending DWM frame
-    
-    ACCENT_POLICY accent = {
-      ACCENT_ENABLE_TRANSPARENTGRADIENT,
-      2,
-      0x00000000,
-      0
-    };
-    
-    WINDOWCOMPOSITIONATTRIBDATA data;
-    data.Attrib = WCA_ACCENT_POLICY;
-    data.pvData = &accent;
-    data.cbData = sizeof(accent);
-    
-    if (g_set_window_composition_attribute(hwnd, &data)) {
-      g_flutter_transparent_windows[hwnd] = true;
+    if (ApplyWindowMode(hwnd, WithWindowModeFlag(mode, kWindowModeTransparent, true))) {
       std::cout << "[AUTOSETUP] Transparency applied successfully" << std::endl;
     } else {
       std::cerr << "[AUTOSETUP] Failed to apply transparency" << std::endl;
@@ -450,15 +1240,7 @@ bool AutoSetupFlutterWindow(HWND hwnd) {
   } else {
     std::cerr << "[AUTOSETUP] SetWindowCompositionAttribute not available" << std::endl;
   }
-  
-  // Force redraw
-  RECT rect;
-  ::GetWindowRect(hwnd, &rect);
-  ::SetWindowPos(hwnd, nullptr, rect.left, rect.top,
-               rect.right - rect.left, rect.bottom - rect.top,
-               SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_FRAMECHANGED);
-  std::cout << "[AUTOSETUP] Force redraw complete" << std::endl;
-  
+
   std::cout << "[AUTOSETUP] Auto-setup complete for window: 0x" << std::hex << hwnd << std::dec << std::endl;
   return true;
 }
@@ -471,9 +1253,9 @@ LRESULT CALLBACK MessageWindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lP
   if (msg == WM_FLUTTER_WINDOW_CREATED) {
     HWND created_hwnd = reinterpret_cast<HWND>(wParam);
     
-    if (::IsWindow(created_hwnd)) {
+    if (win32::IsWindow(created_hwnd)) {
       wchar_t className[256] = {0};
-      if (::GetClassNameW(created_hwnd, className, sizeof(className) / sizeof(wchar_t))) {
+      if (win32::GetClassNameW(created_hwnd, className, sizeof(className) / sizeof(wchar_t))) {
         std::wstring classStr(className);
         
         // Only process FLUTTER_HOST_WINDOW (the actual window, not FLUTTERVIEW)
@@ -485,7 +1267,7 @@ LRESULT CALLBACK MessageWindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lP
           g_pending_autosetup_windows[timer_id] = created_hwnd;
           
           // Use message window handle instead of nullptr to preserve timer ID
-          if (SetTimer(g_message_window, timer_id, 100, nullptr)) {
+          if (win32::SetTimer(g_message_window, timer_id, 100, nullptr)) {
             std::cout << "[CBT] Scheduled delayed auto-setup (200ms) for window: 0x" << std::hex << created_hwnd 
                       << std::dec << " with timer ID: " << timer_id << std::endl;
           } else {
@@ -507,7 +1289,7 @@ LRESULT CALLBACK MessageWindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lP
       HWND target_hwnd = it->second;
       std::cout << "[TIMER] Found window: 0x" << std::hex << target_hwnd << std::dec << std::endl;
       
-      if (::IsWindow(target_hwnd)) {
+      if (win32::IsWindow(target_hwnd)) {
         std::cout << "[TIMER] Window is valid, applying auto-setup..." << std::endl;
         
         if (AutoSetupFlutterWindow(target_hwnd)) {
@@ -520,14 +1302,115 @@ LRESULT CALLBACK MessageWindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lP
       }
       
       g_pending_autosetup_windows.erase(it);
-      KillTimer(hwnd, timer_id);
+      win32::KillTimer(hwnd, timer_id);
     } else {
       std::cout << "[TIMER] Timer ID not found in pending windows" << std::endl;
     }
     return 0;
   }
   
-  return DefWindowProc(hwnd, msg, wParam, lParam);
+  return win32::DefWindowProc(hwnd, msg, wParam, lParam);
+}
+
+/**
+ * Give a newly seen top-level Flutter window the next creation-order slot of
+ * the session file. Returns true with |record| set when the previous session
+ * left a layout for that slot.
+ */
+bool ClaimSessionSlot(HWND hwnd, SessionStore::WindowRecord* record) {
+  if (g_next_session_window_slot >= SessionStore::kMaxWindows) {
+    return false;
+  }
+  uint32_t slot = g_next_session_window_slot++;
+  g_session_window_slots[hwnd] = slot;
+
+  if (!g_session_store.PreviousRecord(slot, record)) {
+    return false;
+  }
+  if (record->flags & SessionStore::kMaximized) {
+    g_session_pending_maximize[hwnd] = true;
+  }
+  // Carry the record over until the window reports its own state
+  g_session_store.Write(slot, *record);
+  return true;
+}
+
+/**
+ * Place a newly created top-level Flutter window from the previous session.
+ * Called from the CBT hook before the window receives WM_NCCREATE, so the
+ * bounds are applied by editing the CREATESTRUCT rather than by moving it.
+ * The window is only recorded here; AdoptWindow subclasses it once it has
+ * been created.
+ */
+void RestoreSessionWindow(HWND hwnd, CREATESTRUCTW* cs) {
+  if (cs->style & WS_CHILD) {
+    return;
+  }
+  wchar_t className[256];
+  if (!win32::GetClassNameW(hwnd, className, sizeof(className) / sizeof(wchar_t))) {
+    return;
+  }
+  std::wstring classStr(className);
+  if (classStr.find(L"FLUTTER") == std::wstring::npos || classStr == L"FLUTTERVIEW") {
+    return;
+  }
+
+  SessionStore::WindowRecord record;
+  if (ClaimSessionSlot(hwnd, &record)) {
+    cs->x = record.left;
+    cs->y = record.top;
+    cs->cx = record.right - record.left;
+    cs->cy = record.bottom - record.top;
+  }
+}
+
+/**
+ * Take a top-level Flutter window into the session once it has been created:
+ * give it a slot and place it from the previous session (unless the CBT hook
+ * already did), subclass it, and post the re-application of its saved mode.
+ * Windows past the session capacity are still subclassed.
+ */
+void AdoptWindow(HWND hwnd) {
+  if (g_original_window_procedures.find(hwnd) != g_original_window_procedures.end()) {
+    return;
+  }
+
+  SessionStore::WindowRecord record;
+  if (g_session_window_slots.find(hwnd) == g_session_window_slots.end() &&
+      ClaimSessionSlot(hwnd, &record)) {
+    win32::SetWindowPos(hwnd, nullptr, record.left, record.top,
+                        record.right - record.left, record.bottom - record.top,
+                        SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOACTIVATE);
+  }
+
+  if (setupWindowInterception(hwnd) &&
+      g_session_window_slots.find(hwnd) != g_session_window_slots.end()) {
+    win32::PostMessage(hwnd, WM_FLUTTER_RESTORE_WINDOW_MODE, 0, 0);
+  }
+}
+
+/**
+ * Top-level window procedure delegate of the runner. The engine calls it for
+ * every message of each of its top-level windows, subclassed or not, so the
+ * runner picks up new windows here without a hook. Messages of subclassed
+ * windows come through the subclass procedure first and return right away.
+ */
+std::optional<LRESULT> RunnerWindowProcDelegate(HWND hwnd, UINT message, WPARAM wParam, LPARAM /* lParam */) {
+  if (hwnd == g_forwarding_window) {
+    return std::nullopt;
+  }
+  // Sent while the window is still being built or already torn down
+  if (message == WM_GETMINMAXINFO || message == WM_NCCREATE || message == WM_NCCALCSIZE ||
+      message == WM_DESTROY || message == WM_NCDESTROY) {
+    return std::nullopt;
+  }
+  AdoptWindow(hwnd);
+  // The subclass procedure only sees messages sent after this one, so the
+  // activation that caused the adoption is recorded here
+  if (message == WM_ACTIVATE && LOWORD(wParam) != WA_INACTIVE) {
+    g_last_active_window = hwnd;
+  }
+  return std::nullopt;
 }
 
 /**
@@ -536,19 +1419,107 @@ LRESULT CALLBACK MessageWindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lP
  */
 LRESULT CALLBACK CBTProc(int nCode, WPARAM wParam, LPARAM lParam) {
   if (nCode == HCBT_CREATEWND) {
-    // HWND hwnd = reinterpret_cast<HWND>(wParam);
-    
+    HWND hwnd = reinterpret_cast<HWND>(wParam);
+    RestoreSessionWindow(hwnd, reinterpret_cast<CBT_CREATEWNDW*>(lParam)->lpcs);
+
     // Post message for async processing - returns immediately, no blocking
     if (g_message_window) {
-      PostMessage(g_message_window, WM_FLUTTER_WINDOW_CREATED, wParam, 0);
+      win32::PostMessage(g_message_window, WM_FLUTTER_WINDOW_CREATED, wParam, 0);
     }
   }
   
-  return CallNextHookEx(g_cbt_hook, nCode, wParam, lParam);
+  return win32::CallNextHookEx(g_cbt_hook, nCode, wParam, lParam);
+}
+
+// The recorder the win32:: wrappers in this process report to; window_manager
+// and flutter_acrylic find it by name, see Win32CallRecorder::Instance().
+extern "C" __declspec(dllexport) Win32CallRecorder* __cdecl
+MultipleWindowsWin32CallRecorder() {
+  static Win32CallRecorder recorder;
+  return &recorder;
+}
+
+// dart:ffi entry points, see window_ffi.h.
+
+HWND FfiWindow(int64_t hwnd) {
+  return reinterpret_cast<HWND>(static_cast<intptr_t>(hwnd));
+}
+
+// The mode as last mirrored. The FFI may be called off the platform thread,
+// so the runner's own maps are not read here; windows the runner does not
+// track have no mode flags besides maximized.
+int32_t FfiWindowMode(HWND window) {
+  WindowStateSnapshot snapshot;
+  if (WindowStateMirror::Instance().Read(window, &snapshot)) {
+    return snapshot.mode;
+  }
+  return win32::IsZoomed(window) ? kWindowModeMaximized : 0;
+}
+
+MULTIPLE_WINDOWS_FFI_EXPORT int32_t __cdecl MultipleWindowsFfiVersion() {
+  return kMultipleWindowsFfiVersion;
+}
+
+MULTIPLE_WINDOWS_FFI_EXPORT MultipleWindowsBounds __cdecl
+MultipleWindowsGetBounds(int64_t hwnd) {
+  MultipleWindowsBounds bounds = {};
+  RECT rect;
+  if (win32::GetWindowRect(FfiWindow(hwnd), &rect)) {
+    bounds.valid = 1;
+    bounds.x = rect.left;
+    bounds.y = rect.top;
+    bounds.width = rect.right - rect.left;
+    bounds.height = rect.bottom - rect.top;
+  }
+  return bounds;
+}
+
+MULTIPLE_WINDOWS_FFI_EXPORT int32_t __cdecl MultipleWindowsIsFocused(int64_t hwnd) {
+  HWND window = FfiWindow(hwnd);
+  return window && win32::GetForegroundWindow() == window ? 1 : 0;
+}
+
+MULTIPLE_WINDOWS_FFI_EXPORT int32_t __cdecl MultipleWindowsIsMaximized(int64_t hwnd) {
+  return win32::IsZoomed(FfiWindow(hwnd)) ? 1 : 0;
+}
+
+MULTIPLE_WINDOWS_FFI_EXPORT int32_t __cdecl MultipleWindowsGetWindowMode(int64_t hwnd) {
+  HWND window = FfiWindow(hwnd);
+  return win32::IsWindow(window) ? FfiWindowMode(window) : -1;
+}
+
+MULTIPLE_WINDOWS_FFI_EXPORT const WindowStateMirror* __cdecl
+MultipleWindowsGetStateMirror() {
+  return &WindowStateMirror::Instance();
+}
+
+MULTIPLE_WINDOWS_FFI_EXPORT MultipleWindowsWindowState __cdecl
+MultipleWindowsGetWindowState(int64_t hwnd) {
+  MultipleWindowsWindowState state = {};
+  HWND window = FfiWindow(hwnd);
+  RECT rect;
+  if (!win32::GetWindowRect(window, &rect)) {
+    return state;
+  }
+  state.valid = 1;
+  state.x = rect.left;
+  state.y = rect.top;
+  state.width = rect.right - rect.left;
+  state.height = rect.bottom - rect.top;
+  state.focused = win32::GetForegroundWindow() == window ? 1 : 0;
+  state.mode = FfiWindowMode(window);
+  state.maximized = (state.mode & kWindowModeMaximized) ? 1 : 0;
+  state.minimized = win32::IsIconic(window) ? 1 : 0;
+  state.visible = win32::IsWindowVisible(window) ? 1 : 0;
+  return state;
 }
 
 int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
                       _In_ wchar_t* command_line, _In_ int show_command) {
+  StartupProfiler& profiler = StartupProfiler::Instance();
+  profiler.Mark("wWinMain");
+  profiler.WatchFirstWindowShown();
+
   // Attach to console when present (e.g., 'flutter run') or create a
   // new console when running with a debugger.
   if (!::AttachConsole(ATTACH_PARENT_PROCESS) && ::IsDebuggerPresent()) {
@@ -558,20 +1529,42 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
   // Initialize COM, so that it is available for use in the library and/or
   // plugins.
   ::CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
+  profiler.Mark("CoInitializeEx");
+
+  // Set to true to skip automatic window setup (message window, CBT hook, timers)
+  bool skip_autosetup = true;
+
+  // Map the session layout file. Windows are placed from the previous
+  // session when the runner's window procedure delegate first sees them, or
+  // already at creation by the CBT hook when auto-setup installs it
+  std::wstring session_path = SessionStore::DefaultPath();
+  if (session_path.empty() ||
+      !g_session_store.Open(session_path, SessionStore::TopologyHash())) {
+    std::cerr << "Session layout file unavailable, windows will not be restored" << std::endl;
+  }
+  profiler.Mark("session_store");
 
   flutter::DartProject project(L"data");
 
   auto command_line_arguments{GetCommandLineArguments()};
 
   project.set_dart_entrypoint_arguments(std::move(command_line_arguments));
+  profiler.Mark("DartProject");
 
   auto const engine{std::make_shared<flutter::FlutterEngine>(project)};
+  profiler.Mark("FlutterEngine");
   RegisterPlugins(engine.get());
+  profiler.Mark("RegisterPlugins");
+
+  // Sees the engine's top-level windows from their first messages on; must
+  // be registered before Dart creates any
+  flutter::PluginRegistrarWindows* runner_registrar =
+      flutter::PluginRegistrarManager::GetInstance()->GetRegistrar<flutter::PluginRegistrarWindows>(
+          engine->GetRegistrarForPlugin("multiple_windows_runner"));
+  int window_proc_id = runner_registrar->RegisterTopLevelWindowProcDelegate(RunnerWindowProcDelegate);
   engine->Run();
+  profiler.Mark("engine_run");
 
-  // Set to true to skip automatic window setup (message window, CBT hook, timers)
-  bool skip_autosetup = true;
-  
   if (skip_autosetup) {
     std::cout << "Auto-setup disabled — skipping window auto-setup and hooks" << std::endl;
   }
@@ -589,6 +1582,7 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
   } else {
     std::cerr << "Failed to get user32.dll handle" << std::endl;
   }
+  profiler.Mark("SetWindowCompositionAttribute");
 
   // Create message-only window for async processing and install CBT hook
   // unless NO_AUTOSETUP is set.
@@ -597,23 +1591,26 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
     wc.lpfnWndProc = MessageWindowProc;
     wc.hInstance = instance;
     wc.lpszClassName = L"FlutterWindowDetectorMessageWindow";
-    RegisterClass(&wc);
+    win32::RegisterClass(&wc);
 
-    g_message_window = CreateWindowEx(0, wc.lpszClassName, L"", 0, 0, 0, 0, 0, 
+    g_message_window = win32::CreateWindowEx(0, wc.lpszClassName, L"", 0, 0, 0, 0, 0, 
                                      HWND_MESSAGE, NULL, instance, NULL);
     if (g_message_window) {
       std::cout << "Message window created for async processing" << std::endl;
     } else {
       std::cerr << "Failed to create message window" << std::endl;
     }
+    profiler.Mark("message_window");
 
-    // Install CBT hook for automatic window creation interception
-    g_cbt_hook = SetWindowsHookEx(WH_CBT, CBTProc, NULL, GetCurrentThreadId());
+    // Install CBT hook for automatic window creation interception; it also
+    // places restored windows before their first WM_NCCREATE
+    g_cbt_hook = win32::SetWindowsHookEx(WH_CBT, CBTProc, NULL, GetCurrentThreadId());
     if (g_cbt_hook) {
       std::cout << "CBT hook installed successfully for window creation tracking" << std::endl;
     } else {
       std::cerr << "Failed to install CBT hook: " << GetLastError() << std::endl;
     }
+    profiler.Mark("cbt_hook");
   }
 
   // ============================================================================
@@ -663,6 +1660,13 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
   // simplified for our specific use case.
   // ============================================================================
 
+  // Read-only queries run here, off the platform thread. Declared before the
+  // channel so it outlives the handler.
+  QueryPool query_pool(2);
+
+  // Lifecycle events of the subclassed windows, pushed to Dart
+  WindowEvents::Instance().Attach(engine->messenger(), CurrentWindowMode);
+
   flutter::MethodChannel<flutter::EncodableValue> channel(
       engine->messenger(), "com.example.window_service",
       &flutter::StandardMethodCodec::GetInstance());
@@ -691,22 +1695,80 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
         // getAllWindowHandles: Get all system window handles
         // ========================================================================
         // Returns a list of ALL window handles in the system (not just Flutter windows).
-        // Useful for debugging or finding other application windows.
+        // Useful for debugging or finding other application windows. Runs on
+        // the query pool.
+        //
+        // Optional filters, evaluated during enumeration so only matching
+        // handles are returned: pid (int), classPrefix (string, case-sensitive),
+        // titleContains (string, case-insensitive), and visible, minimized,
+        // owned, cloaked (bool).
         // ========================================================================
         if (method == "getAllWindowHandles") {
-          std::vector<flutter::EncodableValue> reply;
-          auto all_hwnds = GetAllWindowHandles();
-          for (HWND hwnd : all_hwnds) {
-            reply.push_back(static_cast<int64_t>(reinterpret_cast<intptr_t>(hwnd)));
+          WindowFilter filter;
+          if (const auto* args = std::get_if<flutter::EncodableMap>(call.arguments())) {
+            auto it = args->find(flutter::EncodableValue("pid"));
+            if (it != args->end()) {
+              if (std::holds_alternative<int32_t>(it->second)) {
+                filter.pid = static_cast<DWORD>(std::get<int32_t>(it->second));
+              } else if (std::holds_alternative<int64_t>(it->second)) {
+                filter.pid = static_cast<DWORD>(std::get<int64_t>(it->second));
+              } else {
+                result->Error("bad_type", "'pid' must be an int");
+                return;
+              }
+              filter.has_pid = true;
+            }
+            const std::pair<const char*, WindowFilter::State*> states[] = {
+                {"visible", &filter.visible},
+                {"minimized", &filter.minimized},
+                {"owned", &filter.owned},
+                {"cloaked", &filter.cloaked},
+            };
+            for (const auto& state : states) {
+              it = args->find(flutter::EncodableValue(state.first));
+              if (it == args->end()) {
+                continue;
+              }
+              const auto* wanted = std::get_if<bool>(&it->second);
+              if (!wanted) {
+                result->Error("bad_type", "'visible', 'minimized', 'owned' and 'cloaked' must be bools");
+                return;
+              }
+              *state.second = *wanted ? WindowFilter::State::kYes : WindowFilter::State::kNo;
+            }
+            const std::pair<const char*, std::wstring*> texts[] = {
+                {"classPrefix", &filter.class_prefix},
+                {"titleContains", &filter.title_substring},
+            };
+            for (const auto& text : texts) {
+              it = args->find(flutter::EncodableValue(text.first));
+              if (it == args->end()) {
+                continue;
+              }
+              const auto* utf8 = std::get_if<std::string>(&it->second);
+              if (!utf8 || !Utf8ToUtf16(utf8->data(), utf8->size(), text.second)) {
+                result->Error("bad_type", "'classPrefix' and 'titleContains' must be strings");
+                return;
+              }
+            }
           }
-          result->Success(flutter::EncodableValue(reply));
+          query_pool.Run([filter]() {
+            std::vector<flutter::EncodableValue> reply;
+            auto all_hwnds = EnumerateWindows(filter);
+            reply.reserve(all_hwnds.size());
+            for (HWND hwnd : all_hwnds) {
+              reply.push_back(static_cast<int64_t>(reinterpret_cast<intptr_t>(hwnd)));
+            }
+            return flutter::EncodableValue(std::move(reply));
+          }, std::move(result));
           return;
         }
         // ========================================================================
         // getWindowInfo: Get detailed information about a window
         // ========================================================================
         // Returns window title and class name for the given HWND.
-        // Useful for debugging and identifying windows.
+        // Useful for debugging and identifying windows. The class name and
+        // uncached titles are read on the query pool.
         // ========================================================================
         if (method == "getWindowInfo") {
           const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
@@ -719,20 +1781,125 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
             result->Error("bad_args", "Missing 'hwnd'");
             return;
           }
-          int64_t hwnd_val = std::get<int64_t>(it->second);
+          // The codec sends handles that fit in 32 bits as int32
+          int64_t hwnd_val = 0;
+          if (std::holds_alternative<int64_t>(it->second)) {
+            hwnd_val = std::get<int64_t>(it->second);
+          } else if (std::holds_alternative<int32_t>(it->second)) {
+            hwnd_val = static_cast<int64_t>(std::get<int32_t>(it->second));
+          } else {
+            result->Error("bad_type", "'hwnd' must be an int");
+            return;
+          }
           HWND hwnd = reinterpret_cast<HWND>(static_cast<intptr_t>(hwnd_val));
-          // Example info: window text and class name
-          wchar_t title[256] = {0};
-          wchar_t class_name[256] = {0};
-          ::GetWindowTextW(hwnd, title, sizeof(title) / sizeof(wchar_t));
-          ::GetClassNameW(hwnd, class_name, sizeof(class_name) / sizeof(wchar_t));
-          flutter::EncodableMap info;
-          // Convert wide strings to UTF-8 for Dart
-          std::string title_utf8 = Utf8FromUtf16(title);
-          std::string class_utf8 = Utf8FromUtf16(class_name);
-          info[flutter::EncodableValue("title")] = flutter::EncodableValue(title_utf8);
-          info[flutter::EncodableValue("className")] = flutter::EncodableValue(class_utf8);
-          result->Success(flutter::EncodableValue(info));
+          // Example info: window text and class name. Subclassed windows serve
+          // the title from the cache kept by WM_SETTEXT, which only this
+          // thread may read
+          const std::string* cached_title = CachedWindowTitle(hwnd);
+          bool title_cached = cached_title != nullptr;
+          std::string cached_title_utf8 = title_cached ? *cached_title : std::string();
+          query_pool.Run([hwnd, title_cached, cached_title_utf8]() {
+            wchar_t class_name[256] = {0};
+            int class_length = win32::GetClassNameW(hwnd, class_name, sizeof(class_name) / sizeof(wchar_t));
+            flutter::EncodableMap info;
+            // Convert wide strings to UTF-8 for Dart, using the lengths the
+            // calls returned
+            std::string title_utf8;
+            std::string class_utf8;
+            if (title_cached) {
+              title_utf8 = cached_title_utf8;
+            } else {
+              wchar_t title[256] = {0};
+              int title_length = win32::GetWindowTextW(hwnd, title, sizeof(title) / sizeof(wchar_t));
+              Utf16ToUtf8(title, static_cast<size_t>(title_length), &title_utf8);
+            }
+            Utf16ToUtf8(class_name, static_cast<size_t>(class_length), &class_utf8);
+            info[flutter::EncodableValue("title")] = flutter::EncodableValue(std::move(title_utf8));
+            info[flutter::EncodableValue("className")] = flutter::EncodableValue(std::move(class_utf8));
+            return flutter::EncodableValue(std::move(info));
+          }, std::move(result));
+          return;
+        }
+        // ========================================================================
+        // getWindowInfoMany: Get selected fields of many windows in one call
+        // ========================================================================
+        // Takes {hwnds, fields}: an Int64List (or list of ints) of handles and
+        // the fields wanted out of title, class, rect, style, pid, visible and
+        // owner (all of them if 'fields' is missing). Returns the fields
+        // column-wise, one typed list per field; see window_info_batch.h for
+        // the layout. Runs on the query pool.
+        // ========================================================================
+        if (method == "getWindowInfoMany") {
+          const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+          if (!args) {
+            result->Error("bad_args", "Expected map with 'hwnds'");
+            return;
+          }
+          auto it_hwnds = args->find(flutter::EncodableValue("hwnds"));
+          if (it_hwnds == args->end()) {
+            result->Error("bad_args", "Missing 'hwnds'");
+            return;
+          }
+          std::vector<HWND> hwnds;
+          if (const auto* packed = std::get_if<std::vector<int64_t>>(&it_hwnds->second)) {
+            hwnds.reserve(packed->size());
+            for (int64_t hwnd_val : *packed) {
+              hwnds.push_back(reinterpret_cast<HWND>(static_cast<intptr_t>(hwnd_val)));
+            }
+          } else if (const auto* list = std::get_if<flutter::EncodableList>(&it_hwnds->second)) {
+            hwnds.reserve(list->size());
+            for (const flutter::EncodableValue& value : *list) {
+              int64_t hwnd_val = 0;
+              if (std::holds_alternative<int64_t>(value)) {
+                hwnd_val = std::get<int64_t>(value);
+              } else if (std::holds_alternative<int32_t>(value)) {
+                hwnd_val = static_cast<int64_t>(std::get<int32_t>(value));
+              } else {
+                result->Error("bad_type", "'hwnds' must hold ints");
+                return;
+              }
+              hwnds.push_back(reinterpret_cast<HWND>(static_cast<intptr_t>(hwnd_val)));
+            }
+          } else {
+            result->Error("bad_type", "'hwnds' must be an Int64List or a list of ints");
+            return;
+          }
+
+          uint32_t fields = kWindowInfoTitle | kWindowInfoClass | kWindowInfoRect |
+                            kWindowInfoStyle | kWindowInfoPid | kWindowInfoVisible |
+                            kWindowInfoOwner;
+          auto it_fields = args->find(flutter::EncodableValue("fields"));
+          if (it_fields != args->end()) {
+            const auto* names = std::get_if<flutter::EncodableList>(&it_fields->second);
+            if (!names) {
+              result->Error("bad_type", "'fields' must be a list of strings");
+              return;
+            }
+            fields = 0;
+            for (const flutter::EncodableValue& value : *names) {
+              const auto* name = std::get_if<std::string>(&value);
+              uint32_t field = 0;
+              if (!name || !ParseWindowInfoField(*name, &field)) {
+                result->Error("bad_args", "Unknown field in 'fields'");
+                return;
+              }
+              fields |= field;
+            }
+          }
+
+          // The title cache of subclassed windows is only readable here
+          std::unordered_map<HWND, std::string> cached_titles;
+          if (fields & kWindowInfoTitle) {
+            for (HWND hwnd : hwnds) {
+              if (const std::string* cached_title = CachedWindowTitle(hwnd)) {
+                cached_titles.emplace(hwnd, *cached_title);
+              }
+            }
+          }
+
+          query_pool.Run([hwnds = std::move(hwnds), fields, cached_titles = std::move(cached_titles)]() {
+            return CollectWindowInfo(hwnds, fields, cached_titles);
+          }, std::move(result));
           return;
         }
         // ========================================================================
@@ -753,7 +1920,15 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
             result->Error("bad_args", "Missing 'viewId'");
             return;
           }
-          int64_t view_id = std::get<int64_t>(it->second);
+          int64_t view_id = 0;
+          if (std::holds_alternative<int32_t>(it->second)) {
+            view_id = std::get<int32_t>(it->second);
+          } else if (std::holds_alternative<int64_t>(it->second)) {
+            view_id = std::get<int64_t>(it->second);
+          } else {
+            result->Error("bad_type", "'viewId' must be an int");
+            return;
+          }
           FlutterDesktopPluginRegistrarRef desktop_registrar =
               reinterpret_cast<FlutterDesktopPluginRegistrarRef>(engine->GetRegistrarForPlugin("dummy_plugin"));
           FlutterDesktopViewRef view = FlutterDesktopPluginRegistrarGetViewById(desktop_registrar, view_id);
@@ -771,62 +1946,27 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
         // ========================================================================
         // Sets up window subclassing for proper title bar handling.
         // This is called from Flutter when we need to manipulate a window's title bar.
+        // The window is named by 'hwnd' or by 'target': 'focused' (TargetWindow).
         // ========================================================================
         if (method == "setupWindowInterception") {
           const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
           if (!args) {
-            result->Error("bad_args", "Expected map with 'hwnd'");
-            return;
-          }
-          auto it_hwnd = args->find(flutter::EncodableValue("hwnd"));
-          if (it_hwnd == args->end()) {
-            result->Error("bad_args", "Missing 'hwnd'");
+            result->Error("bad_args", "Expected map with 'hwnd' or 'target'");
             return;
           }
 
           try {
-            // Handle type conversion from Dart
-            int64_t hwnd_val = 0;
-            auto& hwnd_value = it_hwnd->second;
-
-            if (std::holds_alternative<int64_t>(hwnd_value)) {
-              hwnd_val = std::get<int64_t>(hwnd_value);
-            } else if (std::holds_alternative<int32_t>(hwnd_value)) {
-              hwnd_val = static_cast<int64_t>(std::get<int32_t>(hwnd_value));
-            } else if (std::holds_alternative<double>(hwnd_value)) {
-              hwnd_val = static_cast<int64_t>(std::get<double>(hwnd_value));
-            } else {
-              result->Error("bad_type", "HWND value is not a supported numeric type");
-              return;
-            }
-
-            HWND hwnd = reinterpret_cast<HWND>(static_cast<intptr_t>(hwnd_val));
-
-            if (!::IsWindow(hwnd)) {
-              result->Error("invalid_hwnd", "Invalid window handle");
+            HWND hwnd = TargetWindow(*args, result.get());
+            if (!hwnd) {
               return;
             }
 
             // Set up window subclassing for proper message interception
-            WNDPROC originalProc = reinterpret_cast<WNDPROC>(GetWindowLongPtr(hwnd, GWLP_WNDPROC));
-
-            // Only subclass if not already subclassed
-            auto it = g_original_window_procedures.find(hwnd);
-            if (it == g_original_window_procedures.end()) {
-              // Store original procedure
-              g_original_window_procedures[hwnd] = originalProc;
-
-              // Set up subclassing
-              if (SetWindowSubclass(hwnd, FlutterWindowSubclassProc, 1, 0)) {
-                std::cout << "Window subclassing set up for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
-                result->Success(flutter::EncodableValue(true));
-              } else {
-                std::cerr << "Failed to set up window subclassing for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
-                result->Error("subclass_failed", "Failed to set up window subclassing");
-              }
-            } else {
-              // Already subclassed
+            // (no-op when the window is already subclassed)
+            if (setupWindowInterception(hwnd)) {
               result->Success(flutter::EncodableValue(true));
+            } else {
+              result->Error("subclass_failed", "Failed to set up window subclassing");
             }
 
             return;
@@ -846,39 +1986,18 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
         // ========================================================================
         // Toggles between normal window and frameless window.
         // Frameless windows have no borders, title bar, or window controls.
+        // The window is named by 'hwnd' or by 'target': 'focused' (TargetWindow).
         // ========================================================================
         if (method == "toggleFrameless") {
           const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
           if (!args) {
-            result->Error("bad_args", "Expected map with 'hwnd'");
-            return;
-          }
-          auto it_hwnd = args->find(flutter::EncodableValue("hwnd"));
-          if (it_hwnd == args->end()) {
-            result->Error("bad_args", "Missing 'hwnd'");
+            result->Error("bad_args", "Expected map with 'hwnd' or 'target'");
             return;
           }
 
           try {
-            // Handle type conversion from Dart
-            int64_t hwnd_val = 0;
-            auto& hwnd_value = it_hwnd->second;
-
-            if (std::holds_alternative<int64_t>(hwnd_value)) {
-              hwnd_val = std::get<int64_t>(hwnd_value);
-            } else if (std::holds_alternative<int32_t>(hwnd_value)) {
-              hwnd_val = static_cast<int64_t>(std::get<int32_t>(hwnd_value));
-            } else if (std::holds_alternative<double>(hwnd_value)) {
-              hwnd_val = static_cast<int64_t>(std::get<double>(hwnd_value));
-            } else {
-              result->Error("bad_type", "HWND value is not a supported numeric type");
-              return;
-            }
-
-            HWND hwnd = reinterpret_cast<HWND>(static_cast<intptr_t>(hwnd_val));
-
-            if (!::IsWindow(hwnd)) {
-              result->Error("invalid_hwnd", "Invalid window handle");
+            HWND hwnd = TargetWindow(*args, result.get());
+            if (!hwnd) {
               return;
             }
 
@@ -889,78 +2008,15 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
               return;
             }
 
-            // Check current window style to determine if it's frameless
-            LONG_PTR current_style = ::GetWindowLongPtrW(hwnd, GWL_STYLE);
-            bool is_frameless = (current_style & WS_CAPTION) == 0;
+            // Check the tracked mode to determine if it's frameless
+            uint8_t mode = CurrentWindowMode(hwnd);
+            bool is_frameless = (mode & kWindowModeFrameless) != 0;
             std::cout << "[TOGGLE] Current frameless state detected: " << (is_frameless ? "YES" : "NO") << std::endl;
 
             // Toggle: if frameless -> make normal, if normal -> make frameless
-            if (is_frameless) {
-              // Make window normal (restore frame)
-              LONG_PTR style = ::GetWindowLongPtrW(hwnd, GWL_STYLE);
-              style |= (WS_CAPTION | WS_SYSMENU | WS_THICKFRAME | WS_MINIMIZEBOX | WS_MAXIMIZEBOX);
-              ::SetWindowLongPtrW(hwnd, GWL_STYLE, style);
-
-              // Restore extended styles for normal windows
-              LONG_PTR exStyle = ::GetWindowLongPtrW(hwnd, GWL_EXSTYLE);
-              exStyle |= (WS_EX_WINDOWEDGE | WS_EX_CLIENTEDGE);  // Add standard window edges
-              ::SetWindowLongPtrW(hwnd, GWL_EXSTYLE, exStyle);
-
-              // Restore DWM attributes for normal windows
-              // Enable window shadows for normal windows
-
-              // Restore default corner preference for normal windows
-              DWM_WINDOW_CORNER_PREFERENCE cornerPref = DWMWCP_DEFAULT;
-              ::DwmSetWindowAttribute(hwnd, DWMWA_WINDOW_CORNER_PREFERENCE, &cornerPref, sizeof(cornerPref));
-
-              // Reset NC rendering policy to enable shadows
-              DWMNCRENDERINGPOLICY policy = DWMNCRP_ENABLED;
-              ::DwmSetWindowAttribute(hwnd, DWMWA_NCRENDERING_POLICY, &policy, sizeof(policy));
-
-              // Reset DWM frame to normal
-              MARGINS margins = {0, 0, 0, 0};
-              ::DwmExtendFrameIntoClientArea(hwnd, &margins);
-
-              // Unregister from frameless tracking
-              g_flutter_frameless_windows.erase(hwnd);
-
-              std::cout << "Window made normal for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
-            } else {
-              // Make window frameless (following window_manager approach exactly)
-              LONG_PTR style = ::GetWindowLongPtrW(hwnd, GWL_STYLE);
-              // Remove ALL possible border and frame styles for completely clean appearance
-              style &= ~(WS_CAPTION | WS_THICKFRAME | WS_SYSMENU | WS_MINIMIZEBOX | WS_MAXIMIZEBOX |
-                        WS_BORDER | WS_DLGFRAME | WS_SIZEBOX);
-              style |= WS_THICKFRAME;  // Keep resizing capability
-              ::SetWindowLongPtrW(hwnd, GWL_STYLE, style);
-
-              // For frameless windows, remove ALL extended styles that create visual effects
-              LONG_PTR exStyle = ::GetWindowLongPtrW(hwnd, GWL_EXSTYLE);
-              exStyle &= ~(WS_EX_WINDOWEDGE | WS_EX_CLIENTEDGE | WS_EX_DLGMODALFRAME |
-                          WS_EX_STATICEDGE | WS_EX_TOOLWINDOW | WS_EX_APPWINDOW);
-              ::SetWindowLongPtrW(hwnd, GWL_EXSTYLE, exStyle);
-
-              // Additional DWM attributes to ensure no visual artifacts
-              // Disable window transitions and animations
-              DWM_WINDOW_CORNER_PREFERENCE cornerPref = DWMWCP_DONOTROUND;
-              ::DwmSetWindowAttribute(hwnd, DWMWA_WINDOW_CORNER_PREFERENCE, &cornerPref, sizeof(cornerPref));
-
-              // Disable DWM frame extension to remove shadow
-              MARGINS margins = {0, 0, 0, 0};
-              ::DwmExtendFrameIntoClientArea(hwnd, &margins);
-
-              // Register for frameless tracking
-              g_flutter_frameless_windows[hwnd] = true;
-
-              std::cout << "Window made frameless for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
-            }
-
-            // Force window redraw
-            RECT rect;
-            ::GetWindowRect(hwnd, &rect);
-            ::SetWindowPos(hwnd, nullptr, rect.left, rect.top,
-                         rect.right - rect.left, rect.bottom - rect.top,
-                         SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_FRAMECHANGED);
+            ApplyWindowMode(hwnd, WithWindowModeFlag(mode, kWindowModeFrameless, !is_frameless));
+            std::cout << (is_frameless ? "Window made normal" : "Window made frameless")
+                      << " for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
 
             result->Success(flutter::EncodableValue(true));
             return;
@@ -980,16 +2036,12 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
         // ========================================================================
         // Explicitly sets frameless mode for a window.
         // frameless: true for frameless, false for normal window.
+        // The window is named by 'hwnd' or by 'target': 'focused' (TargetWindow).
         // ========================================================================
         if (method == "setFrameless") {
           const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
           if (!args) {
-            result->Error("bad_args", "Expected map with 'hwnd' and 'frameless'");
-            return;
-          }
-          auto it_hwnd = args->find(flutter::EncodableValue("hwnd"));
-          if (it_hwnd == args->end()) {
-            result->Error("bad_args", "Missing 'hwnd'");
+            result->Error("bad_args", "Expected map with 'hwnd' or 'target' and 'frameless'");
             return;
           }
           auto it_frameless = args->find(flutter::EncodableValue("frameless"));
@@ -999,18 +2051,8 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
           }
 
           try {
-            // Handle type conversion from Dart
-            int64_t hwnd_val = 0;
-            auto& hwnd_value = it_hwnd->second;
-
-            if (std::holds_alternative<int64_t>(hwnd_value)) {
-              hwnd_val = std::get<int64_t>(hwnd_value);
-            } else if (std::holds_alternative<int32_t>(hwnd_value)) {
-              hwnd_val = static_cast<int64_t>(std::get<int32_t>(hwnd_value));
-            } else if (std::holds_alternative<double>(hwnd_value)) {
-              hwnd_val = static_cast<int64_t>(std::get<double>(hwnd_value));
-            } else {
-              result->Error("bad_type", "HWND value is not a supported numeric type");
+            HWND hwnd = TargetWindow(*args, result.get());
+            if (!hwnd) {
               return;
             }
 
@@ -1022,17 +2064,6 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
             }
 
             bool frameless = std::get<bool>(frameless_value);
-            HWND hwnd = reinterpret_cast<HWND>(static_cast<intptr_t>(hwnd_val));
-
-            if (!::IsWindow(hwnd)) {
-              result->Error("invalid_hwnd", "Invalid window handle");
-              return;
-            }
-
-            // Check if transparency is active and preserve its state
-            auto transparentIt = g_flutter_transparent_windows.find(hwnd);
-            bool isTransparent = (transparentIt != g_flutter_transparent_windows.end() && transparentIt->second);
-            bool wasTransparent = isTransparent; // Remember original state
 
             // Set up window interception first
             if (!setupWindowInterception(hwnd)) {
@@ -1041,90 +2072,11 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
               return;
             }
 
-            if (frameless) {
-              // Make window frameless (following window_manager approach exactly)
-              LONG_PTR style = ::GetWindowLongPtrW(hwnd, GWL_STYLE);
-              // Remove ALL possible border and frame styles for completely clean appearance
-              style &= ~(WS_CAPTION | WS_THICKFRAME | WS_SYSMENU | WS_MINIMIZEBOX | WS_MAXIMIZEBOX |
-                        WS_BORDER | WS_DLGFRAME | WS_SIZEBOX);
-              style |= WS_THICKFRAME;  // Keep resizing capability
-              ::SetWindowLongPtrW(hwnd, GWL_STYLE, style);
-
-              // For frameless windows, remove ALL extended styles that create visual effects
-              LONG_PTR exStyle = ::GetWindowLongPtrW(hwnd, GWL_EXSTYLE);
-              exStyle &= ~(WS_EX_WINDOWEDGE | WS_EX_CLIENTEDGE | WS_EX_DLGMODALFRAME |
-                          WS_EX_STATICEDGE | WS_EX_TOOLWINDOW | WS_EX_APPWINDOW);
-              ::SetWindowLongPtrW(hwnd, GWL_EXSTYLE, exStyle);
-
-              // Additional DWM attributes to ensure no visual artifacts
-              // Disable window transitions and animations
-              DWM_WINDOW_CORNER_PREFERENCE cornerPref = DWMWCP_DONOTROUND;
-              ::DwmSetWindowAttribute(hwnd, DWMWA_WINDOW_CORNER_PREFERENCE, &cornerPref, sizeof(cornerPref));
-
-              // Disable DWM frame extension to remove shadow  
-              MARGINS margins = {0, 0, 0, 0};  // Zero margins remove shadow
-              ::DwmExtendFrameIntoClientArea(hwnd, &margins);
-
-              // Register for frameless tracking
-              g_flutter_frameless_windows[hwnd] = true;
-
-              std::cout << "Window set to frameless for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
-            } else {
-              // Make window normal
-              LONG_PTR style = ::GetWindowLongPtrW(hwnd, GWL_STYLE);
-              style |= (WS_CAPTION | WS_SYSMENU | WS_THICKFRAME | WS_MINIMIZEBOX | WS_MAXIMIZEBOX);
-              ::SetWindowLongPtrW(hwnd, GWL_STYLE, style);
-
-              // Restore extended styles for normal windows
-              LONG_PTR exStyle = ::GetWindowLongPtrW(hwnd, GWL_EXSTYLE);
-              exStyle |= (WS_EX_WINDOWEDGE | WS_EX_CLIENTEDGE);  // Add standard window edges
-              ::SetWindowLongPtrW(hwnd, GWL_EXSTYLE, exStyle);
-
-              // Restore DWM attributes for normal windows
-              // Enable window shadows for normal windows
-
-              // Restore default corner preference for normal windows
-              DWM_WINDOW_CORNER_PREFERENCE cornerPref = DWMWCP_DEFAULT;
-              ::DwmSetWindowAttribute(hwnd, DWMWA_WINDOW_CORNER_PREFERENCE, &cornerPref, sizeof(cornerPref));
-
-              // Reset NC rendering policy to enable shadows
-              DWMNCRENDERINGPOLICY policy = DWMNCRP_ENABLED;
-              ::DwmSetWindowAttribute(hwnd, DWMWA_NCRENDERING_POLICY, &policy, sizeof(policy));
-
-              // Reset DWM frame to normal
-              MARGINS margins = {0, 0, 0, 0};
-              ::DwmExtendFrameIntoClientArea(hwnd, &margins);
-
-              // Unregister from frameless tracking
-              g_flutter_frameless_windows.erase(hwnd);
-
-              std::cout << "Window set to normal for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
-            }
-
-            // Force window redraw
-            RECT rect;
-            ::GetWindowRect(hwnd, &rect);
-            ::SetWindowPos(hwnd, nullptr, rect.left, rect.top,
-                         rect.right - rect.left, rect.bottom - rect.top,
-                         SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_FRAMECHANGED);
-
-            // If transparency was active before, reapply it after frameless change
-            if (wasTransparent && g_set_window_composition_attribute) {
-              ACCENT_POLICY accent = {
-                  ACCENT_ENABLE_TRANSPARENTGRADIENT,  // AccentState
-                  2,                                  // AccentFlags
-                  0x00000000,                         // GradientColor (fully transparent in ABGR format)
-                  0                                   // AnimationId
-              };
-
-              WINDOWCOMPOSITIONATTRIBDATA data;
-              data.Attrib = WCA_ACCENT_POLICY;
-              data.pvData = &accent;
-              data.cbData = sizeof(accent);
-
-              g_set_window_composition_attribute(hwnd, &data);
-              std::cout << "Reapplied transparency after frameless change for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
-            }
+            // Frameless (following window_manager approach) strips the frame
+            // and its shadow; normal restores the caption, edges and shadow
+            ApplyWindowMode(hwnd, WithWindowModeFlag(CurrentWindowMode(hwnd), kWindowModeFrameless, frameless));
+            std::cout << (frameless ? "Window set to frameless" : "Window set to normal")
+                      << " for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
 
             result->Success(flutter::EncodableValue(true));
             return;
@@ -1147,13 +2099,13 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
         // or if the focused window belongs to a different process.
         // ========================================================================
         if (method == "getFocusedFlutterWindowHandle") {
-          HWND fg = ::GetForegroundWindow();
+          HWND fg = win32::GetForegroundWindow();
           if (!fg) {
             result->Success(flutter::EncodableValue());
             return;
           }
           DWORD pid = 0;
-          ::GetWindowThreadProcessId(fg, &pid);
+          win32::GetWindowThreadProcessId(fg, &pid);
           if (pid != ::GetCurrentProcessId()) {
             // Foreground window isn't in this process; no focused Flutter window
             result->Success(flutter::EncodableValue());
@@ -1170,6 +2122,7 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
         // - If title bar is visible → hides it
         // - If title bar is hidden → shows it
         // This is the most user-friendly method for UI toggles.
+        // The window is named by 'hwnd' or by 'target': 'focused' (TargetWindow).
         // ========================================================================
         if (method == "toggleTitleBar") {
           // Toggle title bar visibility for a window.
@@ -1177,36 +2130,13 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
           // and toggles it to the opposite state.
           const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
           if (!args) {
-            result->Error("bad_args", "Expected map with 'hwnd'");
-            return;
-          }
-          auto it_hwnd = args->find(flutter::EncodableValue("hwnd"));
-          if (it_hwnd == args->end()) {
-            result->Error("bad_args", "Missing 'hwnd'");
+            result->Error("bad_args", "Expected map with 'hwnd' or 'target'");
             return;
           }
 
           try {
-            // Handle type conversion from Dart (which may send int32_t instead of int64_t)
-            int64_t hwnd_val = 0;
-            auto& value = it_hwnd->second;
-
-            // Try different numeric types that Dart might send
-            if (std::holds_alternative<int64_t>(value)) {
-              hwnd_val = std::get<int64_t>(value);
-            } else if (std::holds_alternative<int32_t>(value)) {
-              hwnd_val = static_cast<int64_t>(std::get<int32_t>(value));
-            } else if (std::holds_alternative<double>(value)) {
-              hwnd_val = static_cast<int64_t>(std::get<double>(value));
-            } else {
-              result->Error("bad_type", "HWND value is not a supported numeric type");
-              return;
-            }
-
-            HWND hwnd = reinterpret_cast<HWND>(static_cast<intptr_t>(hwnd_val));
-
-            if (!::IsWindow(hwnd)) {
-              result->Error("invalid_hwnd", "Invalid window handle");
+            HWND hwnd = TargetWindow(*args, result.get());
+            if (!hwnd) {
               return;
             }
 
@@ -1217,72 +2147,14 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
               return;
             }
 
-            // Check current window style to determine title bar state
-            LONG_PTR current_style = ::GetWindowLongPtrW(hwnd, GWL_STYLE);
-            bool has_caption = (current_style & WS_CAPTION) != 0;
-
-            // Check if transparency is active and preserve its state
-            auto transparentIt = g_flutter_transparent_windows.find(hwnd);
-            bool isTransparent = (transparentIt != g_flutter_transparent_windows.end() && transparentIt->second);
-            bool wasTransparent = isTransparent; // Remember original state
-
-            // Toggle: if has caption -> hide, if no caption -> show
-            if (has_caption) {
-              // Hide title bar using proper DWM frame extension
-              LONG_PTR style = ::GetWindowLongPtrW(hwnd, GWL_STYLE);
-              style &= ~(WS_CAPTION);  // Remove caption but keep resizing
-              ::SetWindowLongPtrW(hwnd, GWL_STYLE, style);
-
-              // Only modify DWM margins if transparency is not active
-              if (!isTransparent) {
-                // Extend client area into title bar area (key insight from window_manager)
-                MARGINS margins = {-1, -1, -1, -1};  // Extend all sides into client area
-                ::DwmExtendFrameIntoClientArea(hwnd, &margins);
-              }
-
-              // Register this window for message interception
-              g_flutter_hidden_title_bar_windows[hwnd] = true;
-            } else {
-              // Show title bar: restore WS_CAPTION and related styles
-              LONG_PTR style = ::GetWindowLongPtrW(hwnd, GWL_STYLE);
-              style |= (WS_CAPTION | WS_SYSMENU | WS_THICKFRAME);
-              ::SetWindowLongPtrW(hwnd, GWL_STYLE, style);
-
-              // Only modify DWM margins if transparency is not active
-              if (!isTransparent) {
-                // Reset DWM frame to normal (no extension)
-                MARGINS margins = {0, 0, 0, 0};
-                ::DwmExtendFrameIntoClientArea(hwnd, &margins);
-              }
-
-              // Unregister this window from message interception
-              g_flutter_hidden_title_bar_windows.erase(hwnd);
-            }
+            // Check the tracked mode to determine title bar state
+            uint8_t mode = CurrentWindowMode(hwnd);
+            bool hidden = (mode & kWindowModeHiddenTitleBar) != 0;
 
-            // Force window redraw to apply changes
-            RECT rect;
-            ::GetWindowRect(hwnd, &rect);
-            ::SetWindowPos(hwnd, nullptr, rect.left, rect.top,
-                         rect.right - rect.left, rect.bottom - rect.top,
-                         SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_FRAMECHANGED);
-
-            // If transparency was active before, reapply it after title bar change
-            if (wasTransparent && g_set_window_composition_attribute) {
-              ACCENT_POLICY accent = {
-                  ACCENT_ENABLE_TRANSPARENTGRADIENT,  // AccentState
-                  2,                                  // AccentFlags
-                  0x00000000,                         // GradientColor (fully transparent in ABGR format)
-                  0                                   // AnimationId
-              };
-
-              WINDOWCOMPOSITIONATTRIBDATA data;
-              data.Attrib = WCA_ACCENT_POLICY;
-              data.pvData = &accent;
-              data.cbData = sizeof(accent);
-
-              g_set_window_composition_attribute(hwnd, &data);
-              std::cout << "Reapplied transparency after title bar toggle for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
-            }
+            // Toggle: hiding removes the caption and extends the DWM frame into
+            // the client area (key insight from window_manager); showing
+            // restores both
+            ApplyWindowMode(hwnd, WithWindowModeFlag(mode, kWindowModeHiddenTitleBar, !hidden));
 
             result->Success(flutter::EncodableValue(true));
             return;
@@ -1303,18 +2175,14 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
         // Explicitly sets the title bar to hidden or normal state.
         // Unlike toggleTitleBar, this method requires you to specify the desired state.
         // Useful when you need precise control over the title bar state.
+        // The window is named by 'hwnd' or by 'target': 'focused' (TargetWindow).
         // ========================================================================
         if (method == "setTitleBarStyle") {
           // Set title bar visibility for a window.
           // This method explicitly sets the title bar to hidden or normal state.
           const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
           if (!args) {
-            result->Error("bad_args", "Expected map with 'hwnd' and 'titleBarStyle'");
-            return;
-          }
-          auto it_hwnd = args->find(flutter::EncodableValue("hwnd"));
-          if (it_hwnd == args->end()) {
-            result->Error("bad_args", "Missing 'hwnd'");
+            result->Error("bad_args", "Expected map with 'hwnd' or 'target' and 'titleBarStyle'");
             return;
           }
           auto it_style = args->find(flutter::EncodableValue("titleBarStyle"));
@@ -1324,19 +2192,8 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
           }
 
           try {
-            // Handle type conversion from Dart (which may send int32_t instead of int64_t)
-            int64_t hwnd_val = 0;
-            auto& hwnd_value = it_hwnd->second;
-
-            // Try different numeric types that Dart might send
-            if (std::holds_alternative<int64_t>(hwnd_value)) {
-              hwnd_val = std::get<int64_t>(hwnd_value);
-            } else if (std::holds_alternative<int32_t>(hwnd_value)) {
-              hwnd_val = static_cast<int64_t>(std::get<int32_t>(hwnd_value));
-            } else if (std::holds_alternative<double>(hwnd_value)) {
-              hwnd_val = static_cast<int64_t>(std::get<double>(hwnd_value));
-            } else {
-              result->Error("bad_type", "HWND value is not a supported numeric type");
+            HWND hwnd = TargetWindow(*args, result.get());
+            if (!hwnd) {
               return;
             }
 
@@ -1348,12 +2205,6 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
             }
 
             std::string title_bar_style = std::get<std::string>(style_value);
-            HWND hwnd = reinterpret_cast<HWND>(static_cast<intptr_t>(hwnd_val));
-
-            if (!::IsWindow(hwnd)) {
-              result->Error("invalid_hwnd", "Invalid window handle");
-              return;
-            }
 
             // Set up window interception first (required for proper title bar handling)
             // This ensures the window is properly subclassed before we modify its title bar
@@ -1363,82 +2214,16 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
               return;
             }
 
-            // Check if transparency is active and preserve its state
-            auto transparentIt = g_flutter_transparent_windows.find(hwnd);
-            bool isTransparent = (transparentIt != g_flutter_transparent_windows.end() && transparentIt->second);
-            bool wasTransparent = isTransparent; // Remember original state
-
             // Apply the requested title bar style
-            if (title_bar_style == "hidden") {
-              // Hide title bar using window_manager approach
-              LONG_PTR style = ::GetWindowLongPtrW(hwnd, GWL_STYLE);
-              style &= ~(WS_CAPTION);  // Remove caption but keep resizing
-              ::SetWindowLongPtrW(hwnd, GWL_STYLE, style);
-
-              // Only modify DWM margins if transparency is not active
-              if (!isTransparent) {
-                // Extend client area into title bar area (key insight from window_manager)
-                // For hidden title bar, extend frame into client area
-                MARGINS margins = {-1, -1, -1, -1};  // Extend all sides into client area
-                ::DwmExtendFrameIntoClientArea(hwnd, &margins);
-              }
-
-              // Register this Flutter window for message interception
-              g_flutter_hidden_title_bar_windows[hwnd] = true;
-
-              std::cout << "Title bar hidden - DWM extended client area (top margin = 1)" << std::endl;
-            } else if (title_bar_style == "normal" || title_bar_style == "visible") {
-              // Show title bar: restore WS_CAPTION and related styles
-              LONG_PTR style = ::GetWindowLongPtrW(hwnd, GWL_STYLE);
-              style |= (WS_CAPTION | WS_SYSMENU | WS_THICKFRAME);
-              ::SetWindowLongPtrW(hwnd, GWL_STYLE, style);
-
-              // Only modify DWM margins if transparency is not active
-              if (!isTransparent) {
-                // Reset DWM frame to normal (no extension)
-                MARGINS margins = {0, 0, 0, 0};
-                ::DwmExtendFrameIntoClientArea(hwnd, &margins);
-              }
-
-              // Unregister this window from message interception
-              g_flutter_hidden_title_bar_windows.erase(hwnd);
-
-              std::cout << "Title bar shown - DWM frame reset to normal" << std::endl;
-            } else {
+            bool hidden = title_bar_style == "hidden";
+            if (!hidden && title_bar_style != "normal" && title_bar_style != "visible") {
               result->Error("invalid_style", "titleBarStyle must be 'hidden' or 'normal'");
               return;
             }
-
-            // Force complete window redraw (essential for DWM changes to take effect)
-            RECT rect;
-            ::GetWindowRect(hwnd, &rect);
-            ::SetWindowPos(hwnd, nullptr, rect.left, rect.top,
-                         rect.right - rect.left, rect.bottom - rect.top,
-                         SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_FRAMECHANGED);
-
-            // Additional redraw for maximized windows (window_manager handles this in WM_NCCALCSIZE)
-            if (::IsZoomed(hwnd)) {
-              ::ShowWindow(hwnd, SW_HIDE);
-              ::ShowWindow(hwnd, SW_SHOWMAXIMIZED);
-            }
-
-            // If transparency was active before, reapply it after title bar change
-            if (wasTransparent && g_set_window_composition_attribute) {
-              ACCENT_POLICY accent = {
-                  ACCENT_ENABLE_TRANSPARENTGRADIENT,  // AccentState
-                  2,                                  // AccentFlags
-                  0x00000000,                         // GradientColor (fully transparent in ABGR format)
-                  0                                   // AnimationId
-              };
-
-              WINDOWCOMPOSITIONATTRIBDATA data;
-              data.Attrib = WCA_ACCENT_POLICY;
-              data.pvData = &accent;
-              data.cbData = sizeof(accent);
-
-              g_set_window_composition_attribute(hwnd, &data);
-              std::cout << "Reapplied transparency after title bar change for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
-            }
+            // Hidden extends the DWM frame into the client area; maximized
+            // windows are shown again to pick up the new frame
+            ApplyWindowMode(hwnd, WithWindowModeFlag(CurrentWindowMode(hwnd), kWindowModeHiddenTitleBar, hidden));
+            std::cout << (hidden ? "Title bar hidden - DWM extended client area" : "Title bar shown - DWM frame reset to normal") << std::endl;
 
             result->Success(flutter::EncodableValue(true));
             return;
@@ -1458,16 +2243,12 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
         // ========================================================================
         // Sets the window background to be fully transparent or normal.
         // Uses Windows composition attributes to achieve transparency effect.
+        // The window is named by 'hwnd' or by 'target': 'focused' (TargetWindow).
         // ========================================================================
         if (method == "setTransparentBackground") {
           const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
           if (!args) {
-            result->Error("bad_args", "Expected map with 'hwnd' and 'transparent'");
-            return;
-          }
-          auto it_hwnd = args->find(flutter::EncodableValue("hwnd"));
-          if (it_hwnd == args->end()) {
-            result->Error("bad_args", "Missing 'hwnd'");
+            result->Error("bad_args", "Expected map with 'hwnd' or 'target' and 'transparent'");
             return;
           }
           auto it_transparent = args->find(flutter::EncodableValue("transparent"));
@@ -1477,18 +2258,8 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
           }
 
           try {
-            // Handle type conversion from Dart
-            int64_t hwnd_val = 0;
-            auto& hwnd_value = it_hwnd->second;
-
-            if (std::holds_alternative<int64_t>(hwnd_value)) {
-              hwnd_val = std::get<int64_t>(hwnd_value);
-            } else if (std::holds_alternative<int32_t>(hwnd_value)) {
-              hwnd_val = static_cast<int64_t>(std::get<int32_t>(hwnd_value));
-            } else if (std::holds_alternative<double>(hwnd_value)) {
-              hwnd_val = static_cast<int64_t>(std::get<double>(hwnd_value));
-            } else {
-              result->Error("bad_type", "HWND value is not a supported numeric type");
+            HWND hwnd = TargetWindow(*args, result.get());
+            if (!hwnd) {
               return;
             }
 
@@ -1500,10 +2271,12 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
             }
 
             bool transparent = std::get<bool>(transparent_value);
-            HWND hwnd = reinterpret_cast<HWND>(static_cast<intptr_t>(hwnd_val));
 
-            if (!::IsWindow(hwnd)) {
-              result->Error("invalid_hwnd", "Invalid window handle");
+            // Set up window interception first, so focused-window calls need
+            // no separate setupWindowInterception round trip
+            if (!setupWindowInterception(hwnd)) {
+              std::cerr << "Failed to set up window interception for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
+              result->Error("interception_failed", "Failed to set up window interception");
               return;
             }
 
@@ -1526,108 +2299,21 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
               return;
             }
 
-            if (transparent) {
-              // Make window background transparent
-              // Only disable existing accent policy if transitioning from non-transparent to transparent
-              if (!currentlyTransparent) {
-                ACCENT_POLICY disable_accent = {
-                    ACCENT_DISABLED,  // AccentState
-                    2,                // AccentFlags
-                    0x00000000,       // GradientColor
-                    0                 // AnimationId
-                };
-
-                WINDOWCOMPOSITIONATTRIBDATA disable_data;
-                disable_data.Attrib = WCA_ACCENT_POLICY;
-                disable_data.pvData = &disable_accent;
-                disable_data.cbData = sizeof(disable_accent);
-                g_set_window_composition_attribute(hwnd, &disable_data);
-              }
-
-              // For transparency, we need to extend DWM frame, but only if not already transparent
-              // The frameless operation sets {0, 0, 1, 0} which works better with transparency
-              // So we'll use that instead of {-1, -1, -1, -1}
-              if (!currentlyTransparent) {
-                MARGINS margins = {0, 0, 1, 0};  // Use frameless-style margins for transparency
-                ::DwmExtendFrameIntoClientArea(hwnd, &margins);
-              }
-
-              // Apply transparent gradient accent
-              ACCENT_POLICY accent = {
-                  ACCENT_ENABLE_TRANSPARENTGRADIENT,  // AccentState
-                  2,                                  // AccentFlags
-                  0x00000000,                         // GradientColor (fully transparent in ABGR format)
-                  0                                   // AnimationId
-              };
-
-              WINDOWCOMPOSITIONATTRIBDATA data;
-              data.Attrib = WCA_ACCENT_POLICY;
-              data.pvData = &accent;
-              data.cbData = sizeof(accent);
-
-              if (g_set_window_composition_attribute(hwnd, &data)) {
-                // Track this window as having transparent background
-                g_flutter_transparent_windows[hwnd] = true;
-                std::cout << "Window background set to transparent for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
-              } else {
+            // The transparent gradient accent with {0, 0, 1, 0} margins, unless
+            // the window is frameless; hidden title bars drop their sheet of
+            // glass while transparent
+            if (!ApplyWindowMode(hwnd, WithWindowModeFlag(CurrentWindowMode(hwnd), kWindowModeTransparent, transparent))) {
+              if (transparent) {
                 std::cerr << "Failed to set transparent background for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
                 result->Error("transparency_failed", "Failed to set transparent background");
-                return;
-              }
-            } else {
-              // Restore normal window background
-              // Only disable accent policy if transitioning from transparent to non-transparent
-              if (currentlyTransparent) {
-                ACCENT_POLICY accent = {
-                    ACCENT_DISABLED,  // AccentState
-                    2,                // AccentFlags
-                    0x00000000,       // GradientColor
-                    0                 // AnimationId
-                };
-
-                WINDOWCOMPOSITIONATTRIBDATA data;
-                data.Attrib = WCA_ACCENT_POLICY;
-                data.pvData = &accent;
-                data.cbData = sizeof(accent);
-
-                if (g_set_window_composition_attribute(hwnd, &data)) {
-                  // Check if title bar is hidden to determine correct margins
-                  auto titleBarIt = g_flutter_hidden_title_bar_windows.find(hwnd);
-                  bool titleBarHidden = (titleBarIt != g_flutter_hidden_title_bar_windows.end() && titleBarIt->second);
-
-                  // Reset DWM margins appropriately
-                  MARGINS margins;
-                  if (titleBarHidden) {
-                    // If title bar is hidden, use the margins for hidden title bar
-                    margins = {-1, -1, -1, -1};
-                  } else {
-                    // Normal window margins
-                    margins = {0, 0, 0, 0};
-                  }
-                  ::DwmExtendFrameIntoClientArea(hwnd, &margins);
-
-                  // Untrack this window from transparent tracking
-                  g_flutter_transparent_windows.erase(hwnd);
-                  std::cout << "Window background restored to normal for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
-                } else {
-                  std::cerr << "Failed to restore normal background for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
-                  result->Error("restore_failed", "Failed to restore normal background");
-                  return;
-                }
               } else {
-                // Already in desired state (not transparent)
-                std::cout << "Window background already normal for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
-                result->Success(flutter::EncodableValue(true));
-                return;
+                std::cerr << "Failed to restore normal background for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
+                result->Error("restore_failed", "Failed to restore normal background");
               }
+              return;
             }
-
-            // Force window redraw to apply changes
-            RECT rect;
-            ::GetWindowRect(hwnd, &rect);
-            ::SetWindowPos(hwnd, nullptr, rect.left, rect.top,
-                         rect.right - rect.left, rect.bottom - rect.top,
-                         SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_FRAMECHANGED);
+            std::cout << (transparent ? "Window background set to transparent" : "Window background restored to normal")
+                      << " for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
 
             result->Success(flutter::EncodableValue(true));
             return;
@@ -1642,6 +2328,322 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
           }
         }
 
+        // ========================================================================
+        // setHitTestMask: Set a per-pixel hit-test mask for a window
+        // ========================================================================
+        // Takes a downsampled alpha channel ('alpha', 'width' x 'height' bytes)
+        // that is stretched over the client area. Pixels below 'threshold'
+        // (default 128) let mouse input through. An empty mask removes it.
+        // ========================================================================
+        if (method == "setHitTestMask") {
+          const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+          if (!args) {
+            result->Error("bad_args", "Expected map with 'hwnd', 'width', 'height' and 'alpha'");
+            return;
+          }
+          auto it_hwnd = args->find(flutter::EncodableValue("hwnd"));
+          if (it_hwnd == args->end()) {
+            result->Error("bad_args", "Missing 'hwnd'");
+            return;
+          }
+          auto it_width = args->find(flutter::EncodableValue("width"));
+          auto it_height = args->find(flutter::EncodableValue("height"));
+          auto it_alpha = args->find(flutter::EncodableValue("alpha"));
+          if (it_width == args->end() || it_height == args->end() || it_alpha == args->end()) {
+            result->Error("bad_args", "Missing 'width', 'height' or 'alpha'");
+            return;
+          }
+
+          try {
+            // Handle type conversion from Dart
+            int64_t hwnd_val = 0;
+            auto& hwnd_value = it_hwnd->second;
+
+            if (std::holds_alternative<int64_t>(hwnd_value)) {
+              hwnd_val = std::get<int64_t>(hwnd_value);
+            } else if (std::holds_alternative<int32_t>(hwnd_value)) {
+              hwnd_val = static_cast<int64_t>(std::get<int32_t>(hwnd_value));
+            } else if (std::holds_alternative<double>(hwnd_value)) {
+              hwnd_val = static_cast<int64_t>(std::get<double>(hwnd_value));
+            } else {
+              result->Error("bad_type", "HWND value is not a supported numeric type");
+              return;
+            }
+
+            const auto* width = std::get_if<int32_t>(&it_width->second);
+            const auto* height = std::get_if<int32_t>(&it_height->second);
+            const auto* alpha = std::get_if<std::vector<uint8_t>>(&it_alpha->second);
+            if (!width || !height || !alpha) {
+              result->Error("bad_type", "'width' and 'height' must be ints and 'alpha' a Uint8List");
+              return;
+            }
+
+            int32_t threshold = 128;
+            auto it_threshold = args->find(flutter::EncodableValue("threshold"));
+            if (it_threshold != args->end() && std::holds_alternative<int32_t>(it_threshold->second)) {
+              threshold = (std::min)((std::max)(std::get<int32_t>(it_threshold->second), 0), 255);
+            }
+
+            HWND hwnd = reinterpret_cast<HWND>(static_cast<intptr_t>(hwnd_val));
+
+            if (!win32::IsWindow(hwnd)) {
+              result->Error("invalid_hwnd", "Invalid window handle");
+              return;
+            }
+
+            if (*width <= 0 || *height <= 0 || alpha->empty()) {
+              g_flutter_hit_test_masks.erase(hwnd);
+              result->Success(flutter::EncodableValue(true));
+              return;
+            }
+            if (alpha->size() < static_cast<size_t>(*width) * static_cast<size_t>(*height)) {
+              result->Error("bad_args", "'alpha' is smaller than width * height");
+              return;
+            }
+
+            // The top-level window answers WM_NCHITTEST through the subclass
+            if (!setupWindowInterception(hwnd)) {
+              result->Error("subclass_failed", "Failed to set up window subclassing");
+              return;
+            }
+
+            g_flutter_hit_test_masks[hwnd].Build(alpha->data(), *width, *height, static_cast<uint8_t>(threshold));
+
+            // The Flutter view covers the client area and is hit-tested first
+            if (g_flutter_masked_views.find(hwnd) == g_flutter_masked_views.end()) {
+              HWND view = win32::FindWindowExW(hwnd, nullptr, L"FLUTTERVIEW", nullptr);
+              if (view && win32::SetWindowSubclass(view, FlutterViewMaskSubclassProc, 1, reinterpret_cast<DWORD_PTR>(hwnd))) {
+                g_flutter_masked_views[hwnd] = view;
+              }
+            }
+
+            result->Success(flutter::EncodableValue(true));
+            return;
+          } catch (const std::exception& e) {
+            std::cerr << "Exception in setHitTestMask: " << e.what() << std::endl;
+            result->Error("exception", std::string("Exception: ") + e.what());
+            return;
+          } catch (...) {
+            std::cerr << "Unknown exception in setHitTestMask" << std::endl;
+            result->Error("exception", "Unknown exception occurred");
+            return;
+          }
+        }
+
+        // ========================================================================
+        // execute: Run a batch of window commands in one call
+        // ========================================================================
+        // 'commands' is an ordered list of maps {op, hwnd | target | ref, ...}.
+        // The ops are getWindowHandleForViewId {viewId}, setupWindowInterception,
+        // toggleTitleBar, setTitleBarStyle {titleBarStyle}, toggleFrameless,
+        // setFrameless {frameless} and setTransparentBackground {transparent},
+        // with the arguments of the methods of the same name. 'ref' names the
+        // window returned by an earlier command of the batch, by index.
+        // All commands run in this one platform thread turn; mode changes are
+        // applied once per window after the last command (RunBatchCommand).
+        // Returns one result per command: its value, or {error, message}.
+        // A failed command does not stop the ones after it.
+        // ========================================================================
+        if (method == "execute") {
+          const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+          if (!args) {
+            result->Error("bad_args", "Expected map with 'commands'");
+            return;
+          }
+          auto it_commands = args->find(flutter::EncodableValue("commands"));
+          const auto* commands = it_commands == args->end()
+              ? nullptr
+              : std::get_if<flutter::EncodableList>(&it_commands->second);
+          if (!commands) {
+            result->Error("bad_args", "Missing 'commands'");
+            return;
+          }
+
+          try {
+            FlutterDesktopPluginRegistrarRef desktop_registrar =
+                reinterpret_cast<FlutterDesktopPluginRegistrarRef>(engine->GetRegistrarForPlugin("dummy_plugin"));
+            flutter::EncodableList results;
+            results.reserve(commands->size());
+            std::map<HWND, PendingWindowMode> pending_modes;
+            for (size_t i = 0; i < commands->size(); ++i) {
+              const auto* command = std::get_if<flutter::EncodableMap>(&(*commands)[i]);
+              results.push_back(command
+                  ? RunBatchCommand(desktop_registrar, *command, i, results, &pending_modes)
+                  : BatchError("bad_args", "Command is not a map"));
+            }
+
+            // The single deferred refresh: one mode transition per window
+            for (const auto& pending : pending_modes) {
+              HWND hwnd = pending.first;
+              if (pending.second.mode == CurrentWindowMode(hwnd) ||
+                  ApplyWindowMode(hwnd, pending.second.mode)) {
+                continue;
+              }
+              std::cerr << "Failed to apply batched window mode for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
+              for (size_t index : pending.second.commands) {
+                results[index] = BatchError("mode_failed", "Failed to apply the window mode");
+              }
+            }
+
+            result->Success(flutter::EncodableValue(std::move(results)));
+            return;
+          } catch (const std::exception& e) {
+            std::cerr << "Exception in execute: " << e.what() << std::endl;
+            result->Error("exception", std::string("Exception: ") + e.what());
+            return;
+          } catch (...) {
+            std::cerr << "Unknown exception in execute" << std::endl;
+            result->Error("exception", "Unknown exception occurred");
+            return;
+          }
+        }
+
+        // ========================================================================
+        // getSessionWindowState: Mode flags a window was restored with
+        // ========================================================================
+        // Returns the frameless, hidden title bar and transparent flags saved
+        // for this window in the previous session, or null when it was not
+        // restored, so Dart can re-apply the modes in one call.
+        // ========================================================================
+        if (method == "getSessionWindowState") {
+          const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+          if (!args) {
+            result->Error("bad_args", "Expected map with 'hwnd'");
+            return;
+          }
+          auto it_hwnd = args->find(flutter::EncodableValue("hwnd"));
+          if (it_hwnd == args->end()) {
+            result->Error("bad_args", "Missing 'hwnd'");
+            return;
+          }
+
+          // Handle type conversion from Dart
+          int64_t hwnd_val = 0;
+          auto& hwnd_value = it_hwnd->second;
+
+          if (std::holds_alternative<int64_t>(hwnd_value)) {
+            hwnd_val = std::get<int64_t>(hwnd_value);
+          } else if (std::holds_alternative<int32_t>(hwnd_value)) {
+            hwnd_val = static_cast<int64_t>(std::get<int32_t>(hwnd_value));
+          } else if (std::holds_alternative<double>(hwnd_value)) {
+            hwnd_val = static_cast<int64_t>(std::get<double>(hwnd_value));
+          } else {
+            result->Error("bad_type", "HWND value is not a supported numeric type");
+            return;
+          }
+
+          HWND hwnd = reinterpret_cast<HWND>(static_cast<intptr_t>(hwnd_val));
+          auto slotIt = g_session_window_slots.find(hwnd);
+          SessionStore::WindowRecord record;
+          if (slotIt == g_session_window_slots.end() ||
+              !g_session_store.PreviousRecord(slotIt->second, &record)) {
+            result->Success();
+            return;
+          }
+
+          flutter::EncodableMap state;
+          state[flutter::EncodableValue("frameless")] =
+              flutter::EncodableValue((record.flags & SessionStore::kFrameless) != 0);
+          state[flutter::EncodableValue("hiddenTitleBar")] =
+              flutter::EncodableValue((record.flags & SessionStore::kHiddenTitleBar) != 0);
+          state[flutter::EncodableValue("transparent")] =
+              flutter::EncodableValue((record.flags & SessionStore::kTransparent) != 0);
+          state[flutter::EncodableValue("maximized")] =
+              flutter::EncodableValue((record.flags & SessionStore::kMaximized) != 0);
+          state[flutter::EncodableValue("fullscreen")] =
+              flutter::EncodableValue((record.flags & SessionStore::kFullscreen) != 0);
+          result->Success(flutter::EncodableValue(state));
+          return;
+        }
+
+        // ========================================================================
+        // getCompositionStats: Get composition engine call counters
+        // ========================================================================
+        // Returns {accentIssued, accentSkipped, marginsIssued, marginsSkipped,
+        // attributesIssued, attributesSkipped}: how many
+        // SetWindowCompositionAttribute, DwmExtendFrameIntoClientArea and
+        // DwmSetWindowAttribute calls the runner made, and how many were skipped
+        // because the value was already in effect.
+        // ========================================================================
+        if (method == "getCompositionStats") {
+          const CompositionEngine::Counters& counters = CompositionEngine::counters();
+          flutter::EncodableMap stats;
+          stats[flutter::EncodableValue("accentIssued")] = flutter::EncodableValue(static_cast<int64_t>(counters.accent_issued));
+          stats[flutter::EncodableValue("accentSkipped")] = flutter::EncodableValue(static_cast<int64_t>(counters.accent_skipped));
+          stats[flutter::EncodableValue("marginsIssued")] = flutter::EncodableValue(static_cast<int64_t>(counters.margins_issued));
+          stats[flutter::EncodableValue("marginsSkipped")] = flutter::EncodableValue(static_cast<int64_t>(counters.margins_skipped));
+          stats[flutter::EncodableValue("attributesIssued")] = flutter::EncodableValue(static_cast<int64_t>(counters.attributes_issued));
+          stats[flutter::EncodableValue("attributesSkipped")] = flutter::EncodableValue(static_cast<int64_t>(counters.attributes_skipped));
+          result->Success(flutter::EncodableValue(stats));
+          return;
+        }
+
+        // ========================================================================
+        // startWin32CallRecording / stopWin32CallRecording: Record window calls
+        // ========================================================================
+        // Start clears the log and records every user32/dwmapi call the runner
+        // and the plugins make through the win32:: wrappers. Stop ends the
+        // recording and returns {calls: [{api, cost, hwnd, args}], dropped}
+        // in call order; cost is "query", "state", "frame" or "message" and
+        // dropped counts calls beyond the log's capacity.
+        // ========================================================================
+        if (method == "startWin32CallRecording") {
+          Win32CallRecorder::Instance().Start();
+          result->Success();
+          return;
+        }
+
+        if (method == "stopWin32CallRecording") {
+          Win32CallRecorder& recorder = Win32CallRecorder::Instance();
+          recorder.Stop();
+          flutter::EncodableList calls;
+          calls.reserve(recorder.size());
+          for (uint32_t i = 0; i < recorder.size(); ++i) {
+            const Win32Call& call = recorder.at(i);
+            flutter::EncodableList args(std::begin(call.args), std::end(call.args));
+            flutter::EncodableMap entry;
+            entry[flutter::EncodableValue("api")] = flutter::EncodableValue(Win32CallRecorder::ApiName(call.api));
+            entry[flutter::EncodableValue("cost")] = flutter::EncodableValue(Win32CallRecorder::CostName(call.cost));
+            entry[flutter::EncodableValue("hwnd")] = flutter::EncodableValue(static_cast<int64_t>(reinterpret_cast<intptr_t>(call.hwnd)));
+            entry[flutter::EncodableValue("args")] = flutter::EncodableValue(args);
+            calls.push_back(flutter::EncodableValue(entry));
+          }
+          flutter::EncodableMap log;
+          log[flutter::EncodableValue("calls")] = flutter::EncodableValue(calls);
+          log[flutter::EncodableValue("dropped")] = flutter::EncodableValue(static_cast<int64_t>(recorder.dropped()));
+          result->Success(flutter::EncodableValue(log));
+          return;
+        }
+
+        // ========================================================================
+        // getStartupProfile: Get the startup phase timings
+        // ========================================================================
+        // Returns {phases: [{name, startUs, durationUs}], preMainUs,
+        // firstWindowShownUs, report}. Times are microseconds from the start of
+        // wWinMain; preMainUs is the time from process creation to wWinMain and
+        // firstWindowShownUs is null until a window has been shown.
+        // ========================================================================
+        if (method == "getStartupProfile") {
+          flutter::EncodableList phases;
+          for (const StartupProfiler::Phase& phase : profiler.phases()) {
+            flutter::EncodableMap entry;
+            entry[flutter::EncodableValue("name")] = flutter::EncodableValue(phase.name);
+            entry[flutter::EncodableValue("startUs")] = flutter::EncodableValue(phase.start_us);
+            entry[flutter::EncodableValue("durationUs")] = flutter::EncodableValue(phase.duration_us);
+            phases.push_back(flutter::EncodableValue(entry));
+          }
+          flutter::EncodableMap profile;
+          profile[flutter::EncodableValue("phases")] = flutter::EncodableValue(phases);
+          profile[flutter::EncodableValue("preMainUs")] = flutter::EncodableValue(profiler.pre_main_us());
+          profile[flutter::EncodableValue("firstWindowShownUs")] =
+              profiler.first_window_shown_us() >= 0
+                  ? flutter::EncodableValue(profiler.first_window_shown_us())
+                  : flutter::EncodableValue();
+          profile[flutter::EncodableValue("report")] = flutter::EncodableValue(profiler.Report());
+          result->Success(flutter::EncodableValue(profile));
+          return;
+        }
+
         // ========================================================================
         // isWindowCreationHookActive: Check if CBT hook is active
         // ========================================================================
@@ -1656,54 +2658,107 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
         result->NotImplemented();
       });
 
-  // Get Flutter window handles
-  auto flutter_handles = GetFlutterWindowHandles(engine.get());
-  std::cout << "Found " << flutter_handles.size() << " Flutter window(s):" << std::endl;
-  for (size_t i = 0; i < flutter_handles.size(); ++i) {
-    std::cout << "Flutter Window " << i + 1 << " Handle: 0x" << std::hex << flutter_handles[i] << std::endl;
-  }
+  // Report the startup profile once the first window is on screen. Set
+  // MULTIPLE_WINDOWS_STARTUP_TRACE to a file path to also write a trace.
+  //
+  // Window enumeration diagnostics are opt-in (MULTIPLE_WINDOWS_STARTUP_DIAGNOSTICS)
+  // and run only after the first window is shown. The system-wide EnumWindows
+  // runs on a background thread, since it scales with the number of top-level
+  // windows on the machine.
+  bool startup_diagnostics =
+      ::GetEnvironmentVariableW(L"MULTIPLE_WINDOWS_STARTUP_DIAGNOSTICS", nullptr, 0) > 0;
+  profiler.set_on_first_window_shown([&profiler, &engine, startup_diagnostics]() {
+    std::cout << "Startup profile:\n" << profiler.Report() << std::flush;
+    wchar_t trace_path[MAX_PATH];
+    DWORD length = ::GetEnvironmentVariableW(L"MULTIPLE_WINDOWS_STARTUP_TRACE",
+                                             trace_path, MAX_PATH);
+    if (length > 0 && length < MAX_PATH) {
+      if (!profiler.WriteTrace(trace_path)) {
+        std::cerr << "Failed to write startup trace" << std::endl;
+      }
+    }
 
-  // Get all window handles in the system
-  auto all_handles = GetAllWindowHandles();
-  std::cout << "Total windows in system: " << all_handles.size() << std::endl;
+    if (!startup_diagnostics) {
+      return;
+    }
+    // The engine API is only usable from the platform thread.
+    auto flutter_handles = GetFlutterWindowHandles(engine.get());
+    std::thread([flutter_handles]() {
+      std::cout << "Found " << flutter_handles.size() << " Flutter window(s):" << std::endl;
+      for (size_t i = 0; i < flutter_handles.size(); ++i) {
+        std::cout << "Flutter Window " << i + 1 << " Handle: 0x" << std::hex << flutter_handles[i] << std::dec << std::endl;
+      }
+      auto all_handles = GetAllWindowHandles();
+      std::cout << "Total windows in system: " << all_handles.size() << std::endl;
+    }).detach();
+  });
+  profiler.Mark("message_loop");
 
   ::MSG msg;
-  while (::GetMessage(&msg, nullptr, 0, 0)) {
-    ::TranslateMessage(&msg);
-    ::DispatchMessage(&msg);
+  bool first_message = true;
+  while (win32::GetMessage(&msg, nullptr, 0, 0)) {
+    if (first_message) {
+      profiler.Mark("first_message");
+      first_message = false;
+    }
+    win32::TranslateMessage(&msg);
+    win32::DispatchMessage(&msg);
   }
+  runner_registrar->UnregisterTopLevelWindowProcDelegate(window_proc_id);
+  WindowEvents::Instance().Detach();
 
   // Clean up window subclassing for all tracked windows
   for (auto& pair : g_original_window_procedures) {
     HWND hwnd = pair.first;
-    if (::IsWindow(hwnd)) {
+    if (win32::IsWindow(hwnd)) {
       // Remove our subclass and restore original window procedure
-      RemoveWindowSubclass(hwnd, FlutterWindowSubclassProc, 1);
+      win32::RemoveWindowSubclass(hwnd, FlutterWindowSubclassProc, 1);
       std::cout << "Cleaned up subclassing for hwnd: 0x" << std::hex << hwnd << std::dec << std::endl;
     }
   }
 
+  // Persist the final layout of the windows that are still open
+  for (auto& pair : g_session_window_slots) {
+    if (win32::IsWindow(pair.first)) {
+      RecordSessionWindow(pair.first);
+    }
+  }
+  g_session_store.Close();
+
+  // Remove the hit-test mask subclass from Flutter views
+  for (auto& pair : g_flutter_masked_views) {
+    if (win32::IsWindow(pair.second)) {
+      win32::RemoveWindowSubclass(pair.second, FlutterViewMaskSubclassProc, 1);
+    }
+  }
+
   // Clear the tracking maps
   g_flutter_hidden_title_bar_windows.clear();
   g_original_window_procedures.clear();
+  g_flutter_window_frame_states.clear();
+  g_flutter_hit_test_masks.clear();
+  g_flutter_masked_views.clear();
+  g_window_titles.clear();
+  g_session_window_slots.clear();
+  g_session_pending_maximize.clear();
 
   // Kill any pending auto-setup timers (only if a message window was created).
   if (g_message_window) {
     for (const auto& pair : g_pending_autosetup_windows) {
-      KillTimer(g_message_window, pair.first);
+      win32::KillTimer(g_message_window, pair.first);
     }
   }
   g_pending_autosetup_windows.clear();
 
   // Destroy message window (only if we created one)
   if (g_message_window) {
-    DestroyWindow(g_message_window);
+    win32::DestroyWindow(g_message_window);
     g_message_window = nullptr;
   }
 
   // Unhook CBT hook (only if we installed one)
   if (g_cbt_hook) {
-    UnhookWindowsHookEx(g_cbt_hook);
+    win32::UnhookWindowsHookEx(g_cbt_hook);
     std::cout << "CBT hook uninstalled" << std::endl;
   }
 
@@ -0,0 +1,129 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "query_pool.h"
+
+#include <utility>
+
+#include "../../win32_calls.h"
+
+namespace {
+
+constexpr const wchar_t kWindowClassName[] = L"MultipleWindowsQueryPool";
+
+// Posted by a worker when it has finished a job.
+constexpr UINT kJobFinishedMessage = WM_APP;
+
+}  // namespace
+
+QueryPool::QueryPool(unsigned int threads) {
+  HINSTANCE instance = ::GetModuleHandleW(nullptr);
+  WNDCLASSW window_class = {};
+  window_class.lpfnWndProc = WindowProc;
+  window_class.hInstance = instance;
+  window_class.lpszClassName = kWindowClassName;
+  win32::RegisterClassW(&window_class);
+  window_ = win32::CreateWindowExW(0, kWindowClassName, L"", 0, 0, 0, 0, 0,
+                                   HWND_MESSAGE, nullptr, instance, nullptr);
+  win32::SetWindowLongPtr(window_, GWLP_USERDATA,
+                          reinterpret_cast<LONG_PTR>(this));
+
+  for (unsigned int i = 0; i < threads; ++i) {
+    workers_.emplace_back(&QueryPool::WorkerLoop, this);
+  }
+}
+
+QueryPool::~QueryPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  queued_.notify_all();
+
+  // A query reading the text of one of our windows sends WM_GETTEXT to this
+  // thread, so keep answering sent messages while the workers wind down.
+  for (std::thread& worker : workers_) {
+    HANDLE handle = reinterpret_cast<HANDLE>(worker.native_handle());
+    while (win32::MsgWaitForMultipleObjects(1, &handle, FALSE, INFINITE,
+                                            QS_SENDMESSAGE) ==
+           WAIT_OBJECT_0 + 1) {
+      MSG msg;
+      win32::PeekMessageW(&msg, nullptr, 0, 0, PM_NOREMOVE | PM_QS_SENDMESSAGE);
+    }
+    worker.join();
+  }
+
+  if (window_) {
+    win32::DestroyWindow(window_);
+  }
+}
+
+void QueryPool::Run(Query query, Result result) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_ptr<Job> job(new Job{next_sequence_++, std::move(query),
+                                     std::move(result),
+                                     flutter::EncodableValue()});
+    pending_.push_back(std::move(job));
+  }
+  queued_.notify_one();
+}
+
+// static
+LRESULT CALLBACK QueryPool::WindowProc(HWND hwnd,
+                                       UINT message,
+                                       WPARAM wparam,
+                                       LPARAM lparam) {
+  if (message == kJobFinishedMessage) {
+    QueryPool* pool = reinterpret_cast<QueryPool*>(
+        win32::GetWindowLongPtr(hwnd, GWLP_USERDATA));
+    if (pool) {
+      pool->Deliver();
+    }
+    return 0;
+  }
+  return win32::DefWindowProcW(hwnd, message, wparam, lparam);
+}
+
+void QueryPool::WorkerLoop() {
+  for (;;) {
+    std::unique_ptr<Job> job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      queued_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+      if (stopping_) {
+        return;
+      }
+      job = std::move(pending_.front());
+      pending_.pop_front();
+    }
+
+    job->value = job->query();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      uint64_t sequence = job->sequence;
+      finished_[sequence] = std::move(job);
+    }
+    win32::PostMessage(window_, kJobFinishedMessage, 0, 0);
+  }
+}
+
+void QueryPool::Deliver() {
+  for (;;) {
+    std::unique_ptr<Job> job;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = finished_.find(next_delivery_);
+      if (it == finished_.end()) {
+        return;
+      }
+      job = std::move(it->second);
+      finished_.erase(it);
+      ++next_delivery_;
+    }
+    // Outside the lock: completing may queue the next query.
+    job->result->Success(job->value);
+  }
+}
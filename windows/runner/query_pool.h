@@ -0,0 +1,79 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef RUNNER_QUERY_POOL_H_
+#define RUNNER_QUERY_POOL_H_
+
+#include <windows.h>
+
+#include <flutter/encodable_value.h>
+#include <flutter/method_result.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs read-only method channel queries (window enumeration, titles, class
+// names) on a few worker threads so the platform thread keeps handling input
+// and frames while they run.
+//
+// A query may only call thread-safe Win32 functions and touch no runner
+// state; anything it needs from the platform thread is captured by value when
+// it is queued. Its encoded result is posted back to a message-only window
+// owned by the platform thread, which completes the MethodResult there.
+// Results are completed in the order the queries were queued, whichever
+// worker finishes first.
+class QueryPool {
+ public:
+  using Query = std::function<flutter::EncodableValue()>;
+  using Result = std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>;
+
+  // Must be created on the platform thread.
+  explicit QueryPool(unsigned int threads);
+  ~QueryPool();
+
+  // Runs |query| on a worker and completes |result| with its value on the
+  // platform thread.
+  void Run(Query query, Result result);
+
+ private:
+  struct Job {
+    uint64_t sequence;
+    Query query;
+    Result result;
+    flutter::EncodableValue value;
+  };
+
+  QueryPool(QueryPool const&) = delete;
+  QueryPool& operator=(QueryPool const&) = delete;
+
+  static LRESULT CALLBACK WindowProc(HWND hwnd,
+                                     UINT message,
+                                     WPARAM wparam,
+                                     LPARAM lparam);
+
+  void WorkerLoop();
+
+  // Completes every finished job whose predecessors have been completed.
+  void Deliver();
+
+  HWND window_ = nullptr;
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable queued_;
+  bool stopping_ = false;
+  uint64_t next_sequence_ = 0;
+  uint64_t next_delivery_ = 0;
+  std::deque<std::unique_ptr<Job>> pending_;
+  std::map<uint64_t, std::unique_ptr<Job>> finished_;
+};
+
+#endif  // RUNNER_QUERY_POOL_H_
@@ -0,0 +1,154 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "session_store.h"
+
+#include <algorithm>
+
+#include "../../monitor_cache.h"
+
+namespace {
+
+constexpr uint32_t kSessionMagic = 0x4C57534D;  // 'MSWL'
+constexpr uint32_t kSessionVersion = 1;
+
+constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+}  // namespace
+
+struct SessionStore::FileLayout {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t topology_hash;
+  // One past the highest window index written.
+  uint32_t window_count;
+  uint32_t reserved;
+  WindowRecord windows[kMaxWindows];
+};
+
+SessionStore::~SessionStore() {
+  Close();
+}
+
+bool SessionStore::Open(const std::wstring& path, uint64_t topology_hash) {
+  Close();
+
+  file_ = ::CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                        FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                        FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file_ == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  // The mapping grows a new or truncated file to the full layout size.
+  mapping_ = ::CreateFileMappingW(file_, nullptr, PAGE_READWRITE, 0,
+                                  sizeof(FileLayout), nullptr);
+  if (!mapping_) {
+    Close();
+    return false;
+  }
+  view_ = static_cast<FileLayout*>(
+      ::MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(FileLayout)));
+  if (!view_) {
+    Close();
+    return false;
+  }
+
+  previous_count_ = 0;
+  if (view_->magic == kSessionMagic && view_->version == kSessionVersion &&
+      view_->topology_hash == topology_hash) {
+    previous_count_ = (std::min)(view_->window_count, kMaxWindows);
+    for (uint32_t i = 0; i < previous_count_; ++i) {
+      previous_[i] = view_->windows[i];
+    }
+  }
+
+  view_->magic = kSessionMagic;
+  view_->version = kSessionVersion;
+  view_->topology_hash = topology_hash;
+  view_->window_count = 0;
+  return true;
+}
+
+void SessionStore::Close() {
+  if (view_) {
+    ::FlushViewOfFile(view_, sizeof(FileLayout));
+    ::UnmapViewOfFile(view_);
+    view_ = nullptr;
+  }
+  if (mapping_) {
+    ::CloseHandle(mapping_);
+    mapping_ = nullptr;
+  }
+  if (file_ != INVALID_HANDLE_VALUE) {
+    ::CloseHandle(file_);
+    file_ = INVALID_HANDLE_VALUE;
+  }
+}
+
+bool SessionStore::PreviousRecord(uint32_t index, WindowRecord* record) const {
+  if (index >= previous_count_) {
+    return false;
+  }
+  const WindowRecord& previous = previous_[index];
+  if (previous.right <= previous.left || previous.bottom <= previous.top) {
+    return false;
+  }
+  *record = previous;
+  return true;
+}
+
+void SessionStore::Write(uint32_t index, const WindowRecord& record) {
+  if (!view_ || index >= kMaxWindows) {
+    return;
+  }
+  view_->windows[index] = record;
+  view_->window_count = (std::max)(view_->window_count, index + 1);
+}
+
+bool SessionStore::CurrentRecord(uint32_t index, WindowRecord* record) const {
+  if (!view_ || index >= view_->window_count) {
+    return false;
+  }
+  *record = view_->windows[index];
+  return true;
+}
+
+void SessionStore::SetTopologyHash(uint64_t topology_hash) {
+  if (view_) {
+    view_->topology_hash = topology_hash;
+  }
+}
+
+// static
+std::wstring SessionStore::DefaultPath() {
+  wchar_t buffer[MAX_PATH];
+  DWORD length = ::GetEnvironmentVariableW(L"LOCALAPPDATA", buffer, MAX_PATH);
+  if (length == 0 || length >= MAX_PATH) {
+    return std::wstring();
+  }
+  std::wstring directory = std::wstring(buffer) + L"\\multiple_windows";
+  ::CreateDirectoryW(directory.c_str(), nullptr);
+  return directory + L"\\session_layout.bin";
+}
+
+// static
+uint64_t SessionStore::TopologyHash() {
+  uint64_t hash = kFnvOffsetBasis;
+  for (const CachedMonitor& monitor : MonitorCache::Instance().Monitors()) {
+    hash = HashBytes(hash, &monitor.monitor, sizeof(monitor.monitor));
+    hash = HashBytes(hash, &monitor.dpi, sizeof(monitor.dpi));
+  }
+  return hash;
+}
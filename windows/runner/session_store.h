@@ -0,0 +1,88 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef RUNNER_SESSION_STORE_H_
+#define RUNNER_SESSION_STORE_H_
+
+#include <windows.h>
+
+#include <cstdint>
+#include <string>
+
+// Persists the layout of the app's windows across launches in a small
+// fixed-layout file that is memory-mapped for the lifetime of the process.
+//
+// Windows are identified by their creation order. Updates are plain stores
+// into the mapped view; the file is flushed at exit. On the next launch the
+// previous records are read once, when the file is opened, and used to place
+// windows as they are created, before they are shown.
+class SessionStore {
+ public:
+  static constexpr uint32_t kMaxWindows = 16;
+
+  enum Flags : uint32_t {
+    kFrameless = 1 << 0,
+    kHiddenTitleBar = 1 << 1,
+    kTransparent = 1 << 2,
+    kMaximized = 1 << 3,
+    kFullscreen = 1 << 4,
+  };
+
+  struct WindowRecord {
+    uint32_t flags;
+    uint32_t dpi;
+    // Restored (non-maximized) bounds in screen coordinates.
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+  };
+
+  SessionStore() = default;
+  ~SessionStore();
+
+  // Prevent copying.
+  SessionStore(SessionStore const&) = delete;
+  SessionStore& operator=(SessionStore const&) = delete;
+
+  // Maps the session file at |path|, creating it if needed, and keeps the
+  // records of the previous session when they were written for the same
+  // monitor topology (|topology_hash|).
+  bool Open(const std::wstring& path, uint64_t topology_hash);
+
+  // Flushes and unmaps the file.
+  void Close();
+
+  // The record of window |index| from the previous session, if any.
+  bool PreviousRecord(uint32_t index, WindowRecord* record) const;
+
+  // Stores the record of window |index| for the next session.
+  void Write(uint32_t index, const WindowRecord& record);
+
+  // The record of window |index| written in this session, if any.
+  bool CurrentRecord(uint32_t index, WindowRecord* record) const;
+
+  // Marks the records written in this session as being for |topology_hash|,
+  // after the display configuration changed.
+  void SetTopologyHash(uint64_t topology_hash);
+
+  // Default location of the session file, under %LOCALAPPDATA%.
+  static std::wstring DefaultPath();
+
+  // Hash of the monitor rects and DPIs, so a layout is only restored onto
+  // the display configuration it was saved on.
+  static uint64_t TopologyHash();
+
+ private:
+  struct FileLayout;
+
+  HANDLE file_ = INVALID_HANDLE_VALUE;
+  HANDLE mapping_ = nullptr;
+  FileLayout* view_ = nullptr;
+
+  uint32_t previous_count_ = 0;
+  WindowRecord previous_[kMaxWindows] = {};
+};
+
+#endif  // RUNNER_SESSION_STORE_H_
@@ -0,0 +1,122 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "startup_profiler.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include "../../win32_calls.h"
+
+// static
+StartupProfiler& StartupProfiler::Instance() {
+  static StartupProfiler instance;
+  return instance;
+}
+
+void StartupProfiler::Mark(const char* name) {
+  if (frequency_.QuadPart == 0) {
+    ::QueryPerformanceFrequency(&frequency_);
+    ::QueryPerformanceCounter(&origin_);
+
+    // Time spent before wWinMain (loader, CRT init), from the process creation
+    // time on the wall clock.
+    FILETIME creation, exited, kernel, user, now;
+    if (::GetProcessTimes(::GetCurrentProcess(), &creation, &exited, &kernel,
+                          &user)) {
+      ::GetSystemTimePreciseAsFileTime(&now);
+      ULARGE_INTEGER created = {{creation.dwLowDateTime,
+                                 creation.dwHighDateTime}};
+      ULARGE_INTEGER current = {{now.dwLowDateTime, now.dwHighDateTime}};
+      if (current.QuadPart >= created.QuadPart) {
+        // FILETIME is in 100ns units.
+        pre_main_us_ =
+            static_cast<int64_t>((current.QuadPart - created.QuadPart) / 10);
+      }
+    }
+  }
+
+  int64_t now_us = NowUs();
+  phases_.push_back({name, last_us_, now_us - last_us_});
+  last_us_ = now_us;
+}
+
+void StartupProfiler::WatchFirstWindowShown() {
+  if (show_hook_ || first_window_shown_us_ >= 0) {
+    return;
+  }
+  // Out-of-context events are delivered to this thread's message loop.
+  show_hook_ = win32::SetWinEventHook(
+      EVENT_OBJECT_SHOW, EVENT_OBJECT_SHOW, nullptr, OnObjectShown,
+      ::GetCurrentProcessId(), 0, WINEVENT_OUTOFCONTEXT);
+}
+
+// static
+void CALLBACK StartupProfiler::OnObjectShown(HWINEVENTHOOK hook,
+                                             DWORD event,
+                                             HWND hwnd,
+                                             LONG id_object,
+                                             LONG id_child,
+                                             DWORD event_thread,
+                                             DWORD event_time) {
+  if (id_object != OBJID_WINDOW || id_child != CHILDID_SELF || !hwnd ||
+      win32::GetAncestor(hwnd, GA_ROOT) != hwnd) {
+    return;
+  }
+  StartupProfiler& profiler = Instance();
+  if (profiler.first_window_shown_us_ >= 0) {
+    return;
+  }
+  profiler.Mark("first_window_shown");
+  profiler.first_window_shown_us_ = profiler.last_us_;
+  win32::UnhookWinEvent(profiler.show_hook_);
+  profiler.show_hook_ = nullptr;
+  if (profiler.on_first_window_shown_) {
+    profiler.on_first_window_shown_();
+  }
+}
+
+std::string StartupProfiler::Report() const {
+  std::string report;
+  char line[160];
+  if (pre_main_us_ >= 0) {
+    snprintf(line, sizeof(line), "%-32s %9.2f ms\n", "process_start_to_main",
+             pre_main_us_ / 1000.0);
+    report += line;
+  }
+  for (const Phase& phase : phases_) {
+    snprintf(line, sizeof(line), "%-32s +%9.2f ms %9.2f ms\n",
+             phase.name.c_str(), phase.start_us / 1000.0,
+             phase.duration_us / 1000.0);
+    report += line;
+  }
+  return report;
+}
+
+bool StartupProfiler::WriteTrace(const std::wstring& path) const {
+  std::ofstream out(std::filesystem::path(path),
+                    std::ios::binary | std::ios::trunc);
+  if (!out) {
+    return false;
+  }
+  // Complete ("X") events on a single track; the phase names are plain
+  // identifiers and need no JSON escaping.
+  out << "{\"traceEvents\":[";
+  bool first = true;
+  for (const Phase& phase : phases_) {
+    out << (first ? "" : ",") << "{\"name\":\"" << phase.name
+        << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << phase.start_us
+        << ",\"dur\":" << phase.duration_us << "}";
+    first = false;
+  }
+  out << "],\"displayTimeUnit\":\"ms\"}\n";
+  return out.good();
+}
+
+int64_t StartupProfiler::NowUs() const {
+  LARGE_INTEGER now;
+  ::QueryPerformanceCounter(&now);
+  return (now.QuadPart - origin_.QuadPart) * 1000000 / frequency_.QuadPart;
+}
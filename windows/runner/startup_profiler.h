@@ -0,0 +1,84 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef RUNNER_STARTUP_PROFILER_H_
+#define RUNNER_STARTUP_PROFILER_H_
+
+#include <windows.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Records monotonic (QueryPerformanceCounter) timestamps for the phases of
+// wWinMain and for the first window shown, for tracking cold-start time.
+//
+// Each Mark() ends a phase that started at the previous mark. The origin is
+// the first mark; the time the process spent before wWinMain is reported
+// separately, from the process creation time.
+class StartupProfiler {
+ public:
+  struct Phase {
+    std::string name;
+    // Microseconds since the origin.
+    int64_t start_us;
+    int64_t duration_us;
+  };
+
+  static StartupProfiler& Instance();
+
+  // Ends the current phase as |name|. The first call sets the origin.
+  void Mark(const char* name);
+
+  // Starts watching for the first top-level window of this process to be
+  // shown, which is recorded as the "first_window_shown" mark.
+  void WatchFirstWindowShown();
+
+  // Called once, right after the "first_window_shown" mark.
+  void set_on_first_window_shown(std::function<void()> callback) {
+    on_first_window_shown_ = std::move(callback);
+  }
+
+  const std::vector<Phase>& phases() const { return phases_; }
+
+  // Microseconds from process creation to the origin, or -1 if unknown.
+  int64_t pre_main_us() const { return pre_main_us_; }
+
+  // Microseconds from the origin to the first window shown, or -1.
+  int64_t first_window_shown_us() const { return first_window_shown_us_; }
+
+  // One line per phase: "name  +start_ms  duration_ms".
+  std::string Report() const;
+
+  // Writes the phases in Chrome trace event format (chrome://tracing,
+  // Perfetto).
+  bool WriteTrace(const std::wstring& path) const;
+
+ private:
+  StartupProfiler() = default;
+  StartupProfiler(StartupProfiler const&) = delete;
+  StartupProfiler& operator=(StartupProfiler const&) = delete;
+
+  static void CALLBACK OnObjectShown(HWINEVENTHOOK hook,
+                                     DWORD event,
+                                     HWND hwnd,
+                                     LONG id_object,
+                                     LONG id_child,
+                                     DWORD event_thread,
+                                     DWORD event_time);
+
+  int64_t NowUs() const;
+
+  LARGE_INTEGER frequency_ = {};
+  LARGE_INTEGER origin_ = {};
+  int64_t last_us_ = 0;
+  int64_t pre_main_us_ = -1;
+  int64_t first_window_shown_us_ = -1;
+  HWINEVENTHOOK show_hook_ = nullptr;
+  std::function<void()> on_first_window_shown_;
+  std::vector<Phase> phases_;
+};
+
+#endif  // RUNNER_STARTUP_PROFILER_H_
@@ -9,8 +9,11 @@
 #include <stdio.h>
 #include <windows.h>
 
+#include <cwchar>
 #include <iostream>
 
+#include "../../utf_transcode.h"
+
 void CreateAndAttachConsole() {
   if (::AllocConsole()) {
     FILE *unused;
@@ -49,20 +52,9 @@ std::string Utf8FromUtf16(const wchar_t* utf16_string) {
   if (utf16_string == nullptr) {
     return std::string();
   }
-  unsigned int target_length = ::WideCharToMultiByte(
-      CP_UTF8, WC_ERR_INVALID_CHARS, utf16_string,
-      -1, nullptr, 0, nullptr, nullptr)
-    -1; // remove the trailing null character
+  // Invalid input (unpaired surrogates) yields an empty string, as with
+  // WC_ERR_INVALID_CHARS.
   std::string utf8_string;
-  if (target_length == 0 || target_length > utf8_string.max_size()) {
-    return utf8_string;
-  }
-  utf8_string.resize(target_length);
-  int converted_length = ::WideCharToMultiByte(
-      CP_UTF8, WC_ERR_INVALID_CHARS, utf16_string,
-      -1, utf8_string.data(), target_length, nullptr, nullptr);
-  if (converted_length == 0) {
-    return std::string();
-  }
+  Utf16ToUtf8(utf16_string, std::wcslen(utf16_string), &utf8_string);
   return utf8_string;
 }
@@ -0,0 +1,140 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "window_events.h"
+
+#include <flutter/event_stream_handler_functions.h>
+#include <flutter/standard_method_codec.h>
+#include <flutter_windows.h>
+
+#include <utility>
+
+#include "../../win32_calls.h"
+
+namespace {
+
+int64_t HandleValue(HWND hwnd) {
+  return static_cast<int64_t>(reinterpret_cast<intptr_t>(hwnd));
+}
+
+}  // namespace
+
+// static
+WindowEvents& WindowEvents::Instance() {
+  static WindowEvents instance;
+  return instance;
+}
+
+void WindowEvents::Attach(flutter::BinaryMessenger* messenger,
+                          std::function<uint8_t(HWND)> current_mode) {
+  current_mode_ = std::move(current_mode);
+  channel_ = std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+      messenger, kChannelName, &flutter::StandardMethodCodec::GetInstance());
+  channel_->SetStreamHandler(
+      std::make_unique<
+          flutter::StreamHandlerFunctions<flutter::EncodableValue>>(
+          [this](const flutter::EncodableValue* /* arguments */,
+                 std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>&&
+                     events)
+              -> std::unique_ptr<
+                  flutter::StreamHandlerError<flutter::EncodableValue>> {
+            sink_ = std::move(events);
+            // The listener starts from the windows that exist now.
+            for (const auto& entry : windows_) {
+              SendCreated(entry.first, entry.second.mode);
+            }
+            return nullptr;
+          },
+          [this](const flutter::EncodableValue* /* arguments */)
+              -> std::unique_ptr<
+                  flutter::StreamHandlerError<flutter::EncodableValue>> {
+            sink_.reset();
+            return nullptr;
+          }));
+}
+
+void WindowEvents::Detach() {
+  sink_.reset();
+  channel_.reset();
+  current_mode_ = nullptr;
+}
+
+void WindowEvents::WindowCreated(HWND hwnd) {
+  uint8_t mode = current_mode_ ? current_mode_(hwnd) : 0;
+  windows_[hwnd] = {mode};
+  SendCreated(hwnd, mode);
+}
+
+void WindowEvents::WindowShown(HWND hwnd, bool shown) {
+  if (windows_.count(hwnd)) {
+    Send(shown ? "shown" : "hidden", hwnd);
+  }
+}
+
+void WindowEvents::WindowDestroyed(HWND hwnd) {
+  if (windows_.erase(hwnd)) {
+    Send("destroyed", hwnd);
+  }
+}
+
+void WindowEvents::WindowActivated(HWND hwnd, bool active) {
+  if (windows_.count(hwnd)) {
+    flutter::EncodableMap fields;
+    fields[flutter::EncodableValue("active")] = flutter::EncodableValue(active);
+    Send("focused", hwnd, std::move(fields));
+  }
+}
+
+void WindowEvents::WindowDpiChanged(HWND hwnd, UINT dpi) {
+  if (windows_.count(hwnd)) {
+    flutter::EncodableMap fields;
+    fields[flutter::EncodableValue("dpi")] =
+        flutter::EncodableValue(static_cast<int32_t>(dpi));
+    Send("dpiChanged", hwnd, std::move(fields));
+  }
+}
+
+void WindowEvents::WindowModeMaybeChanged(HWND hwnd) {
+  auto it = windows_.find(hwnd);
+  if (it == windows_.end() || !current_mode_) {
+    return;
+  }
+  uint8_t mode = current_mode_(hwnd);
+  if (mode == it->second.mode) {
+    return;
+  }
+  it->second.mode = mode;
+  flutter::EncodableMap fields;
+  fields[flutter::EncodableValue("mode")] =
+      flutter::EncodableValue(static_cast<int32_t>(mode));
+  Send("modeChanged", hwnd, std::move(fields));
+}
+
+void WindowEvents::SendCreated(HWND hwnd, uint8_t mode) {
+  flutter::EncodableMap fields;
+  fields[flutter::EncodableValue("visible")] =
+      flutter::EncodableValue(win32::IsWindowVisible(hwnd) != FALSE);
+  fields[flutter::EncodableValue("focused")] =
+      flutter::EncodableValue(win32::GetActiveWindow() == hwnd);
+  fields[flutter::EncodableValue("mode")] =
+      flutter::EncodableValue(static_cast<int32_t>(mode));
+  fields[flutter::EncodableValue("dpi")] =
+      flutter::EncodableValue(
+          static_cast<int32_t>(FlutterDesktopGetDpiForHWND(hwnd)));
+  Send("created", hwnd, std::move(fields));
+}
+
+void WindowEvents::Send(const char* type,
+                        HWND hwnd,
+                        flutter::EncodableMap fields) {
+  int64_t sequence = ++sequence_;
+  if (!sink_) {
+    return;
+  }
+  fields[flutter::EncodableValue("seq")] = flutter::EncodableValue(sequence);
+  fields[flutter::EncodableValue("type")] = flutter::EncodableValue(type);
+  fields[flutter::EncodableValue("hwnd")] =
+      flutter::EncodableValue(HandleValue(hwnd));
+  sink_->Success(flutter::EncodableValue(std::move(fields)));
+}
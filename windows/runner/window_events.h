@@ -0,0 +1,81 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef RUNNER_WINDOW_EVENTS_H_
+#define RUNNER_WINDOW_EVENTS_H_
+
+#include <windows.h>
+
+#include <flutter/binary_messenger.h>
+#include <flutter/encodable_value.h>
+#include <flutter/event_channel.h>
+#include <flutter/event_sink.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+
+// Pushes lifecycle events of the app's windows to Dart over an EventChannel,
+// so the Dart side can mirror them instead of polling.
+//
+// Every event is a map {seq, type, hwnd, ...}. seq increases by one per event
+// for the life of the process. type is one of:
+//   created      {visible, focused, mode, dpi}: a window is now tracked; also
+//                sent for every tracked window when a listener attaches
+//   shown, hidden  from the SWP_SHOWWINDOW and SWP_HIDEWINDOW flags of
+//                WM_WINDOWPOSCHANGED, so every way of showing a window counts
+//   destroyed
+//   focused      {active}: activated or deactivated
+//   modeChanged  {mode}: kWindowMode* flags (window_mode.h) changed
+//   dpiChanged   {dpi}
+//
+// The app's windows are the ones the runner subclasses: the CBT hook's, or,
+// with the hook off, every top-level window the engine's window procedure
+// delegate sees. The events come from the subclass procedure and from the
+// window mode executor. Platform thread only.
+class WindowEvents {
+ public:
+  static constexpr const char* kChannelName =
+      "com.example.window_service/events";
+
+  static WindowEvents& Instance();
+
+  // Registers the event channel. |current_mode| returns the window mode of a
+  // window as the runner tracks it.
+  void Attach(flutter::BinaryMessenger* messenger,
+              std::function<uint8_t(HWND)> current_mode);
+
+  // Drops the channel and the listener; call before the engine goes away.
+  void Detach();
+
+  void WindowCreated(HWND hwnd);
+  void WindowShown(HWND hwnd, bool shown);
+  void WindowDestroyed(HWND hwnd);
+  void WindowActivated(HWND hwnd, bool active);
+  void WindowDpiChanged(HWND hwnd, UINT dpi);
+
+  // Sends modeChanged if the mode differs from the last one sent.
+  void WindowModeMaybeChanged(HWND hwnd);
+
+ private:
+  struct Tracked {
+    uint8_t mode;
+  };
+
+  WindowEvents() = default;
+  WindowEvents(WindowEvents const&) = delete;
+  WindowEvents& operator=(WindowEvents const&) = delete;
+
+  void SendCreated(HWND hwnd, uint8_t mode);
+  void Send(const char* type, HWND hwnd, flutter::EncodableMap fields = {});
+
+  std::unique_ptr<flutter::EventChannel<flutter::EncodableValue>> channel_;
+  std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> sink_;
+  std::function<uint8_t(HWND)> current_mode_;
+  std::map<HWND, Tracked> windows_;
+  int64_t sequence_ = 0;
+};
+
+#endif  // RUNNER_WINDOW_EVENTS_H_
@@ -0,0 +1,81 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef RUNNER_WINDOW_FFI_H_
+#define RUNNER_WINDOW_FFI_H_
+
+#include <windows.h>
+
+#include <cstdint>
+
+// C ABI the runner exports for dart:ffi, so the hot window queries are plain
+// synchronous calls instead of a MethodChannel round trip with map encoding.
+// lib/app/window_ffi.dart binds them with DynamicLibrary.executable().
+//
+// Windows are passed as the int64 HWND values the channel uses. Results are
+// plain structs returned by value, so Dart needs no allocator. The layouts
+// and signatures are stable: change them only together with
+// kMultipleWindowsFfiVersion and the Dart bindings.
+//
+// Every export is safe to call from any thread. The mode flags are read from
+// the state mirror (window_state_mirror.h), which the platform thread writes
+// under a sequence lock, never from the runner's own per-window maps.
+// Everything else reads the window directly.
+
+class WindowStateMirror;
+
+#define MULTIPLE_WINDOWS_FFI_EXPORT extern "C" __declspec(dllexport)
+
+constexpr int32_t kMultipleWindowsFfiVersion = 1;
+
+// Outer bounds of a window in physical pixels, as GetWindowRect().
+struct MultipleWindowsBounds {
+  // 0 when the handle is not a window; the other fields are then 0.
+  int32_t valid;
+  int32_t x;
+  int32_t y;
+  int32_t width;
+  int32_t height;
+};
+
+// Everything the single queries return, read in one call.
+struct MultipleWindowsWindowState {
+  int32_t valid;
+  int32_t x;
+  int32_t y;
+  int32_t width;
+  int32_t height;
+  // The foreground window.
+  int32_t focused;
+  int32_t maximized;
+  int32_t minimized;
+  int32_t visible;
+  // kWindowMode* flags (window_mode.h), including kWindowModeMaximized.
+  int32_t mode;
+};
+
+MULTIPLE_WINDOWS_FFI_EXPORT int32_t __cdecl MultipleWindowsFfiVersion();
+
+MULTIPLE_WINDOWS_FFI_EXPORT MultipleWindowsBounds __cdecl
+MultipleWindowsGetBounds(int64_t hwnd);
+
+// 1 or 0; 0 also for handles that are not windows.
+MULTIPLE_WINDOWS_FFI_EXPORT int32_t __cdecl MultipleWindowsIsFocused(
+    int64_t hwnd);
+MULTIPLE_WINDOWS_FFI_EXPORT int32_t __cdecl MultipleWindowsIsMaximized(
+    int64_t hwnd);
+
+// The window mode flags, or -1 when the handle is not a window.
+MULTIPLE_WINDOWS_FFI_EXPORT int32_t __cdecl MultipleWindowsGetWindowMode(
+    int64_t hwnd);
+
+MULTIPLE_WINDOWS_FFI_EXPORT MultipleWindowsWindowState __cdecl
+MultipleWindowsGetWindowState(int64_t hwnd);
+
+// The per-window state mirror (window_state_mirror.h). The address is fixed
+// for the life of the process; map it once and read it without calls.
+MULTIPLE_WINDOWS_FFI_EXPORT const WindowStateMirror* __cdecl
+MultipleWindowsGetStateMirror();
+
+#endif  // RUNNER_WINDOW_FFI_H_
@@ -0,0 +1,100 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "window_filter.h"
+
+#include <dwmapi.h>
+
+#include <string_view>
+#include <utility>
+
+#include "../../win32_calls.h"
+
+namespace {
+
+// Longest title or class name compared, in UTF-16 code units.
+constexpr int kMaxTextLength = 512;
+
+struct Enumeration {
+  const WindowFilter* filter;
+  // |filter->title_substring|, lower-cased once for the whole enumeration.
+  std::wstring title_needle;
+  std::vector<HWND> handles;
+};
+
+bool StateMatches(WindowFilter::State wanted, bool actual) {
+  return wanted == WindowFilter::State::kAny ||
+         (wanted == WindowFilter::State::kYes) == actual;
+}
+
+void LowerCase(wchar_t* text, int length) {
+  if (length > 0) {
+    win32::CharLowerBuffW(text, static_cast<DWORD>(length));
+  }
+}
+
+bool Matches(HWND hwnd, const Enumeration& enumeration) {
+  const WindowFilter& filter = *enumeration.filter;
+  if (filter.has_pid) {
+    DWORD pid = 0;
+    win32::GetWindowThreadProcessId(hwnd, &pid);
+    if (pid != filter.pid) {
+      return false;
+    }
+  }
+  if (!StateMatches(filter.visible, win32::IsWindowVisible(hwnd) != FALSE) ||
+      !StateMatches(filter.minimized, win32::IsIconic(hwnd) != FALSE) ||
+      !StateMatches(filter.owned,
+                    win32::GetWindow(hwnd, GW_OWNER) != nullptr)) {
+    return false;
+  }
+  if (filter.cloaked != WindowFilter::State::kAny) {
+    DWORD cloaked = 0;
+    if (FAILED(win32::DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked,
+                                            sizeof(cloaked)))) {
+      cloaked = 0;
+    }
+    if (!StateMatches(filter.cloaked, cloaked != 0)) {
+      return false;
+    }
+  }
+
+  wchar_t text[kMaxTextLength];
+  if (!filter.class_prefix.empty()) {
+    int length = win32::GetClassNameW(hwnd, text, kMaxTextLength);
+    if (static_cast<size_t>(length) < filter.class_prefix.size() ||
+        filter.class_prefix.compare(0, filter.class_prefix.size(), text,
+                                    filter.class_prefix.size()) != 0) {
+      return false;
+    }
+  }
+  if (!enumeration.title_needle.empty()) {
+    int length = win32::GetWindowTextW(hwnd, text, kMaxTextLength);
+    LowerCase(text, length);
+    if (std::wstring_view(text, static_cast<size_t>(length))
+            .find(enumeration.title_needle) == std::wstring_view::npos) {
+      return false;
+    }
+  }
+  return true;
+}
+
+BOOL CALLBACK EnumerateWindowsProc(HWND hwnd, LPARAM lparam) {
+  Enumeration* enumeration = reinterpret_cast<Enumeration*>(lparam);
+  if (Matches(hwnd, *enumeration)) {
+    enumeration->handles.push_back(hwnd);
+  }
+  return TRUE;
+}
+
+}  // namespace
+
+std::vector<HWND> EnumerateWindows(const WindowFilter& filter) {
+  Enumeration enumeration = {&filter, filter.title_substring, {}};
+  LowerCase(&enumeration.title_needle[0],
+            static_cast<int>(enumeration.title_needle.size()));
+  win32::EnumWindows(EnumerateWindowsProc,
+                     reinterpret_cast<LPARAM>(&enumeration));
+  return std::move(enumeration.handles);
+}
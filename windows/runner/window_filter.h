@@ -0,0 +1,40 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef RUNNER_WINDOW_FILTER_H_
+#define RUNNER_WINDOW_FILTER_H_
+
+#include <windows.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Predicates on top-level windows, evaluated during EnumWindows so that only
+// the matching handles are collected and sent to Dart.
+//
+// Each predicate is optional; a window matches when all the set ones hold.
+// They are checked cheapest first, so the class name and title are only read
+// for windows that passed the rest.
+struct WindowFilter {
+  enum class State : uint8_t { kAny, kYes, kNo };
+
+  bool has_pid = false;
+  DWORD pid = 0;
+  State visible = State::kAny;
+  State minimized = State::kAny;
+  // Owned by another window (GW_OWNER).
+  State owned = State::kAny;
+  // Hidden by DWM (DWMWA_CLOAKED), e.g. on another virtual desktop.
+  State cloaked = State::kAny;
+  // Case-sensitive prefix of the window class name.
+  std::wstring class_prefix;
+  // Case-insensitive substring of the window title.
+  std::wstring title_substring;
+};
+
+// Top-level windows in Z order that match |filter|.
+std::vector<HWND> EnumerateWindows(const WindowFilter& filter);
+
+#endif  // RUNNER_WINDOW_FILTER_H_
@@ -0,0 +1,280 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "window_info_batch.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <thread>
+#include <utility>
+
+#include "../../utf_transcode.h"
+#include "../../win32_calls.h"
+
+namespace {
+
+// Below this many handles per thread, splitting costs more than it saves.
+constexpr size_t kHandlesPerThread = 512;
+constexpr size_t kMaxThreads = 4;
+
+// Scratch text per slice before the arena falls back to the heap; a few
+// hundred typical titles and class names.
+constexpr size_t kSliceArenaBytes = 64 * 1024;
+constexpr size_t kEmptyArenaBytes = 64;
+
+// Longest title or class name read, in UTF-16 code units.
+constexpr int kMaxTextLength = 512;
+
+const struct {
+  const char* name;
+  uint32_t field;
+} kFieldNames[] = {
+    {"title", kWindowInfoTitle},   {"class", kWindowInfoClass},
+    {"rect", kWindowInfoRect},     {"style", kWindowInfoStyle},
+    {"pid", kWindowInfoPid},       {"visible", kWindowInfoVisible},
+    {"owner", kWindowInfoOwner},
+};
+
+// Fixed-width columns, written in place by every slice at its own indices.
+struct Columns {
+  std::vector<uint8_t> valid;
+  std::vector<int32_t> rect;
+  std::vector<int32_t> style;
+  std::vector<int32_t> ex_style;
+  std::vector<int32_t> pid;
+  std::vector<uint8_t> visible;
+  std::vector<int64_t> owner;
+};
+
+// Variable-width text of one slice of the handles, merged into the reply
+// once all slices are done. End offsets are relative to the slice.
+struct Slice {
+  Slice(void* buffer, size_t size)
+      : arena(buffer, size),
+        titles(&arena),
+        title_ends(&arena),
+        classes(&arena),
+        class_ends(&arena) {}
+
+  std::pmr::monotonic_buffer_resource arena;
+  std::pmr::vector<char> titles;
+  std::pmr::vector<int32_t> title_ends;
+  std::pmr::vector<char> classes;
+  std::pmr::vector<int32_t> class_ends;
+};
+
+void AppendText(const wchar_t* text,
+                int length,
+                std::string* scratch,
+                std::pmr::vector<char>* out,
+                std::pmr::vector<int32_t>* ends) {
+  if (length > 0 &&
+      Utf16ToUtf8(text, static_cast<size_t>(length), scratch)) {
+    out->insert(out->end(), scratch->begin(), scratch->end());
+  }
+  ends->push_back(static_cast<int32_t>(out->size()));
+}
+
+void CollectSlice(const std::vector<HWND>& hwnds,
+                  size_t begin,
+                  size_t end,
+                  uint32_t fields,
+                  const std::unordered_map<HWND, std::string>& cached_titles,
+                  Columns* columns,
+                  Slice* slice) {
+  // Reused for every conversion in the slice.
+  std::string scratch;
+  scratch.reserve(kMaxTextLength * 3);
+  wchar_t text[kMaxTextLength];
+
+  for (size_t i = begin; i < end; ++i) {
+    HWND hwnd = hwnds[i];
+    bool valid = win32::IsWindow(hwnd) != FALSE;
+    columns->valid[i] = valid;
+
+    if (fields & kWindowInfoTitle) {
+      auto cached = cached_titles.find(hwnd);
+      if (cached != cached_titles.end()) {
+        slice->titles.insert(slice->titles.end(), cached->second.begin(),
+                             cached->second.end());
+        slice->title_ends.push_back(
+            static_cast<int32_t>(slice->titles.size()));
+      } else {
+        int length =
+            valid ? win32::GetWindowTextW(hwnd, text, kMaxTextLength) : 0;
+        AppendText(text, length, &scratch, &slice->titles,
+                   &slice->title_ends);
+      }
+    }
+    if (fields & kWindowInfoClass) {
+      int length = valid ? win32::GetClassNameW(hwnd, text, kMaxTextLength) : 0;
+      AppendText(text, length, &scratch, &slice->classes, &slice->class_ends);
+    }
+    if (!valid) {
+      // Fixed-width columns stay zero.
+      continue;
+    }
+    if (fields & kWindowInfoRect) {
+      RECT rect = {};
+      win32::GetWindowRect(hwnd, &rect);
+      columns->rect[i * 4] = rect.left;
+      columns->rect[i * 4 + 1] = rect.top;
+      columns->rect[i * 4 + 2] = rect.right;
+      columns->rect[i * 4 + 3] = rect.bottom;
+    }
+    if (fields & kWindowInfoStyle) {
+      columns->style[i] = win32::GetWindowLong(hwnd, GWL_STYLE);
+      columns->ex_style[i] = win32::GetWindowLong(hwnd, GWL_EXSTYLE);
+    }
+    if (fields & kWindowInfoPid) {
+      DWORD pid = 0;
+      win32::GetWindowThreadProcessId(hwnd, &pid);
+      columns->pid[i] = static_cast<int32_t>(pid);
+    }
+    if (fields & kWindowInfoVisible) {
+      columns->visible[i] = win32::IsWindowVisible(hwnd) != FALSE;
+    }
+    if (fields & kWindowInfoOwner) {
+      columns->owner[i] = static_cast<int64_t>(
+          reinterpret_cast<intptr_t>(win32::GetWindow(hwnd, GW_OWNER)));
+    }
+  }
+}
+
+// Concatenates the slices' text into one UTF-8 column and absolute offsets.
+void MergeText(const std::vector<std::unique_ptr<Slice>>& slices,
+               std::pmr::vector<char> Slice::*text,
+               std::pmr::vector<int32_t> Slice::*ends,
+               size_t count,
+               flutter::EncodableMap* reply,
+               const char* name,
+               const char* ends_name) {
+  size_t total = 0;
+  for (const auto& slice : slices) {
+    total += ((*slice).*text).size();
+  }
+  std::vector<uint8_t> merged;
+  merged.reserve(total);
+  std::vector<int32_t> merged_ends;
+  merged_ends.reserve(count);
+  for (const auto& slice : slices) {
+    int32_t base = static_cast<int32_t>(merged.size());
+    merged.insert(merged.end(), ((*slice).*text).begin(),
+                  ((*slice).*text).end());
+    for (int32_t end : (*slice).*ends) {
+      merged_ends.push_back(base + end);
+    }
+  }
+  (*reply)[flutter::EncodableValue(name)] =
+      flutter::EncodableValue(std::move(merged));
+  (*reply)[flutter::EncodableValue(ends_name)] =
+      flutter::EncodableValue(std::move(merged_ends));
+}
+
+}  // namespace
+
+bool ParseWindowInfoField(const std::string& name, uint32_t* field) {
+  for (const auto& entry : kFieldNames) {
+    if (name == entry.name) {
+      *field = entry.field;
+      return true;
+    }
+  }
+  return false;
+}
+
+flutter::EncodableValue CollectWindowInfo(
+    const std::vector<HWND>& hwnds,
+    uint32_t fields,
+    const std::unordered_map<HWND, std::string>& cached_titles) {
+  size_t count = hwnds.size();
+  Columns columns;
+  columns.valid.resize(count);
+  if (fields & kWindowInfoRect) {
+    columns.rect.resize(count * 4);
+  }
+  if (fields & kWindowInfoStyle) {
+    columns.style.resize(count);
+    columns.ex_style.resize(count);
+  }
+  if (fields & kWindowInfoPid) {
+    columns.pid.resize(count);
+  }
+  if (fields & kWindowInfoVisible) {
+    columns.visible.resize(count);
+  }
+  if (fields & kWindowInfoOwner) {
+    columns.owner.resize(count);
+  }
+
+  size_t hardware = (std::max)(std::thread::hardware_concurrency(), 1u);
+  size_t threads = (std::min)({count / kHandlesPerThread, kMaxThreads,
+                               hardware});
+  threads = (std::max)(threads, size_t{1});
+  size_t per_slice = (count + threads - 1) / threads;
+
+  // One block for all the slices' arenas, released with the reply built.
+  bool wants_text = (fields & (kWindowInfoTitle | kWindowInfoClass)) != 0;
+  size_t arena_bytes = wants_text ? kSliceArenaBytes : kEmptyArenaBytes;
+  std::unique_ptr<std::byte[]> arena_storage(
+      new std::byte[threads * arena_bytes]);
+  std::vector<std::unique_ptr<Slice>> slices;
+  slices.reserve(threads);
+  for (size_t t = 0; t < threads; ++t) {
+    slices.push_back(std::make_unique<Slice>(
+        arena_storage.get() + t * arena_bytes, arena_bytes));
+  }
+
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < threads; ++t) {
+    size_t begin = (std::min)(t * per_slice, count);
+    size_t end = (std::min)(begin + per_slice, count);
+    workers.emplace_back(CollectSlice, std::cref(hwnds), begin, end, fields,
+                         std::cref(cached_titles), &columns, slices[t].get());
+  }
+  CollectSlice(hwnds, 0, (std::min)(per_slice, count), fields, cached_titles,
+               &columns, slices[0].get());
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  flutter::EncodableMap reply;
+  reply[flutter::EncodableValue("count")] =
+      flutter::EncodableValue(static_cast<int64_t>(count));
+  reply[flutter::EncodableValue("valid")] =
+      flutter::EncodableValue(std::move(columns.valid));
+  if (fields & kWindowInfoTitle) {
+    MergeText(slices, &Slice::titles, &Slice::title_ends, count, &reply,
+              "title", "titleEnds");
+  }
+  if (fields & kWindowInfoClass) {
+    MergeText(slices, &Slice::classes, &Slice::class_ends, count, &reply,
+              "class", "classEnds");
+  }
+  if (fields & kWindowInfoRect) {
+    reply[flutter::EncodableValue("rect")] =
+        flutter::EncodableValue(std::move(columns.rect));
+  }
+  if (fields & kWindowInfoStyle) {
+    reply[flutter::EncodableValue("style")] =
+        flutter::EncodableValue(std::move(columns.style));
+    reply[flutter::EncodableValue("exStyle")] =
+        flutter::EncodableValue(std::move(columns.ex_style));
+  }
+  if (fields & kWindowInfoPid) {
+    reply[flutter::EncodableValue("pid")] =
+        flutter::EncodableValue(std::move(columns.pid));
+  }
+  if (fields & kWindowInfoVisible) {
+    reply[flutter::EncodableValue("visible")] =
+        flutter::EncodableValue(std::move(columns.visible));
+  }
+  if (fields & kWindowInfoOwner) {
+    reply[flutter::EncodableValue("owner")] =
+        flutter::EncodableValue(std::move(columns.owner));
+  }
+  return flutter::EncodableValue(std::move(reply));
+}
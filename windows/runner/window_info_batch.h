@@ -0,0 +1,59 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef RUNNER_WINDOW_INFO_BATCH_H_
+#define RUNNER_WINDOW_INFO_BATCH_H_
+
+#include <windows.h>
+
+#include <flutter/encodable_value.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Fields getWindowInfoMany can return, as bits of a field mask.
+enum WindowInfoField : uint32_t {
+  kWindowInfoTitle = 1 << 0,
+  kWindowInfoClass = 1 << 1,
+  kWindowInfoRect = 1 << 2,
+  kWindowInfoStyle = 1 << 3,
+  kWindowInfoPid = 1 << 4,
+  kWindowInfoVisible = 1 << 5,
+  kWindowInfoOwner = 1 << 6,
+};
+
+// Maps a Dart field name ("title", "class", "rect", "style", "pid",
+// "visible", "owner") to its bit. Returns false for unknown names.
+bool ParseWindowInfoField(const std::string& name, uint32_t* field);
+
+// Collects |fields| for every window in |hwnds| into one column-wise reply:
+//
+//   count       int
+//   valid       Uint8List(count)         IsWindow at collection time
+//   title       Uint8List                UTF-8 titles back to back, and
+//   titleEnds   Int32List(count)         the end offset of each
+//   class       Uint8List, classEnds     the same for class names
+//   rect        Int32List(4 * count)     left, top, right, bottom
+//   style       Int32List(count)         GWL_STYLE, and
+//   exStyle     Int32List(count)         GWL_EXSTYLE
+//   pid         Int32List(count)
+//   visible     Uint8List(count)
+//   owner       Int64List(count)         GW_OWNER, 0 if none
+//
+// Only the requested columns are present. Every column is a single
+// allocation; scratch text for each slice of the handles lives in a
+// monotonic arena that is dropped when the call returns. Large handle sets
+// are split across threads.
+//
+// Thread-safe, apart from |cached_titles|, which holds the titles of the
+// runner's own subclassed windows and must be copied from the platform
+// thread; those windows are not asked for their text again.
+flutter::EncodableValue CollectWindowInfo(
+    const std::vector<HWND>& hwnds,
+    uint32_t fields,
+    const std::unordered_map<HWND, std::string>& cached_titles);
+
+#endif  // RUNNER_WINDOW_INFO_BATCH_H_
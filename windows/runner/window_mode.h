@@ -0,0 +1,344 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef RUNNER_WINDOW_MODE_H_
+#define RUNNER_WINDOW_MODE_H_
+
+#include <windows.h>
+
+#include <dwmapi.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "../../nc_insets.h"
+
+// The custom frame modes of the runner's windows and the calls that move a
+// window from one mode to another.
+//
+// A mode is the combination of the hidden title bar, frameless and
+// transparent flags plus whether the window is maximized: sixteen modes in
+// all. kWindowModes holds what each mode ends up with (style bits, extended
+// style bits, corner preference, NC rendering policy, frame margins and
+// transparency accent) and kWindowModePlans the ordered steps for every
+// (from, to) pair. Both are built at compile time and checked by the
+// static_asserts at the end of this file, so the handlers only look up a plan
+// and run it.
+
+/// Bits of a window mode.
+enum WindowModeFlags : uint8_t {
+  kWindowModeHiddenTitleBar = 1 << 0,
+  kWindowModeFrameless = 1 << 1,
+  kWindowModeTransparent = 1 << 2,
+  kWindowModeMaximized = 1 << 3,
+};
+
+constexpr size_t kWindowModeCount = 16;
+
+/// The flags the runner tracks per window; maximized comes from the window.
+constexpr uint8_t kWindowModeTrackedFlags =
+    kWindowModeHiddenTitleBar | kWindowModeFrameless | kWindowModeTransparent;
+
+/// The only frame margins the runner uses. A window with a visible frame
+/// keeps none; a hidden title bar extends the frame into the whole client
+/// area; a transparent background only needs a one pixel extension, which
+/// also keeps the DWM shadow of a window drawing its own caption.
+constexpr MARGINS kNoFrameMargins = {0, 0, 0, 0};
+constexpr MARGINS kSheetOfGlassMargins = {-1, -1, -1, -1};
+constexpr MARGINS kTransparentMargins = {0, 0, 1, 0};
+
+/// |mode| with |flag| set or cleared.
+constexpr uint8_t WithWindowModeFlag(uint8_t mode, uint8_t flag, bool on) {
+  return static_cast<uint8_t>(on ? (mode | flag) : (mode & ~flag));
+}
+
+/// What a window in a given mode looks like.
+struct WindowModeAttributes {
+  // Tracked flags (no kWindowModeMaximized).
+  uint8_t flags;
+  // Frame mode the WM_NCCALCSIZE insets are computed for.
+  NcFrameMode frame;
+  // GWL_STYLE and GWL_EXSTYLE bits to set and to clear.
+  LONG_PTR style_set;
+  LONG_PTR style_clear;
+  LONG_PTR ex_style_set;
+  LONG_PTR ex_style_clear;
+  DWM_WINDOW_CORNER_PREFERENCE corner;
+  DWMNCRENDERINGPOLICY nc_rendering;
+  MARGINS margins;
+  // Whether the transparent gradient accent is requested.
+  bool transparent_accent;
+};
+
+/// One call of a transition plan, in execution order.
+enum class WindowModeStep : uint8_t {
+  // The accent goes first: it is the only call that can fail, and failing
+  // leaves the window in its old mode.
+  kAccent,
+  kStyle,
+  kExStyle,
+  kCornerPreference,
+  kNcRendering,
+  kMargins,
+  // Update the runner's per-window tracking and session record.
+  kTracking,
+  // RefreshNcInsets(); reads the tracking, and must precede the frame change.
+  kNcInsets,
+  // SetWindowPos(SWP_FRAMECHANGED).
+  kFrameChanged,
+  // Hide and show a maximized window so it is laid out for its new frame.
+  kReshowMaximized,
+  kCount,
+};
+
+constexpr size_t kMaxWindowModeSteps =
+    static_cast<size_t>(WindowModeStep::kCount);
+
+/// The steps that move a window from one mode to another.
+struct WindowModePlan {
+  size_t count = 0;
+  WindowModeStep steps[kMaxWindowModeSteps] = {};
+};
+
+constexpr bool SameMargins(const MARGINS& a, const MARGINS& b) {
+  return a.cxLeftWidth == b.cxLeftWidth && a.cxRightWidth == b.cxRightWidth &&
+         a.cyTopHeight == b.cyTopHeight && a.cyBottomHeight == b.cyBottomHeight;
+}
+
+constexpr WindowModeAttributes MakeWindowModeAttributes(uint8_t mode) {
+  constexpr LONG_PTR kCaptionButtons =
+      WS_SYSMENU | WS_MINIMIZEBOX | WS_MAXIMIZEBOX;
+  constexpr LONG_PTR kEdges = WS_EX_WINDOWEDGE | WS_EX_CLIENTEDGE;
+
+  const bool transparent = (mode & kWindowModeTransparent) != 0;
+  WindowModeAttributes attributes = {};
+  attributes.flags = static_cast<uint8_t>(mode & kWindowModeTrackedFlags);
+  attributes.transparent_accent = transparent;
+  if (mode & kWindowModeFrameless) {
+    // Frameless wins over a hidden title bar. Only the resize border is
+    // kept; zero margins and no NC rendering remove the shadow, also when
+    // transparent.
+    attributes.frame = NcFrameMode::kFrameless;
+    attributes.style_set = WS_THICKFRAME;
+    attributes.style_clear = WS_CAPTION | WS_BORDER | WS_DLGFRAME |
+                             kCaptionButtons;
+    attributes.ex_style_clear = kEdges | WS_EX_DLGMODALFRAME |
+                                WS_EX_STATICEDGE | WS_EX_TOOLWINDOW |
+                                WS_EX_APPWINDOW;
+    attributes.corner = DWMWCP_DONOTROUND;
+    attributes.nc_rendering = DWMNCRP_DISABLED;
+    attributes.margins = kNoFrameMargins;
+  } else if (mode & kWindowModeHiddenTitleBar) {
+    attributes.frame = NcFrameMode::kHiddenTitleBar;
+    attributes.style_set = WS_THICKFRAME | kCaptionButtons;
+    attributes.style_clear = WS_CAPTION;
+    attributes.ex_style_set = kEdges;
+    attributes.corner = DWMWCP_DEFAULT;
+    attributes.nc_rendering = DWMNCRP_ENABLED;
+    // The sheet of glass would cover a transparent background.
+    attributes.margins =
+        transparent ? kTransparentMargins : kSheetOfGlassMargins;
+  } else {
+    attributes.frame = NcFrameMode::kNormal;
+    attributes.style_set = WS_CAPTION | WS_THICKFRAME | kCaptionButtons;
+    attributes.ex_style_set = kEdges;
+    attributes.corner = DWMWCP_DEFAULT;
+    attributes.nc_rendering = DWMNCRP_ENABLED;
+    attributes.margins = transparent ? kTransparentMargins : kNoFrameMargins;
+  }
+  return attributes;
+}
+
+constexpr std::array<WindowModeAttributes, kWindowModeCount>
+MakeWindowModes() {
+  std::array<WindowModeAttributes, kWindowModeCount> modes = {};
+  for (size_t mode = 0; mode < kWindowModeCount; ++mode) {
+    modes[mode] = MakeWindowModeAttributes(static_cast<uint8_t>(mode));
+  }
+  return modes;
+}
+
+/// Target attributes of each mode, indexed by WindowModeFlags.
+constexpr std::array<WindowModeAttributes, kWindowModeCount> kWindowModes =
+    MakeWindowModes();
+
+constexpr WindowModePlan MakeWindowModePlan(uint8_t from, uint8_t to) {
+  const WindowModeAttributes& a = kWindowModes[from];
+  const WindowModeAttributes& b = kWindowModes[to];
+  WindowModePlan plan;
+  auto add = [&plan](WindowModeStep step) { plan.steps[plan.count++] = step; };
+  if (a.transparent_accent != b.transparent_accent) {
+    add(WindowModeStep::kAccent);
+  }
+  if (a.style_set != b.style_set || a.style_clear != b.style_clear) {
+    add(WindowModeStep::kStyle);
+  }
+  if (a.ex_style_set != b.ex_style_set ||
+      a.ex_style_clear != b.ex_style_clear) {
+    add(WindowModeStep::kExStyle);
+  }
+  if (a.corner != b.corner) {
+    add(WindowModeStep::kCornerPreference);
+  }
+  if (a.nc_rendering != b.nc_rendering) {
+    add(WindowModeStep::kNcRendering);
+  }
+  if (!SameMargins(a.margins, b.margins)) {
+    add(WindowModeStep::kMargins);
+  }
+  if (a.flags != b.flags) {
+    add(WindowModeStep::kTracking);
+  }
+  if (a.frame != b.frame) {
+    add(WindowModeStep::kNcInsets);
+  }
+  if (plan.count > 0) {
+    add(WindowModeStep::kFrameChanged);
+  }
+  if (a.frame != b.frame && (to & kWindowModeMaximized)) {
+    add(WindowModeStep::kReshowMaximized);
+  }
+  return plan;
+}
+
+constexpr std::array<WindowModePlan, kWindowModeCount * kWindowModeCount>
+MakeWindowModePlans() {
+  std::array<WindowModePlan, kWindowModeCount * kWindowModeCount> plans = {};
+  for (size_t from = 0; from < kWindowModeCount; ++from) {
+    for (size_t to = 0; to < kWindowModeCount; ++to) {
+      plans[from * kWindowModeCount + to] = MakeWindowModePlan(
+          static_cast<uint8_t>(from), static_cast<uint8_t>(to));
+    }
+  }
+  return plans;
+}
+
+/// Transition plans, indexed by from * kWindowModeCount + to.
+constexpr std::array<WindowModePlan, kWindowModeCount * kWindowModeCount>
+    kWindowModePlans = MakeWindowModePlans();
+
+/// The plan that moves a window from mode |from| to mode |to|.
+constexpr const WindowModePlan& WindowModePlanFor(uint8_t from, uint8_t to) {
+  return kWindowModePlans[static_cast<size_t>(from) * kWindowModeCount + to];
+}
+
+// Every mode sets and clears disjoint bits and uses one of the three frame
+// margins. The sheet of glass is only used without a caption and without a
+// transparent background, and frameless windows never extend the frame.
+constexpr bool WindowModesAreConsistent() {
+  for (const WindowModeAttributes& mode : kWindowModes) {
+    if ((mode.style_set & mode.style_clear) != 0 ||
+        (mode.ex_style_set & mode.ex_style_clear) != 0) {
+      return false;
+    }
+    bool no_frame = SameMargins(mode.margins, kNoFrameMargins);
+    bool sheet_of_glass = SameMargins(mode.margins, kSheetOfGlassMargins);
+    bool transparent = SameMargins(mode.margins, kTransparentMargins);
+    if (!no_frame && !sheet_of_glass && !transparent) {
+      return false;
+    }
+    if (sheet_of_glass && ((mode.style_set & WS_CAPTION) == WS_CAPTION ||
+                           mode.transparent_accent)) {
+      return false;
+    }
+    if (mode.frame == NcFrameMode::kFrameless && !no_frame) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Replaying each plan on its source mode yields the target mode, with:
+// - the steps in execution order, each at most once;
+// - the NC insets refreshed after the tracking they are computed from;
+// - everything applied before the frame change, which comes last but for the
+//   maximized re-show;
+// - an empty plan exactly when the tracked flags stay the same.
+constexpr bool WindowModePlansAreConsistent() {
+  for (size_t from = 0; from < kWindowModeCount; ++from) {
+    for (size_t to = 0; to < kWindowModeCount; ++to) {
+      const WindowModePlan& plan = WindowModePlanFor(
+          static_cast<uint8_t>(from), static_cast<uint8_t>(to));
+      const WindowModeAttributes& target = kWindowModes[to];
+      WindowModeAttributes state = kWindowModes[from];
+      bool frame_changed = false;
+      for (size_t i = 0; i < plan.count; ++i) {
+        WindowModeStep step = plan.steps[i];
+        if (i > 0 && plan.steps[i - 1] >= step) {
+          return false;
+        }
+        if (frame_changed && step != WindowModeStep::kReshowMaximized) {
+          return false;
+        }
+        switch (step) {
+          case WindowModeStep::kStyle:
+            state.style_set = target.style_set;
+            state.style_clear = target.style_clear;
+            break;
+          case WindowModeStep::kExStyle:
+            state.ex_style_set = target.ex_style_set;
+            state.ex_style_clear = target.ex_style_clear;
+            break;
+          case WindowModeStep::kCornerPreference:
+            state.corner = target.corner;
+            break;
+          case WindowModeStep::kNcRendering:
+            state.nc_rendering = target.nc_rendering;
+            break;
+          case WindowModeStep::kMargins:
+            state.margins = target.margins;
+            break;
+          case WindowModeStep::kAccent:
+            state.transparent_accent = target.transparent_accent;
+            break;
+          case WindowModeStep::kTracking:
+            state.flags = target.flags;
+            break;
+          case WindowModeStep::kNcInsets:
+            if (state.flags != target.flags) {
+              return false;
+            }
+            state.frame = target.frame;
+            break;
+          case WindowModeStep::kFrameChanged:
+            frame_changed = true;
+            break;
+          case WindowModeStep::kReshowMaximized:
+            if (!frame_changed || !(to & kWindowModeMaximized)) {
+              return false;
+            }
+            break;
+          case WindowModeStep::kCount:
+            return false;
+        }
+      }
+      bool same = state.flags == target.flags && state.frame == target.frame &&
+                  state.style_set == target.style_set &&
+                  state.style_clear == target.style_clear &&
+                  state.ex_style_set == target.ex_style_set &&
+                  state.ex_style_clear == target.ex_style_clear &&
+                  state.corner == target.corner &&
+                  state.nc_rendering == target.nc_rendering &&
+                  SameMargins(state.margins, target.margins) &&
+                  state.transparent_accent == target.transparent_accent;
+      if (!same || frame_changed != (plan.count > 0)) {
+        return false;
+      }
+      const WindowModeAttributes& source = kWindowModes[from];
+      bool unchanged = source.flags == target.flags;
+      if (unchanged != (plan.count == 0)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static_assert(WindowModesAreConsistent(),
+              "window modes must use the canonical frame margins");
+static_assert(WindowModePlansAreConsistent(),
+              "window mode plans must reach their target mode in order");
+
+#endif  // RUNNER_WINDOW_MODE_H_
@@ -0,0 +1,150 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "window_state_mirror.h"
+
+#include <cstddef>
+#include <type_traits>
+
+static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t) &&
+                  sizeof(std::atomic<int64_t>) == sizeof(int64_t),
+              "Mirrored fields must have the layout of plain integers");
+static_assert(sizeof(WindowStateRecord) == 40,
+              "WindowStateRecord layout is shared with Dart");
+static_assert(offsetof(WindowStateRecord, hwnd) == 8 &&
+                  offsetof(WindowStateRecord, mode) == 36,
+              "WindowStateRecord layout is shared with Dart");
+static_assert(std::is_standard_layout_v<WindowStateMirror> &&
+                  sizeof(WindowStateMirror) ==
+                      8 + WindowStateMirror::kCapacity * 40,
+              "WindowStateMirror layout is shared with Dart");
+
+namespace {
+
+int64_t HandleValue(HWND hwnd) {
+  return static_cast<int64_t>(reinterpret_cast<intptr_t>(hwnd));
+}
+
+}  // namespace
+
+void WindowStateRecord::Write(const WindowStateSnapshot& snapshot) {
+  uint32_t start = sequence.load(std::memory_order_relaxed);
+  sequence.store(start + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  dpi.store(snapshot.dpi, std::memory_order_relaxed);
+  hwnd.store(snapshot.hwnd, std::memory_order_relaxed);
+  x.store(snapshot.x, std::memory_order_relaxed);
+  y.store(snapshot.y, std::memory_order_relaxed);
+  width.store(snapshot.width, std::memory_order_relaxed);
+  height.store(snapshot.height, std::memory_order_relaxed);
+  flags.store(snapshot.flags, std::memory_order_relaxed);
+  mode.store(snapshot.mode, std::memory_order_relaxed);
+  sequence.store(start + 2, std::memory_order_release);
+}
+
+void WindowStateRecord::Read(WindowStateSnapshot* snapshot) const {
+  for (;;) {
+    uint32_t before = sequence.load(std::memory_order_acquire);
+    if (before & 1) {
+      ::YieldProcessor();
+      continue;
+    }
+    snapshot->dpi = dpi.load(std::memory_order_relaxed);
+    snapshot->hwnd = hwnd.load(std::memory_order_relaxed);
+    snapshot->x = x.load(std::memory_order_relaxed);
+    snapshot->y = y.load(std::memory_order_relaxed);
+    snapshot->width = width.load(std::memory_order_relaxed);
+    snapshot->height = height.load(std::memory_order_relaxed);
+    snapshot->flags = flags.load(std::memory_order_relaxed);
+    snapshot->mode = mode.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence.load(std::memory_order_relaxed) == before) {
+      return;
+    }
+  }
+}
+
+// static
+WindowStateMirror& WindowStateMirror::Instance() {
+  static WindowStateMirror instance;
+  return instance;
+}
+
+WindowStateMirror::WindowStateMirror()
+    : version_(kVersion), capacity_(kCapacity), records_() {}
+
+bool WindowStateMirror::Track(HWND hwnd, const WindowStateSnapshot& state) {
+  WindowStateRecord* record = Find(hwnd);
+  if (!record) {
+    record = Find(nullptr);
+  }
+  if (!record) {
+    return false;
+  }
+  Write(record, hwnd, state, (state.flags & kFocused) != 0);
+  return true;
+}
+
+void WindowStateMirror::Untrack(HWND hwnd) {
+  if (WindowStateRecord* record = Find(hwnd)) {
+    record->Write({});
+  }
+}
+
+void WindowStateMirror::Update(HWND hwnd, const WindowStateSnapshot& state) {
+  if (WindowStateRecord* record = Find(hwnd)) {
+    bool focused =
+        (record->flags.load(std::memory_order_relaxed) & kFocused) != 0;
+    Write(record, hwnd, state, focused);
+  }
+}
+
+void WindowStateMirror::UpdateFocus(HWND hwnd, bool focused) {
+  if (WindowStateRecord* record = Find(hwnd)) {
+    // The writer's own copy cannot be torn.
+    WindowStateSnapshot state;
+    record->Read(&state);
+    Write(record, hwnd, state, focused);
+  }
+}
+
+bool WindowStateMirror::Read(HWND hwnd, WindowStateSnapshot* snapshot) const {
+  int64_t value = HandleValue(hwnd);
+  for (const WindowStateRecord& record : records_) {
+    if (record.hwnd.load(std::memory_order_relaxed) != value) {
+      continue;
+    }
+    record.Read(snapshot);
+    // The slot may have been freed or reused in between.
+    if (snapshot->hwnd == value) {
+      return true;
+    }
+  }
+  return false;
+}
+
+WindowStateRecord* WindowStateMirror::Find(HWND hwnd) {
+  int64_t value = HandleValue(hwnd);
+  for (WindowStateRecord& record : records_) {
+    // Only the writer calls this, so the handle cannot change under it.
+    if (record.hwnd.load(std::memory_order_relaxed) == value) {
+      return &record;
+    }
+  }
+  return nullptr;
+}
+
+// static
+void WindowStateMirror::Write(WindowStateRecord* record,
+                              HWND hwnd,
+                              const WindowStateSnapshot& state,
+                              bool focused) {
+  WindowStateSnapshot snapshot = state;
+  snapshot.hwnd = HandleValue(hwnd);
+  snapshot.flags &= ~kFocused;
+  if (focused) {
+    snapshot.flags |= kFocused;
+  }
+  record->Write(snapshot);
+}
@@ -0,0 +1,119 @@
+// Copyright 2014 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef RUNNER_WINDOW_STATE_MIRROR_H_
+#define RUNNER_WINDOW_STATE_MIRROR_H_
+
+#include <windows.h>
+
+#include <atomic>
+#include <cstdint>
+
+// The state of a window as last written to the mirror.
+struct WindowStateSnapshot {
+  int64_t hwnd;
+  int32_t x;
+  int32_t y;
+  int32_t width;
+  int32_t height;
+  int32_t dpi;
+  int32_t flags;
+  int32_t mode;
+};
+
+// One window's slot in the mirror, guarded by a sequence lock: |sequence| is
+// odd while the single writer updates the fields, and a read is only good if
+// it saw the same even value before and after. The fields are atomics only
+// so that concurrent reads are defined; they have the layout of plain
+// integers.
+//
+// Layout (40 bytes), in int32 units: sequence 0, dpi 1, hwnd 2-3, x 4, y 5,
+// width 6, height 7, flags 8, mode 9. hwnd is 0 for a free slot.
+struct WindowStateRecord {
+  std::atomic<uint32_t> sequence;
+  std::atomic<int32_t> dpi;
+  std::atomic<int64_t> hwnd;
+  std::atomic<int32_t> x;
+  std::atomic<int32_t> y;
+  std::atomic<int32_t> width;
+  std::atomic<int32_t> height;
+  std::atomic<int32_t> flags;
+  std::atomic<int32_t> mode;
+
+  // Writer only.
+  void Write(const WindowStateSnapshot& snapshot);
+
+  // Any thread. Retries until it gets a consistent copy.
+  void Read(WindowStateSnapshot* snapshot) const;
+};
+
+// Bounds, DPI, state flags, window mode and focus of each of the app's
+// windows, kept in fixed-layout process memory so that Dart can map it once
+// through dart:ffi (MultipleWindowsGetStateMirror in window_ffi.h) and read
+// it with plain loads: no call, no message and no allocation per read.
+//
+// The mirror does not query windows: the subclass procedure passes in the
+// state it already tracks, from the WINDOWPOS of WM_WINDOWPOSCHANGED, from
+// WM_DPICHANGED and WM_ACTIVATE, and from the window mode executor after
+// every mode change. Writes happen on the platform thread only; reads are
+// safe from any thread.
+//
+// Dart reads without acquire ordering, which is only sound on x86 and x64,
+// where loads are not reordered with other loads; on other CPUs Dart does not
+// use the mirror and calls MultipleWindowsGetWindowState instead. Native
+// readers go through Read(), which is fenced.
+//
+// Layout: version (uint32), capacity (uint32), then |capacity| records.
+// lib/app/window_state_mirror.dart reads it by these offsets; bump kVersion
+// when they change.
+class WindowStateMirror {
+ public:
+  static constexpr uint32_t kVersion = 1;
+  static constexpr uint32_t kCapacity = 64;
+
+  // Bits of WindowStateRecord::flags.
+  enum Flags : int32_t {
+    kVisible = 1 << 0,
+    kMinimized = 1 << 1,
+    kMaximized = 1 << 2,
+    // The app's active window.
+    kFocused = 1 << 3,
+  };
+
+  static WindowStateMirror& Instance();
+
+  // Claims a record for |hwnd| and fills it with |state|; the hwnd of
+  // |state| is not used. Returns false if all records are in use; the window
+  // is then not mirrored.
+  bool Track(HWND hwnd, const WindowStateSnapshot& state);
+
+  // Frees the record of |hwnd|.
+  void Untrack(HWND hwnd);
+
+  // Rewrites the record of |hwnd|, if tracked, with |state|. Focus keeps its
+  // last value, whatever kFocused in |state| says; UpdateFocus sets it.
+  void Update(HWND hwnd, const WindowStateSnapshot& state);
+  void UpdateFocus(HWND hwnd, bool focused);
+
+  // Any thread. Returns false if |hwnd| is not tracked.
+  bool Read(HWND hwnd, WindowStateSnapshot* snapshot) const;
+
+ private:
+  WindowStateMirror();
+  WindowStateMirror(WindowStateMirror const&) = delete;
+  WindowStateMirror& operator=(WindowStateMirror const&) = delete;
+
+  WindowStateRecord* Find(HWND hwnd);
+  static void Write(WindowStateRecord* record,
+                    HWND hwnd,
+                    const WindowStateSnapshot& state,
+                    bool focused);
+
+  // The exported layout starts here.
+  uint32_t version_;
+  uint32_t capacity_;
+  WindowStateRecord records_[kCapacity];
+};
+
+#endif  // RUNNER_WINDOW_STATE_MIRROR_H_